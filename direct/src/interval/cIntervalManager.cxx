@@ -13,6 +13,7 @@
 
 #include "cIntervalManager.h"
 #include "cMetaInterval.h"
+#include "clockObject.h"
 #include "dcast.h"
 #include "eventQueue.h"
 #include "mutexHolder.h"
@@ -27,6 +28,7 @@ CIntervalManager() {
   _first_slot = 0;
   _next_event_index = 0;
   _event_queue = EventQueue::get_global_event_queue();
+  _lerp_batch = new CLerpBatch;
 }
 
 /**
@@ -246,7 +248,7 @@ get_max_index() const {
 /**
  * This should be called every frame to do the processing for all the active
  * intervals.  It will call step_play() for each interval that has been added
- * and that has not yet been removed.
+ * and that has not yet been removed, and then step the lerp batch.
  *
  * After each call to step(), the scripting language should call
  * get_next_event() and get_next_removal() repeatedly to process all the high-
@@ -278,6 +280,9 @@ step() {
     }
   }
 
+  // Then advance all of the simple lerps together.
+  _lerp_batch->step(ClockObject::get_global_clock()->get_frame_time());
+
   _next_event_index = 0;
 }
 
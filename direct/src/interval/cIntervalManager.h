@@ -16,6 +16,7 @@
 
 #include "directbase.h"
 #include "cInterval.h"
+#include "cLerpBatch.h"
 #include "pointerTo.h"
 #include "pvector.h"
 #include "pmap.h"
@@ -54,6 +55,8 @@ PUBLISHED:
   int get_num_intervals() const;
   int get_max_index() const;
 
+  INLINE CLerpBatch *get_lerp_batch() const;
+
   void step();
   int get_next_event();
   int get_next_removal();
@@ -63,6 +66,8 @@ PUBLISHED:
 
   static CIntervalManager *get_global_ptr();
 
+  MAKE_PROPERTY(lerp_batch, get_lerp_batch);
+
 private:
   void finish_interval(CInterval *interval);
   void remove_index(int index);
@@ -85,6 +90,8 @@ private:
   Removed _removed;
   EventQueue *_event_queue;
 
+  PT(CLerpBatch) _lerp_batch;
+
   int _first_slot;
   int _next_event_index;
 
@@ -0,0 +1,369 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file cLerpBatch.cxx
+ * @author agent
+ * @date 2026-10-18
+ */
+
+#include "cLerpBatch.h"
+#include "transformState.h"
+#include "renderState.h"
+#include "colorAttrib.h"
+#include "colorScaleAttrib.h"
+#include "lightMutexHolder.h"
+#include "pStatCollector.h"
+#include "pStatTimer.h"
+
+static PStatCollector lerp_batch_pcollector("App:Show code:ivalLoop:Lerp batch");
+
+/**
+ *
+ */
+CLerpBatch::
+CLerpBatch() {
+}
+
+/**
+ * Adds a lerp that moves the node from start_pos to end_pos, relative to its
+ * parent, over the indicated number of seconds.
+ */
+void CLerpBatch::
+add_pos_lerp(const NodePath &node, double duration,
+             const LPoint3 &start_pos, const LPoint3 &end_pos,
+             CLerpInterval::BlendType blend_type) {
+  add_lerp(node, P_pos, duration,
+           LVecBase4(start_pos, 0), LVecBase4(end_pos, 0), blend_type);
+}
+
+/**
+ * Adds a lerp that scales the node from start_scale to end_scale over the
+ * indicated number of seconds.
+ */
+void CLerpBatch::
+add_scale_lerp(const NodePath &node, double duration,
+               const LVecBase3 &start_scale, const LVecBase3 &end_scale,
+               CLerpInterval::BlendType blend_type) {
+  add_lerp(node, P_scale, duration,
+           LVecBase4(start_scale, 0), LVecBase4(end_scale, 0), blend_type);
+}
+
+/**
+ * Adds a lerp that changes the flat color of the node from start_color to
+ * end_color over the indicated number of seconds.
+ */
+void CLerpBatch::
+add_color_lerp(const NodePath &node, double duration,
+               const LColor &start_color, const LColor &end_color,
+               CLerpInterval::BlendType blend_type) {
+  add_lerp(node, P_color, duration, start_color, end_color, blend_type);
+}
+
+/**
+ * Adds a lerp that changes the color scale of the node from
+ * start_color_scale to end_color_scale over the indicated number of seconds.
+ */
+void CLerpBatch::
+add_color_scale_lerp(const NodePath &node, double duration,
+                     const LVecBase4 &start_color_scale,
+                     const LVecBase4 &end_color_scale,
+                     CLerpInterval::BlendType blend_type) {
+  add_lerp(node, P_color_scale, duration, start_color_scale, end_color_scale,
+           blend_type);
+}
+
+/**
+ * Removes all of the lerps on the indicated node from the batch, leaving the
+ * node in whatever state the last step() left it in.  Returns the number of
+ * lerps removed.
+ */
+int CLerpBatch::
+stop_lerps(const NodePath &node) {
+  LightMutexHolder holder(_lock);
+
+  PandaNode *stop_node = node.node();
+  size_t num_lerps = _nodes.size();
+  size_t j = 0;
+  for (size_t i = 0; i < num_lerps; ++i) {
+    if (_nodes[i] != stop_node) {
+      if (i != j) {
+        _nodes[j] = std::move(_nodes[i]);
+        _properties[j] = _properties[i];
+        _blend_types[j] = _blend_types[i];
+        _start_times[j] = _start_times[i];
+        _durations[j] = _durations[i];
+        _starts[j] = _starts[i];
+        _deltas[j] = _deltas[i];
+      }
+      ++j;
+    }
+  }
+
+  _nodes.resize(j);
+  _properties.resize(j);
+  _blend_types.resize(j);
+  _start_times.resize(j);
+  _durations.resize(j);
+  _starts.resize(j);
+  _deltas.resize(j);
+  return (int)(num_lerps - j);
+}
+
+/**
+ * Removes all of the lerps from the batch.
+ */
+void CLerpBatch::
+clear() {
+  LightMutexHolder holder(_lock);
+
+  _nodes.clear();
+  _properties.clear();
+  _blend_types.clear();
+  _start_times.clear();
+  _durations.clear();
+  _starts.clear();
+  _deltas.clear();
+}
+
+/**
+ * Advances all of the lerps in the batch to the indicated time, which is
+ * normally the current frame time, and applies the new values to their
+ * nodes.  Lerps that have reached their ending values are removed.
+ */
+void CLerpBatch::
+step(double t) {
+  LightMutexHolder holder(_lock);
+
+  size_t num_lerps = _nodes.size();
+  if (num_lerps == 0) {
+    return;
+  }
+
+  PStatTimer timer(lerp_batch_pcollector);
+  Thread *current_thread = Thread::get_current_thread();
+
+  _d.resize(num_lerps);
+  _values.resize(num_lerps);
+  double *d = &_d[0];
+
+  // First, compute the fraction of its duration that each lerp has run.
+  for (size_t i = 0; i < num_lerps; ++i) {
+    if (_start_times[i] < 0.0) {
+      _start_times[i] = t;
+    }
+  }
+  for (size_t i = 0; i < num_lerps; ++i) {
+    double duration = _durations[i];
+    double f = (duration > 0.0) ? (t - _start_times[i]) / duration : 1.0;
+    d[i] = std::min(std::max(f, 0.0), 1.0);
+  }
+
+  // Then apply the blend curve, which works the same way as in
+  // CLerpInterval::compute_delta().
+  for (size_t i = 0; i < num_lerps; ++i) {
+    double f = d[i];
+    double f2 = f * f;
+    switch (_blend_types[i]) {
+    case CLerpInterval::BT_ease_in:
+      d[i] = ((3.0 * f2) - (f2 * f)) * 0.5;
+      break;
+
+    case CLerpInterval::BT_ease_out:
+      d[i] = ((3.0 * f) - (f2 * f)) * 0.5;
+      break;
+
+    case CLerpInterval::BT_ease_in_out:
+      d[i] = (3.0 * f2) - (2.0 * f * f2);
+      break;
+
+    default:
+      break;
+    }
+  }
+
+  // Now compute all of the new values in one go.
+  const LVecBase4 *starts = &_starts[0];
+  const LVecBase4 *deltas = &_deltas[0];
+  LVecBase4 *values = &_values[0];
+  for (size_t i = 0; i < num_lerps; ++i) {
+    values[i] = starts[i] + deltas[i] * (PN_stdfloat)d[i];
+  }
+
+  // And apply them to the nodes, one run of lerps on the same node at a time.
+  size_t begin = 0;
+  while (begin < num_lerps) {
+    size_t end = begin + 1;
+    while (end < num_lerps && _nodes[end] == _nodes[begin]) {
+      ++end;
+    }
+    apply_values(begin, end, current_thread);
+    begin = end;
+  }
+
+  // Finally, remove the lerps that have finished.  Since the unblended
+  // fraction reaches 1 only at the end of the lerp, we can check the time.
+  size_t j = 0;
+  for (size_t i = 0; i < num_lerps; ++i) {
+    if (_durations[i] > 0.0 && t - _start_times[i] < _durations[i]) {
+      if (i != j) {
+        _nodes[j] = std::move(_nodes[i]);
+        _properties[j] = _properties[i];
+        _blend_types[j] = _blend_types[i];
+        _start_times[j] = _start_times[i];
+        _durations[j] = _durations[i];
+        _starts[j] = _starts[i];
+        _deltas[j] = _deltas[i];
+      }
+      ++j;
+    }
+  }
+
+  if (j != num_lerps) {
+    _nodes.resize(j);
+    _properties.resize(j);
+    _blend_types.resize(j);
+    _start_times.resize(j);
+    _durations.resize(j);
+    _starts.resize(j);
+    _deltas.resize(j);
+  }
+}
+
+/**
+ * Appends a new lerp to the batch.
+ */
+void CLerpBatch::
+add_lerp(const NodePath &node, Property property, double duration,
+         const LVecBase4 &start, const LVecBase4 &end,
+         CLerpInterval::BlendType blend_type) {
+  nassertv(!node.is_empty());
+  LightMutexHolder holder(_lock);
+
+  _nodes.push_back(node.node());
+  _properties.push_back(property);
+  _blend_types.push_back(blend_type);
+  _start_times.push_back(-1.0);
+  _durations.push_back(duration);
+  _starts.push_back(start);
+  _deltas.push_back(end - start);
+}
+
+/**
+ * Applies the values computed for the indicated range of lerps, which all
+ * affect the same node, to that node.  The node's transform and state are
+ * each replaced at most once.
+ */
+void CLerpBatch::
+apply_values(size_t begin, size_t end, Thread *current_thread) {
+  PandaNode *node = _nodes[begin];
+
+  // Gather up the new values first; if there are several lerps of the same
+  // property, the last one wins.
+  const LVecBase4 *pos = nullptr;
+  const LVecBase4 *scale = nullptr;
+  const LVecBase4 *color = nullptr;
+  const LVecBase4 *color_scale = nullptr;
+  for (size_t i = begin; i < end; ++i) {
+    switch (_properties[i]) {
+    case P_pos:
+      pos = &_values[i];
+      break;
+
+    case P_scale:
+      scale = &_values[i];
+      break;
+
+    case P_color:
+      color = &_values[i];
+      break;
+
+    case P_color_scale:
+      color_scale = &_values[i];
+      break;
+    }
+  }
+
+  if (pos != nullptr || scale != nullptr) {
+    CPT(TransformState) transform = node->get_transform(current_thread);
+    if (transform->has_components() && !transform->is_2d()) {
+      // Make the new transform in one go from its components.
+      LPoint3 new_pos = (pos != nullptr) ? LPoint3(pos->get_xyz()) : transform->get_pos();
+      LVecBase3 new_scale = (scale != nullptr) ? scale->get_xyz() : transform->get_scale();
+      if (transform->quat_given()) {
+        transform = TransformState::make_pos_quat_scale_shear
+          (new_pos, transform->get_quat(), new_scale, transform->get_shear());
+      } else {
+        transform = TransformState::make_pos_hpr_scale_shear
+          (new_pos, transform->get_hpr(), new_scale, transform->get_shear());
+      }
+
+    } else {
+      // The transform is given as a matrix; let TransformState work out how
+      // to replace the components.
+      if (pos != nullptr) {
+        transform = transform->set_pos(pos->get_xyz());
+      }
+      if (scale != nullptr) {
+        transform = transform->set_scale(scale->get_xyz());
+      }
+    }
+    node->set_transform(transform, current_thread);
+  }
+
+  if (color != nullptr || color_scale != nullptr) {
+    CPT(RenderState) state = node->get_state(current_thread);
+    CPT(RenderAttrib) color_attrib;
+    CPT(RenderAttrib) color_scale_attrib;
+    if (color != nullptr) {
+      color_attrib = ColorAttrib::make_flat(*color);
+    }
+    if (color_scale != nullptr) {
+      color_scale_attrib = ColorScaleAttrib::make(*color_scale);
+    }
+
+    int color_slot = ColorAttrib::get_class_slot();
+    int color_scale_slot = ColorScaleAttrib::get_class_slot();
+    RenderState::SlotMask lerp_slots;
+    lerp_slots.set_bit(color_slot);
+    lerp_slots.set_bit(color_scale_slot);
+
+    if (state->compare_mask(*RenderState::make_empty(), ~lerp_slots) == 0 &&
+        state->get_override(color_slot) == 0 &&
+        state->get_override(color_scale_slot) == 0) {
+      // The node's state holds nothing but the attributes being lerped, as is
+      // usually the case, so we can make the new state directly.
+      if (color_attrib == nullptr) {
+        color_attrib = state->get_attrib(color_slot);
+      }
+      if (color_scale_attrib == nullptr) {
+        color_scale_attrib = state->get_attrib(color_scale_slot);
+      }
+      const RenderAttrib *attribs[2];
+      int num_attribs = 0;
+      if (color_attrib != nullptr) {
+        attribs[num_attribs++] = color_attrib;
+      }
+      if (color_scale_attrib != nullptr) {
+        attribs[num_attribs++] = color_scale_attrib;
+      }
+      state = RenderState::make(attribs, num_attribs);
+
+    } else {
+      // Otherwise, we have to replace them one at a time.  We can't compose
+      // the changes onto the state, because that would multiply the color
+      // scales.
+      if (color_attrib != nullptr) {
+        state = state->set_attrib(color_attrib);
+      }
+      if (color_scale_attrib != nullptr) {
+        state = state->set_attrib(color_scale_attrib);
+      }
+    }
+    node->set_state(state, current_thread);
+  }
+}
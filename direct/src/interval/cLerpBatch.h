@@ -0,0 +1,104 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file cLerpBatch.h
+ * @author agent
+ * @date 2026-10-18
+ */
+
+#ifndef CLERPBATCH_H
+#define CLERPBATCH_H
+
+#include "directbase.h"
+#include "cLerpInterval.h"
+#include "referenceCount.h"
+#include "nodePath.h"
+#include "pandaNode.h"
+#include "pointerTo.h"
+#include "pvector.h"
+#include "lightMutex.h"
+
+/**
+ * A lightweight alternative to CLerpNodePathInterval for the common case of
+ * many simple lerps that each move a single property of a node--its
+ * position, scale, color, or color scale--from one value to another.
+ *
+ * Rather than being separate intervals, each with its own bookkeeping, the
+ * lerps in a batch are stored together in parallel arrays and are all
+ * evaluated in a single pass by step().  The new values are then applied to
+ * the nodes, composing one new TransformState or RenderState per node even
+ * if several of its properties are being lerped, provided that the lerps for
+ * the same node were added one after the other.
+ *
+ * A lerp begins at the first call to step() after it is added, and is
+ * removed from the batch once it reaches its ending value.  There are no done
+ * events; use a regular interval if you need to know when it finishes.
+ *
+ * Normally, you would use the batch owned by the CIntervalManager, which is
+ * stepped along with the intervals each frame.
+ */
+class EXPCL_DIRECT_INTERVAL CLerpBatch : public ReferenceCount {
+PUBLISHED:
+  CLerpBatch();
+
+  void add_pos_lerp(const NodePath &node, double duration,
+                    const LPoint3 &start_pos, const LPoint3 &end_pos,
+                    CLerpInterval::BlendType blend_type = CLerpInterval::BT_no_blend);
+  void add_scale_lerp(const NodePath &node, double duration,
+                      const LVecBase3 &start_scale, const LVecBase3 &end_scale,
+                      CLerpInterval::BlendType blend_type = CLerpInterval::BT_no_blend);
+  void add_color_lerp(const NodePath &node, double duration,
+                      const LColor &start_color, const LColor &end_color,
+                      CLerpInterval::BlendType blend_type = CLerpInterval::BT_no_blend);
+  void add_color_scale_lerp(const NodePath &node, double duration,
+                            const LVecBase4 &start_color_scale,
+                            const LVecBase4 &end_color_scale,
+                            CLerpInterval::BlendType blend_type = CLerpInterval::BT_no_blend);
+
+  int stop_lerps(const NodePath &node);
+  void clear();
+
+  INLINE int get_num_lerps() const;
+  MAKE_PROPERTY(num_lerps, get_num_lerps);
+
+  void step(double t);
+
+private:
+  enum Property {
+    P_pos,
+    P_scale,
+    P_color,
+    P_color_scale,
+  };
+
+  void add_lerp(const NodePath &node, Property property, double duration,
+                const LVecBase4 &start, const LVecBase4 &end,
+                CLerpInterval::BlendType blend_type);
+  void apply_values(size_t begin, size_t end, Thread *current_thread);
+
+  LightMutex _lock;
+
+  // The lerps, one element per lerp in each of these arrays.  The start time
+  // is negative until the lerp has been stepped for the first time.
+  typedef pvector<PT(PandaNode)> Nodes;
+  Nodes _nodes;
+  pvector<Property> _properties;
+  pvector<CLerpInterval::BlendType> _blend_types;
+  pvector<double> _start_times;
+  pvector<double> _durations;
+  pvector<LVecBase4> _starts;
+  pvector<LVecBase4> _deltas;
+
+  // Scratch arrays filled in by step().
+  pvector<double> _d;
+  pvector<LVecBase4> _values;
+};
+
+#include "cLerpBatch.I"
+
+#endif
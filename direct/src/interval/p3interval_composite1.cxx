@@ -7,6 +7,7 @@
 #include "cConstrainHprInterval.cxx"
 #include "cConstrainPosHprInterval.cxx"
 #include "cLerpInterval.cxx"
+#include "cLerpBatch.cxx"
 #include "cLerpNodePathInterval.cxx"
 #include "cLerpAnimEffectInterval.cxx"
 #include "cMetaInterval.cxx"
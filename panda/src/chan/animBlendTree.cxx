@@ -0,0 +1,583 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file animBlendTree.cxx
+ * @author agent
+ * @date 2026-10-18
+ */
+
+#include "animBlendTree.h"
+#include "partBundle.h"
+#include "movingPartMatrix.h"
+#include "movingPartScalar.h"
+#include "config_chan.h"
+
+#include <algorithm>
+
+/**
+ * Adds the indicated fraction of the difference between layer and ref to the
+ * matrix.  The difference is the transform that takes ref to layer, which is
+ * applied before base.
+ */
+static void
+abt_add_difference(LMatrix4 &base, const LMatrix4 &layer, const LMatrix4 &ref,
+                   PN_stdfloat weight) {
+  LMatrix4 inv_ref;
+  if (!inv_ref.invert_from(ref)) {
+    return;
+  }
+  LMatrix4 delta = layer * inv_ref;
+  if (weight != 1.0f) {
+    delta *= weight;
+    delta += LMatrix4::ident_mat() * (1.0f - weight);
+  }
+  base = delta * base;
+}
+
+/**
+ * Adds the indicated fraction of the difference between layer and ref to the
+ * scalar.
+ */
+static void
+abt_add_difference(PN_stdfloat &base, PN_stdfloat layer, PN_stdfloat ref,
+                   PN_stdfloat weight) {
+  base += (layer - ref) * weight;
+}
+
+/**
+ *
+ */
+AnimBlendTree::
+AnimBlendTree() :
+  _root(-1),
+  _controls_seq(0),
+  _weights_stale(true),
+  _masks_stale(true),
+  _bundle(nullptr),
+  _hierarchy_seq(0)
+{
+}
+
+/**
+ * Adds a node that plays the indicated AnimControl, which must have been
+ * bound to the PartBundle that the tree is assigned to.  The AnimControl is
+ * played, looped or posed as usual to choose the frame.  Returns the index of
+ * the new node.
+ */
+int AnimBlendTree::
+add_clip(AnimControl *control) {
+  nassertr(control != nullptr, -1);
+  int n = add_node(NT_clip);
+  _nodes[n]._control = control;
+
+  if (std::find(_controls.begin(), _controls.end(), control) == _controls.end()) {
+    _controls.push_back(control);
+    ++_controls_seq;
+  }
+  return n;
+}
+
+/**
+ * Adds a node that blends between its children according to the value of
+ * the named parameter.  Each child is placed at a point along the parameter's
+ * range with add_blend_child(); the two children on either side of the
+ * parameter's value are blended linearly.  Returns the index of the new node.
+ */
+int AnimBlendTree::
+add_blend_1d(const std::string &parameter) {
+  int n = add_node(NT_blend_1d);
+  _nodes[n]._parameter = find_parameter(parameter);
+  return n;
+}
+
+/**
+ * Adds a node that blends between its children according to the values of
+ * the two named parameters.  Each child is placed at a point in the plane
+ * with add_blend_child(), and is weighted by the inverse square of its
+ * distance from the point given by the parameters.  Returns the index of the
+ * new node.
+ */
+int AnimBlendTree::
+add_blend_2d(const std::string &x_parameter, const std::string &y_parameter) {
+  int n = add_node(NT_blend_2d);
+  _nodes[n]._parameter = find_parameter(x_parameter);
+  _nodes[n]._y_parameter = find_parameter(y_parameter);
+  return n;
+}
+
+/**
+ * Adds the indicated child to a 1-D or 2-D blend node, placed at the given
+ * point.  The y coordinate is ignored for a 1-D blend.  The child must have
+ * been added to the tree before the blend node.
+ */
+void AnimBlendTree::
+add_blend_child(int node, int child, PN_stdfloat x, PN_stdfloat y) {
+  nassertv(node >= 0 && node < (int)_nodes.size());
+  nassertv(child >= 0 && child < node);
+  Node &blend = _nodes[node];
+  nassertv(blend._type == NT_blend_1d || blend._type == NT_blend_2d);
+
+  if (blend._type == NT_blend_1d) {
+    // Keep the children sorted along the axis.
+    y = 0.0f;
+    size_t i = 0;
+    while (i < blend._points.size() && blend._points[i][0] <= x) {
+      ++i;
+    }
+    blend._children.insert(blend._children.begin() + i, child);
+    blend._points.insert(blend._points.begin() + i, LPoint2(x, y));
+  } else {
+    blend._children.push_back(child);
+    blend._points.push_back(LPoint2(x, y));
+  }
+  blend._weights.push_back(0.0f);
+  _weights_stale = true;
+}
+
+/**
+ * Adds a node that adds the difference between the layer and a reference
+ * pose on top of the base.  The reference pose is given by the reference
+ * node, or is the default pose of each joint if reference is -1.  If
+ * weight_parameter is given, the named parameter scales the difference, so
+ * that 0 leaves the base alone.  Returns the index of the new node.
+ */
+int AnimBlendTree::
+add_additive(int base, int layer, const std::string &weight_parameter,
+             int reference) {
+  int size = (int)_nodes.size();
+  nassertr(base >= 0 && base < size, -1);
+  nassertr(layer >= 0 && layer < size, -1);
+  nassertr(reference >= -1 && reference < size, -1);
+
+  int n = add_node(NT_additive);
+  Node &node = _nodes[n];
+  node._children.push_back(base);
+  node._children.push_back(layer);
+  if (reference >= 0) {
+    node._children.push_back(reference);
+  }
+  node._reference = reference;
+  if (!weight_parameter.empty()) {
+    node._parameter = find_parameter(weight_parameter);
+  }
+  return n;
+}
+
+/**
+ * Adds a node that replaces the base with the overlay on the joints named by
+ * the mask, and their descendants, as in PartBundle::bind_anim().  The other
+ * joints show the base.  If weight_parameter is given, the named parameter
+ * blends between the base, at 0, and the overlay, at 1.  Returns the index
+ * of the new node.
+ */
+int AnimBlendTree::
+add_layer(int base, int overlay, const PartSubset &mask,
+          const std::string &weight_parameter) {
+  int size = (int)_nodes.size();
+  nassertr(base >= 0 && base < size, -1);
+  nassertr(overlay >= 0 && overlay < size, -1);
+
+  int n = add_node(NT_layer);
+  Node &node = _nodes[n];
+  node._children.push_back(base);
+  node._children.push_back(overlay);
+  node._mask = mask;
+  if (!weight_parameter.empty()) {
+    node._parameter = find_parameter(weight_parameter);
+  }
+  _masks_stale = true;
+  return n;
+}
+
+/**
+ * Returns the weight that the nth node currently gives to its ith child, as
+ * computed from the parameters.  For an additive or layer node, this is the
+ * weight of the layer or the overlay.
+ */
+PN_stdfloat AnimBlendTree::
+get_node_child_weight(int n, int i) {
+  nassertr(n >= 0 && n < (int)_nodes.size(), 0.0f);
+  const Node &node = _nodes[n];
+  nassertr(i >= 0 && i < (int)node._children.size(), 0.0f);
+  if (_weights_stale) {
+    compute_weights();
+  }
+
+  switch (node._type) {
+  case NT_blend_1d:
+  case NT_blend_2d:
+    return node._weights[i];
+
+  case NT_additive:
+  case NT_layer:
+    return (i == 1) ? node._weight : 1.0f;
+
+  default:
+    return 0.0f;
+  }
+}
+
+/**
+ * Specifies the node whose result is applied to the bundle.
+ */
+void AnimBlendTree::
+set_root(int node) {
+  nassertv(node >= -1 && node < (int)_nodes.size());
+  _root = node;
+  _weights_stale = true;
+}
+
+/**
+ * Changes the value of the named parameter.  The new value takes effect at
+ * the bundle's next update.
+ */
+void AnimBlendTree::
+set_parameter(const std::string &name, PN_stdfloat value) {
+  int p = find_parameter(name);
+  if (_parameters[p] != value) {
+    _parameters[p] = value;
+    _weights_stale = true;
+  }
+}
+
+/**
+ * Returns the current value of the named parameter, or 0 if it has not been
+ * set.
+ */
+PN_stdfloat AnimBlendTree::
+get_parameter(const std::string &name) const {
+  ParameterIndex::const_iterator pi = _parameter_index.find(name);
+  if (pi == _parameter_index.end()) {
+    return 0.0f;
+  }
+  return _parameters[(*pi).second];
+}
+
+/**
+ * Returns true if the named parameter is used by any node, or has been set.
+ */
+bool AnimBlendTree::
+has_parameter(const std::string &name) const {
+  return _parameter_index.find(name) != _parameter_index.end();
+}
+
+/**
+ * Called by the PartBundle before each update to bring the tree up to date
+ * with the parameters and the bundle's part hierarchy.  Returns true if the
+ * result of the tree may have changed for reasons other than the frames of
+ * its AnimControls, in which case all of the parts must be evaluated again.
+ */
+bool AnimBlendTree::
+prepare(PartBundle *bundle) {
+  bool changed = false;
+
+  if (_masks_stale || bundle != _bundle ||
+      _hierarchy_seq != bundle->get_hierarchy_seq()) {
+    compute_masks(bundle);
+    changed = true;
+  }
+
+  if (_weights_stale) {
+    compute_weights();
+    changed = true;
+  }
+
+  return changed;
+}
+
+/**
+ * Computes the value of the indicated joint from the tree.
+ */
+void AnimBlendTree::
+evaluate(MovingPartMatrix *part, bool frame_blend, LMatrix4 &value) const {
+  if (_root < 0 || !r_evaluate(_root, part, frame_blend, value)) {
+    if (restore_initial_pose) {
+      value = part->_default_value;
+    }
+  }
+}
+
+/**
+ * Computes the value of the indicated slider from the tree.
+ */
+void AnimBlendTree::
+evaluate(MovingPartScalar *part, bool frame_blend, PN_stdfloat &value) const {
+  if (_root < 0 || !r_evaluate(_root, part, frame_blend, value)) {
+    if (restore_initial_pose) {
+      value = part->_default_value;
+    }
+  }
+}
+
+/**
+ * Appends a new, empty node of the indicated type and returns its index.
+ */
+int AnimBlendTree::
+add_node(NodeType type) {
+  Node node;
+  node._type = type;
+  node._parameter = -1;
+  node._y_parameter = -1;
+  node._reference = -1;
+  node._weight = 1.0f;
+  _nodes.push_back(node);
+  _weights_stale = true;
+  return (int)_nodes.size() - 1;
+}
+
+/**
+ * Returns the index of the named parameter, adding it if necessary.
+ */
+int AnimBlendTree::
+find_parameter(const std::string &name) {
+  ParameterIndex::const_iterator pi = _parameter_index.find(name);
+  if (pi != _parameter_index.end()) {
+    return (*pi).second;
+  }
+  int p = (int)_parameters.size();
+  _parameters.push_back(0.0f);
+  _parameter_index[name] = p;
+  return p;
+}
+
+/**
+ * Recomputes the weights of the children of the blend nodes, and the weights
+ * of the additive and layer nodes, from the current parameters.
+ */
+void AnimBlendTree::
+compute_weights() {
+  Nodes::iterator ni;
+  for (ni = _nodes.begin(); ni != _nodes.end(); ++ni) {
+    Node &node = (*ni);
+    size_t num_children = node._children.size();
+
+    switch (node._type) {
+    case NT_blend_1d:
+      if (num_children > 0) {
+        PN_stdfloat x = _parameters[node._parameter];
+        std::fill(node._weights.begin(), node._weights.end(), 0.0f);
+
+        // Find the pair of children on either side of x; beyond the ends,
+        // the nearest child has all of the weight.
+        size_t i = 0;
+        while (i < num_children && node._points[i][0] <= x) {
+          ++i;
+        }
+        if (i == 0) {
+          node._weights[0] = 1.0f;
+        } else if (i == num_children) {
+          node._weights[num_children - 1] = 1.0f;
+        } else {
+          PN_stdfloat x0 = node._points[i - 1][0];
+          PN_stdfloat x1 = node._points[i][0];
+          PN_stdfloat t = (x - x0) / (x1 - x0);
+          node._weights[i - 1] = 1.0f - t;
+          node._weights[i] = t;
+        }
+      }
+      break;
+
+    case NT_blend_2d:
+      if (num_children > 0) {
+        LPoint2 p(_parameters[node._parameter], _parameters[node._y_parameter]);
+        PN_stdfloat net = 0.0f;
+        size_t exact = num_children;
+        for (size_t i = 0; i < num_children; ++i) {
+          PN_stdfloat dist2 = (node._points[i] - p).length_squared();
+          if (dist2 < 1.0e-8f) {
+            exact = i;
+            break;
+          }
+          node._weights[i] = 1.0f / dist2;
+          net += node._weights[i];
+        }
+        if (exact < num_children) {
+          // The parameters are right on top of one of the children.
+          std::fill(node._weights.begin(), node._weights.end(), 0.0f);
+          node._weights[exact] = 1.0f;
+        } else {
+          for (size_t i = 0; i < num_children; ++i) {
+            node._weights[i] /= net;
+          }
+        }
+      }
+      break;
+
+    case NT_additive:
+    case NT_layer:
+      node._weight = (node._parameter < 0) ? 1.0f : _parameters[node._parameter];
+      break;
+
+    default:
+      break;
+    }
+  }
+
+  _weights_stale = false;
+}
+
+/**
+ * Determines which parts of the bundle are selected by the masks of the layer
+ * nodes.
+ */
+void AnimBlendTree::
+compute_masks(PartBundle *bundle) {
+  _bundle = bundle;
+  _hierarchy_seq = bundle->get_hierarchy_seq();
+
+  Nodes::iterator ni;
+  for (ni = _nodes.begin(); ni != _nodes.end(); ++ni) {
+    Node &node = (*ni);
+    if (node._type == NT_layer) {
+      node._masked_parts.clear();
+      if (bundle != nullptr) {
+        r_compute_mask(bundle, node._mask.is_include_empty(), node._mask,
+                       node._masked_parts);
+      }
+    }
+  }
+
+  _masks_stale = false;
+}
+
+/**
+ * Adds the parts at and below the indicated group that are selected by the
+ * mask to the set.  The rules are the same as for the PartSubset passed to
+ * PartBundle::bind_anim().
+ */
+void AnimBlendTree::
+r_compute_mask(PartGroup *group, bool is_included, const PartSubset &mask,
+               pset<const MovingPartBase *> &parts) {
+  if (mask.matches_include(group->get_name())) {
+    is_included = true;
+  } else if (mask.matches_exclude(group->get_name())) {
+    is_included = false;
+  }
+
+  if (is_included && group->is_of_type(MovingPartBase::get_class_type())) {
+    parts.insert(DCAST(MovingPartBase, group));
+  }
+
+  int num_children = group->get_num_children();
+  for (int i = 0; i < num_children; ++i) {
+    r_compute_mask(group->get_child(i), is_included, mask, parts);
+  }
+}
+
+/**
+ * Computes the value of the indicated part from the nth node.  Returns false
+ * if the node has no value for this part, for instance because none of its
+ * animations has a channel for it.
+ */
+template<class PartType, class ValueType>
+bool AnimBlendTree::
+r_evaluate(int n, PartType *part, bool frame_blend, ValueType &value) const {
+  typedef typename PartType::ChannelType ChannelType;
+  const Node &node = _nodes[n];
+
+  switch (node._type) {
+  case NT_clip:
+    {
+      AnimControl *control = node._control;
+      int channel_index = control->get_channel_index();
+      if (channel_index < 0 || channel_index >= (int)part->_channels.size() ||
+          part->_channels[channel_index] == nullptr) {
+        return false;
+      }
+      ChannelType *channel = DCAST(ChannelType, part->_channels[channel_index]);
+      channel->get_value(control->get_frame(), value);
+
+      if (frame_blend) {
+        PN_stdfloat frac = (PN_stdfloat)control->get_frac();
+        if (frac != 0.0f) {
+          ValueType next;
+          channel->get_value(control->get_next_frame(), next);
+          value *= (1.0f - frac);
+          value += next * frac;
+        }
+      }
+      return true;
+    }
+
+  case NT_blend_1d:
+  case NT_blend_2d:
+    {
+      // A weighted average of the children that have a value, skipping the
+      // ones that don't contribute at all.
+      bool any = false;
+      PN_stdfloat net = 0.0f;
+      size_t num_children = node._children.size();
+      for (size_t i = 0; i < num_children; ++i) {
+        PN_stdfloat weight = node._weights[i];
+        if (weight == 0.0f) {
+          continue;
+        }
+        ValueType v;
+        if (r_evaluate(node._children[i], part, frame_blend, v)) {
+          if (any) {
+            value += v * weight;
+          } else {
+            value = v * weight;
+            any = true;
+          }
+          net += weight;
+        }
+      }
+      if (!any || net == 0.0f) {
+        return false;
+      }
+      if (net != 1.0f) {
+        value *= (1.0f / net);
+      }
+      return true;
+    }
+
+  case NT_additive:
+    {
+      if (!r_evaluate(node._children[0], part, frame_blend, value)) {
+        value = part->_default_value;
+      }
+      if (node._weight == 0.0f) {
+        return true;
+      }
+      ValueType layer;
+      if (!r_evaluate(node._children[1], part, frame_blend, layer)) {
+        return true;
+      }
+      ValueType ref;
+      if (node._reference < 0 ||
+          !r_evaluate(node._reference, part, frame_blend, ref)) {
+        ref = part->_default_value;
+      }
+      abt_add_difference(value, layer, ref, node._weight);
+      return true;
+    }
+
+  case NT_layer:
+    {
+      bool has_base = r_evaluate(node._children[0], part, frame_blend, value);
+      if (node._weight == 0.0f ||
+          node._masked_parts.find(part) == node._masked_parts.end()) {
+        return has_base;
+      }
+      ValueType overlay;
+      if (!r_evaluate(node._children[1], part, frame_blend, overlay)) {
+        return has_base;
+      }
+      if (!has_base || node._weight == 1.0f) {
+        value = overlay;
+      } else {
+        value *= (1.0f - node._weight);
+        value += overlay * node._weight;
+      }
+      return true;
+    }
+  }
+
+  return false;
+}
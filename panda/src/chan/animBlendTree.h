@@ -0,0 +1,168 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file animBlendTree.h
+ * @author agent
+ * @date 2026-10-18
+ */
+
+#ifndef ANIMBLENDTREE_H
+#define ANIMBLENDTREE_H
+
+#include "pandabase.h"
+
+#include "referenceCount.h"
+#include "animControl.h"
+#include "partSubset.h"
+#include "pointerTo.h"
+#include "luse.h"
+#include "pvector.h"
+#include "pmap.h"
+#include "pset.h"
+#include "vector_int.h"
+
+class PartBundle;
+class PartGroup;
+class MovingPartBase;
+class MovingPartMatrix;
+class MovingPartScalar;
+
+/**
+ * A graph of blending operations between the AnimControls bound to a
+ * PartBundle, which replaces the simple weighted blend of
+ * PartBundle::set_control_effect() when it is assigned with
+ * PartBundle::set_blend_tree().
+ *
+ * The leaves of the tree are clips, each of which plays an AnimControl.
+ * These are combined by 1-D and 2-D blend spaces, which weight their children
+ * according to the position of one or two named parameters among the points
+ * the children are placed at; by additive nodes, which add the difference
+ * between a layer and a reference pose on top of a base; and by layer nodes,
+ * which replace the base with an overlay on only those joints named by a
+ * PartSubset.  Additive and layer nodes may also be faded in and out with a
+ * parameter.
+ *
+ * The tree is evaluated for each joint as part of the bundle's update, so
+ * that changing a parameter is the only work left to do each frame.  Nodes
+ * may only refer to nodes that were added before them, so the graph cannot
+ * contain cycles.  A tree should be assigned to only one PartBundle at a
+ * time.
+ */
+class EXPCL_PANDA_CHAN AnimBlendTree : public ReferenceCount {
+PUBLISHED:
+  enum NodeType {
+    NT_clip,
+    NT_blend_1d,
+    NT_blend_2d,
+    NT_additive,
+    NT_layer,
+  };
+
+  AnimBlendTree();
+
+  int add_clip(AnimControl *control);
+  int add_blend_1d(const std::string &parameter);
+  int add_blend_2d(const std::string &x_parameter,
+                   const std::string &y_parameter);
+  void add_blend_child(int node, int child, PN_stdfloat x,
+                       PN_stdfloat y = 0.0f);
+  int add_additive(int base, int layer,
+                   const std::string &weight_parameter = std::string(),
+                   int reference = -1);
+  int add_layer(int base, int overlay, const PartSubset &mask,
+                const std::string &weight_parameter = std::string());
+
+  INLINE int get_num_nodes() const;
+  INLINE NodeType get_node_type(int n) const;
+  INLINE AnimControl *get_node_control(int n) const;
+  INLINE int get_num_node_children(int n) const;
+  INLINE int get_node_child(int n, int i) const;
+  PN_stdfloat get_node_child_weight(int n, int i);
+
+  void set_root(int node);
+  INLINE int get_root() const;
+  MAKE_PROPERTY(root, get_root, set_root);
+
+  void set_parameter(const std::string &name, PN_stdfloat value);
+  PN_stdfloat get_parameter(const std::string &name) const;
+  bool has_parameter(const std::string &name) const;
+
+  INLINE int get_num_controls() const;
+  INLINE AnimControl *get_control(int n) const;
+  MAKE_SEQ(get_controls, get_num_controls, get_control);
+  MAKE_SEQ_PROPERTY(controls, get_num_controls, get_control);
+
+public:
+  bool prepare(PartBundle *bundle);
+  INLINE int get_controls_seq() const;
+
+  void evaluate(MovingPartMatrix *part, bool frame_blend,
+                LMatrix4 &value) const;
+  void evaluate(MovingPartScalar *part, bool frame_blend,
+                PN_stdfloat &value) const;
+
+private:
+  class Node {
+  public:
+    NodeType _type;
+    PT(AnimControl) _control;
+
+    // The blend parameters, or the weight parameter of an additive or layer
+    // node; -1 if none.
+    int _parameter;
+    int _y_parameter;
+
+    // The blended nodes, or the base and the layer or overlay.
+    vector_int _children;
+    pvector<LPoint2> _points;
+    int _reference;
+
+    // Recomputed by prepare() when the parameters change.
+    pvector<PN_stdfloat> _weights;
+    PN_stdfloat _weight;
+
+    // The parts selected by the mask of a layer node.
+    PartSubset _mask;
+    pset<const MovingPartBase *> _masked_parts;
+  };
+  typedef pvector<Node> Nodes;
+
+  int add_node(NodeType type);
+  int find_parameter(const std::string &name);
+  void compute_weights();
+  void compute_masks(PartBundle *bundle);
+  static void r_compute_mask(PartGroup *group, bool is_included,
+                             const PartSubset &mask,
+                             pset<const MovingPartBase *> &parts);
+
+#ifndef CPPPARSER
+  template<class PartType, class ValueType>
+  bool r_evaluate(int n, PartType *part, bool frame_blend,
+                  ValueType &value) const;
+#endif
+
+  Nodes _nodes;
+  int _root;
+
+  typedef pmap<std::string, int> ParameterIndex;
+  ParameterIndex _parameter_index;
+  pvector<PN_stdfloat> _parameters;
+
+  typedef pvector<PT(AnimControl)> Controls;
+  Controls _controls;
+  int _controls_seq;
+
+  bool _weights_stale;
+  bool _masks_stale;
+  PartBundle *_bundle;
+  int _hierarchy_seq;
+};
+
+#include "animBlendTree.I"
+
+#endif
@@ -12,6 +12,7 @@
  */
 
 #include "animBundle.h"
+#include "config_chan.h"
 
 #include "indent.h"
 #include "datagram.h"
@@ -47,6 +48,37 @@ copy_bundle() const {
   return DCAST(AnimBundle, group.p());
 }
 
+/**
+ * Replaces each AnimChannelMatrixXfmTable in the bundle with an
+ * AnimChannelMatrixCompressed, using the tolerances specified by the config
+ * variables compress-chan-rotation-tolerance,
+ * compress-chan-position-tolerance and compress-chan-scale-tolerance.
+ * Returns the number of channels that were replaced.
+ */
+int AnimBundle::
+compress_channels() {
+  return r_compress_channels(compress_chan_rotation_tolerance,
+                             compress_chan_position_tolerance,
+                             compress_chan_scale_tolerance);
+}
+
+/**
+ * Replaces each AnimChannelMatrixXfmTable in the bundle with an
+ * AnimChannelMatrixCompressed that reproduces it within the indicated
+ * tolerances.  The rotation tolerance is an angle in degrees.  See
+ * AnimChannelMatrixCompressed::compress().  Returns the number of channels
+ * that were replaced.
+ *
+ * This should be done before the animation is bound to any PartBundle.
+ */
+int AnimBundle::
+compress_channels(PN_stdfloat rotation_tolerance,
+                  PN_stdfloat position_tolerance,
+                  PN_stdfloat scale_tolerance) {
+  return r_compress_channels(rotation_tolerance, position_tolerance,
+                             scale_tolerance);
+}
+
 /**
  * Writes a one-line description of the bundle.
  */
@@ -38,6 +38,11 @@ PUBLISHED:
   INLINE double get_base_frame_rate() const;
   INLINE int get_num_frames() const;
 
+  int compress_channels();
+  int compress_channels(PN_stdfloat rotation_tolerance,
+                        PN_stdfloat position_tolerance,
+                        PN_stdfloat scale_tolerance);
+
   virtual void output(std::ostream &out) const;
 
 protected:
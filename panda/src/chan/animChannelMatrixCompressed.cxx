@@ -0,0 +1,791 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file animChannelMatrixCompressed.cxx
+ * @author agent
+ * @date 2026-10-18
+ */
+
+#include "animChannelMatrixCompressed.h"
+#include "animBundle.h"
+#include "config_chan.h"
+
+#include "indent.h"
+#include "datagram.h"
+#include "datagramIterator.h"
+#include "bamReader.h"
+#include "bamWriter.h"
+#include "deg_2_rad.h"
+#include "vector_int.h"
+
+#include <algorithm>
+
+TypeHandle AnimChannelMatrixCompressed::_type_handle;
+
+// No segment between two keys is allowed to span more frames than this.
+// This bounds the cost of the key reduction, which is quadratic in the
+// segment length.
+static const int compressed_max_span = 1024;
+
+/**
+ * Encodes the indicated unit quaternion into three 16-bit values, as decoded
+ * by Track::get_key_quat().
+ */
+static void
+compressed_encode_quat(const LQuaternion &quat, uint16_t v[3]) {
+  static const PN_stdfloat range = 0.70710678118654752f;
+
+  int largest = 0;
+  for (int i = 1; i < 4; ++i) {
+    if (cabs(quat[i]) > cabs(quat[largest])) {
+      largest = i;
+    }
+  }
+
+  // q and -q are the same rotation; choose the one whose largest component
+  // is positive, so that we can reconstruct it from the others.
+  PN_stdfloat sign = (quat[largest] < 0.0f) ? -1.0f : 1.0f;
+
+  int j = 0;
+  for (int i = 0; i < 4; ++i) {
+    if (i != largest) {
+      PN_stdfloat c = std::max(-range, std::min(range, quat[i] * sign));
+      v[j++] = (uint16_t)floor((c + range) / (2.0f * range) * 32767.0f + 0.5f);
+    }
+  }
+  v[0] |= (uint16_t)((largest & 1) << 15);
+  v[1] |= (uint16_t)((largest & 2) << 14);
+}
+
+/**
+ * Normalized linear interpolation between two rotations.
+ */
+static void
+compressed_nlerp(const LQuaternion &a, const LQuaternion &b, PN_stdfloat t,
+                 LQuaternion &result) {
+  if (a.dot(b) < 0.0f) {
+    result = a * (1.0f - t) - b * t;
+  } else {
+    result = a * (1.0f - t) + b * t;
+  }
+  result.normalize();
+}
+
+/**
+ * Returns true if the two rotations are within the indicated distance of each
+ * other, measured as the length of the difference between the quaternions.
+ * For the small angles we deal with, this is much better conditioned than
+ * comparing the dot product against a cosine.
+ */
+static bool
+compressed_quat_within(const LQuaternion &a, const LQuaternion &b,
+                       PN_stdfloat max_dist) {
+  LVecBase4 diff = a - b;
+  LVecBase4 sum = a + b;
+  PN_stdfloat dist2 = std::min(diff.length_squared(), sum.length_squared());
+  return dist2 <= max_dist * max_dist;
+}
+
+/**
+ * Used only for bam loader.
+ */
+AnimChannelMatrixCompressed::
+AnimChannelMatrixCompressed() : _num_frames(0) {
+}
+
+/**
+ * Creates a new AnimChannelMatrixCompressed, just like this one, without
+ * copying any children.  The new copy is added to the indicated parent.
+ * Intended to be called by make_copy() only.
+ */
+AnimChannelMatrixCompressed::
+AnimChannelMatrixCompressed(AnimGroup *parent, const AnimChannelMatrixCompressed &copy) :
+  AnimChannelMatrix(parent, copy),
+  _num_frames(copy._num_frames)
+{
+  for (int i = 0; i < TT_num_tracks; ++i) {
+    _tracks[i] = copy._tracks[i];
+  }
+}
+
+/**
+ * Creates a channel with no keys, which holds the identity matrix.  Use
+ * compress() to fill it.
+ */
+AnimChannelMatrixCompressed::
+AnimChannelMatrixCompressed(AnimGroup *parent, const std::string &name) :
+  AnimChannelMatrix(parent, name),
+  _num_frames(0)
+{
+}
+
+/**
+ *
+ */
+AnimChannelMatrixCompressed::
+~AnimChannelMatrixCompressed() {
+}
+
+/**
+ * Fills the channel with the animation of the indicated channel, which must
+ * be part of an animation with the same number of frames.  Only as many keys
+ * are stored as are needed to reproduce the source animation within the
+ * given tolerances: the rotation tolerance is an angle in degrees, the
+ * position and scale tolerances are distances in each component.  The scale
+ * tolerance applies to the shear as well.
+ */
+void AnimChannelMatrixCompressed::
+compress(AnimChannelMatrix *source, PN_stdfloat rotation_tolerance,
+         PN_stdfloat position_tolerance, PN_stdfloat scale_tolerance) {
+  nassertv(source != nullptr && _root != nullptr);
+
+  clear_keys();
+  _num_frames = _root->get_num_frames();
+  nassertv(_num_frames >= 0 && _num_frames <= 65535);
+
+  pvector<LVecBase3> scales, shears, positions;
+  pvector<LQuaternion> quats;
+  scales.reserve(_num_frames);
+  shears.reserve(_num_frames);
+  positions.reserve(_num_frames);
+  quats.reserve(_num_frames);
+
+  for (int f = 0; f < _num_frames; ++f) {
+    LVecBase3 scale, shear, pos;
+    LQuaternion quat;
+    source->get_scale(f, scale);
+    source->get_shear(f, shear);
+    source->get_quat(f, quat);
+    source->get_pos(f, pos);
+    quat.normalize();
+    scales.push_back(scale);
+    shears.push_back(shear);
+    quats.push_back(quat);
+    positions.push_back(pos);
+  }
+
+  compress_vec_track(_tracks[TT_scale], scales, LVecBase3(1.0f, 1.0f, 1.0f),
+                     scale_tolerance);
+  compress_vec_track(_tracks[TT_shear], shears, LVecBase3::zero(),
+                     scale_tolerance);
+  compress_quat_track(_tracks[TT_rotation], quats, rotation_tolerance);
+  compress_vec_track(_tracks[TT_pos], positions, LVecBase3::zero(),
+                     position_tolerance);
+}
+
+/**
+ * Removes all of the keys from the channel, so that it holds the identity
+ * matrix.
+ */
+void AnimChannelMatrixCompressed::
+clear_keys() {
+  for (int i = 0; i < TT_num_tracks; ++i) {
+    _tracks[i]._frames.clear();
+    _tracks[i]._values.clear();
+    _tracks[i]._floats.clear();
+  }
+}
+
+/**
+ * Returns the total number of keys stored for all of the components of the
+ * transform.  An uncompressed channel would store one key per frame for each
+ * component that changes.
+ */
+int AnimChannelMatrixCompressed::
+get_num_keys() const {
+  int num_keys = 0;
+  for (int i = 0; i < TT_num_tracks; ++i) {
+    num_keys += _tracks[i].get_num_keys();
+  }
+  return num_keys;
+}
+
+/**
+ * Returns true if the value has changed since the last call to has_changed().
+ * last_frame is the frame number of the last call; this_frame is the current
+ * frame number.
+ */
+bool AnimChannelMatrixCompressed::
+has_changed(int last_frame, double last_frac,
+            int this_frame, double this_frac) {
+  if (last_frame != this_frame) {
+    for (int i = 0; i < TT_num_tracks; ++i) {
+      if (_tracks[i].has_changed(wrap_frame(last_frame), wrap_frame(this_frame))) {
+        return true;
+      }
+    }
+  }
+
+  if (last_frac != this_frac) {
+    // If we have some fractional changes, also check the next subsequent
+    // frame (since we'll be blending with that).
+    for (int i = 0; i < TT_num_tracks; ++i) {
+      if (_tracks[i].has_changed(wrap_frame(last_frame), wrap_frame(this_frame + 1))) {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+/**
+ * Gets the value of the channel at the indicated frame.
+ */
+void AnimChannelMatrixCompressed::
+get_value(int frame, LMatrix4 &mat) {
+  frame = wrap_frame(frame);
+
+  LQuaternion quat;
+  LVecBase3 pos;
+  _tracks[TT_rotation].sample_quat(frame, quat);
+  _tracks[TT_pos].sample_vec(frame, pos);
+
+  LMatrix3 rot;
+  quat.extract_to_matrix(rot);
+
+  if (_tracks[TT_scale].get_num_keys() != 0 ||
+      _tracks[TT_shear].get_num_keys() != 0) {
+    LVecBase3 scale(1.0f, 1.0f, 1.0f);
+    LVecBase3 shear(0.0f, 0.0f, 0.0f);
+    _tracks[TT_scale].sample_vec(frame, scale);
+    _tracks[TT_shear].sample_vec(frame, shear);
+    rot = LMatrix3::scale_shear_mat(scale, shear) * rot;
+  }
+
+  mat = LMatrix4(rot, pos);
+}
+
+/**
+ * Gets the value of the channel at the indicated frame, without any scale or
+ * shear information.
+ */
+void AnimChannelMatrixCompressed::
+get_value_no_scale_shear(int frame, LMatrix4 &mat) {
+  frame = wrap_frame(frame);
+
+  LQuaternion quat;
+  LVecBase3 pos;
+  _tracks[TT_rotation].sample_quat(frame, quat);
+  _tracks[TT_pos].sample_vec(frame, pos);
+
+  LMatrix3 rot;
+  quat.extract_to_matrix(rot);
+  mat = LMatrix4(rot, pos);
+}
+
+/**
+ * Gets the scale value at the indicated frame.
+ */
+void AnimChannelMatrixCompressed::
+get_scale(int frame, LVecBase3 &scale) {
+  scale.set(1.0f, 1.0f, 1.0f);
+  _tracks[TT_scale].sample_vec(wrap_frame(frame), scale);
+}
+
+/**
+ * Returns the h, p, and r components associated with the current frame.  As
+ * above, this only makes sense for a matrix-type channel.
+ */
+void AnimChannelMatrixCompressed::
+get_hpr(int frame, LVecBase3 &hpr) {
+  LQuaternion quat;
+  _tracks[TT_rotation].sample_quat(wrap_frame(frame), quat);
+  hpr = quat.get_hpr();
+}
+
+/**
+ * Returns the rotation component associated with the current frame, expressed
+ * as a quaternion.  As above, this only makes sense for a matrix-type
+ * channel.
+ */
+void AnimChannelMatrixCompressed::
+get_quat(int frame, LQuaternion &quat) {
+  _tracks[TT_rotation].sample_quat(wrap_frame(frame), quat);
+}
+
+/**
+ * Returns the x, y, and z translation components associated with the current
+ * frame.  As above, this only makes sense for a matrix-type channel.
+ */
+void AnimChannelMatrixCompressed::
+get_pos(int frame, LVecBase3 &pos) {
+  pos.set(0.0f, 0.0f, 0.0f);
+  _tracks[TT_pos].sample_vec(wrap_frame(frame), pos);
+}
+
+/**
+ * Returns the a, b, and c shear components associated with the current frame.
+ * As above, this only makes sense for a matrix-type channel.
+ */
+void AnimChannelMatrixCompressed::
+get_shear(int frame, LVecBase3 &shear) {
+  shear.set(0.0f, 0.0f, 0.0f);
+  _tracks[TT_shear].sample_vec(wrap_frame(frame), shear);
+}
+
+/**
+ * Writes a brief description of the channel and all of its descendants.
+ */
+void AnimChannelMatrixCompressed::
+write(std::ostream &out, int indent_level) const {
+  static const char track_letters[TT_num_tracks] = { 's', 'a', 'r', 't' };
+
+  indent(out, indent_level)
+    << get_type() << " " << get_name() << " ";
+
+  // Write the number of keys in each of the tracks that have data.
+  bool found_any = false;
+  for (int i = 0; i < TT_num_tracks; ++i) {
+    if (_tracks[i].get_num_keys() != 0) {
+      out << track_letters[i] << _tracks[i].get_num_keys();
+      found_any = true;
+    }
+  }
+
+  if (!found_any) {
+    out << "(no data)";
+  }
+
+  if (!_children.empty()) {
+    out << " {\n";
+    write_descendants(out, indent_level + 2);
+    indent(out, indent_level) << "}";
+  }
+
+  out << "\n";
+}
+
+/**
+ * Returns a copy of this object, and attaches it to the indicated parent
+ * (which may be NULL only if this is an AnimBundle).  Intended to be called
+ * by copy_subtree() only.
+ */
+AnimGroup *AnimChannelMatrixCompressed::
+make_copy(AnimGroup *parent) const {
+  return new AnimChannelMatrixCompressed(parent, *this);
+}
+
+/**
+ * Quantizes the indicated per-frame values into the track, storing only the
+ * keys needed to reproduce them within the tolerance.  If the values are all
+ * within the tolerance of the default value, the track is left empty.
+ */
+void AnimChannelMatrixCompressed::
+compress_vec_track(Track &track, const pvector<LVecBase3> &values,
+                   const LVecBase3 &default_value, PN_stdfloat tolerance) {
+  int num_frames = (int)values.size();
+  if (num_frames == 0) {
+    return;
+  }
+
+  LVecBase3 min_value = values[0];
+  LVecBase3 max_value = values[0];
+  bool is_default = true;
+  for (int f = 0; f < num_frames; ++f) {
+    for (int c = 0; c < 3; ++c) {
+      min_value[c] = std::min(min_value[c], values[f][c]);
+      max_value[c] = std::max(max_value[c], values[f][c]);
+      if (cabs(values[f][c] - default_value[c]) > tolerance) {
+        is_default = false;
+      }
+    }
+  }
+  if (is_default) {
+    return;
+  }
+
+  track._base = min_value;
+  track._step = (max_value - min_value) / 65535.0f;
+
+  // Quantize all of the frames first, and decode them again, so that the
+  // error of the interpolated frames is measured against what the reader
+  // will actually see.
+  pvector<uint16_t> quantized(num_frames * 3);
+  pvector<LVecBase3> decoded(num_frames);
+  bool quantized_ok = true;
+  for (int f = 0; f < num_frames; ++f) {
+    for (int c = 0; c < 3; ++c) {
+      int q = 0;
+      if (track._step[c] > 0.0f) {
+        q = (int)floor((values[f][c] - min_value[c]) / track._step[c] + 0.5f);
+        q = std::max(0, std::min(65535, q));
+      }
+      quantized[f * 3 + c] = (uint16_t)q;
+      decoded[f][c] = track._base[c] + q * track._step[c];
+      if (cabs(decoded[f][c] - values[f][c]) > tolerance) {
+        quantized_ok = false;
+      }
+    }
+  }
+
+  pvector<PN_float32> floats;
+  if (!quantized_ok) {
+    // The range of the track is too large for 16 bits to reach the
+    // tolerance, as may be the case for root motion.  Store the keys as
+    // floats instead.
+    floats.resize(num_frames * 3);
+    for (int f = 0; f < num_frames; ++f) {
+      for (int c = 0; c < 3; ++c) {
+        floats[f * 3 + c] = (PN_float32)values[f][c];
+        decoded[f][c] = floats[f * 3 + c];
+      }
+    }
+    track._base = LVecBase3::zero();
+    track._step = LVecBase3::zero();
+  }
+
+  // Now extend each segment from its first key for as long as the frames in
+  // between can be interpolated within the tolerance.  The keys themselves
+  // are already known to be within the tolerance.
+  vector_int keys;
+  keys.push_back(0);
+  int a = 0;
+  while (a < num_frames - 1) {
+    int b = a + 1;
+    while (b + 1 < num_frames && b + 1 - a <= compressed_max_span) {
+      int c = b + 1;
+      bool ok = true;
+      for (int i = a + 1; i < c && ok; ++i) {
+        PN_stdfloat t = (PN_stdfloat)(i - a) / (PN_stdfloat)(c - a);
+        LVecBase3 v = decoded[a] + (decoded[c] - decoded[a]) * t;
+        ok = (cabs(v[0] - values[i][0]) <= tolerance &&
+              cabs(v[1] - values[i][1]) <= tolerance &&
+              cabs(v[2] - values[i][2]) <= tolerance);
+      }
+      if (!ok) {
+        break;
+      }
+      b = c;
+    }
+    keys.push_back(b);
+    a = b;
+  }
+
+  // A track that holds still needs only its first key.
+  if (keys.size() == 2 && num_frames > 1 &&
+      decoded[0] == decoded[num_frames - 1]) {
+    keys.pop_back();
+  }
+
+  for (size_t k = 0; k < keys.size(); ++k) {
+    int f = keys[k];
+    track._frames.push_back((uint16_t)f);
+    for (int c = 0; c < 3; ++c) {
+      if (quantized_ok) {
+        track._values.push_back(quantized[f * 3 + c]);
+      } else {
+        track._floats.push_back(floats[f * 3 + c]);
+      }
+    }
+  }
+  if ((int)keys.size() == num_frames) {
+    track._frames.clear();
+  }
+}
+
+/**
+ * Quantizes the indicated per-frame rotations into the track, storing only
+ * the keys needed to reproduce them within the tolerance, which is an angle
+ * in degrees.  If the rotations are all within the tolerance of the identity,
+ * the track is left empty.
+ */
+void AnimChannelMatrixCompressed::
+compress_quat_track(Track &track, const pvector<LQuaternion> &values,
+                    PN_stdfloat tolerance) {
+  int num_frames = (int)values.size();
+  if (num_frames == 0) {
+    return;
+  }
+
+  // The difference between two unit quaternions that are an angle apart has
+  // a length of twice the sine of a quarter of the angle.
+  PN_stdfloat max_dist = 2.0f * csin(deg_2_rad(tolerance) * 0.25f);
+
+  bool is_identity = true;
+  for (int f = 0; f < num_frames && is_identity; ++f) {
+    is_identity = compressed_quat_within(values[f], LQuaternion::ident_quat(),
+                                         max_dist);
+  }
+  if (is_identity) {
+    return;
+  }
+
+  track._base = LVecBase3::zero();
+  track._step = LVecBase3::zero();
+  track._values.resize(num_frames * 3);
+  pvector<LQuaternion> decoded(num_frames);
+  for (int f = 0; f < num_frames; ++f) {
+    compressed_encode_quat(values[f], &track._values[f * 3]);
+    track.get_key_quat(f, decoded[f]);
+  }
+  pvector<uint16_t> quantized;
+  quantized.swap(track._values);
+
+  vector_int keys;
+  keys.push_back(0);
+  int a = 0;
+  while (a < num_frames - 1) {
+    int b = a + 1;
+    while (b + 1 < num_frames && b + 1 - a <= compressed_max_span) {
+      int c = b + 1;
+      bool ok = true;
+      for (int i = a + 1; i < c && ok; ++i) {
+        PN_stdfloat t = (PN_stdfloat)(i - a) / (PN_stdfloat)(c - a);
+        LQuaternion q;
+        compressed_nlerp(decoded[a], decoded[c], t, q);
+        ok = compressed_quat_within(q, values[i], max_dist);
+      }
+      if (!ok) {
+        break;
+      }
+      b = c;
+    }
+    keys.push_back(b);
+    a = b;
+  }
+
+  if (keys.size() == 2 && num_frames > 1 &&
+      quantized[0] == quantized[(num_frames - 1) * 3] &&
+      quantized[1] == quantized[(num_frames - 1) * 3 + 1] &&
+      quantized[2] == quantized[(num_frames - 1) * 3 + 2]) {
+    keys.pop_back();
+  }
+
+  for (size_t k = 0; k < keys.size(); ++k) {
+    int f = keys[k];
+    track._frames.push_back((uint16_t)f);
+    track._values.push_back(quantized[f * 3]);
+    track._values.push_back(quantized[f * 3 + 1]);
+    track._values.push_back(quantized[f * 3 + 2]);
+  }
+  if ((int)keys.size() == num_frames) {
+    track._frames.clear();
+  }
+}
+
+/**
+ * Determines the two keys to interpolate between for the indicated frame,
+ * which must already be in the range of the animation, and the fraction of
+ * the way from the first to the second.  The track must have at least one
+ * key.
+ */
+void AnimChannelMatrixCompressed::Track::
+find_keys(int frame, int &k0, int &k1, PN_stdfloat &t) const {
+  int num_keys = get_num_keys();
+  t = 0.0f;
+
+  if (_frames.empty()) {
+    // Every frame is a key.
+    k0 = k1 = std::min(frame, num_keys - 1);
+    return;
+  }
+
+  pvector<uint16_t>::const_iterator it =
+    std::upper_bound(_frames.begin(), _frames.end(), (uint16_t)frame);
+  k1 = (int)(it - _frames.begin());
+  if (k1 >= num_keys) {
+    k0 = k1 = num_keys - 1;
+    return;
+  }
+  k0 = std::max(k1 - 1, 0);
+  int f0 = _frames[k0];
+  int f1 = _frames[k1];
+  if (f1 > f0) {
+    t = (PN_stdfloat)(frame - f0) / (PN_stdfloat)(f1 - f0);
+  }
+}
+
+/**
+ * Returns true if the track may have a different value at the two indicated
+ * frames, which must already be in the range of the animation.
+ */
+bool AnimChannelMatrixCompressed::Track::
+has_changed(int frame_a, int frame_b) const {
+  if (get_num_keys() <= 1 || frame_a == frame_b) {
+    return false;
+  }
+
+  int a0, a1, b0, b1;
+  PN_stdfloat ta, tb;
+  find_keys(frame_a, a0, a1, ta);
+  find_keys(frame_b, b0, b1, tb);
+
+  if (a0 != b0 || a1 != b1) {
+    return true;
+  }
+
+  // Both frames are between the same two keys; the value changes only if
+  // those keys differ.
+  return (ta != tb && keys_differ(a0, a1));
+}
+
+/**
+ * Samples a vector track at the indicated frame.  The value is left unchanged
+ * if the track has no keys.
+ */
+void AnimChannelMatrixCompressed::Track::
+sample_vec(int frame, LVecBase3 &value) const {
+  if (get_num_keys() == 0) {
+    return;
+  }
+
+  int k0, k1;
+  PN_stdfloat t;
+  find_keys(frame, k0, k1, t);
+  get_key_vec(k0, value);
+  if (t != 0.0f) {
+    LVecBase3 v1;
+    get_key_vec(k1, v1);
+    value += (v1 - value) * t;
+  }
+}
+
+/**
+ * Samples the rotation track at the indicated frame.  The identity is
+ * returned if the track has no keys.
+ */
+void AnimChannelMatrixCompressed::Track::
+sample_quat(int frame, LQuaternion &quat) const {
+  if (_values.empty()) {
+    quat = LQuaternion::ident_quat();
+    return;
+  }
+
+  int k0, k1;
+  PN_stdfloat t;
+  find_keys(frame, k0, k1, t);
+  if (t == 0.0f) {
+    get_key_quat(k0, quat);
+  } else {
+    LQuaternion q0, q1;
+    get_key_quat(k0, q0);
+    get_key_quat(k1, q1);
+    compressed_nlerp(q0, q1, t, quat);
+  }
+}
+
+/**
+ * Writes the contents of the track to the datagram.
+ */
+void AnimChannelMatrixCompressed::Track::
+write_datagram(Datagram &me, bool rotation, int num_frames) const {
+  int num_keys = get_num_keys();
+  me.add_uint16(num_keys);
+  if (num_keys == 0) {
+    return;
+  }
+
+  // The frame numbers are implied if every frame is a key.
+  if (num_keys != num_frames) {
+    for (int k = 0; k < num_keys; ++k) {
+      me.add_uint16(_frames[k]);
+    }
+  }
+  if (!rotation) {
+    me.add_bool(!_floats.empty());
+    if (!_floats.empty()) {
+      for (size_t i = 0; i < _floats.size(); ++i) {
+        me.add_float32(_floats[i]);
+      }
+      return;
+    }
+    _base.write_datagram(me);
+    _step.write_datagram(me);
+  }
+  for (size_t i = 0; i < _values.size(); ++i) {
+    me.add_uint16(_values[i]);
+  }
+}
+
+/**
+ * Reads the contents of the track from the datagram.
+ */
+void AnimChannelMatrixCompressed::Track::
+fillin(DatagramIterator &scan, bool rotation, int num_frames) {
+  int num_keys = scan.get_uint16();
+  _frames.clear();
+  _values.clear();
+  _floats.clear();
+  if (num_keys == 0) {
+    return;
+  }
+
+  if (num_keys != num_frames) {
+    _frames.reserve(num_keys);
+    for (int k = 0; k < num_keys; ++k) {
+      _frames.push_back(scan.get_uint16());
+    }
+  }
+  if (!rotation) {
+    if (scan.get_bool()) {
+      _floats.reserve(num_keys * 3);
+      for (int i = 0; i < num_keys * 3; ++i) {
+        _floats.push_back(scan.get_float32());
+      }
+      return;
+    }
+    _base.read_datagram(scan);
+    _step.read_datagram(scan);
+  }
+  _values.reserve(num_keys * 3);
+  for (int i = 0; i < num_keys * 3; ++i) {
+    _values.push_back(scan.get_uint16());
+  }
+}
+
+/**
+ * Function to write the important information in the particular object to a
+ * Datagram
+ */
+void AnimChannelMatrixCompressed::
+write_datagram(BamWriter *manager, Datagram &me) {
+  AnimChannelMatrix::write_datagram(manager, me);
+
+  me.add_uint16(_num_frames);
+  for (int i = 0; i < TT_num_tracks; ++i) {
+    _tracks[i].write_datagram(me, i == TT_rotation, _num_frames);
+  }
+}
+
+/**
+ * Function that reads out of the datagram (or asks manager to read) all of
+ * the data that is needed to re-create this object and stores it in the
+ * appropiate place
+ */
+void AnimChannelMatrixCompressed::
+fillin(DatagramIterator &scan, BamReader *manager) {
+  AnimChannelMatrix::fillin(scan, manager);
+
+  _num_frames = scan.get_uint16();
+  for (int i = 0; i < TT_num_tracks; ++i) {
+    _tracks[i].fillin(scan, i == TT_rotation, _num_frames);
+  }
+}
+
+/**
+ * Factory method to generate an AnimChannelMatrixCompressed object.
+ */
+TypedWritable *AnimChannelMatrixCompressed::
+make_AnimChannelMatrixCompressed(const FactoryParams &params) {
+  AnimChannelMatrixCompressed *me = new AnimChannelMatrixCompressed;
+  DatagramIterator scan;
+  BamReader *manager;
+
+  parse_params(params, scan, manager);
+  me->fillin(scan, manager);
+  return me;
+}
+
+/**
+ * Factory method to generate an AnimChannelMatrixCompressed object.
+ */
+void AnimChannelMatrixCompressed::
+register_with_read_factory() {
+  BamReader::get_factory()->register_factory(get_class_type(), make_AnimChannelMatrixCompressed);
+}
@@ -0,0 +1,150 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file animChannelMatrixCompressed.h
+ * @author agent
+ * @date 2026-10-18
+ */
+
+#ifndef ANIMCHANNELMATRIXCOMPRESSED_H
+#define ANIMCHANNELMATRIXCOMPRESSED_H
+
+#include "pandabase.h"
+
+#include "animChannel.h"
+#include "pvector.h"
+#include "luse.h"
+#include "cmath.h"
+
+/**
+ * An animation channel that issues a matrix each frame, read from a set of
+ * compressed key tables.  This is a much more compact alternative to
+ * AnimChannelMatrixXfmTable, both on disk and in memory.
+ *
+ * The rotation is stored as a quaternion, quantized to 48 bits by storing
+ * only its three smallest components.  The scale, shear and translation are
+ * quantized to 16 bits per component relative to their range over the
+ * animation, or stored as floats if that range is too large for 16 bits to
+ * meet the tolerance.  Furthermore, only the frames that are needed to reproduce the
+ * animation within a given tolerance are stored; the frames in between are
+ * reconstructed by interpolating between the nearest stored keys.
+ *
+ * Use compress() to fill the channel from another matrix channel, or
+ * AnimBundle::compress_channels() to replace all of the
+ * AnimChannelMatrixXfmTables in an animation.
+ */
+class EXPCL_PANDA_CHAN AnimChannelMatrixCompressed : public AnimChannelMatrix {
+protected:
+  AnimChannelMatrixCompressed();
+  AnimChannelMatrixCompressed(AnimGroup *parent, const AnimChannelMatrixCompressed &copy);
+
+PUBLISHED:
+  explicit AnimChannelMatrixCompressed(AnimGroup *parent, const std::string &name);
+  virtual ~AnimChannelMatrixCompressed();
+
+  void compress(AnimChannelMatrix *source, PN_stdfloat rotation_tolerance,
+                PN_stdfloat position_tolerance, PN_stdfloat scale_tolerance);
+  void clear_keys();
+
+  INLINE int get_num_frames() const;
+  int get_num_keys() const;
+
+public:
+  virtual bool has_changed(int last_frame, double last_frac,
+                           int this_frame, double this_frac);
+  virtual void get_value(int frame, LMatrix4 &mat);
+
+  virtual void get_value_no_scale_shear(int frame, LMatrix4 &value);
+  virtual void get_scale(int frame, LVecBase3 &scale);
+  virtual void get_hpr(int frame, LVecBase3 &hpr);
+  virtual void get_quat(int frame, LQuaternion &quat);
+  virtual void get_pos(int frame, LVecBase3 &pos);
+  virtual void get_shear(int frame, LVecBase3 &shear);
+
+  virtual void write(std::ostream &out, int indent_level) const;
+
+protected:
+  virtual AnimGroup *make_copy(AnimGroup *parent) const;
+
+private:
+  enum TrackType {
+    TT_scale,
+    TT_shear,
+    TT_rotation,
+    TT_pos,
+    TT_num_tracks,
+  };
+
+  // One component of the transform, such as the translation.  Each key
+  // stores three 16-bit values; for the vector tracks these scale _step and
+  // are added to _base, for the rotation track they encode a quaternion.  A
+  // vector track whose range is too large to be quantized to 16 bits within
+  // the tolerance stores its keys as floats in _floats instead.
+  class Track {
+  public:
+    INLINE int get_num_keys() const;
+    INLINE bool keys_differ(int k0, int k1) const;
+    void find_keys(int frame, int &k0, int &k1, PN_stdfloat &t) const;
+    bool has_changed(int frame_a, int frame_b) const;
+
+    INLINE void get_key_vec(int k, LVecBase3 &value) const;
+    INLINE void get_key_quat(int k, LQuaternion &quat) const;
+    void sample_vec(int frame, LVecBase3 &value) const;
+    void sample_quat(int frame, LQuaternion &quat) const;
+
+    void write_datagram(Datagram &me, bool rotation, int num_frames) const;
+    void fillin(DatagramIterator &scan, bool rotation, int num_frames);
+
+    // The frame number of each key, or empty if every frame is a key.
+    pvector<uint16_t> _frames;
+    pvector<uint16_t> _values;
+    pvector<PN_float32> _floats;
+    LVecBase3 _base;
+    LVecBase3 _step;
+  };
+
+  void compress_vec_track(Track &track, const pvector<LVecBase3> &values,
+                          const LVecBase3 &default_value,
+                          PN_stdfloat tolerance);
+  void compress_quat_track(Track &track, const pvector<LQuaternion> &values,
+                           PN_stdfloat tolerance);
+  INLINE int wrap_frame(int frame) const;
+
+  Track _tracks[TT_num_tracks];
+  int _num_frames;
+
+public:
+  static void register_with_read_factory();
+  virtual void write_datagram(BamWriter *manager, Datagram &me);
+
+  static TypedWritable *make_AnimChannelMatrixCompressed(const FactoryParams &params);
+
+protected:
+  void fillin(DatagramIterator &scan, BamReader *manager);
+
+public:
+  virtual TypeHandle get_type() const {
+    return get_class_type();
+  }
+  virtual TypeHandle force_init_type() {init_type(); return get_class_type();}
+  static TypeHandle get_class_type() {
+    return _type_handle;
+  }
+  static void init_type() {
+    AnimChannelMatrix::init_type();
+    register_type(_type_handle, "AnimChannelMatrixCompressed",
+                  AnimChannelMatrix::get_class_type());
+  }
+
+private:
+  static TypeHandle _type_handle;
+};
+
+#include "animChannelMatrixCompressed.I"
+
+#endif
@@ -0,0 +1,183 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file animChannelMatrixStreamed.cxx
+ * @author agent
+ * @date 2026-10-18
+ */
+
+#include "animChannelMatrixStreamed.h"
+#include "indent.h"
+
+TypeHandle AnimChannelMatrixStreamed::_type_handle;
+
+/**
+ * Creates a new AnimChannelMatrixStreamed, just like this one, without
+ * copying any children.  The new copy is added to the indicated parent.
+ * Intended to be called by make_copy() only.
+ */
+AnimChannelMatrixStreamed::
+AnimChannelMatrixStreamed(AnimGroup *parent, const AnimChannelMatrixStreamed &copy) :
+  AnimChannelMatrix(parent, copy),
+  _stream(copy._stream),
+  _offset(copy._offset)
+{
+}
+
+/**
+ * Creates a channel that reads its values from the indicated stream, at the
+ * given position within each frame.
+ */
+AnimChannelMatrixStreamed::
+AnimChannelMatrixStreamed(AnimGroup *parent, const std::string &name,
+                          AnimStream *stream, int offset) :
+  AnimChannelMatrix(parent, name),
+  _stream(stream),
+  _offset(offset)
+{
+}
+
+/**
+ * Returns true if the value has changed since the last call to has_changed().
+ * last_frame is the frame number of the last call; this_frame is the current
+ * frame number.
+ */
+bool AnimChannelMatrixStreamed::
+has_changed(int last_frame, double last_frac,
+            int this_frame, double this_frac) {
+  // We don't want to read the chunk of the last frame again just to find
+  // out, so we assume that any different frame is a change.
+  return (last_frame != this_frame || last_frac != this_frac);
+}
+
+/**
+ * Gets the value of the channel at the indicated frame.
+ */
+void AnimChannelMatrixStreamed::
+get_value(int frame, LMatrix4 &mat) {
+  PN_stdfloat components[num_matrix_components];
+  get_components(frame, components);
+  compose_matrix(mat, components);
+}
+
+/**
+ * Gets the value of the channel at the indicated frame, without any scale or
+ * shear information.
+ */
+void AnimChannelMatrixStreamed::
+get_value_no_scale_shear(int frame, LMatrix4 &mat) {
+  PN_stdfloat components[num_matrix_components];
+  get_components(frame, components);
+  for (int i = 0; i < 3; i++) {
+    components[i] = 1.0f;
+    components[i + 3] = 0.0f;
+  }
+  compose_matrix(mat, components);
+}
+
+/**
+ * Gets the scale value at the indicated frame.
+ */
+void AnimChannelMatrixStreamed::
+get_scale(int frame, LVecBase3 &scale) {
+  PN_stdfloat components[num_matrix_components];
+  get_components(frame, components);
+  scale.set(components[0], components[1], components[2]);
+}
+
+/**
+ * Returns the h, p, and r components associated with the current frame.
+ */
+void AnimChannelMatrixStreamed::
+get_hpr(int frame, LVecBase3 &hpr) {
+  PN_stdfloat components[num_matrix_components];
+  get_components(frame, components);
+  hpr.set(components[6], components[7], components[8]);
+}
+
+/**
+ * Returns the rotation component associated with the current frame, expressed
+ * as a quaternion.
+ */
+void AnimChannelMatrixStreamed::
+get_quat(int frame, LQuaternion &quat) {
+  LVecBase3 hpr;
+  get_hpr(frame, hpr);
+  quat.set_hpr(hpr);
+}
+
+/**
+ * Returns the x, y, and z translation components associated with the current
+ * frame.
+ */
+void AnimChannelMatrixStreamed::
+get_pos(int frame, LVecBase3 &pos) {
+  PN_stdfloat components[num_matrix_components];
+  get_components(frame, components);
+  pos.set(components[9], components[10], components[11]);
+}
+
+/**
+ * Returns the a, b, and c shear components associated with the current frame.
+ */
+void AnimChannelMatrixStreamed::
+get_shear(int frame, LVecBase3 &shear) {
+  PN_stdfloat components[num_matrix_components];
+  get_components(frame, components);
+  shear.set(components[3], components[4], components[5]);
+}
+
+/**
+ * Writes a brief description of the channel and all of its descendants.
+ */
+void AnimChannelMatrixStreamed::
+write(std::ostream &out, int indent_level) const {
+  indent(out, indent_level)
+    << get_type() << " " << get_name() << " from "
+    << _stream->get_filename();
+
+  if (!_children.empty()) {
+    out << " {\n";
+    write_descendants(out, indent_level + 2);
+    indent(out, indent_level) << "}";
+  }
+
+  out << "\n";
+}
+
+/**
+ * Returns a copy of this object, and attaches it to the indicated parent
+ * (which may be NULL only if this is an AnimBundle).  Intended to be called
+ * by copy_subtree() only.
+ */
+AnimGroup *AnimChannelMatrixStreamed::
+make_copy(AnimGroup *parent) const {
+  return new AnimChannelMatrixStreamed(parent, *this);
+}
+
+/**
+ * Fills in the twelve matrix components at the indicated frame, reading them
+ * from the stream.  If the stream cannot provide them, the identity
+ * transform is returned.
+ */
+void AnimChannelMatrixStreamed::
+get_components(int frame, PN_stdfloat components[num_matrix_components]) {
+  CPT(AnimStream::Chunk) chunk = _stream->get_chunk(frame);
+  if (chunk == nullptr) {
+    for (int i = 0; i < num_matrix_components; i++) {
+      components[i] = (i < 3) ? 1.0f : 0.0f;
+    }
+    return;
+  }
+
+  size_t index = (size_t)(frame - chunk->_first_frame) * _stream->get_stride() + _offset;
+  nassertv(index + num_matrix_components <= chunk->_values.size());
+  for (int i = 0; i < num_matrix_components; i++) {
+    components[i] = chunk->_values[index + i];
+  }
+}
@@ -0,0 +1,82 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file animChannelMatrixStreamed.h
+ * @author agent
+ * @date 2026-10-18
+ */
+
+#ifndef ANIMCHANNELMATRIXSTREAMED_H
+#define ANIMCHANNELMATRIXSTREAMED_H
+
+#include "pandabase.h"
+
+#include "animChannel.h"
+#include "animStream.h"
+#include "compose_matrix.h"
+
+/**
+ * An animation channel that issues a matrix each frame, read on demand from
+ * an AnimStream.  These are created by AnimStream::make_bundle().
+ */
+class EXPCL_PANDA_CHAN AnimChannelMatrixStreamed : public AnimChannelMatrix {
+protected:
+  AnimChannelMatrixStreamed(AnimGroup *parent, const AnimChannelMatrixStreamed &copy);
+
+public:
+  explicit AnimChannelMatrixStreamed(AnimGroup *parent, const std::string &name,
+                                     AnimStream *stream, int offset);
+
+PUBLISHED:
+  INLINE AnimStream *get_stream() const;
+  MAKE_PROPERTY(stream, get_stream);
+
+public:
+  virtual bool has_changed(int last_frame, double last_frac,
+                           int this_frame, double this_frac);
+  virtual void get_value(int frame, LMatrix4 &mat);
+
+  virtual void get_value_no_scale_shear(int frame, LMatrix4 &value);
+  virtual void get_scale(int frame, LVecBase3 &scale);
+  virtual void get_hpr(int frame, LVecBase3 &hpr);
+  virtual void get_quat(int frame, LQuaternion &quat);
+  virtual void get_pos(int frame, LVecBase3 &pos);
+  virtual void get_shear(int frame, LVecBase3 &shear);
+
+  virtual void write(std::ostream &out, int indent_level) const;
+
+protected:
+  virtual AnimGroup *make_copy(AnimGroup *parent) const;
+
+private:
+  void get_components(int frame, PN_stdfloat components[num_matrix_components]);
+
+  PT(AnimStream) _stream;
+  int _offset;
+
+public:
+  virtual TypeHandle get_type() const {
+    return get_class_type();
+  }
+  virtual TypeHandle force_init_type() {init_type(); return get_class_type();}
+  static TypeHandle get_class_type() {
+    return _type_handle;
+  }
+  static void init_type() {
+    AnimChannelMatrix::init_type();
+    register_type(_type_handle, "AnimChannelMatrixStreamed",
+                  AnimChannelMatrix::get_class_type());
+  }
+
+private:
+  static TypeHandle _type_handle;
+};
+
+#include "animChannelMatrixStreamed.I"
+
+#endif
@@ -0,0 +1,99 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file animChannelScalarStreamed.cxx
+ * @author agent
+ * @date 2026-10-18
+ */
+
+#include "animChannelScalarStreamed.h"
+#include "indent.h"
+
+TypeHandle AnimChannelScalarStreamed::_type_handle;
+
+/**
+ * Creates a new AnimChannelScalarStreamed, just like this one, without
+ * copying any children.  The new copy is added to the indicated parent.
+ * Intended to be called by make_copy() only.
+ */
+AnimChannelScalarStreamed::
+AnimChannelScalarStreamed(AnimGroup *parent, const AnimChannelScalarStreamed &copy) :
+  AnimChannelScalar(parent, copy),
+  _stream(copy._stream),
+  _offset(copy._offset)
+{
+}
+
+/**
+ * Creates a channel that reads its values from the indicated stream, at the
+ * given position within each frame.
+ */
+AnimChannelScalarStreamed::
+AnimChannelScalarStreamed(AnimGroup *parent, const std::string &name,
+                          AnimStream *stream, int offset) :
+  AnimChannelScalar(parent, name),
+  _stream(stream),
+  _offset(offset)
+{
+}
+
+/**
+ * Returns true if the value has changed since the last call to has_changed().
+ * last_frame is the frame number of the last call; this_frame is the current
+ * frame number.
+ */
+bool AnimChannelScalarStreamed::
+has_changed(int last_frame, double last_frac,
+            int this_frame, double this_frac) {
+  return (last_frame != this_frame || last_frac != this_frac);
+}
+
+/**
+ * Gets the value of the channel at the indicated frame.  If the stream cannot
+ * provide it, 0 is returned.
+ */
+void AnimChannelScalarStreamed::
+get_value(int frame, PN_stdfloat &value) {
+  CPT(AnimStream::Chunk) chunk = _stream->get_chunk(frame);
+  if (chunk == nullptr) {
+    value = 0.0f;
+    return;
+  }
+
+  size_t index = (size_t)(frame - chunk->_first_frame) * _stream->get_stride() + _offset;
+  nassertv(index < chunk->_values.size());
+  value = chunk->_values[index];
+}
+
+/**
+ * Writes a brief description of the channel and all of its descendants.
+ */
+void AnimChannelScalarStreamed::
+write(std::ostream &out, int indent_level) const {
+  indent(out, indent_level)
+    << get_type() << " " << get_name() << " from "
+    << _stream->get_filename();
+
+  if (!_children.empty()) {
+    out << " {\n";
+    write_descendants(out, indent_level + 2);
+    indent(out, indent_level) << "}";
+  }
+
+  out << "\n";
+}
+
+/**
+ * Returns a copy of this object, and attaches it to the indicated parent
+ * (which may be NULL only if this is an AnimBundle).  Intended to be called
+ * by copy_subtree() only.
+ */
+AnimGroup *AnimChannelScalarStreamed::
+make_copy(AnimGroup *parent) const {
+  return new AnimChannelScalarStreamed(parent, *this);
+}
@@ -0,0 +1,72 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file animChannelScalarStreamed.h
+ * @author agent
+ * @date 2026-10-18
+ */
+
+#ifndef ANIMCHANNELSCALARSTREAMED_H
+#define ANIMCHANNELSCALARSTREAMED_H
+
+#include "pandabase.h"
+
+#include "animChannel.h"
+#include "animStream.h"
+
+/**
+ * An animation channel that issues a scalar each frame, read on demand from
+ * an AnimStream.  These are created by AnimStream::make_bundle().
+ */
+class EXPCL_PANDA_CHAN AnimChannelScalarStreamed : public AnimChannelScalar {
+protected:
+  AnimChannelScalarStreamed(AnimGroup *parent, const AnimChannelScalarStreamed &copy);
+
+public:
+  explicit AnimChannelScalarStreamed(AnimGroup *parent, const std::string &name,
+                                     AnimStream *stream, int offset);
+
+PUBLISHED:
+  INLINE AnimStream *get_stream() const;
+  MAKE_PROPERTY(stream, get_stream);
+
+public:
+  virtual bool has_changed(int last_frame, double last_frac,
+                           int this_frame, double this_frac);
+  virtual void get_value(int frame, PN_stdfloat &value);
+
+  virtual void write(std::ostream &out, int indent_level) const;
+
+protected:
+  virtual AnimGroup *make_copy(AnimGroup *parent) const;
+
+private:
+  PT(AnimStream) _stream;
+  int _offset;
+
+public:
+  virtual TypeHandle get_type() const {
+    return get_class_type();
+  }
+  virtual TypeHandle force_init_type() {init_type(); return get_class_type();}
+  static TypeHandle get_class_type() {
+    return _type_handle;
+  }
+  static void init_type() {
+    AnimChannelScalar::init_type();
+    register_type(_type_handle, "AnimChannelScalarStreamed",
+                  AnimChannelScalar::get_class_type());
+  }
+
+private:
+  static TypeHandle _type_handle;
+};
+
+#include "animChannelScalarStreamed.I"
+
+#endif
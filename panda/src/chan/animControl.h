@@ -116,6 +116,8 @@ public:
 
 private:
   static TypeHandle _type_handle;
+
+  friend class JointTable;
 };
 
 INLINE std::ostream &operator << (std::ostream &out, const AnimControl &control);
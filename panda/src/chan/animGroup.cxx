@@ -13,6 +13,8 @@
 
 #include "animGroup.h"
 #include "animBundle.h"
+#include "animChannelMatrixXfmTable.h"
+#include "animChannelMatrixCompressed.h"
 #include "config_chan.h"
 
 #include "indent.h"
@@ -167,6 +169,42 @@ sort_descendants() {
 }
 
 
+/**
+ * The recursive implementation of AnimBundle::compress_channels().  Replaces
+ * each AnimChannelMatrixXfmTable at or below this group with an equivalent
+ * AnimChannelMatrixCompressed, which takes over its children.  Returns the
+ * number of channels replaced.
+ */
+int AnimGroup::
+r_compress_channels(PN_stdfloat rotation_tolerance,
+                    PN_stdfloat position_tolerance,
+                    PN_stdfloat scale_tolerance) {
+  int count = 0;
+
+  for (size_t i = 0; i < _children.size(); ++i) {
+    AnimGroup *child = _children[i];
+    if (child->is_exact_type(AnimChannelMatrixXfmTable::get_class_type())) {
+      // The constructor adds the new channel to the end of our children; we
+      // then move it into the place of the table.
+      PT(AnimChannelMatrixCompressed) channel =
+        new AnimChannelMatrixCompressed(this, child->get_name());
+      channel->compress(DCAST(AnimChannelMatrixXfmTable, child),
+                        rotation_tolerance, position_tolerance,
+                        scale_tolerance);
+      channel->_children.swap(child->_children);
+      _children.pop_back();
+      _children[i] = channel;
+      child = channel;
+      ++count;
+    }
+
+    count += child->r_compress_channels(rotation_tolerance, position_tolerance,
+                                        scale_tolerance);
+  }
+
+  return count;
+}
+
 /**
  * Returns the TypeHandle associated with the ValueType we are concerned with.
  * This is provided to allow a bit of run-time checking that joints and
@@ -63,6 +63,10 @@ protected:
   virtual AnimGroup *make_copy(AnimGroup *parent) const;
   PT(AnimGroup) copy_subtree(AnimGroup *parent) const;
 
+  int r_compress_channels(PN_stdfloat rotation_tolerance,
+                          PN_stdfloat position_tolerance,
+                          PN_stdfloat scale_tolerance);
+
 protected:
   typedef pvector< PT(AnimGroup) > Children;
   Children _children;
@@ -0,0 +1,623 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file animStream.cxx
+ * @author agent
+ * @date 2026-10-18
+ */
+
+#include "animStream.h"
+#include "animChannelMatrixStreamed.h"
+#include "animChannelScalarStreamed.h"
+#include "config_chan.h"
+#include "loader.h"
+#include "asyncTaskManager.h"
+#include "virtualFileSystem.h"
+#include "datagram.h"
+#include "datagramIterator.h"
+#include "lightMutexHolder.h"
+
+#include <algorithm>
+
+using std::string;
+
+// The first bytes of every stream file.
+static const string _stream_magic("pas\n", 4);
+
+// The number of values stored per frame for a matrix channel: the scale,
+// shear, hpr and pos components, as for AnimChannelMatrixXfmTable.
+static const int _matrix_stride = 12;
+
+/**
+ *
+ */
+AnimStream::
+AnimStream() :
+  _in(nullptr),
+  _base_frame_rate(0.0f),
+  _num_frames(0),
+  _chunk_frames(0),
+  _stride(0),
+  _max_resident_chunks(anim_stream_max_resident_chunks),
+  _num_chunk_reads(0),
+  _num_sync_chunk_reads(0),
+  _prefetch(anim_stream_prefetch),
+  _last_chunk(-1),
+  _prefetch_chunk(-1)
+{
+  if (_max_resident_chunks < 1) {
+    _max_resident_chunks = 1;
+  }
+}
+
+/**
+ *
+ */
+AnimStream::
+~AnimStream() {
+  close();
+}
+
+/**
+ * Opens the indicated stream file, which should have been written by
+ * write_bundle(), and reads its header.  None of the frames are read yet.
+ * Returns true on success, false on failure.
+ */
+bool AnimStream::
+open(const Filename &filename) {
+  close();
+
+  Filename fn = filename;
+  fn.set_binary();
+
+  VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
+  std::istream *in = vfs->open_read_file(fn, false);
+  if (in == nullptr) {
+    chan_cat.error()
+      << "Unable to open " << fn << "\n";
+    return false;
+  }
+
+  // Check the magic number, and read the length of the header.
+  vector_uchar prefix(_stream_magic.size() + 4);
+  in->read((char *)&prefix[0], prefix.size());
+  if ((size_t)in->gcount() != prefix.size() ||
+      memcmp(&prefix[0], _stream_magic.data(), _stream_magic.size()) != 0) {
+    chan_cat.error()
+      << fn << " is not an animation stream file.\n";
+    vfs->close_read_file(in);
+    return false;
+  }
+  Datagram prefix_dg(std::move(prefix));
+  DatagramIterator prefix_scan(prefix_dg, _stream_magic.size());
+  size_t header_length = prefix_scan.get_uint32();
+
+  vector_uchar header_data(header_length);
+  if (header_length > 0) {
+    in->read((char *)&header_data[0], header_length);
+  }
+  if ((size_t)in->gcount() != header_length) {
+    chan_cat.error()
+      << "Unexpected end of file reading " << fn << "\n";
+    vfs->close_read_file(in);
+    return false;
+  }
+
+  Datagram header(std::move(header_data));
+  DatagramIterator scan(header);
+  _name = scan.get_string();
+  _base_frame_rate = scan.get_float32();
+  _num_frames = scan.get_uint32();
+  _chunk_frames = scan.get_uint32();
+  _stride = scan.get_uint32();
+
+  // The groups are stored in preorder, so each parent precedes its children.
+  bool valid = (_num_frames > 0 && _chunk_frames > 0);
+  int stride = 0;
+  size_t num_groups = scan.get_uint32();
+  _groups.reserve(num_groups);
+  for (size_t i = 0; i < num_groups && valid; ++i) {
+    GroupDef def;
+    def._type = (GroupType)scan.get_uint8();
+    def._name = scan.get_string();
+    def._parent = scan.get_int32();
+    valid = (i == 0) ? (def._parent == -1) :
+      (def._parent >= 0 && def._parent < (int)i);
+    if (def._type == GT_matrix) {
+      stride += _matrix_stride;
+    } else if (def._type == GT_scalar) {
+      stride += 1;
+    }
+    _groups.push_back(def);
+  }
+
+  size_t num_chunks = scan.get_uint32();
+  if (!valid || _groups.empty() || stride != _stride ||
+      num_chunks != (size_t)((_num_frames + _chunk_frames - 1) / _chunk_frames)) {
+    chan_cat.error()
+      << fn << " is not a valid animation stream file.\n";
+    _groups.clear();
+    vfs->close_read_file(in);
+    return false;
+  }
+
+  _chunk_offsets.reserve(num_chunks);
+  for (size_t i = 0; i < num_chunks; ++i) {
+    _chunk_offsets.push_back(scan.get_uint64());
+  }
+
+  LightMutexHolder holder(_lock);
+  _filename = fn;
+  _in = in;
+  _chunks.clear();
+  _chunks.resize(num_chunks);
+  _resident.clear();
+  _num_chunk_reads = 0;
+  _num_sync_chunk_reads = 0;
+  _last_chunk = -1;
+
+  if (chan_cat.is_debug()) {
+    chan_cat.debug()
+      << "Opened animation stream " << fn << " with " << _num_frames
+      << " frames in " << num_chunks << " chunks\n";
+  }
+  return true;
+}
+
+/**
+ * Closes the stream file and releases all of the chunks.  Channels that were
+ * made from this stream return their default values after this call.
+ */
+void AnimStream::
+close() {
+  LightMutexHolder holder(_lock);
+  wait_prefetch();
+  if (_in != nullptr) {
+    LightMutexHolder read_holder(_read_lock);
+    VirtualFileSystem::close_read_file(_in);
+    _in = nullptr;
+  }
+  _groups.clear();
+  _chunk_offsets.clear();
+  _chunks.clear();
+  _resident.clear();
+  _last_chunk = -1;
+}
+
+/**
+ * Builds a new AnimBundle with the hierarchy stored in the stream, whose
+ * channels read their values from this stream.  The result may be bound to a
+ * PartBundle like any other AnimBundle.  Returns NULL if the stream is not
+ * open.
+ */
+PT(AnimBundle) AnimStream::
+make_bundle() {
+  nassertr(is_open() && !_groups.empty(), nullptr);
+
+  PT(AnimBundle) bundle = new AnimBundle(_name, _base_frame_rate, _num_frames);
+
+  pvector<AnimGroup *> groups(_groups.size(), nullptr);
+  groups[0] = bundle;
+  int offset = 0;
+  for (size_t i = 1; i < _groups.size(); ++i) {
+    const GroupDef &def = _groups[i];
+    AnimGroup *parent = groups[def._parent];
+
+    switch (def._type) {
+    case GT_matrix:
+      groups[i] = new AnimChannelMatrixStreamed(parent, def._name, this, offset);
+      offset += _matrix_stride;
+      break;
+
+    case GT_scalar:
+      groups[i] = new AnimChannelScalarStreamed(parent, def._name, this, offset);
+      offset += 1;
+      break;
+
+    default:
+      groups[i] = new AnimGroup(parent, def._name);
+      break;
+    }
+  }
+
+  return bundle;
+}
+
+/**
+ * Changes the maximum number of chunks that are kept in memory at once.  The
+ * chunks around the frames currently being played are retained; this should
+ * be at least large enough to hold the frames played by all of the
+ * AnimControls sharing this stream, or chunks will be read repeatedly.
+ */
+void AnimStream::
+set_max_resident_chunks(int max_resident_chunks) {
+  nassertv(max_resident_chunks >= 1);
+  LightMutexHolder holder(_lock);
+  _max_resident_chunks = max_resident_chunks;
+  evict_chunks();
+}
+
+/**
+ * Returns the number of chunks that are currently in memory.
+ */
+int AnimStream::
+get_num_resident_chunks() const {
+  LightMutexHolder holder(_lock);
+  return (int)_resident.size();
+}
+
+/**
+ * Releases all of the chunks that are in memory.  They will be read again
+ * from the file as they are needed.
+ */
+void AnimStream::
+release_chunks() {
+  LightMutexHolder holder(_lock);
+  for (int n : _resident) {
+    _chunks[n] = nullptr;
+  }
+  _resident.clear();
+}
+
+/**
+ * Writes the indicated animation to a stream file, which may later be opened
+ * with open().  Every channel is sampled at each frame, so any kind of
+ * channel may be written.  chunk_frames is the number of frames stored
+ * together in each chunk; if it is 0, the value of anim-stream-chunk-frames
+ * is used.  Returns true on success, false on failure.
+ */
+bool AnimStream::
+write_bundle(const Filename &filename, AnimBundle *bundle, int chunk_frames) {
+  nassertr(bundle != nullptr, false);
+  if (chunk_frames <= 0) {
+    chunk_frames = std::max((int)anim_stream_chunk_frames, 1);
+  }
+
+  int num_frames = bundle->get_num_frames();
+  nassertr(num_frames > 0, false);
+  int num_chunks = (num_frames + chunk_frames - 1) / chunk_frames;
+
+  GroupDefs groups;
+  pvector<AnimGroup *> channels;
+  r_collect_groups(bundle, -1, groups, channels);
+
+  int stride = 0;
+  for (const GroupDef &def : groups) {
+    if (def._type == GT_matrix) {
+      stride += _matrix_stride;
+    } else if (def._type == GT_scalar) {
+      stride += 1;
+    }
+  }
+
+  Datagram header;
+  header.add_string(bundle->get_name());
+  header.add_float32(bundle->get_base_frame_rate());
+  header.add_uint32(num_frames);
+  header.add_uint32(chunk_frames);
+  header.add_uint32(stride);
+  header.add_uint32(groups.size());
+  for (const GroupDef &def : groups) {
+    header.add_uint8(def._type);
+    header.add_string(def._name);
+    header.add_int32(def._parent);
+  }
+
+  // The chunk offsets are of fixed size, so we can compute where the first
+  // chunk will begin before we add them.
+  uint64_t offset = _stream_magic.size() + 4 + header.get_length() + 4 +
+    (uint64_t)num_chunks * 8;
+  header.add_uint32(num_chunks);
+  for (int c = 0; c < num_chunks; ++c) {
+    int count = std::min(chunk_frames, num_frames - c * chunk_frames);
+    header.add_uint64(offset);
+    offset += (uint64_t)count * stride * 4;
+  }
+
+  Filename fn = filename;
+  fn.set_binary();
+
+  VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
+  std::ostream *out = vfs->open_write_file(fn, false, true);
+  if (out == nullptr) {
+    chan_cat.error()
+      << "Unable to write " << fn << "\n";
+    return false;
+  }
+
+  Datagram prefix;
+  prefix.append_data(_stream_magic.data(), _stream_magic.size());
+  prefix.add_uint32(header.get_length());
+  out->write((const char *)prefix.get_data(), prefix.get_length());
+  out->write((const char *)header.get_data(), header.get_length());
+
+  for (int c = 0; c < num_chunks; ++c) {
+    int first = c * chunk_frames;
+    int last = std::min(first + chunk_frames, num_frames);
+
+    Datagram chunk;
+    for (int frame = first; frame < last; ++frame) {
+      for (AnimGroup *channel : channels) {
+        if (channel->is_of_type(AnimChannelMatrix::get_class_type())) {
+          AnimChannelMatrix *matrix = (AnimChannelMatrix *)channel;
+          LVecBase3 scale, shear, hpr, pos;
+          matrix->get_scale(frame, scale);
+          matrix->get_shear(frame, shear);
+          matrix->get_hpr(frame, hpr);
+          matrix->get_pos(frame, pos);
+          for (int i = 0; i < 3; ++i) {
+            chunk.add_float32(scale[i]);
+          }
+          for (int i = 0; i < 3; ++i) {
+            chunk.add_float32(shear[i]);
+          }
+          for (int i = 0; i < 3; ++i) {
+            chunk.add_float32(hpr[i]);
+          }
+          for (int i = 0; i < 3; ++i) {
+            chunk.add_float32(pos[i]);
+          }
+        } else {
+          PN_stdfloat value;
+          ((AnimChannelScalar *)channel)->get_value(frame, value);
+          chunk.add_float32(value);
+        }
+      }
+    }
+    out->write((const char *)chunk.get_data(), chunk.get_length());
+  }
+
+  bool success = !out->fail();
+  vfs->close_write_file(out);
+
+  if (!success) {
+    chan_cat.error()
+      << "Error writing " << fn << "\n";
+  }
+  return success;
+}
+
+/**
+ * Returns the chunk containing the indicated frame, reading it from the file
+ * if it is not already in memory.  The frame number is wrapped into the range
+ * of the animation, and returned in that form.  Returns NULL if the chunk
+ * could not be read.
+ */
+CPT(AnimStream::Chunk) AnimStream::
+get_chunk(int &frame) {
+  LightMutexHolder holder(_lock);
+  if (_in == nullptr) {
+    return nullptr;
+  }
+
+  frame %= _num_frames;
+  if (frame < 0) {
+    frame += _num_frames;
+  }
+  int n = frame / _chunk_frames;
+
+  if (_chunks[n] == nullptr && _prefetch_task != nullptr &&
+      _prefetch_chunk == n) {
+    // The chunk is already being read in the background; wait for it, rather
+    // than reading it a second time.
+    wait_prefetch();
+    if (_in == nullptr) {
+      return nullptr;
+    }
+  }
+
+  if (_chunks[n] == nullptr) {
+    PT(Chunk) chunk = read_chunk(n);
+    if (chunk == nullptr) {
+      return nullptr;
+    }
+    ++_num_sync_chunk_reads;
+    add_chunk(n, chunk);
+
+  } else if (_resident.back() != n) {
+    // Move it to the end of the list, to mark it as most recently used.
+    vector_int::iterator ri = std::find(_resident.begin(), _resident.end(), n);
+    nassertr(ri != _resident.end(), _chunks[n]);
+    _resident.erase(ri);
+    _resident.push_back(n);
+  }
+
+  CPT(Chunk) chunk = _chunks[n];
+  if (n != _last_chunk) {
+    // The playhead has entered a new chunk, so this is a good time to start
+    // reading the one after it.
+    _last_chunk = n;
+    start_prefetch((n + 1) % (int)_chunks.size());
+  }
+
+  return chunk;
+}
+
+/**
+ * Reads the nth chunk from the file, and returns it, or NULL on failure.  The
+ * chunk is not yet added to the chunk table.  This only holds the read lock
+ * while it reads; it may be called with or without the lock held.
+ */
+PT(AnimStream::Chunk) AnimStream::
+read_chunk(int n) {
+  int first = n * _chunk_frames;
+  int count = std::min(_chunk_frames, _num_frames - first);
+  size_t num_values = (size_t)count * _stride;
+  size_t num_bytes = num_values * 4;
+
+  vector_uchar buffer(num_bytes);
+  {
+    LightMutexHolder read_holder(_read_lock);
+    _in->clear();
+    _in->seekg(_chunk_offsets[n]);
+    if (num_bytes > 0) {
+      _in->read((char *)&buffer[0], num_bytes);
+    }
+    if (_in->fail() || (size_t)_in->gcount() != num_bytes) {
+      chan_cat.error()
+        << "Unable to read frames " << first << " to " << first + count - 1
+        << " of " << _filename << "\n";
+      return nullptr;
+    }
+  }
+
+  PT(Chunk) chunk = new Chunk;
+  chunk->_first_frame = first;
+  chunk->_values.resize(num_values);
+
+  Datagram dg(std::move(buffer));
+  DatagramIterator scan(dg);
+  for (size_t i = 0; i < num_values; ++i) {
+    chunk->_values[i] = scan.get_float32();
+  }
+
+  if (chan_cat.is_spam()) {
+    chan_cat.spam()
+      << "Read frames " << first << " to " << first + count - 1
+      << " of " << _filename << "\n";
+  }
+
+  return chunk;
+}
+
+/**
+ * Stores a chunk returned by read_chunk() in the chunk table, as the most
+ * recently used chunk.  Assumes the lock is held.
+ */
+void AnimStream::
+add_chunk(int n, Chunk *chunk) {
+  _chunks[n] = chunk;
+  _resident.push_back(n);
+  ++_num_chunk_reads;
+
+  evict_chunks();
+}
+
+/**
+ * Releases the least recently used chunks until no more than the maximum
+ * number remain in memory.  Assumes the lock is held.
+ */
+void AnimStream::
+evict_chunks() {
+  if ((int)_resident.size() > _max_resident_chunks) {
+    size_t num_evict = _resident.size() - _max_resident_chunks;
+    for (size_t i = 0; i < num_evict; ++i) {
+      _chunks[_resident[i]] = nullptr;
+    }
+    _resident.erase(_resident.begin(), _resident.begin() + num_evict);
+  }
+}
+
+/**
+ * Starts reading the nth chunk in the background, on the Loader's task chain,
+ * if prefetching is enabled and the chunk is not already in memory.  Assumes
+ * the lock is held.
+ */
+void AnimStream::
+start_prefetch(int n) {
+  // With room for only one chunk, the prefetched chunk would push out the one
+  // being played.
+  if (!_prefetch || _max_resident_chunks < 2 || _prefetch_task != nullptr ||
+      _chunks[n] != nullptr || !Thread::is_threading_supported()) {
+    return;
+  }
+
+  // If the Loader has no threads, nothing would run the task until the main
+  // loop gets to it, which is likely too late.
+  Loader *loader = Loader::get_global_ptr();
+  AsyncTaskManager *task_mgr = loader->get_task_manager();
+  AsyncTaskChain *chain = task_mgr->find_task_chain(loader->get_task_chain());
+  if (chain == nullptr || chain->get_num_threads() == 0) {
+    return;
+  }
+
+  PT(GenericAsyncTask) task =
+    new GenericAsyncTask("anim_stream_prefetch", &st_prefetch, this);
+  task->set_task_chain(loader->get_task_chain());
+  _prefetch_chunk = n;
+  _prefetch_task = task;
+  task_mgr->add(task);
+}
+
+/**
+ * Waits for the chunk being read in the background, if any, to be finished.
+ * Assumes the lock is held; it is released while waiting.
+ */
+void AnimStream::
+wait_prefetch() {
+  while (_prefetch_task != nullptr) {
+    PT(AsyncTask) task = _prefetch_task;
+    _lock.release();
+    task->wait();
+    _lock.acquire();
+
+    if (_prefetch_task == task) {
+      // The task was removed without having run.
+      _prefetch_task = nullptr;
+    }
+  }
+}
+
+/**
+ * The task function that reads a chunk in the background.  See
+ * start_prefetch().
+ */
+AsyncTask::DoneStatus AnimStream::
+st_prefetch(GenericAsyncTask *task, void *data) {
+  AnimStream *self = (AnimStream *)data;
+
+  int n;
+  {
+    LightMutexHolder holder(self->_lock);
+    n = self->_prefetch_chunk;
+    if (self->_in == nullptr || self->_chunks[n] != nullptr) {
+      self->_prefetch_task = nullptr;
+      return AsyncTask::DS_done;
+    }
+  }
+
+  // The lock is not held while reading, so that the frames already in memory
+  // may still be played in the meantime.
+  PT(Chunk) chunk = self->read_chunk(n);
+
+  LightMutexHolder holder(self->_lock);
+  if (chunk != nullptr && self->_chunks[n] == nullptr) {
+    self->add_chunk(n, chunk);
+  }
+  self->_prefetch_task = nullptr;
+  return AsyncTask::DS_done;
+}
+
+/**
+ * Records the indicated group and all of its descendants in preorder, along
+ * with the list of channels, in the order their values are stored.
+ */
+void AnimStream::
+r_collect_groups(AnimGroup *group, int parent, GroupDefs &groups,
+                 pvector<AnimGroup *> &channels) {
+  GroupDef def;
+  def._name = group->get_name();
+  def._parent = parent;
+  if (group->is_of_type(AnimChannelMatrix::get_class_type())) {
+    def._type = GT_matrix;
+    channels.push_back(group);
+  } else if (group->is_of_type(AnimChannelScalar::get_class_type())) {
+    def._type = GT_scalar;
+    channels.push_back(group);
+  } else {
+    def._type = GT_group;
+  }
+
+  int index = (int)groups.size();
+  groups.push_back(def);
+
+  int num_children = group->get_num_children();
+  for (int i = 0; i < num_children; ++i) {
+    r_collect_groups(group->get_child(i), index, groups, channels);
+  }
+}
@@ -0,0 +1,172 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file animStream.h
+ * @author agent
+ * @date 2026-10-18
+ */
+
+#ifndef ANIMSTREAM_H
+#define ANIMSTREAM_H
+
+#include "pandabase.h"
+
+#include "referenceCount.h"
+#include "animBundle.h"
+#include "filename.h"
+#include "lightMutex.h"
+#include "genericAsyncTask.h"
+#include "pointerTo.h"
+#include "pvector.h"
+#include "vector_int.h"
+
+/**
+ * An animation file that is read a piece at a time, while it is played,
+ * rather than all at once when it is loaded.
+ *
+ * A stream file is written from an ordinary AnimBundle with write_bundle().
+ * It stores the hierarchy of the animation up front, followed by the sampled
+ * value of every channel for each frame, in chunks of a fixed number of
+ * frames.  Opening the stream reads only the hierarchy; make_bundle() then
+ * builds an AnimBundle whose channels read their values from the stream.
+ * The chunks containing the frames being played are read from the file as
+ * they are needed, and the least recently used chunks are released once more
+ * than get_max_resident_chunks() of them are in memory.  This allows very
+ * long animations, such as cutscenes, to be played without keeping them in
+ * memory in their entirety.
+ *
+ * If set_prefetch() is in effect, the next chunk is read in the background,
+ * on the Loader's task chain, as soon as the frames of a chunk start to be
+ * played, so that an animation played from start to finish only has to wait
+ * for the file to be read for its first chunk.
+ *
+ * Stream files, which have the extension .pas, can also be loaded with the
+ * Loader or PartBundle::load_bind_anim(); listing them in the PartBundle's
+ * AnimPreloadTable allows them to be bound asynchronously without reading the
+ * file at all until the animation is played.
+ *
+ * The AnimBundle made from a stream may not be written to a bam file.
+ */
+class EXPCL_PANDA_CHAN AnimStream : public ReferenceCount {
+PUBLISHED:
+  AnimStream();
+  ~AnimStream();
+
+  bool open(const Filename &filename);
+  void close();
+  INLINE bool is_open() const;
+  INLINE const Filename &get_filename() const;
+
+  INLINE const std::string &get_name() const;
+  INLINE PN_stdfloat get_base_frame_rate() const;
+  INLINE int get_num_frames() const;
+  INLINE int get_chunk_frames() const;
+  INLINE int get_num_chunks() const;
+
+  PT(AnimBundle) make_bundle();
+
+  void set_max_resident_chunks(int max_resident_chunks);
+  INLINE int get_max_resident_chunks() const;
+  int get_num_resident_chunks() const;
+  INLINE int get_num_chunk_reads() const;
+  INLINE int get_num_sync_chunk_reads() const;
+  void release_chunks();
+
+  INLINE void set_prefetch(bool prefetch);
+  INLINE bool get_prefetch() const;
+
+  static bool write_bundle(const Filename &filename, AnimBundle *bundle,
+                           int chunk_frames = 0);
+
+  MAKE_PROPERTY(filename, get_filename);
+  MAKE_PROPERTY(name, get_name);
+  MAKE_PROPERTY(base_frame_rate, get_base_frame_rate);
+  MAKE_PROPERTY(num_frames, get_num_frames);
+  MAKE_PROPERTY(chunk_frames, get_chunk_frames);
+  MAKE_PROPERTY(num_chunks, get_num_chunks);
+  MAKE_PROPERTY(max_resident_chunks, get_max_resident_chunks,
+                set_max_resident_chunks);
+  MAKE_PROPERTY(num_resident_chunks, get_num_resident_chunks);
+  MAKE_PROPERTY(num_chunk_reads, get_num_chunk_reads);
+  MAKE_PROPERTY(num_sync_chunk_reads, get_num_sync_chunk_reads);
+  MAKE_PROPERTY(prefetch, get_prefetch, set_prefetch);
+
+public:
+  // The values of all channels over a range of frames.  Each frame stores
+  // the twelve matrix components of each matrix channel, followed by the
+  // value of each scalar channel, in the order of the hierarchy.
+  class Chunk : public ReferenceCount {
+  public:
+    int _first_frame;
+    pvector<PN_stdfloat> _values;
+  };
+
+  CPT(Chunk) get_chunk(int &frame);
+  INLINE int get_stride() const;
+
+private:
+  enum GroupType {
+    GT_group,
+    GT_matrix,
+    GT_scalar,
+  };
+
+  // One node of the animation hierarchy, as stored in the stream header.
+  class GroupDef {
+  public:
+    GroupType _type;
+    std::string _name;
+    int _parent;
+  };
+  typedef pvector<GroupDef> GroupDefs;
+
+  PT(Chunk) read_chunk(int n);
+  void add_chunk(int n, Chunk *chunk);
+  void evict_chunks();
+  void start_prefetch(int n);
+  void wait_prefetch();
+  static AsyncTask::DoneStatus st_prefetch(GenericAsyncTask *task, void *data);
+  static void r_collect_groups(AnimGroup *group, int parent,
+                               GroupDefs &groups,
+                               pvector<AnimGroup *> &channels);
+
+  Filename _filename;
+  std::istream *_in;
+
+  std::string _name;
+  PN_stdfloat _base_frame_rate;
+  int _num_frames;
+  int _chunk_frames;
+  int _stride;
+  GroupDefs _groups;
+  pvector<uint64_t> _chunk_offsets;
+
+  // Protects the chunk table.  _read_lock protects the file pointer; if both
+  // are held, _lock must be acquired first.
+  mutable LightMutex _lock;
+  LightMutex _read_lock;
+  typedef pvector<PT(Chunk)> Chunks;
+  Chunks _chunks;
+
+  // The chunks currently in memory, least recently used first.
+  vector_int _resident;
+  int _max_resident_chunks;
+  int _num_chunk_reads;
+  int _num_sync_chunk_reads;
+
+  // The chunk that was returned by the last call to get_chunk(), and the
+  // chunk being read in the background, if any.
+  bool _prefetch;
+  int _last_chunk;
+  int _prefetch_chunk;
+  PT(AsyncTask) _prefetch_task;
+};
+
+#include "animStream.I"
+
+#endif
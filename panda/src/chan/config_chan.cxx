@@ -16,14 +16,19 @@
 #include "animBundleNode.h"
 #include "animChannelBase.h"
 #include "animChannelMatrixXfmTable.h"
+#include "animChannelMatrixCompressed.h"
 #include "animChannelMatrixDynamic.h"
 #include "animChannelMatrixFixed.h"
+#include "animChannelMatrixStreamed.h"
 #include "animChannelScalarTable.h"
 #include "animChannelScalarDynamic.h"
+#include "animChannelScalarStreamed.h"
 #include "animControl.h"
 #include "animGroup.h"
 #include "animPreloadTable.h"
 #include "bindAnimRequest.h"
+#include "loaderFileTypeAnimStream.h"
+#include "loaderFileTypeRegistry.h"
 #include "movingPartBase.h"
 #include "movingPartMatrix.h"
 #include "movingPartScalar.h"
@@ -48,6 +53,33 @@ ConfigVariableBool compress_channels
           "the bam file only; it does not reduce the memory footprint of the "
           "channels when the bam file is loaded."));
 
+ConfigVariableBool compress_anim_channels
+("compress-anim-channels", false,
+ PRC_DESC("Set this true to compress animation channels as they are loaded "
+          "from an egg file.  Each matrix channel is replaced with an "
+          "AnimChannelMatrixCompressed, which stores quantized keys for "
+          "only those frames needed to reproduce the animation within "
+          "compress-chan-rotation-tolerance, compress-chan-position-tolerance "
+          "and compress-chan-scale-tolerance.  Unlike compress-channels, "
+          "this reduces the memory footprint of the animation as well as "
+          "the size of the bam file."));
+
+ConfigVariableDouble compress_chan_rotation_tolerance
+("compress-chan-rotation-tolerance", 0.05,
+ PRC_DESC("The maximum error, in degrees, that compress-anim-channels may "
+          "introduce into the rotation of a joint."));
+
+ConfigVariableDouble compress_chan_position_tolerance
+("compress-chan-position-tolerance", 0.0005,
+ PRC_DESC("The maximum error, in model units, that compress-anim-channels "
+          "may introduce into each component of the translation of a "
+          "joint."));
+
+ConfigVariableDouble compress_chan_scale_tolerance
+("compress-chan-scale-tolerance", 0.0005,
+ PRC_DESC("The maximum error that compress-anim-channels may introduce into "
+          "each component of the scale and shear of a joint."));
+
 /*
  * There are some special values above 100 which are generally only useful for
  * debugging (specifically, to research at what point a particular animation
@@ -101,19 +133,72 @@ PRC_DESC("This specifies the priority assign to an asynchronous bind "
          "model loads).  A higher number here makes the animations "
          "load sooner."));
 
+ConfigVariableBool compiled_joint_update
+("compiled-joint-update", false,
+ PRC_DESC("Set this true to have each PartBundle compile its hierarchy of "
+          "joints into a flat table, which is evaluated in a single pass "
+          "each frame instead of by recursively walking the hierarchy.  "
+          "This is faster for characters with many joints.  It may also "
+          "be enabled per bundle with PartBundle::set_compiled_update()."));
+
+ConfigVariableBool anim_instancing
+("anim-instancing", false,
+ PRC_DESC("Set this true to allow PartBundles that are playing the same "
+          "animations at the same frame with the same blend weights to "
+          "share a single evaluation of their joint transforms each frame, "
+          "rather than each sampling the animation channels separately.  "
+          "This helps crowds of copies of the same model, which also share "
+          "a single joint palette for hardware skinning.  Vertices "
+          "animated on the CPU are still skinned by each Character.  It "
+          "may also be enabled per bundle with "
+          "PartBundle::set_anim_instancing()."));
+
+ConfigVariableInt anim_instancing_frac_steps
+("anim-instancing-frac-steps", 4,
+ PRC_DESC("When anim-instancing is in effect and frame blending is enabled, "
+          "this is the number of steps that the time between two frames is "
+          "divided into when deciding whether two PartBundles are at the "
+          "same point in the animation.  Larger numbers share less often "
+          "but are more accurate."));
+
+ConfigVariableInt anim_stream_chunk_frames
+("anim-stream-chunk-frames", 48,
+ PRC_DESC("The number of frames that are stored together in each chunk of "
+          "an animation stream file written by AnimStream::write_bundle(), "
+          "unless otherwise specified.  Each chunk is read from disk as a "
+          "whole when one of its frames is played."));
+
+ConfigVariableInt anim_stream_max_resident_chunks
+("anim-stream-max-resident-chunks", 4,
+ PRC_DESC("The maximum number of chunks of each animation stream that are "
+          "kept in memory at once.  The least recently played chunks are "
+          "released first.  This may also be changed per stream with "
+          "AnimStream::set_max_resident_chunks()."));
+
+ConfigVariableBool anim_stream_prefetch
+("anim-stream-prefetch", true,
+ PRC_DESC("Set this true to read the next chunk of an animation stream in "
+          "the background, on the Loader's task chain, as soon as the "
+          "frames of a chunk start playing.  This may also be changed per "
+          "stream with AnimStream::set_prefetch()."));
+
 ConfigureFn(config_chan) {
   AnimBundle::init_type();
   AnimBundleNode::init_type();
   AnimChannelBase::init_type();
   AnimChannelMatrixXfmTable::init_type();
+  AnimChannelMatrixCompressed::init_type();
   AnimChannelMatrixDynamic::init_type();
   AnimChannelMatrixFixed::init_type();
+  AnimChannelMatrixStreamed::init_type();
   AnimChannelScalarTable::init_type();
   AnimChannelScalarDynamic::init_type();
+  AnimChannelScalarStreamed::init_type();
   AnimControl::init_type();
   AnimGroup::init_type();
   AnimPreloadTable::init_type();
   BindAnimRequest::init_type();
+  LoaderFileTypeAnimStream::init_type();
   MovingPartBase::init_type();
   MovingPartMatrix::init_type();
   MovingPartScalar::init_type();
@@ -137,12 +222,16 @@ ConfigureFn(config_chan) {
   AnimBundle::register_with_read_factory();
   AnimBundleNode::register_with_read_factory();
   AnimChannelMatrixXfmTable::register_with_read_factory();
+  AnimChannelMatrixCompressed::register_with_read_factory();
   AnimChannelMatrixDynamic::register_with_read_factory();
   AnimChannelMatrixFixed::register_with_read_factory();
   AnimChannelScalarTable::register_with_read_factory();
   AnimChannelScalarDynamic::register_with_read_factory();
   AnimPreloadTable::register_with_read_factory();
 
+  LoaderFileTypeRegistry *file_types = LoaderFileTypeRegistry::get_global_ptr();
+  file_types->register_type(new LoaderFileTypeAnimStream);
+
   // For compatibility with old .bam files.
 #ifndef STDFLOAT_DOUBLE
   TypeRegistry *reg = TypeRegistry::ptr();
@@ -18,15 +18,26 @@
 #include "notifyCategoryProxy.h"
 #include "configVariableBool.h"
 #include "configVariableInt.h"
+#include "configVariableDouble.h"
 
 // Configure variables for chan package.
 NotifyCategoryDecl(chan, EXPCL_PANDA_CHAN, EXPTP_PANDA_CHAN);
 
 EXPCL_PANDA_CHAN extern ConfigVariableBool compress_channels;
+EXPCL_PANDA_CHAN extern ConfigVariableBool compress_anim_channels;
+EXPCL_PANDA_CHAN extern ConfigVariableDouble compress_chan_rotation_tolerance;
+EXPCL_PANDA_CHAN extern ConfigVariableDouble compress_chan_position_tolerance;
+EXPCL_PANDA_CHAN extern ConfigVariableDouble compress_chan_scale_tolerance;
 EXPCL_PANDA_CHAN extern ConfigVariableInt compress_chan_quality;
 EXPCL_PANDA_CHAN extern ConfigVariableBool read_compressed_channels;
 EXPCL_PANDA_CHAN extern ConfigVariableBool interpolate_frames;
 EXPCL_PANDA_CHAN extern ConfigVariableBool restore_initial_pose;
 EXPCL_PANDA_CHAN extern ConfigVariableInt async_bind_priority;
+EXPCL_PANDA_CHAN extern ConfigVariableBool compiled_joint_update;
+EXPCL_PANDA_CHAN extern ConfigVariableBool anim_instancing;
+EXPCL_PANDA_CHAN extern ConfigVariableInt anim_instancing_frac_steps;
+EXPCL_PANDA_CHAN extern ConfigVariableInt anim_stream_chunk_frames;
+EXPCL_PANDA_CHAN extern ConfigVariableInt anim_stream_max_resident_chunks;
+EXPCL_PANDA_CHAN extern ConfigVariableBool anim_stream_prefetch;
 
 #endif
@@ -0,0 +1,142 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file jointPaletteCache.cxx
+ * @author agent
+ * @date 2026-10-18
+ */
+
+#include "jointPaletteCache.h"
+#include "lightMutexHolder.h"
+#include "atomicAdjust.h"
+
+#include <algorithm>
+
+JointPaletteCache *JointPaletteCache::_global_ptr = nullptr;
+
+/**
+ *
+ */
+JointPaletteCache::
+JointPaletteCache() :
+  _lock("JointPaletteCache::_lock"),
+  _frame(-1),
+  _num_hits(0),
+  _num_misses(0)
+{
+}
+
+/**
+ * Empties the cache and resets the hit and miss counts.
+ */
+void JointPaletteCache::
+clear() {
+  LightMutexHolder holder(_lock);
+  _palettes.clear();
+  _tables.clear();
+  _num_hits = 0;
+  _num_misses = 0;
+}
+
+/**
+ * Returns the palette computed with the indicated key in the indicated frame,
+ * or NULL if no bundle has yet computed one.  The signature must match the
+ * one the palette was computed with, in case two different bundles happen to
+ * produce the same hash.
+ */
+CPT(JointPaletteCache::Palette) JointPaletteCache::
+find_palette(const Key &key, const Signature &signature, int frame) {
+  LightMutexHolder holder(_lock);
+  check_frame(frame);
+
+  Palettes::const_iterator pi = _palettes.find(key);
+  if (pi != _palettes.end() && (*pi).second->_signature == signature) {
+    ++_num_hits;
+    return (*pi).second;
+  }
+
+  ++_num_misses;
+  return nullptr;
+}
+
+/**
+ * Records the palette computed by a bundle with the indicated key in the
+ * indicated frame, for the benefit of the bundles that are updated after it.
+ * If another bundle got there first, its palette is kept.  Either way, the
+ * palette that is now in the cache is returned.
+ */
+CPT(JointPaletteCache::Palette) JointPaletteCache::
+store_palette(const Key &key, const Palette *palette, int frame) {
+  LightMutexHolder holder(_lock);
+  check_frame(frame);
+  return (*_palettes.insert(Palettes::value_type(key, palette)).first).second;
+}
+
+/**
+ * Called by a Character whose bundle holds the net transforms of the
+ * indicated palette in the indicated frame, for each of its TransformTables.
+ * The prototype is the table of the original model that the table was copied
+ * from, which identifies the joints and rest poses the table was built for.
+ *
+ * Returns the first table registered with the same palette and prototype in
+ * this frame, which holds the same matrices as this one, or the table itself
+ * if it is the first.
+ */
+CPT(TransformTable) JointPaletteCache::
+share_table(const Palette *palette, const TransformTable *prototype,
+            const TransformTable *table, int frame) {
+  LightMutexHolder holder(_lock);
+  check_frame(frame);
+  TableKey key(palette, prototype);
+  return (*_tables.insert(Tables::value_type(key, table)).first).second;
+}
+
+/**
+ * Empties the cache if the frame has changed since it was last used.  Assumes
+ * the lock is held.
+ */
+void JointPaletteCache::
+check_frame(int frame) {
+  if (frame != _frame) {
+    _palettes.clear();
+    _tables.clear();
+    _frame = frame;
+  }
+}
+
+/**
+ * Creates the global pointer.  This may be called by several threads at once,
+ * if the bundles are being updated in parallel; only one of them wins.
+ */
+void JointPaletteCache::
+make_global_ptr() {
+  JointPaletteCache *ptr = new JointPaletteCache;
+  void *result = AtomicAdjust::compare_and_exchange_ptr(
+    (void * TVOLATILE &)_global_ptr, nullptr, (void *)ptr);
+  if (result != nullptr) {
+    delete ptr;
+  }
+}
+
+/**
+ * Orders the keys for the map.
+ */
+bool JointPaletteCache::Key::
+operator < (const Key &other) const {
+  if (_signature_hash != other._signature_hash) {
+    return _signature_hash < other._signature_hash;
+  }
+  if (_blend_type != other._blend_type) {
+    return _blend_type < other._blend_type;
+  }
+  if (_frame_blend != other._frame_blend) {
+    return _frame_blend < other._frame_blend;
+  }
+  return std::lexicographical_compare(_entries.begin(), _entries.end(),
+                                      other._entries.begin(), other._entries.end());
+}
@@ -0,0 +1,133 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file jointPaletteCache.h
+ * @author agent
+ * @date 2026-10-18
+ */
+
+#ifndef JOINTPALETTECACHE_H
+#define JOINTPALETTECACHE_H
+
+#include "pandabase.h"
+
+#include "referenceCount.h"
+#include "pointerTo.h"
+#include "luse.h"
+#include "pvector.h"
+#include "epvector.h"
+#include "pmap.h"
+#include "lightMutex.h"
+#include "transformTable.h"
+
+class AnimBundle;
+
+/**
+ * Holds the joint transforms computed by the PartBundles that have enabled
+ * PartBundle::set_anim_instancing() in the current frame, so that other
+ * bundles playing the same animations at the same frame with the same blend
+ * weights can copy them instead of sampling the animation channels again.
+ *
+ * A palette is only shared between bundles whose joints are bound to the very
+ * same channels, in the same order; in practice, these are copies of the same
+ * model playing the same AnimBundle.  The cache is emptied at the start of
+ * each frame.
+ *
+ * The cache also pairs up the TransformTables of the Characters whose bundles
+ * ended up with the same net transforms, so that the copies of each table
+ * can share the palette buffer of the first one for hardware skinning; see
+ * share_table().
+ */
+class EXPCL_PANDA_CHAN JointPaletteCache {
+protected:
+  JointPaletteCache();
+
+PUBLISHED:
+  INLINE int get_num_palettes() const;
+  INLINE int get_num_hits() const;
+  INLINE int get_num_misses() const;
+  void clear();
+
+  INLINE static JointPaletteCache *get_global_ptr();
+
+PUBLISHED:
+  MAKE_PROPERTY(num_palettes, get_num_palettes);
+  MAKE_PROPERTY(num_hits, get_num_hits);
+  MAKE_PROPERTY(num_misses, get_num_misses);
+
+public:
+  typedef pvector<size_t> Signature;
+
+  // Identifies the animation state of a bundle: the animations it is
+  // playing, with their frame and blend weight, and the channels its joints
+  // are bound to.
+  class EXPCL_PANDA_CHAN Key {
+  public:
+    class Entry {
+    public:
+      INLINE bool operator < (const Entry &other) const;
+
+      AnimBundle *_anim;
+      int _frame;
+      int _frac;
+      PN_stdfloat _effect;
+    };
+    typedef pvector<Entry> Entries;
+
+    bool operator < (const Key &other) const;
+
+    size_t _signature_hash;
+    int _blend_type;
+    bool _frame_blend;
+    Entries _entries;
+  };
+
+  // The transforms computed by the first bundle to be updated with a given
+  // Key in the current frame.
+  class EXPCL_PANDA_CHAN Palette : public ReferenceCount {
+  public:
+    ALLOC_DELETED_CHAIN(Palette);
+
+    Signature _signature;
+    LMatrix4 _root_xform;
+    epvector<LMatrix4> _local_transforms;
+    epvector<LMatrix4> _net_transforms;
+  };
+
+  CPT(Palette) find_palette(const Key &key, const Signature &signature,
+                            int frame);
+  CPT(Palette) store_palette(const Key &key, const Palette *palette,
+                             int frame);
+  CPT(TransformTable) share_table(const Palette *palette,
+                                  const TransformTable *prototype,
+                                  const TransformTable *table, int frame);
+
+private:
+  void check_frame(int frame);
+  static void make_global_ptr();
+
+  typedef pmap<Key, CPT(Palette)> Palettes;
+
+  // The first table registered with share_table() for each palette and
+  // prototype table in the current frame.
+  typedef std::pair<const Palette *, const TransformTable *> TableKey;
+  typedef pmap<TableKey, CPT(TransformTable)> Tables;
+
+  LightMutex _lock;
+  int _frame;
+  Palettes _palettes;
+  Tables _tables;
+  int _num_hits;
+  int _num_misses;
+
+  static JointPaletteCache *_global_ptr;
+};
+
+#include "jointPaletteCache.I"
+
+#endif
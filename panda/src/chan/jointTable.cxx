@@ -0,0 +1,530 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file jointTable.cxx
+ * @author agent
+ * @date 2026-10-18
+ */
+
+#include "jointTable.h"
+#include "partBundle.h"
+#include "movingPartMatrix.h"
+#include "animControl.h"
+#include "animChannel.h"
+#include "config_chan.h"
+#include "clockObject.h"
+#include "stl_compares.h"
+
+#include <algorithm>
+
+/**
+ *
+ */
+JointTable::
+JointTable() :
+  _hierarchy_seq(0),
+  _compiled(false),
+  _full_update(false),
+  _max_joint_depth(-1),
+  _interpolate_updates(false),
+  _signature_hash(0),
+  _signature_valid(false),
+  _palette_frame(-1)
+{
+}
+
+/**
+ * Returns true if the table has not yet been compiled, or if the part
+ * hierarchy of the indicated bundle has changed since it was.
+ */
+bool JointTable::
+is_stale(PartBundle *bundle) const {
+  return !_compiled || _hierarchy_seq != bundle->get_hierarchy_seq();
+}
+
+/**
+ * Empties the table.  It will be rebuilt the next time it is needed.
+ */
+void JointTable::
+clear() {
+  _parts.clear();
+  _part_parents.clear();
+  _part_parent_index.clear();
+  _part_joint.clear();
+  _part_depth.clear();
+  _part_flags.clear();
+  _joints.clear();
+  _joint_parent.clear();
+  _joint_part.clear();
+  _local_transforms.clear();
+  _net_transforms.clear();
+  _interp_from.clear();
+  _interp_to.clear();
+  _joint_interp.clear();
+  _signature.clear();
+  _signature_controls.clear();
+  _signature_valid = false;
+  _palette = nullptr;
+  _palette_frame = -1;
+  _compiled = false;
+}
+
+/**
+ * Rebuilds the table from the current part hierarchy of the indicated bundle.
+ */
+void JointTable::
+compile(PartBundle *bundle) {
+  clear();
+  _hierarchy_seq = bundle->get_hierarchy_seq();
+
+  r_compile(bundle, -1, -1, 0);
+
+  _part_flags.resize(_parts.size(), 0);
+  _net_transforms.resize(_joints.size(), LMatrix4::ident_mat());
+  _interp_from.resize(_joints.size(), LMatrix4::ident_mat());
+  _interp_to.resize(_joints.size(), LMatrix4::ident_mat());
+  _joint_interp.resize(_joints.size(), 0);
+  _compiled = true;
+
+  // We don't know the net transforms the joints currently hold, so the first
+  // update after compiling recomputes all of them.
+  _full_update = true;
+
+  if (chan_cat.is_debug()) {
+    chan_cat.debug()
+      << "Compiled " << _parts.size() << " parts of " << *bundle
+      << " into a table with " << _joints.size() << " joints\n";
+  }
+}
+
+/**
+ * Updates all of the parts in the table to reflect the data for the current
+ * frame.  This performs the same work as PartGroup::do_update() does when
+ * called on the bundle, but without walking the hierarchy.
+ *
+ * The return value is true if any part has changed, false otherwise.
+ */
+bool JointTable::
+update(PartBundle *root, const CycleData *root_cdata, bool parent_changed,
+       bool anim_changed, Thread *current_thread) {
+  nassertr(_compiled, false);
+
+  bool full_update = _full_update;
+  _full_update = false;
+  if (full_update) {
+    parent_changed = true;
+  }
+
+  const PartBundle::CData *cdata = (const PartBundle::CData *)root_cdata;
+
+  // If the level of detail has changed, all of the parts are sampled again,
+  // since the ones that were skipped or interpolated may be out of date.
+  int max_joint_depth = root->_max_joint_depth;
+  bool interpolate_updates = root->_interpolate_updates && root->_update_delay > 0.0;
+  if (max_joint_depth != _max_joint_depth ||
+      interpolate_updates != _interpolate_updates) {
+    _max_joint_depth = max_joint_depth;
+    _interpolate_updates = interpolate_updates;
+    std::fill(_joint_interp.begin(), _joint_interp.end(), 0);
+    anim_changed = true;
+  }
+
+  // If another bundle playing the same animations has already computed its
+  // joint transforms in this frame, we can simply copy them.
+  JointPaletteCache::Key key;
+  CPT(JointPaletteCache::Palette) shared;
+  bool instancing = false;
+  int frame = ClockObject::get_global_clock()->get_frame_count(current_thread);
+  _palette = nullptr;
+  _palette_frame = frame;
+  if (root->_anim_instancing && max_joint_depth < 0 && !interpolate_updates &&
+      root->_blend_tree == nullptr && !cdata->_blend.empty()) {
+    instancing = make_palette_key(cdata, anim_changed || full_update, key);
+    if (instancing) {
+      shared = JointPaletteCache::get_global_ptr()->find_palette(key, _signature, frame);
+      nassertr(shared == nullptr || shared->_local_transforms.size() == _joints.size(), false);
+    }
+  }
+
+  // In the common case, a joint is animated by a single AnimControl without
+  // frame blending.  We sample its channel directly, looking up the frame
+  // number only once per control rather than once per joint.
+  AnimControl *last_control = nullptr;
+  int last_frame = 0;
+
+  // First, fetch the new value of each part whose channels have changed.
+  // Since a part always follows its parent in the table, we can determine in
+  // the same pass whether any part above it has changed.
+  size_t num_parts = _parts.size();
+  for (size_t i = 0; i < num_parts; ++i) {
+    MovingPartBase *part = _parts[i];
+    int parent_index = _part_parent_index[i];
+    int joint = _part_joint[i];
+    unsigned char flags = 0;
+
+    AnimControl *control = part->_effective_control;
+    if (shared != nullptr && joint >= 0) {
+      const LMatrix4 &value = shared->_local_transforms[joint];
+      if (anim_changed || full_update || _local_transforms[joint] != value) {
+        _joints[joint]->_value = value;
+        flags = F_self_changed | F_dirty;
+      }
+
+    } else if (max_joint_depth >= 0 && _part_depth[i] > max_joint_depth &&
+               !full_update) {
+      // This part is below the level of detail; it keeps its last value.
+
+    } else if (joint >= 0 && control != nullptr &&
+               part->_forced_channel == nullptr && !cdata->_do_frame_blend &&
+               root->_blend_tree == nullptr) {
+      if (control != last_control) {
+        last_control = control;
+        last_frame = control->get_frame();
+      }
+      AnimChannelMatrix *channel = DCAST(AnimChannelMatrix, part->_effective_channel);
+      if (anim_changed || control->_marked_frame < 0 ||
+          channel->has_changed(control->_marked_frame, control->_marked_frac,
+                               last_frame, 0.0)) {
+        channel->get_value(last_frame, _joints[joint]->_value);
+        flags = F_self_changed | F_dirty;
+      }
+
+    } else if (anim_changed || part->has_channel_changed(root_cdata)) {
+      part->get_blend_value(root);
+      flags = F_self_changed | F_dirty;
+    }
+
+    if (joint >= 0) {
+      if ((flags & F_self_changed) != 0) {
+        if (!interpolate_updates || full_update) {
+          _local_transforms[joint] = _joints[joint]->_value;
+          _joint_interp[joint] = 0;
+        } else {
+          // Don't show the new pose yet; start moving towards it from the
+          // pose the joint is showing now.
+          _interp_from[joint] = _local_transforms[joint];
+          _interp_to[joint] = _joints[joint]->_value;
+          _joints[joint]->_value = _local_transforms[joint];
+          _joint_interp[joint] = 1;
+          flags = 0;
+        }
+      } else if (_joint_interp[joint]) {
+        // There is no newer pose, so finish the move towards the last one.
+        _local_transforms[joint] = _interp_to[joint];
+        _joints[joint]->_value = _interp_to[joint];
+        _joint_interp[joint] = 0;
+        flags = F_self_changed | F_dirty;
+      }
+    }
+
+    if (parent_index < 0 ? parent_changed
+                         : (_part_flags[parent_index] & F_dirty) != 0) {
+      flags |= F_dirty;
+    }
+    _part_flags[i] = flags;
+  }
+
+  // The net transforms can be copied as well, if they were computed relative
+  // to the same root transform.
+  const JointPaletteCache::Palette *shared_nets = nullptr;
+  if (shared != nullptr && shared->_root_xform == cdata->_root_xform) {
+    shared_nets = shared;
+  }
+
+  bool any_changed = propagate(root, root_cdata, parent_changed, full_update,
+                               shared_nets, current_thread);
+
+  if (instancing) {
+    if (shared == nullptr) {
+      shared = store_palette(root_cdata, key, frame);
+    }
+
+    // Remember the palette if the joints now hold exactly its net transforms,
+    // so that the Character can share its vertex transforms too.  This is
+    // not the case if we were computed relative to a different root
+    // transform, or lost a race to store our own palette.
+    if (shared->_net_transforms == _net_transforms) {
+      _palette = shared;
+    }
+  }
+  return any_changed;
+}
+
+/**
+ * Called by PartBundle::update() between the updates, when the update rate
+ * has been reduced and set_interpolate_updates() is in effect.  Moves each
+ * joint that has not yet reached the pose computed by the last update the
+ * indicated fraction of the way there from the pose it started from.
+ *
+ * The return value is true if any part has changed, false otherwise.
+ */
+bool JointTable::
+interpolate(PartBundle *root, const CycleData *root_cdata, PN_stdfloat t,
+            Thread *current_thread) {
+  nassertr(_compiled, false);
+  if (!_interpolate_updates) {
+    return false;
+  }
+  t = std::min(std::max(t, (PN_stdfloat)0.0f), (PN_stdfloat)1.0f);
+
+  bool any_interp = false;
+  size_t num_parts = _parts.size();
+  for (size_t i = 0; i < num_parts; ++i) {
+    int parent_index = _part_parent_index[i];
+    int joint = _part_joint[i];
+    unsigned char flags = 0;
+
+    if (joint >= 0 && _joint_interp[joint]) {
+      // This is the same linear blend that BT_linear uses to blend between
+      // animation frames.
+      LMatrix4 &local = _local_transforms[joint];
+      local = _interp_from[joint] * (1.0f - t);
+      local += _interp_to[joint] * t;
+      _joints[joint]->_value = local;
+      flags = F_self_changed | F_dirty;
+      any_interp = true;
+    }
+    if (parent_index >= 0 && (_part_flags[parent_index] & F_dirty) != 0) {
+      flags |= F_dirty;
+    }
+    _part_flags[i] = flags;
+  }
+
+  if (!any_interp) {
+    return false;
+  }
+  return propagate(root, root_cdata, false, false, nullptr, current_thread);
+}
+
+/**
+ * The second half of update() and interpolate(): once the flags of the parts
+ * have been computed, this computes the net transforms of the joints that
+ * need it, and lets each part that changed update whatever depends on it.
+ */
+bool JointTable::
+propagate(PartBundle *root, const CycleData *root_cdata, bool parent_changed,
+          bool full_update, const JointPaletteCache::Palette *shared_nets,
+          Thread *current_thread) {
+  const PartBundle::CData *cdata = (const PartBundle::CData *)root_cdata;
+
+  // First compute the net transform of each joint that needs it, in one pass
+  // over the contiguous transform arrays.  A toplevel joint takes its parent
+  // transform from the bundle instead, and so only changes when it does.
+  const LMatrix4 &root_xform = cdata->_root_xform;
+  size_t num_joints = _joints.size();
+  for (size_t j = 0; j < num_joints; ++j) {
+    unsigned char &flags = _part_flags[_joint_part[j]];
+    int parent_joint = _joint_parent[j];
+    if (parent_joint >= 0) {
+      if (flags & F_dirty) {
+        if (shared_nets != nullptr) {
+          _net_transforms[j] = shared_nets->_net_transforms[j];
+        } else {
+          _net_transforms[j].multiply(_local_transforms[j], _net_transforms[parent_joint]);
+        }
+        flags |= F_net_changed;
+      }
+    } else if ((flags & F_self_changed) != 0 || full_update) {
+      if (shared_nets != nullptr) {
+        _net_transforms[j] = shared_nets->_net_transforms[j];
+      } else {
+        _net_transforms[j].multiply(_local_transforms[j], root_xform);
+      }
+      flags |= F_net_changed;
+    }
+  }
+
+  // Then let each part that changed update whatever depends on it.
+  bool any_changed = false;
+  size_t num_parts = _parts.size();
+  for (size_t i = 0; i < num_parts; ++i) {
+    unsigned char flags = _part_flags[i];
+    if ((flags & F_dirty) == 0) {
+      continue;
+    }
+
+    bool self_changed = (flags & F_self_changed) != 0;
+    int joint = _part_joint[i];
+    if (joint >= 0) {
+      if (_joints[joint]->apply_net_transform(_net_transforms[joint], self_changed,
+                                              (flags & F_net_changed) != 0,
+                                              current_thread)) {
+        any_changed = true;
+      }
+    } else {
+      int parent_index = _part_parent_index[i];
+      bool part_parent_changed = (parent_index < 0) ? parent_changed
+        : (_part_flags[parent_index] & F_dirty) != 0;
+      if (_parts[i]->update_internals(root, _part_parents[i], self_changed,
+                                      part_parent_changed, current_thread)) {
+        any_changed = true;
+      }
+    }
+  }
+
+  return any_changed;
+}
+
+/**
+ * Fills in the key that identifies the current animation state of the bundle
+ * in the JointPaletteCache.  The signature of the channels that the joints
+ * are bound to is recomputed if recompute is true, or if the AnimControls
+ * have been reordered since it was last computed.
+ *
+ * Returns false if the bundle cannot share its transforms, for instance
+ * because some of its joints are controlled directly.
+ */
+bool JointTable::
+make_palette_key(const CycleData *root_cdata, bool recompute,
+                 JointPaletteCache::Key &key) {
+  const PartBundle::CData *cdata = (const PartBundle::CData *)root_cdata;
+  typedef JointPaletteCache::Key::Entry Entry;
+
+  // The controls are listed in a consistent order, so that bundles blending
+  // the same animations in the same way produce the same key.
+  typedef pvector<std::pair<Entry, AnimControl *> > Controls;
+  Controls controls;
+  controls.reserve(cdata->_blend.size());
+
+  int frac_steps = std::max((int)anim_instancing_frac_steps, 1);
+  PartBundle::ChannelBlend::const_iterator cbi;
+  for (cbi = cdata->_blend.begin(); cbi != cdata->_blend.end(); ++cbi) {
+    AnimControl *control = (*cbi).first;
+    Entry entry;
+    entry._anim = control->get_anim();
+    entry._frame = control->get_frame();
+    entry._frac = 0;
+    if (cdata->_do_frame_blend) {
+      entry._frac = (int)(control->get_frac() * frac_steps);
+    }
+    entry._effect = (*cbi).second;
+    controls.push_back(Controls::value_type(entry, control));
+  }
+  std::sort(controls.begin(), controls.end());
+
+  size_t num_controls = controls.size();
+  if (!recompute && _signature_controls.size() == num_controls) {
+    for (size_t c = 0; c < num_controls; ++c) {
+      if (_signature_controls[c] != controls[c].second) {
+        recompute = true;
+        break;
+      }
+    }
+  } else {
+    recompute = true;
+  }
+
+  if (recompute) {
+    _signature.clear();
+    _signature_controls.clear();
+    _signature_valid = true;
+    for (size_t c = 0; c < num_controls; ++c) {
+      _signature_controls.push_back(controls[c].second);
+    }
+
+    size_t num_joints = _joints.size();
+    for (size_t j = 0; j < num_joints && _signature_valid; ++j) {
+      MovingPartMatrix *part = _joints[j];
+      if (part->_forced_channel != nullptr) {
+        _signature_valid = false;
+        break;
+      }
+
+      bool any_channel = false;
+      for (size_t c = 0; c < num_controls; ++c) {
+        int channel_index = controls[c].second->get_channel_index();
+        AnimChannelBase *channel = nullptr;
+        if (channel_index >= 0 && channel_index < (int)part->_channels.size()) {
+          channel = part->_channels[channel_index];
+        }
+        _signature.push_back((size_t)channel);
+        any_channel = any_channel || (channel != nullptr);
+      }
+      if (!any_channel) {
+        // A joint without a channel holds its default value.
+        _signature.push_back(part->_default_value.get_hash());
+      }
+    }
+
+    _signature_hash = 0;
+    JointPaletteCache::Signature::const_iterator si;
+    for (si = _signature.begin(); si != _signature.end(); ++si) {
+      _signature_hash = integer_hash<size_t>::add_hash(_signature_hash, *si);
+    }
+  }
+
+  if (!_signature_valid) {
+    return false;
+  }
+
+  key._signature_hash = _signature_hash;
+  key._blend_type = (int)cdata->_blend_type;
+  key._frame_blend = cdata->_do_frame_blend;
+  key._entries.reserve(num_controls);
+  for (size_t c = 0; c < num_controls; ++c) {
+    key._entries.push_back(controls[c].first);
+  }
+  return true;
+}
+
+/**
+ * Offers the joint transforms that were just computed to the
+ * JointPaletteCache, for the other bundles with the same key.  Returns the
+ * palette that the cache holds for the key, which is normally the new one.
+ */
+CPT(JointPaletteCache::Palette) JointTable::
+store_palette(const CycleData *root_cdata, const JointPaletteCache::Key &key,
+              int frame) {
+  const PartBundle::CData *cdata = (const PartBundle::CData *)root_cdata;
+
+  PT(JointPaletteCache::Palette) palette = new JointPaletteCache::Palette;
+  palette->_signature = _signature;
+  palette->_root_xform = cdata->_root_xform;
+  palette->_local_transforms = _local_transforms;
+  palette->_net_transforms = _net_transforms;
+
+  return JointPaletteCache::get_global_ptr()->store_palette(key, palette, frame);
+}
+
+/**
+ * Adds the MovingParts at and below the indicated group to the table.
+ * parent_index is the index of the nearest MovingPart above the group, and
+ * parent_joint the index of the joint that is the group itself, if any, or
+ * -1.  depth is the number of MovingParts above the children of the group.
+ */
+void JointTable::
+r_compile(PartGroup *group, int parent_index, int parent_joint, int depth) {
+  int num_children = group->get_num_children();
+  for (int ci = 0; ci < num_children; ++ci) {
+    PartGroup *child = group->get_child(ci);
+    int child_index = parent_index;
+    int child_joint = -1;
+
+    if (child->is_of_type(MovingPartBase::get_class_type())) {
+      MovingPartBase *part = DCAST(MovingPartBase, child);
+      child_index = (int)_parts.size();
+      _parts.push_back(part);
+      _part_parents.push_back(group);
+      _part_parent_index.push_back(parent_index);
+      _part_depth.push_back(depth);
+
+      if (child->is_character_joint()) {
+        MovingPartMatrix *joint = DCAST(MovingPartMatrix, child);
+        child_joint = (int)_joints.size();
+        _joints.push_back(joint);
+        _joint_parent.push_back(parent_joint);
+        _joint_part.push_back(child_index);
+        _local_transforms.push_back(joint->_value);
+      }
+      _part_joint.push_back(child_joint);
+    }
+
+    r_compile(child, child_index, child_joint,
+              (child_index != parent_index) ? depth + 1 : depth);
+  }
+}
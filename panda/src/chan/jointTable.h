@@ -0,0 +1,148 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file jointTable.h
+ * @author agent
+ * @date 2026-10-18
+ */
+
+#ifndef JOINTTABLE_H
+#define JOINTTABLE_H
+
+#include "pandabase.h"
+
+#include "partGroup.h"
+#include "luse.h"
+#include "pvector.h"
+#include "epvector.h"
+#include "vector_int.h"
+#include "thread.h"
+#include "jointPaletteCache.h"
+
+class PartBundle;
+class MovingPartBase;
+class MovingPartMatrix;
+class CycleData;
+class AnimControl;
+
+/**
+ * A compiled form of the MovingPart hierarchy of a PartBundle, used by
+ * PartBundle::update() in place of the recursive do_update() traversal when
+ * compiled updates are enabled (see PartBundle::set_compiled_update()).
+ *
+ * The parts are stored in a flat array in depth-first order, so that each
+ * part follows its parent, with the index of the parent of each part in a
+ * parallel array.  The character joints additionally have their local and
+ * net transforms stored in contiguous arrays, so that the net transforms of
+ * all of the joints that changed this frame can be computed in a single pass
+ * over the table.  The joints are then handed their new net transform, and
+ * only need to propagate it to the nodes and vertices that depend on it.
+ *
+ * Joints driven by a single AnimControl are sampled directly from their
+ * channel, with the control's frame number computed once per update.
+ *
+ * The table also implements the reduced levels of detail of
+ * PartBundle::set_max_joint_depth(), by not sampling the parts below the
+ * given depth, and PartBundle::set_interpolate_updates(), by keeping the last
+ * two poses of each joint to blend between.
+ *
+ * When PartBundle::set_anim_instancing() is in effect, the table also shares
+ * its joint transforms through the JointPaletteCache with the other bundles
+ * that are playing the same animations in the same way, and remembers the
+ * palette it ended up with, so that the Character can share its vertex
+ * transforms as well.
+ *
+ * The table is rebuilt automatically whenever the part hierarchy changes.
+ * This class is not reentrant; it is protected by the PartBundle's cycler.
+ */
+class EXPCL_PANDA_CHAN JointTable {
+public:
+  JointTable();
+  JointTable(const JointTable &copy) = delete;
+
+  JointTable &operator = (const JointTable &copy) = delete;
+
+  bool is_stale(PartBundle *bundle) const;
+  void clear();
+  void compile(PartBundle *bundle);
+  INLINE void request_full_update();
+
+  INLINE int get_num_parts() const;
+  INLINE int get_num_joints() const;
+  INLINE const JointPaletteCache::Palette *get_palette(int frame) const;
+
+  bool update(PartBundle *root, const CycleData *root_cdata,
+              bool parent_changed, bool anim_changed,
+              Thread *current_thread);
+  bool interpolate(PartBundle *root, const CycleData *root_cdata,
+                   PN_stdfloat t, Thread *current_thread);
+
+private:
+  void r_compile(PartGroup *group, int parent_index, int parent_joint,
+                 int depth);
+  bool propagate(PartBundle *root, const CycleData *root_cdata,
+                 bool parent_changed, bool full_update,
+                 const JointPaletteCache::Palette *shared_nets,
+                 Thread *current_thread);
+  bool make_palette_key(const CycleData *root_cdata, bool recompute,
+                        JointPaletteCache::Key &key);
+  CPT(JointPaletteCache::Palette)
+    store_palette(const CycleData *root_cdata,
+                  const JointPaletteCache::Key &key, int frame);
+
+  enum Flags {
+    F_self_changed = 0x01,
+    F_dirty        = 0x02,
+    F_net_changed  = 0x04,
+  };
+
+  // One entry per MovingPart.  The parts are not reference-counted; they are
+  // kept alive by the bundle that owns this table.
+  pvector<MovingPartBase *> _parts;
+  pvector<PartGroup *> _part_parents;
+  vector_int _part_parent_index;
+  vector_int _part_joint;
+  vector_int _part_depth;
+  pvector<unsigned char> _part_flags;
+
+  // One entry per character joint.
+  pvector<MovingPartMatrix *> _joints;
+  vector_int _joint_parent;
+  vector_int _joint_part;
+  epvector<LMatrix4> _local_transforms;
+  epvector<LMatrix4> _net_transforms;
+
+  // The poses that each joint is interpolated between, and whether it is
+  // still on its way from one to the other.
+  epvector<LMatrix4> _interp_from;
+  epvector<LMatrix4> _interp_to;
+  pvector<unsigned char> _joint_interp;
+
+  // Identifies the channels that the joints are bound to, in the order of
+  // the AnimControls listed in _signature_controls, for sharing the
+  // transforms with other bundles.
+  JointPaletteCache::Signature _signature;
+  pvector<AnimControl *> _signature_controls;
+  size_t _signature_hash;
+  bool _signature_valid;
+
+  // The palette whose net transforms the joints hold after the last update,
+  // if any, and the frame of that update.
+  CPT(JointPaletteCache::Palette) _palette;
+  int _palette_frame;
+
+  int _hierarchy_seq;
+  bool _compiled;
+  bool _full_update;
+  int _max_joint_depth;
+  bool _interpolate_updates;
+};
+
+#include "jointTable.I"
+
+#endif
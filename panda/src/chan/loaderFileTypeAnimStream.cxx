@@ -0,0 +1,91 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file loaderFileTypeAnimStream.cxx
+ * @author agent
+ * @date 2026-10-18
+ */
+
+#include "loaderFileTypeAnimStream.h"
+#include "animStream.h"
+#include "animBundleNode.h"
+#include "bamCacheRecord.h"
+#include "modelRoot.h"
+#include "loaderOptions.h"
+
+TypeHandle LoaderFileTypeAnimStream::_type_handle;
+
+/**
+ *
+ */
+LoaderFileTypeAnimStream::
+LoaderFileTypeAnimStream() {
+}
+
+/**
+ *
+ */
+std::string LoaderFileTypeAnimStream::
+get_name() const {
+  return "Panda animation stream";
+}
+
+/**
+ *
+ */
+std::string LoaderFileTypeAnimStream::
+get_extension() const {
+  return "pas";
+}
+
+/**
+ * Returns true if the loader is allowed to store the result in the model
+ * cache.  This is never the case for an animation stream, since the channels
+ * it produces cannot be written to a bam file, and there would be no point
+ * anyway.
+ */
+bool LoaderFileTypeAnimStream::
+get_allow_disk_cache(const LoaderOptions &options) const {
+  return false;
+}
+
+/**
+ * Returns true if the file type can be used to load files, and load_file() is
+ * supported.  Returns false if load_file() is unimplemented and will always
+ * fail.
+ */
+bool LoaderFileTypeAnimStream::
+supports_load() const {
+  return true;
+}
+
+/**
+ *
+ */
+PT(PandaNode) LoaderFileTypeAnimStream::
+load_file(const Filename &path, const LoaderOptions &options,
+          BamCacheRecord *record) const {
+  if (record != nullptr) {
+    record->add_dependent_file(path);
+  }
+
+  PT(AnimStream) stream = new AnimStream;
+  if (!stream->open(path)) {
+    return nullptr;
+  }
+
+  PT(AnimBundle) bundle = stream->make_bundle();
+  if (bundle == nullptr) {
+    return nullptr;
+  }
+
+  PT(ModelRoot) root = new ModelRoot(path.get_basename());
+  root->set_fullpath(path);
+  root->add_child(new AnimBundleNode(bundle->get_name(), bundle));
+  return root;
+}
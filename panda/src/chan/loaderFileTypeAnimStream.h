@@ -0,0 +1,58 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file loaderFileTypeAnimStream.h
+ * @author agent
+ * @date 2026-10-18
+ */
+
+#ifndef LOADERFILETYPEANIMSTREAM_H
+#define LOADERFILETYPEANIMSTREAM_H
+
+#include "pandabase.h"
+
+#include "loaderFileType.h"
+
+/**
+ * This defines the Loader interface to read the animation stream files
+ * written by AnimStream::write_bundle().  Only the header of the file is
+ * read at load time; the frames are read while the animation is played.
+ */
+class EXPCL_PANDA_CHAN LoaderFileTypeAnimStream : public LoaderFileType {
+public:
+  LoaderFileTypeAnimStream();
+
+  virtual std::string get_name() const;
+  virtual std::string get_extension() const;
+
+  virtual bool get_allow_disk_cache(const LoaderOptions &options) const;
+
+  virtual bool supports_load() const;
+
+  virtual PT(PandaNode) load_file(const Filename &path, const LoaderOptions &options,
+                                  BamCacheRecord *record) const;
+
+public:
+  static TypeHandle get_class_type() {
+    return _type_handle;
+  }
+  static void init_type() {
+    LoaderFileType::init_type();
+    register_type(_type_handle, "LoaderFileTypeAnimStream",
+                  LoaderFileType::get_class_type());
+  }
+  virtual TypeHandle get_type() const {
+    return get_class_type();
+  }
+  virtual TypeHandle force_init_type() {init_type(); return get_class_type();}
+
+private:
+  static TypeHandle _type_handle;
+};
+
+#endif
@@ -55,6 +55,7 @@ public:
   virtual bool do_update(PartBundle *root, const CycleData *root_cdata,
                          PartGroup *parent, bool parent_changed,
                          bool anim_changed, Thread *current_thread);
+  bool has_channel_changed(const CycleData *root_cdata) const;
 
   virtual void get_blend_value(const PartBundle *root)=0;
   virtual bool update_internals(PartBundle *root, PartGroup *parent,
@@ -118,6 +119,9 @@ public:
 
 private:
   static TypeHandle _type_handle;
+
+  friend class JointTable;
+  friend class AnimBlendTree;
 };
 
 #include "movingPartBase.I"
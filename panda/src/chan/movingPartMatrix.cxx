@@ -61,14 +61,18 @@ get_blend_value(const PartBundle *root) {
 
   PartBundle::CDReader cdata(root->_cycler);
 
-  if (cdata->_blend.empty()) {
+  if (root->_blend_tree != nullptr) {
+    // The blend tree decides how the animations are combined.
+    root->_blend_tree->evaluate(this, cdata->_do_frame_blend, _value);
+
+  } else if (cdata->_blend.empty()) {
     // No channel is bound; supply the default value.
     if (restore_initial_pose) {
       _value = _default_value;
     }
 
   } else if (_effective_control != nullptr &&
-             !cdata->_frame_blend_flag) {
+             !cdata->_do_frame_blend) {
     // A single value, the normal case.
     ChannelType *channel = DCAST(ChannelType, _effective_channel);
     channel->get_value(_effective_control->get_frame(), _value);
@@ -97,7 +101,7 @@ get_blend_value(const PartBundle *root) {
             ValueType v;
             channel->get_value(control->get_frame(), v);
 
-            if (!cdata->_frame_blend_flag) {
+            if (!cdata->_do_frame_blend) {
               // Hold the current frame until the next one is ready.
               net_value += v * effect;
             } else {
@@ -153,7 +157,7 @@ get_blend_value(const PartBundle *root) {
             channel->get_scale(frame, iscale);
             channel->get_shear(frame, ishear);
 
-            if (!cdata->_frame_blend_flag) {
+            if (!cdata->_do_frame_blend) {
               // Hold the current frame until the next one is ready.
               net_value += v * effect;
               scale += iscale * effect;
@@ -226,7 +230,7 @@ get_blend_value(const PartBundle *root) {
             channel->get_pos(frame, ipos);
             channel->get_shear(frame, ishear);
 
-            if (!cdata->_frame_blend_flag) {
+            if (!cdata->_do_frame_blend) {
               // Hold the current frame until the next one is ready.
               scale += iscale * effect;
               hpr += ihpr * effect;
@@ -303,7 +307,7 @@ get_blend_value(const PartBundle *root) {
             channel->get_pos(frame, ipos);
             channel->get_shear(frame, ishear);
 
-            if (!cdata->_frame_blend_flag) {
+            if (!cdata->_do_frame_blend) {
               // Hold the current frame until the next one is ready.
               scale += iscale * effect;
               quat += iquat * effect;
@@ -359,6 +363,21 @@ get_blend_value(const PartBundle *root) {
   }
 }
 
+/**
+ * Called by the JointTable, in place of update_internals(), for parts that
+ * return true from is_character_joint().  The net transform of the part from
+ * the root of the bundle has already been computed by the table; the part
+ * need only store it and update whatever depends on it.
+ *
+ * net_changed is true if net_transform differs from the value passed the
+ * previous time.  The return value is true if the part has changed.
+ */
+bool MovingPartMatrix::
+apply_net_transform(const LMatrix4 &, bool self_changed, bool net_changed,
+                    Thread *) {
+  return self_changed || net_changed;
+}
+
 /**
  * Freezes this particular joint so that it will always hold the specified
  * transform.  Returns true if this is a joint that can be so frozen, false
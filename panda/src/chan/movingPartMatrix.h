@@ -37,6 +37,9 @@ public:
 
   virtual AnimChannelBase *make_default_channel() const;
   virtual void get_blend_value(const PartBundle *root);
+  virtual bool apply_net_transform(const LMatrix4 &net_transform,
+                                   bool self_changed, bool net_changed,
+                                   Thread *current_thread);
 
   virtual bool apply_freeze_matrix(const LVecBase3 &pos, const LVecBase3 &hpr, const LVecBase3 &scale);
   virtual bool apply_control(PandaNode *node);
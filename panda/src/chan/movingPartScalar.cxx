@@ -47,14 +47,18 @@ get_blend_value(const PartBundle *root) {
 
   PartBundle::CDReader cdata(root->_cycler);
 
-  if (cdata->_blend.empty()) {
+  if (root->_blend_tree != nullptr) {
+    // The blend tree decides how the animations are combined.
+    root->_blend_tree->evaluate(this, cdata->_do_frame_blend, _value);
+
+  } else if (cdata->_blend.empty()) {
     // No channel is bound; supply the default value.
     if (restore_initial_pose) {
       _value = _default_value;
     }
 
   } else if (_effective_control != nullptr &&
-             !cdata->_frame_blend_flag) {
+             !cdata->_do_frame_blend) {
     // A single value, the normal case.
     ChannelType *channel = DCAST(ChannelType, _effective_channel);
     channel->get_value(_effective_control->get_frame(), _value);
@@ -79,7 +83,7 @@ get_blend_value(const PartBundle *root) {
         ValueType v;
         channel->get_value(control->get_frame(), v);
 
-        if (!cdata->_frame_blend_flag) {
+        if (!cdata->_do_frame_blend) {
           // Hold the current frame until the next one is ready.
           _value += v * effect;
         } else {
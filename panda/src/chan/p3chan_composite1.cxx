@@ -1,13 +1,17 @@
 #include "auto_bind.cxx"
+#include "animBlendTree.cxx"
 #include "animBundle.cxx"
 #include "animBundleNode.cxx"
 #include "animChannel.cxx"
 #include "animChannelBase.cxx"
 #include "animChannelFixed.cxx"
+#include "animChannelMatrixCompressed.cxx"
 #include "animChannelMatrixDynamic.cxx"
 #include "animChannelMatrixFixed.cxx"
+#include "animChannelMatrixStreamed.cxx"
 #include "animChannelMatrixXfmTable.cxx"
 #include "animChannelScalarDynamic.cxx"
+#include "animChannelScalarStreamed.cxx"
 #include "animChannelScalarTable.cxx"
 #include "animControl.cxx"
 #include "animControlCollection.cxx"
@@ -1,6 +1,10 @@
 #include "animPreloadTable.cxx"
+#include "animStream.cxx"
 #include "bindAnimRequest.cxx"
 #include "config_chan.cxx"
+#include "jointPaletteCache.cxx"
+#include "jointTable.cxx"
+#include "loaderFileTypeAnimStream.cxx"
 #include "movingPartBase.cxx"
 #include "movingPartMatrix.cxx"
 #include "movingPartScalar.cxx"
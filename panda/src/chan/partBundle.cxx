@@ -55,6 +55,14 @@ PartBundle(const PartBundle &copy) :
 {
   _anim_preload = copy._anim_preload;
   _update_delay = 0.0;
+  _max_joint_depth = -1;
+  _allow_frame_blend = true;
+  _interpolate_updates = false;
+  _anim_instancing = copy._anim_instancing;
+  _compiled_update = copy._compiled_update;
+  _blend_tree_seq = -1;
+  _hierarchy_checked_seq = -1;
+  _hierarchy_seq = 0;
 
   CDWriter cdata(_cycler, true);
   CDReader cdata_from(copy._cycler);
@@ -73,6 +81,14 @@ PartBundle(const string &name) :
   PartGroup(name)
 {
   _update_delay = 0.0;
+  _max_joint_depth = -1;
+  _allow_frame_blend = true;
+  _interpolate_updates = false;
+  _anim_instancing = anim_instancing;
+  _compiled_update = compiled_joint_update;
+  _blend_tree_seq = -1;
+  _hierarchy_checked_seq = -1;
+  _hierarchy_seq = 0;
 }
 
 /**
@@ -466,6 +482,53 @@ release_joint(const string &joint_name) {
   return child->clear_forced_channel();
 }
 
+/**
+ * Specifies whether the bundle should compile its part hierarchy into a flat
+ * JointTable, and evaluate that each frame instead of recursively walking the
+ * hierarchy.  The results are the same either way, but the compiled table is
+ * faster for characters with many joints, since the net transforms of all of
+ * the joints are computed in a single pass over contiguous memory.
+ *
+ * The default is set by the config variable compiled-joint-update.
+ */
+void PartBundle::
+set_compiled_update(bool compiled_update) {
+  nassertv(Thread::get_current_pipeline_stage() == 0);
+
+  CDWriter cdata(_cycler);
+  _compiled_update = compiled_update;
+  _joint_table.clear();
+}
+
+/**
+ * Assigns an AnimBlendTree to decide how the AnimControls bound to this
+ * bundle are blended together, in place of set_control_effect() and
+ * set_blend_type().  The tree is evaluated for each joint as part of the
+ * update, and is driven by setting its parameters.
+ *
+ * While the tree is assigned, the AnimControls it plays are in effect, and
+ * starting or stopping them only changes the frame that they show; the
+ * control effects should not be changed.  Pass NULL, or call
+ * clear_blend_tree(), to go back to blending by the control effects, all of
+ * which are reset to zero.
+ */
+void PartBundle::
+set_blend_tree(AnimBlendTree *tree) {
+  nassertv(Thread::get_current_pipeline_stage() == 0);
+
+  CDWriter cdata(_cycler);
+  _blend_tree = tree;
+  _blend_tree_seq = -1;
+  if (tree != nullptr) {
+    sync_blend_tree(cdata);
+  } else {
+    cdata->_blend.clear();
+    cdata->_last_control_set = nullptr;
+    recompute_net_blend(cdata);
+  }
+  cdata->_anim_changed = true;
+}
+
 /**
  * Updates all the parts in the bundle to reflect the data for the current
  * frame (as set in each of the AnimControls).
@@ -479,13 +542,17 @@ update() {
   CDWriter cdata(_cycler, false, current_thread);
   bool any_changed = false;
 
+  if (_blend_tree != nullptr) {
+    sync_blend_tree(cdata);
+  }
+
   double now = ClockObject::get_global_clock()->get_frame_time(current_thread);
   if (now > cdata->_last_update + _update_delay || cdata->_anim_changed) {
     bool anim_changed = cdata->_anim_changed;
-    bool frame_blend_flag = cdata->_frame_blend_flag;
+    cdata->_do_frame_blend = cdata->_frame_blend_flag && _allow_frame_blend;
+    bool frame_blend_flag = cdata->_do_frame_blend;
 
-    any_changed = do_update(this, cdata, nullptr, false, anim_changed,
-                            current_thread);
+    any_changed = do_update_parts(cdata, false, anim_changed, current_thread);
 
     // Now update all the controls for next time.
     ChannelBlend::const_iterator cbi;
@@ -496,6 +563,14 @@ update() {
 
     cdata->_anim_changed = false;
     cdata->_last_update = now;
+
+  } else if (_interpolate_updates && _update_delay > 0.0 &&
+             !_joint_table.is_stale(this)) {
+    // Between updates, the joints move smoothly from the pose of the
+    // next-to-last update to the pose of the last one.
+    double t = (now - cdata->_last_update) / _update_delay;
+    any_changed = _joint_table.interpolate(this, cdata, (PN_stdfloat)t,
+                                           current_thread);
   }
 
   return any_changed;
@@ -509,13 +584,20 @@ bool PartBundle::
 force_update() {
   Thread *current_thread = Thread::get_current_thread();
   CDWriter cdata(_cycler, false, current_thread);
-  bool any_changed = do_update(this, cdata, nullptr, true, true, current_thread);
+  if (_blend_tree != nullptr) {
+    sync_blend_tree(cdata);
+  }
+  cdata->_do_frame_blend = cdata->_frame_blend_flag && _allow_frame_blend;
+
+  // A forced update ignores the joint depth and interpolation limits too.
+  _joint_table.request_full_update();
+  bool any_changed = do_update_parts(cdata, true, true, current_thread);
 
   // Now update all the controls for next time.
   ChannelBlend::const_iterator cbi;
   for (cbi = cdata->_blend.begin(); cbi != cdata->_blend.end(); ++cbi) {
     AnimControl *control = (*cbi).first;
-    control->mark_channels(cdata->_frame_blend_flag);
+    control->mark_channels(cdata->_do_frame_blend);
   }
 
   cdata->_anim_changed = false;
@@ -524,6 +606,36 @@ force_update() {
 }
 
 
+/**
+ * The internal implementation of update() and force_update().  Updates the
+ * parts either from the compiled JointTable or by walking the hierarchy.  The
+ * table is also used whenever set_max_joint_depth(),
+ * set_interpolate_updates() or set_anim_instancing() is in effect, since
+ * only the table keeps track of the depth, the previous pose and the shared
+ * transforms of each joint.
+ */
+bool PartBundle::
+do_update_parts(CData *cdata, bool parent_changed, bool anim_changed,
+                Thread *current_thread) {
+  if (_compiled_update || _max_joint_depth >= 0 || _interpolate_updates ||
+      _anim_instancing) {
+    if (_joint_table.is_stale(this)) {
+      _joint_table.compile(this);
+    }
+    return _joint_table.update(this, cdata, parent_changed, anim_changed,
+                               current_thread);
+  }
+
+  // The transforms in the table won't be kept up to date from here on, so
+  // it will have to start over if it is needed again.
+  if (!_joint_table.is_stale(this)) {
+    _joint_table.clear();
+  }
+
+  return do_update(this, cdata, nullptr, parent_changed, anim_changed,
+                   current_thread);
+}
+
 /**
  * Called by the AnimControl whenever it starts an animation.  This is just a
  * hook so the bundle can do something, if necessary, before the animation
@@ -534,6 +646,11 @@ control_activated(AnimControl *control) {
   nassertv(Thread::get_current_pipeline_stage() == 0);
   nassertv(control->get_part() == this);
 
+  // The blend tree, if any, decides which animations are in effect.
+  if (_blend_tree != nullptr) {
+    return;
+  }
+
   CDLockedReader cdata(_cycler);
 
   // If (and only if) our anim_blend_flag is false, then starting an animation
@@ -617,6 +734,50 @@ do_bind_anim(AnimControl *control, AnimBundle *anim,
   return true;
 }
 
+/**
+ * Returns a number that is incremented whenever a part is added to or
+ * removed from the hierarchy of this bundle, or the parts are reordered.
+ * This is used to detect when the tables built from the hierarchy, such as
+ * the JointTable, must be rebuilt.
+ *
+ * Unlike PartGroup::get_global_hierarchy_seq(), this is not affected by
+ * changes to the hierarchies of other bundles.  When the global number has
+ * changed, the hierarchy is compared with the one seen the last time.
+ */
+int PartBundle::
+get_hierarchy_seq() {
+  AtomicAdjust::Integer global_seq = PartGroup::get_global_hierarchy_seq();
+  if (global_seq != _hierarchy_checked_seq) {
+    _hierarchy_checked_seq = global_seq;
+
+    HierarchyGroups groups;
+    groups.reserve(_hierarchy_groups.size());
+    r_list_hierarchy(groups, this);
+    if (groups != _hierarchy_groups) {
+      _hierarchy_groups.swap(groups);
+      ++_hierarchy_seq;
+    }
+  }
+  return _hierarchy_seq;
+}
+
+/**
+ * Returns the palette of the JointPaletteCache whose net transforms the
+ * joints of this bundle were given by its update in the current frame, or
+ * NULL if the bundle has not been updated in this frame, or did not share its
+ * transforms with other bundles.  See set_anim_instancing().
+ *
+ * All of the bundles that return the same palette hold the very same net
+ * transforms, so the Characters they belong to may share whatever is
+ * computed from them.
+ */
+CPT(JointPaletteCache::Palette) PartBundle::
+get_shared_palette(Thread *current_thread) const {
+  CDReader cdata(_cycler, current_thread);
+  int frame = ClockObject::get_global_clock()->get_frame_count(current_thread);
+  return _joint_table.get_palette(frame);
+}
+
 /**
  * Adds the PartBundleNode pointer to the set of nodes associated with the
  * PartBundle.  Normally called only by the PartBundleNode itself, for
@@ -691,6 +852,50 @@ do_get_control_effect(AnimControl *control, const CData *cdata) const {
 }
 
 
+/**
+ * Brings the blend tree up to date before an update.  The AnimControls played
+ * by the tree are all put into effect, so that the parts notice when their
+ * frames change; if the tree's parameters or structure have changed, all of
+ * the parts are evaluated again.
+ */
+void PartBundle::
+sync_blend_tree(CData *cdata) {
+  if (_blend_tree->prepare(this)) {
+    cdata->_anim_changed = true;
+  }
+
+  if (_blend_tree_seq != _blend_tree->get_controls_seq()) {
+    _blend_tree_seq = _blend_tree->get_controls_seq();
+
+    cdata->_blend.clear();
+    int num_controls = _blend_tree->get_num_controls();
+    for (int i = 0; i < num_controls; ++i) {
+      AnimControl *control = _blend_tree->get_control(i);
+      nassertd(control->get_part() == this) continue;
+      cdata->_blend[control] = 1.0f;
+    }
+    cdata->_last_control_set = nullptr;
+    recompute_net_blend(cdata);
+    cdata->_anim_changed = true;
+  }
+}
+
+/**
+ * Appends the descendants of the indicated group to the list, depth-first,
+ * for get_hierarchy_seq().  The children of each group are followed by a
+ * nullptr, so that the list identifies the shape of the hierarchy as well.
+ */
+void PartBundle::
+r_list_hierarchy(HierarchyGroups &groups, const PartGroup *group) {
+  int num_children = group->get_num_children();
+  for (int i = 0; i < num_children; ++i) {
+    const PartGroup *child = group->get_child(i);
+    groups.push_back(child);
+    r_list_hierarchy(groups, child);
+  }
+  groups.push_back(nullptr);
+}
+
 /**
  * Recomputes the total blending amount after a control effect has been
  * adjusted.  This value must be kept up-to-date so we can normalize the
@@ -831,6 +1036,7 @@ CData() {
   _blend_type = anim_blend_type;
   _anim_blend_flag = false;
   _frame_blend_flag = interpolate_frames;
+  _do_frame_blend = _frame_blend_flag;
   _root_xform = LMatrix4::ident_mat();
   _last_control_set = nullptr;
   _net_blend = 0.0f;
@@ -846,6 +1052,7 @@ CData(const PartBundle::CData &copy) :
   _blend_type(copy._blend_type),
   _anim_blend_flag(copy._anim_blend_flag),
   _frame_blend_flag(copy._frame_blend_flag),
+  _do_frame_blend(copy._do_frame_blend),
   _root_xform(copy._root_xform),
   _last_control_set(copy._last_control_set),
   _blend(copy._blend),
@@ -31,6 +31,8 @@
 #include "transformState.h"
 #include "weakPointerTo.h"
 #include "copyOnWritePointer.h"
+#include "jointTable.h"
+#include "animBlendTree.h"
 
 class Loader;
 class AnimBundle;
@@ -142,6 +144,32 @@ PUBLISHED:
   bool control_joint(const std::string &joint_name, PandaNode *node);
   bool release_joint(const std::string &joint_name);
 
+  void set_compiled_update(bool compiled_update);
+  INLINE bool get_compiled_update() const;
+  MAKE_PROPERTY(compiled_update, get_compiled_update, set_compiled_update);
+
+  INLINE void set_max_joint_depth(int max_joint_depth);
+  INLINE int get_max_joint_depth() const;
+  INLINE void set_allow_frame_blend(bool allow_frame_blend);
+  INLINE bool get_allow_frame_blend() const;
+  INLINE void set_interpolate_updates(bool interpolate_updates);
+  INLINE bool get_interpolate_updates() const;
+  INLINE void set_update_delay(double delay);
+  INLINE double get_update_delay() const;
+  MAKE_PROPERTY(max_joint_depth, get_max_joint_depth, set_max_joint_depth);
+  MAKE_PROPERTY(allow_frame_blend, get_allow_frame_blend, set_allow_frame_blend);
+  MAKE_PROPERTY(interpolate_updates, get_interpolate_updates, set_interpolate_updates);
+  MAKE_PROPERTY(update_delay, get_update_delay, set_update_delay);
+
+  INLINE void set_anim_instancing(bool anim_instancing);
+  INLINE bool get_anim_instancing() const;
+  MAKE_PROPERTY(anim_instancing, get_anim_instancing, set_anim_instancing);
+
+  void set_blend_tree(AnimBlendTree *tree);
+  INLINE AnimBlendTree *get_blend_tree() const;
+  INLINE void clear_blend_tree();
+  MAKE_PROPERTY(blend_tree, get_blend_tree, set_blend_tree);
+
   bool update();
   bool force_update();
 
@@ -150,11 +178,13 @@ public:
   // they're just public so we don't have to declare a bunch of friends.
   virtual void control_activated(AnimControl *control);
   void control_removed(AnimControl *control);
-  INLINE void set_update_delay(double delay);
 
   bool do_bind_anim(AnimControl *control, AnimBundle *anim,
                     int hierarchy_match_flags, const PartSubset &subset);
 
+  int get_hierarchy_seq();
+  CPT(JointPaletteCache::Palette) get_shared_palette(Thread *current_thread) const;
+
 protected:
   virtual void add_node(PartBundleNode *node);
   virtual void remove_node(PartBundleNode *node);
@@ -166,6 +196,12 @@ private:
   PN_stdfloat do_get_control_effect(AnimControl *control, const CData *cdata) const;
   void recompute_net_blend(CData *cdata);
   void clear_and_stop_intersecting(AnimControl *control, CData *cdata);
+  bool do_update_parts(CData *cdata, bool parent_changed, bool anim_changed,
+                       Thread *current_thread);
+  void sync_blend_tree(CData *cdata);
+
+  typedef pvector<const PartGroup *> HierarchyGroups;
+  static void r_list_hierarchy(HierarchyGroups &groups, const PartGroup *group);
 
   COWPT(AnimPreloadTable) _anim_preload;
 
@@ -177,6 +213,29 @@ private:
 
   double _update_delay;
 
+  // These reduce the work done by update(), for an animation LOD.  See
+  // Character::add_lod_animation_level().
+  int _max_joint_depth;
+  bool _allow_frame_blend;
+  bool _interpolate_updates;
+
+  bool _anim_instancing;
+  bool _compiled_update;
+
+  // If this is set, it decides how the AnimControls are blended, in place of
+  // the control effects.
+  PT(AnimBlendTree) _blend_tree;
+  int _blend_tree_seq;
+
+  JointTable _joint_table;
+
+  // The groups of the hierarchy as of the last call to get_hierarchy_seq(),
+  // listed depth-first with a nullptr after the children of each group, and
+  // the value of PartGroup::get_global_hierarchy_seq() at that time.
+  HierarchyGroups _hierarchy_groups;
+  AtomicAdjust::Integer _hierarchy_checked_seq;
+  int _hierarchy_seq;
+
   // This is the data that must be cycled between pipeline stages.
   class CData : public CycleData {
   public:
@@ -193,6 +252,12 @@ private:
     BlendType _blend_type;
     bool _anim_blend_flag;
     bool _frame_blend_flag;
+
+    // This is _frame_blend_flag, unless frame blending has been disabled with
+    // set_allow_frame_blend().  It is recomputed before each update, and is
+    // the flag that the parts actually consult.
+    bool _do_frame_blend;
+
     LMatrix4 _root_xform;
     AnimControl *_last_control_set;
     ChannelBlend _blend;
@@ -241,6 +306,7 @@ private:
   friend class MovingPartBase;
   friend class MovingPartMatrix;
   friend class MovingPartScalar;
+  friend class JointTable;
 };
 
 inline std::ostream &operator <<(std::ostream &out, const PartBundle &bundle) {
@@ -27,6 +27,7 @@
 
 using std::ostream;
 
+AtomicAdjust::Integer PartGroup::_global_hierarchy_seq = 0;
 TypeHandle PartGroup::_type_handle;
 
 /**
@@ -41,6 +42,7 @@ PartGroup(PartGroup *parent, const std::string &name) :
   nassertv(parent != nullptr);
 
   parent->_children.push_back(this);
+  mark_hierarchy_changed();
 }
 
 /**
@@ -85,6 +87,7 @@ copy_subgraph() const {
     PartGroup *child = (*ci)->copy_subgraph();
     root->_children.push_back(child);
   }
+  mark_hierarchy_changed();
 
   return root;
 }
@@ -166,6 +169,7 @@ public:
 void PartGroup::
 sort_descendants() {
   std::stable_sort(_children.begin(), _children.end(), PartGroupAlphabeticalOrder());
+  mark_hierarchy_changed();
 
   Children::iterator ci;
   for (ci = _children.begin(); ci != _children.end(); ++ci) {
@@ -670,6 +674,7 @@ complete_pointers(TypedWritable **p_list, BamReader *manager) {
   for (ci = _children.begin(); ci != _children.end(); ++ci) {
     (*ci) = DCAST(PartGroup, p_list[pi++]);
   }
+  mark_hierarchy_changed();
 
   return pi;
 }
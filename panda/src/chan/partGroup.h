@@ -23,6 +23,7 @@
 #include "thread.h"
 #include "plist.h"
 #include "luse.h"
+#include "atomicAdjust.h"
 
 class AnimControl;
 class AnimGroup;
@@ -100,7 +101,11 @@ public:
   virtual void do_xform(const LMatrix4 &mat, const LMatrix4 &inv_mat);
   virtual void determine_effective_channels(const CycleData *root_cdata);
 
+  INLINE static AtomicAdjust::Integer get_global_hierarchy_seq();
+
 protected:
+  INLINE static void mark_hierarchy_changed();
+
   void write_descendants(std::ostream &out, int indent_level) const;
   void write_descendants_with_value(std::ostream &out, int indent_level) const;
 
@@ -144,6 +149,7 @@ public:
   }
 
 private:
+  static AtomicAdjust::Integer _global_hierarchy_seq;
   static TypeHandle _type_handle;
 
   friend class Character;
@@ -0,0 +1,455 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file animationScheduler.cxx
+ * @author agent
+ * @date 2026-10-18
+ */
+
+#include "animationScheduler.h"
+#include "characterJoint.h"
+#include "config_char.h"
+#include "asyncTaskManager.h"
+#include "animChannelMatrixDynamic.h"
+#include "movingPartBase.h"
+#include "clockObject.h"
+#include "lightMutexHolder.h"
+#include "pStatTimer.h"
+
+#include <algorithm>
+
+AnimationScheduler *AnimationScheduler::_global_ptr = nullptr;
+PStatCollector AnimationScheduler::_update_pcollector("App:Animation:Scheduler");
+
+/**
+ * Use get_global_ptr() to get the one AnimationScheduler.
+ */
+AnimationScheduler::
+AnimationScheduler() :
+  _active(false),
+  _num_updated(0),
+  _num_levels(0)
+{
+  _task = new GenericAsyncTask("animationScheduler", &st_update, this);
+  _task->set_sort(animation_scheduler_sort);
+
+  if (animation_scheduler) {
+    set_active(true);
+  }
+}
+
+/**
+ * Starts or stops the scheduler.  While it is active, the scheduler adds a
+ * task to the global AsyncTaskManager that calls update() each frame; see
+ * animation-scheduler-sort to control where in the frame it runs.  When it is
+ * stopped, the Characters are once again updated by the cull traversal only,
+ * except for those that were added with add_character(), which are left for
+ * the application to update with explicit calls to update().
+ */
+void AnimationScheduler::
+set_active(bool active) {
+  if (active == _active) {
+    return;
+  }
+
+  _active = active;
+  AsyncTaskManager *manager = AsyncTaskManager::get_global_ptr();
+  if (active) {
+    manager->add(_task);
+  } else {
+    manager->remove(_task);
+
+    LightMutexHolder holder(_lock);
+    _visible.clear();
+  }
+}
+
+/**
+ * Changes the number of threads of the "animation" task chain, on which the
+ * Characters are updated.  If this is 0, update() updates them all on the
+ * calling thread instead, in the same order it would have used otherwise.
+ */
+void AnimationScheduler::
+set_num_threads(int num_threads) {
+  get_task_chain()->set_num_threads(num_threads);
+}
+
+/**
+ * Returns the number of threads of the "animation" task chain.
+ */
+int AnimationScheduler::
+get_num_threads() const {
+  return ((AnimationScheduler *)this)->get_task_chain()->get_num_threads();
+}
+
+/**
+ * Adds the indicated Character to the list of Characters that update()
+ * updates every time, whether it has been in view or not.  This is useful
+ * for a Character whose exposed joints are needed by the application.
+ */
+void AnimationScheduler::
+add_character(Character *character) {
+  nassertv(character != nullptr);
+  LightMutexHolder holder(_lock);
+  Characters::const_iterator ci =
+    std::find(_characters.begin(), _characters.end(), character);
+  if (ci == _characters.end()) {
+    _characters.push_back(character);
+  }
+}
+
+/**
+ * Removes the indicated Character from the list added by add_character().
+ * Returns true if it was removed, or false if it was not on the list.
+ */
+bool AnimationScheduler::
+remove_character(Character *character) {
+  LightMutexHolder holder(_lock);
+  Characters::iterator ci =
+    std::find(_characters.begin(), _characters.end(), character);
+  if (ci == _characters.end()) {
+    return false;
+  }
+  _characters.erase(ci);
+  return true;
+}
+
+/**
+ * Returns true if the indicated Character has been added with
+ * add_character(), or false otherwise.
+ */
+bool AnimationScheduler::
+has_character(Character *character) const {
+  LightMutexHolder holder(_lock);
+  Characters::const_iterator ci =
+    std::find(_characters.begin(), _characters.end(), character);
+  return (ci != _characters.end());
+}
+
+/**
+ * Removes all of the Characters added with add_character().
+ */
+void AnimationScheduler::
+clear_characters() {
+  LightMutexHolder holder(_lock);
+  _characters.clear();
+}
+
+/**
+ * Returns the number of Characters that have been added with
+ * add_character().
+ */
+int AnimationScheduler::
+get_num_characters() const {
+  LightMutexHolder holder(_lock);
+  return (int)_characters.size();
+}
+
+/**
+ * Returns the nth Character that has been added with add_character().
+ */
+Character *AnimationScheduler::
+get_character(int n) const {
+  LightMutexHolder holder(_lock);
+  nassertr(n >= 0 && n < (int)_characters.size(), nullptr);
+  return _characters[n];
+}
+
+/**
+ * Updates all of the Characters that were visited by the cull traversal since
+ * the last call to update(), as well as those that were added with
+ * add_character().  The Characters are updated in parallel on the threads of
+ * the "animation" task chain, and this method does not return until all of
+ * them are done.
+ *
+ * This is normally called by the scheduler's own task, each frame, while the
+ * scheduler is active, but it may also be called explicitly.
+ */
+void AnimationScheduler::
+update() {
+  PStatTimer timer(_update_pcollector);
+
+  Characters characters;
+  {
+    LightMutexHolder holder(_lock);
+    characters.swap(_visible);
+    characters.insert(characters.end(), _characters.begin(), _characters.end());
+  }
+
+  // A Character may be both in view and on our own list.
+  std::sort(characters.begin(), characters.end());
+  characters.erase(std::unique(characters.begin(), characters.end()),
+                   characters.end());
+
+  int num_characters = (int)characters.size();
+  _num_updated = num_characters;
+  _num_levels = 0;
+  if (num_characters == 0) {
+    return;
+  }
+
+  // Characters that share a PartBundle can't be updated at the same time, so
+  // they are joined into a single group.  At the same time, we find out which
+  // nodes each Character exposes and which nodes it is controlled by.
+  typedef pmap<PartBundle *, int> BundleOwners;
+  typedef pmap<PandaNode *, int> NodeOwners;
+  typedef pvector<std::pair<int, PandaNode *> > Controls;
+  BundleOwners bundle_owners;
+  NodeOwners node_owners;
+  Controls controls;
+  vector_int groups(num_characters);
+
+  pvector<PandaNode *> inputs;
+  pvector<PandaNode *> outputs;
+  for (int i = 0; i < num_characters; ++i) {
+    groups[i] = i;
+
+    Character *character = characters[i];
+    int num_bundles = character->get_num_bundles();
+    for (int bi = 0; bi < num_bundles; ++bi) {
+      PartBundle *bundle = character->get_bundle(bi);
+      std::pair<BundleOwners::iterator, bool> result =
+        bundle_owners.insert(BundleOwners::value_type(bundle, i));
+      if (!result.second) {
+        int a = find_group(groups, i);
+        int b = find_group(groups, (*result.first).second);
+        groups[a] = b;
+      }
+
+      inputs.clear();
+      outputs.clear();
+      collect_nodes(bundle, inputs, outputs);
+      for (size_t ni = 0; ni < outputs.size(); ++ni) {
+        node_owners[outputs[ni]] = i;
+      }
+      for (size_t ni = 0; ni < inputs.size(); ++ni) {
+        controls.push_back(Controls::value_type(i, inputs[ni]));
+      }
+    }
+  }
+
+  // A group that is controlled by a node that another group exposes must
+  // wait for the other group.
+  pvector<vector_int> deps(num_characters);
+  for (Controls::const_iterator ci = controls.begin();
+       ci != controls.end();
+       ++ci) {
+    NodeOwners::const_iterator oi = node_owners.find((*ci).second);
+    if (oi != node_owners.end()) {
+      int a = find_group(groups, (*ci).first);
+      int b = find_group(groups, (*oi).second);
+      if (a != b) {
+        deps[a].push_back(b);
+      }
+    }
+  }
+
+  // Now make a task for each group.  The sort of each task is its level in
+  // the dependency graph; the task chain doesn't start any task until all of
+  // the tasks with a lower sort are done.
+  typedef pmap<int, PT(UpdateTask)> Tasks;
+  Tasks tasks;
+  vector_int levels(num_characters, -1);
+  for (int i = 0; i < num_characters; ++i) {
+    int group = find_group(groups, i);
+    PT(UpdateTask) &task = tasks[group];
+    if (task == nullptr) {
+      int level = get_level(group, deps, levels);
+      task = new UpdateTask;
+      task->set_sort(level);
+      _num_levels = std::max(_num_levels, level + 1);
+    }
+    task->_characters.push_back(characters[i]);
+  }
+
+  if (char_cat.is_debug()) {
+    char_cat.debug()
+      << "Updating " << num_characters << " characters in " << tasks.size()
+      << " groups and " << _num_levels << " levels\n";
+  }
+
+  AsyncTaskChain *chain = get_task_chain();
+  if (tasks.size() == 1 || chain->get_num_threads() == 0) {
+    // There's nothing to gain from handing the work to another thread.
+    for (int level = 0; level < _num_levels; ++level) {
+      for (Tasks::const_iterator ti = tasks.begin(); ti != tasks.end(); ++ti) {
+        if ((*ti).second->get_sort() == level) {
+          (*ti).second->update_characters();
+        }
+      }
+    }
+    return;
+  }
+
+  // The tasks are added in order of level, so that the threads, which may
+  // already be working on the first level, never see a task with a lower sort
+  // than the one they are on.
+  AsyncTaskManager *manager = AsyncTaskManager::get_global_ptr();
+  for (int level = 0; level < _num_levels; ++level) {
+    for (Tasks::const_iterator ti = tasks.begin(); ti != tasks.end(); ++ti) {
+      UpdateTask *task = (*ti).second;
+      if (task->get_sort() == level) {
+        task->set_task_chain(chain->get_name());
+        manager->add(task);
+      }
+    }
+  }
+  chain->wait_for_tasks();
+}
+
+/**
+ * Called by Character::cull_callback() to indicate that the Character is in
+ * view, and should be updated by the next call to update().
+ */
+void AnimationScheduler::
+mark_visible(Character *character) {
+  int frame = ClockObject::get_global_clock()->get_frame_count();
+
+  LightMutexHolder holder(_lock);
+  if (character->_scheduled_frame != frame) {
+    character->_scheduled_frame = frame;
+    _visible.push_back(character);
+  }
+}
+
+/**
+ *
+ */
+AnimationScheduler::UpdateTask::
+UpdateTask() : AsyncTask("updateCharacters") {
+}
+
+/**
+ * Updates each of the Characters in turn.
+ */
+void AnimationScheduler::UpdateTask::
+update_characters() {
+  for (size_t i = 0; i < _characters.size(); ++i) {
+    _characters[i]->update();
+  }
+}
+
+/**
+ * Runs the task on one of the threads of the task chain.
+ */
+AsyncTask::DoneStatus AnimationScheduler::UpdateTask::
+do_task() {
+  update_characters();
+  return DS_done;
+}
+
+/**
+ * Returns the task chain on which the Characters are updated, creating it
+ * the first time.
+ */
+AsyncTaskChain *AnimationScheduler::
+get_task_chain() {
+  if (_chain == nullptr) {
+    AsyncTaskManager *manager = AsyncTaskManager::get_global_ptr();
+    _chain = manager->make_task_chain("animation");
+    _chain->set_num_threads(animation_scheduler_threads);
+    _chain->set_frame_sync(false);
+  }
+  return _chain;
+}
+
+/**
+ * Walks through the parts of a bundle, collecting the nodes that are exposed
+ * by its joints, and the nodes that control its joints.
+ */
+void AnimationScheduler::
+collect_nodes(PartGroup *part, pvector<PandaNode *> &inputs,
+              pvector<PandaNode *> &outputs) {
+  if (part->is_character_joint()) {
+    CharacterJoint *joint = DCAST(CharacterJoint, part);
+    CharacterJoint::NodeList::const_iterator ni;
+    for (ni = joint->_net_transform_nodes.begin();
+         ni != joint->_net_transform_nodes.end();
+         ++ni) {
+      outputs.push_back(*ni);
+    }
+    for (ni = joint->_local_transform_nodes.begin();
+         ni != joint->_local_transform_nodes.end();
+         ++ni) {
+      outputs.push_back(*ni);
+    }
+  }
+
+  if (part->is_of_type(MovingPartBase::get_class_type())) {
+    AnimChannelBase *channel = ((MovingPartBase *)part)->get_forced_channel();
+    if (channel != nullptr &&
+        channel->is_of_type(AnimChannelMatrixDynamic::get_class_type())) {
+      PandaNode *node = ((AnimChannelMatrixDynamic *)channel)->get_value_node();
+      if (node != nullptr) {
+        inputs.push_back(node);
+      }
+    }
+  }
+
+  int num_children = part->get_num_children();
+  for (int i = 0; i < num_children; ++i) {
+    collect_nodes(part->get_child(i), inputs, outputs);
+  }
+}
+
+/**
+ * Returns the representative member of the group that the ith Character
+ * belongs to.
+ */
+int AnimationScheduler::
+find_group(vector_int &groups, int i) {
+  while (groups[i] != i) {
+    groups[i] = groups[groups[i]];
+    i = groups[i];
+  }
+  return i;
+}
+
+/**
+ * Returns the level of the indicated group in the dependency graph: 0 if it
+ * doesn't depend on any other group, or one more than the highest level of
+ * the groups it depends on.  A cycle in the graph is broken at the point
+ * where it is found.
+ */
+int AnimationScheduler::
+get_level(int group, const pvector<vector_int> &deps, vector_int &levels) {
+  if (levels[group] >= 0) {
+    return levels[group];
+  }
+  if (levels[group] == -2) {
+    // We have come around a cycle.
+    return -1;
+  }
+
+  levels[group] = -2;
+  int level = 0;
+  const vector_int &group_deps = deps[group];
+  for (size_t di = 0; di < group_deps.size(); ++di) {
+    level = std::max(level, get_level(group_deps[di], deps, levels) + 1);
+  }
+  levels[group] = level;
+  return level;
+}
+
+/**
+ * The function called by the scheduler's task each frame.
+ */
+AsyncTask::DoneStatus AnimationScheduler::
+st_update(GenericAsyncTask *task, void *data) {
+  ((AnimationScheduler *)data)->update();
+  return AsyncTask::DS_cont;
+}
+
+/**
+ * Creates the global AnimationScheduler.
+ */
+void AnimationScheduler::
+make_global_ptr() {
+  nassertv(_global_ptr == nullptr);
+  _global_ptr = new AnimationScheduler;
+}
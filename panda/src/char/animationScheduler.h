@@ -0,0 +1,129 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file animationScheduler.h
+ * @author agent
+ * @date 2026-10-18
+ */
+
+#ifndef ANIMATIONSCHEDULER_H
+#define ANIMATIONSCHEDULER_H
+
+#include "pandabase.h"
+
+#include "character.h"
+#include "asyncTask.h"
+#include "asyncTaskChain.h"
+#include "genericAsyncTask.h"
+#include "lightMutex.h"
+#include "pStatCollector.h"
+#include "pvector.h"
+#include "pmap.h"
+#include "vector_int.h"
+
+/**
+ * Updates the animation of many Characters at once, in parallel, on the
+ * threads of an AsyncTaskChain.
+ *
+ * Normally, each Character is updated by the cull traversal, one at a time,
+ * as it is found in the view frustum.  While the scheduler is active, it
+ * remembers the Characters that the cull traversal visited, and in the next
+ * frame it updates all of them together from a task on the global
+ * AsyncTaskManager, before the frame is rendered.  The cull traversal then
+ * finds them already up to date.  A Character that has just come into view
+ * is still updated by the cull traversal as before.  Characters may also be
+ * added with add_character(), to be updated every frame whether they are in
+ * view or not.
+ *
+ * Characters that share a PartBundle are always updated one after the other
+ * on the same thread.  A Character with a joint that is controlled by a node
+ * (see PartBundle::control_joint()) that is in turn exposed by a joint of
+ * another Character (see CharacterJoint::add_net_transform()) is not updated
+ * until the other Character is done.
+ */
+class EXPCL_PANDA_CHAR AnimationScheduler {
+protected:
+  AnimationScheduler();
+
+PUBLISHED:
+  void set_active(bool active);
+  INLINE bool is_active() const;
+
+  void set_num_threads(int num_threads);
+  int get_num_threads() const;
+
+  void add_character(Character *character);
+  bool remove_character(Character *character);
+  bool has_character(Character *character) const;
+  void clear_characters();
+  int get_num_characters() const;
+  Character *get_character(int n) const;
+  MAKE_SEQ(get_characters, get_num_characters, get_character);
+
+  void update();
+
+  INLINE int get_num_updated() const;
+  INLINE int get_num_levels() const;
+
+  INLINE static AnimationScheduler *get_global_ptr();
+
+PUBLISHED:
+  MAKE_PROPERTY(active, is_active, set_active);
+  MAKE_PROPERTY(num_threads, get_num_threads, set_num_threads);
+  MAKE_SEQ_PROPERTY(characters, get_num_characters, get_character);
+  MAKE_PROPERTY(num_updated, get_num_updated);
+  MAKE_PROPERTY(num_levels, get_num_levels);
+
+public:
+  void mark_visible(Character *character);
+
+private:
+  typedef pvector<PT(Character)> Characters;
+
+  // Updates a group of Characters, one after another.
+  class UpdateTask : public AsyncTask {
+  public:
+    UpdateTask();
+    ALLOC_DELETED_CHAIN(UpdateTask);
+
+    void update_characters();
+
+  protected:
+    virtual DoneStatus do_task();
+
+  public:
+    Characters _characters;
+  };
+
+  AsyncTaskChain *get_task_chain();
+  void collect_nodes(PartGroup *part, pvector<PandaNode *> &inputs,
+                     pvector<PandaNode *> &outputs);
+  static int find_group(vector_int &groups, int i);
+  static int get_level(int group, const pvector<vector_int> &deps,
+                       vector_int &levels);
+
+  static AsyncTask::DoneStatus st_update(GenericAsyncTask *task, void *data);
+  static void make_global_ptr();
+
+  mutable LightMutex _lock;
+  bool _active;
+  Characters _characters;
+  Characters _visible;
+  PT(GenericAsyncTask) _task;
+  PT(AsyncTaskChain) _chain;
+
+  int _num_updated;
+  int _num_levels;
+
+  static AnimationScheduler *_global_ptr;
+  static PStatCollector _update_pcollector;
+};
+
+#include "animationScheduler.I"
+
+#endif
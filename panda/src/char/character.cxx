@@ -13,6 +13,7 @@
 
 #include "character.h"
 #include "characterJoint.h"
+#include "animationScheduler.h"
 #include "config_char.h"
 #include "nodePath.h"
 #include "geomNode.h"
@@ -27,10 +28,20 @@
 #include "camera.h"
 #include "cullTraverser.h"
 #include "cullTraverserData.h"
+#include "boundingSphere.h"
+#include "lens.h"
+#include "pStatClient.h"
 
 TypeHandle Character::_type_handle;
 
 PStatCollector Character::_animation_pcollector("*:Animation");
+PStatCollector Character::_lod_level_pcollectors[Character::num_lod_level_pcollectors] = {
+  PStatCollector("Animation LOD:Level 0"),
+  PStatCollector("Animation LOD:Level 1"),
+  PStatCollector("Animation LOD:Level 2"),
+  PStatCollector("Animation LOD:Level 3+"),
+};
+AtomicAdjust::Integer Character::_lod_pstats_frame = -1;
 
 /**
  * Use make_copy() or copy_subgraph() to copy a Character.
@@ -43,6 +54,12 @@ Character(const Character &copy, bool copy_bundles) :
   _lod_near_distance(copy._lod_near_distance),
   _lod_delay_factor(copy._lod_delay_factor),
   _do_lod_animation(copy._do_lod_animation),
+  _lod_distance_delay(copy._lod_distance_delay),
+  _lod_level_delay(copy._lod_level_delay),
+  _lod_levels(copy._lod_levels),
+  _lod_level(copy._lod_level),
+  _lod_level_frame(-1),
+  _lod_size(copy._lod_size),
   _joints_pcollector(copy._joints_pcollector),
   _skinning_pcollector(copy._skinning_pcollector)
 {
@@ -67,6 +84,7 @@ Character(const Character &copy, bool copy_bundles) :
   _last_auto_update = -1.0;
   _view_frame = -1;
   _view_distance2 = 0.0f;
+  _scheduled_frame = -1;
 }
 
 /**
@@ -75,6 +93,11 @@ Character(const Character &copy, bool copy_bundles) :
 Character::
 Character(const std::string &name) :
   PartBundleNode(name, new CharacterJointBundle(name)),
+  _lod_distance_delay(0.0),
+  _lod_level_delay(0.0),
+  _lod_level(0),
+  _lod_level_frame(-1),
+  _lod_size(1.0f),
   _joints_pcollector(PStatCollector(_animation_pcollector, name), "Joints"),
   _skinning_pcollector(PStatCollector(_animation_pcollector, name), "Vertices")
 {
@@ -83,6 +106,7 @@ Character(const std::string &name) :
   _last_auto_update = -1.0;
   _view_frame = -1;
   _view_distance2 = 0.0f;
+  _scheduled_frame = -1;
 }
 
 /**
@@ -197,6 +221,51 @@ cull_callback(CullTraverser *trav, CullTraverserData &data) {
     }
   }
 
+  if (!_lod_levels.empty()) {
+    int this_frame = ClockObject::get_global_clock()->get_frame_count();
+
+    // If multiple cameras are viewing the character in this frame, the one
+    // that sees it the largest counts.
+    PN_stdfloat size = compute_lod_size(trav, data);
+    if (this_frame == _lod_level_frame) {
+      size = std::max(size, _lod_size);
+    }
+    _lod_size = size;
+
+    int level = 0;
+    int num_levels = (int)_lod_levels.size();
+    while (level < num_levels && size < _lod_levels[level]._max_size) {
+      ++level;
+    }
+    if (level != _lod_level) {
+      set_lod_level(level);
+    }
+
+    if (PStatClient::is_connected()) {
+      // The first Character to be culled in each frame resets the counts
+      // from the previous frame.
+      AtomicAdjust::Integer last_frame = AtomicAdjust::get(_lod_pstats_frame);
+      if (last_frame != this_frame &&
+          AtomicAdjust::compare_and_exchange(_lod_pstats_frame, last_frame, this_frame) == last_frame) {
+        for (int i = 0; i < num_lod_level_pcollectors; ++i) {
+          _lod_level_pcollectors[i].clear_level();
+        }
+      }
+      if (this_frame != _lod_level_frame) {
+        _lod_level_pcollectors[std::min(level, (int)num_lod_level_pcollectors - 1)].add_level(1);
+      }
+    }
+    _lod_level_frame = this_frame;
+  }
+
+  // If the AnimationScheduler is active, it will update us together with the
+  // other Characters from the next frame on.  If it has already updated us
+  // for this frame, update() does nothing.
+  AnimationScheduler *scheduler = AnimationScheduler::get_global_ptr();
+  if (scheduler->is_active()) {
+    scheduler->mark_visible(this);
+  }
+
   update();
   return true;
 }
@@ -349,6 +418,66 @@ clear_lod_animation() {
   set_lod_current_delay(0.0);
 }
 
+/**
+ * Adds a level of detail for the animation of the character, based on its
+ * size on the screen.  While the character's bounding volume covers less
+ * than max_size of the height of the screen, as seen by the camera that sees
+ * it the largest, its animation is updated no more often than every
+ * update_delay seconds (see PartBundle::set_update_delay()).  In addition, if
+ * max_joint_depth is not -1, only the joints up to that many levels below the
+ * root of the hierarchy are animated on each update (see
+ * PartBundle::set_max_joint_depth()), and unless frame_blend is true, the
+ * frame blending of the animations is turned off (see
+ * PartBundle::set_allow_frame_blend()).
+ *
+ * If interpolate is true, the joints are smoothly interpolated between the
+ * updates, rather than jumping from one pose to the next (see
+ * PartBundle::set_interpolate_updates()).  The character then appears to
+ * animate every frame, but the cost of sampling the animation channels is
+ * only paid on the updates.
+ *
+ * Any number of levels may be added; the smallest one that the character
+ * still fits within applies.  This may be combined with set_lod_animation(),
+ * in which case the longer of the two delays applies.
+ */
+void Character::
+add_lod_animation_level(PN_stdfloat max_size, double update_delay,
+                        int max_joint_depth, bool frame_blend,
+                        bool interpolate) {
+  nassertv(max_size > 0.0f);
+  nassertv(update_delay >= 0.0);
+
+  LodLevel level;
+  level._max_size = max_size;
+  level._update_delay = update_delay;
+  level._max_joint_depth = max_joint_depth;
+  level._frame_blend = frame_blend;
+  level._interpolate = interpolate;
+
+  LodLevels::iterator li = _lod_levels.begin();
+  while (li != _lod_levels.end() && (*li)._max_size >= max_size) {
+    ++li;
+  }
+  _lod_levels.insert(li, level);
+
+  // Choose the level again the next time the character is culled.
+  set_lod_level(0);
+  _lod_level_frame = -1;
+}
+
+/**
+ * Removes all of the levels of detail added by add_lod_animation_level().
+ * Henceforth, the character is animated at full detail regardless of its size
+ * on the screen.
+ */
+void Character::
+clear_lod_animation_levels() {
+  _lod_levels.clear();
+  set_lod_level(0);
+  _lod_level_frame = -1;
+  _lod_size = 1.0f;
+}
+
 /**
  * Returns a pointer to the joint with the given name, if there is such a
  * joint, or NULL if there is no such joint.  This will not return a pointer
@@ -459,6 +588,7 @@ force_update() {
   for (int i = 0; i < num_bundles; ++i) {
     get_bundle(i)->force_update();
   }
+  share_tables();
 }
 
 /**
@@ -498,6 +628,7 @@ r_copy_children(const PandaNode *from, PandaNode::InstanceMap &inst_map,
   GeomSliderMap gsmap;
   r_copy_char(this, from_char, from_char, node_map, joint_map,
               gvmap, gjmap, gsmap);
+  record_copied_tables(gvmap, from_char);
 
   for (i = 0; i < num_bundles; ++i) {
     copy_node_pointers(node_map, get_bundle(i), from_char->get_bundle(i));
@@ -527,6 +658,7 @@ update_bundle(PartBundleHandle *old_bundle_handle, PartBundle *new_bundle) {
   GeomJointMap gjmap;
   GeomSliderMap gsmap;
   r_update_geom(this, joint_map, gvmap, gjmap, gsmap);
+  record_copied_tables(gvmap, this);
 }
 
 /**
@@ -576,20 +708,146 @@ do_update() {
       get_bundle(i)->update();
     }
   }
+  share_tables();
+}
+
+/**
+ * Called after the bundles have been updated.  If the bundle of this
+ * Character shared its joint transforms with other bundles in this frame,
+ * each TransformTable of this Character is told to use the palette of the
+ * corresponding table of the first other copy of the same model with the
+ * same transforms, so that the matrices are only packed and uploaded once.
+ * Otherwise, each table goes back to providing its own palette.
+ */
+void Character::
+share_tables() {
+  if (_copied_tables.empty()) {
+    return;
+  }
+
+  Thread *current_thread = Thread::get_current_thread();
+  CPT(JointPaletteCache::Palette) palette;
+  if (get_num_bundles() == 1) {
+    palette = get_bundle(0)->get_shared_palette(current_thread);
+  }
+
+  JointPaletteCache *cache = JointPaletteCache::get_global_ptr();
+  int frame = ClockObject::get_global_clock()->get_frame_count(current_thread);
+
+  CopiedTables::const_iterator ti;
+  for (ti = _copied_tables.begin(); ti != _copied_tables.end(); ++ti) {
+    const TransformTable *table = (*ti).first;
+    CPT(TransformTable) source;
+    if (palette != nullptr) {
+      source = cache->share_table(palette, (*ti).second, table, frame);
+      if (source == table) {
+        source = nullptr;
+      }
+    }
+    if (table->get_palette_source() != source) {
+      table->set_palette_source(source);
+    }
+  }
 }
 
 /**
  * Changes the amount of delay we should impose due to the LOD animation
- * setting.
+ * setting.  The delay imposed by the current level of detail, if it is
+ * longer, takes precedence.
  */
 void Character::
 set_lod_current_delay(double delay) {
+  _lod_distance_delay = delay;
+  delay = std::max(_lod_distance_delay, _lod_level_delay);
+
   int num_bundles = get_num_bundles();
   for (int i = 0; i < num_bundles; ++i) {
     get_bundle(i)->set_update_delay(delay);
   }
 }
 
+/**
+ * Returns the height of the character's bounding volume, as seen by the
+ * current camera, as a fraction of the height of the screen.  This is the
+ * figure that is compared against the levels added by
+ * add_lod_animation_level().
+ */
+PN_stdfloat Character::
+compute_lod_size(CullTraverser *trav, CullTraverserData &data) {
+  const Lens *lens = trav->get_scene()->get_lens();
+  CPT(BoundingVolume) bounds = get_bounds();
+  if (lens == nullptr || bounds->is_empty() || bounds->is_infinite() ||
+      !bounds->is_of_type(GeometricBoundingVolume::get_class_type())) {
+    return 1.0f;
+  }
+
+  LPoint3 center;
+  PN_stdfloat radius;
+  const BoundingSphere *sphere = bounds->as_bounding_sphere();
+  if (sphere != nullptr) {
+    center = sphere->get_center();
+    radius = sphere->get_radius();
+  } else {
+    const FiniteBoundingVolume *fbv = bounds->as_finite_bounding_volume();
+    if (fbv == nullptr) {
+      return 1.0f;
+    }
+    LPoint3 min_point = fbv->get_min();
+    LPoint3 max_point = fbv->get_max();
+    center = (min_point + max_point) * 0.5f;
+    radius = (max_point - min_point).length() * 0.5f;
+  }
+
+  // Bring the sphere into camera space, and measure it through the lens.
+  const LMatrix4 &modelview = data.get_modelview_transform(trav)->get_mat();
+  center = center * modelview;
+  radius *= modelview.xform_vec(LVector3(1.0f, 0.0f, 0.0f)).length();
+
+  const LMatrix4 &proj = lens->get_projection_mat();
+  LVecBase4 p0 = LVecBase4(center, 1.0f) * proj;
+  LVecBase4 p1 = LVecBase4(center + LVector3::up() * radius, 1.0f) * proj;
+  if (p0[3] <= 0.0f || p1[3] <= 0.0f) {
+    // The character surrounds the camera.
+    return 1.0f;
+  }
+
+  // The projected coordinates run from -1 to 1 across the screen.
+  return cabs(p1[1] / p1[3] - p0[1] / p0[3]);
+}
+
+/**
+ * Applies the indicated level of detail, as added by
+ * add_lod_animation_level(), to the character's bundles.  Level 0 is the full
+ * detail.
+ */
+void Character::
+set_lod_level(int level) {
+  _lod_level = level;
+
+  int max_joint_depth = -1;
+  bool frame_blend = true;
+  bool interpolate = false;
+  _lod_level_delay = 0.0;
+  if (level > 0) {
+    nassertv(level <= (int)_lod_levels.size());
+    const LodLevel &lod = _lod_levels[level - 1];
+    max_joint_depth = lod._max_joint_depth;
+    frame_blend = lod._frame_blend;
+    interpolate = lod._interpolate;
+    _lod_level_delay = lod._update_delay;
+  }
+
+  int num_bundles = get_num_bundles();
+  for (int i = 0; i < num_bundles; ++i) {
+    PartBundle *bundle = get_bundle(i);
+    bundle->set_max_joint_depth(max_joint_depth);
+    bundle->set_allow_frame_blend(frame_blend);
+    bundle->set_interpolate_updates(interpolate);
+  }
+
+  set_lod_current_delay(_lod_distance_delay);
+}
+
 /**
  * After the joint hierarchy has already been copied from the indicated
  * hierarchy, this recursively walks through the joints and builds up a
@@ -728,6 +986,7 @@ r_merge_bundles(Character::JointMap &joint_map,
   }
 
   new_group->_children.swap(new_children);
+  PartGroup::mark_hierarchy_changed();
 }
 
 
@@ -921,6 +1180,41 @@ copy_node_pointers(const Character::NodeMap &node_map,
   }
 }
 
+/**
+ * Records the TransformTables of the new vertex data in the indicated map,
+ * along with the tables of the original model that they were copied from,
+ * for the benefit of share_tables().  The map was filled in while copying
+ * the geometry of the indicated Character, which may be this one.
+ */
+void Character::
+record_copied_tables(const Character::GeomVertexMap &gvmap,
+                     const Character *from) {
+  CopiedTables tables;
+
+  GeomVertexMap::const_iterator gvmi;
+  for (gvmi = gvmap.begin(); gvmi != gvmap.end(); ++gvmi) {
+    CPT(TransformTable) orig_table = (*gvmi).first->get_transform_table();
+    CPT(TransformTable) new_table = (*gvmi).second->get_transform_table();
+    if (orig_table == nullptr || new_table == nullptr) {
+      continue;
+    }
+
+    // If the table we copied was itself a copy, we refer to the table that
+    // it was copied from, so that all copies of a model agree.
+    CPT(TransformTable) prototype = orig_table;
+    CopiedTables::const_iterator ti;
+    for (ti = from->_copied_tables.begin(); ti != from->_copied_tables.end(); ++ti) {
+      if ((*ti).first == orig_table) {
+        prototype = (*ti).second;
+        break;
+      }
+    }
+    tables.push_back(CopiedTables::value_type(new_table, prototype));
+  }
+
+  _copied_tables.swap(tables);
+}
+
 /**
  * Creates a new TransformTable, similar to the indicated one, with the joint
  * and slider pointers redirected into this object.
@@ -25,6 +25,7 @@
 #include "pointerTo.h"
 #include "geom.h"
 #include "pStatCollector.h"
+#include "atomicAdjust.h"
 #include "transformTable.h"
 #include "transformBlendTable.h"
 #include "sliderTable.h"
@@ -68,6 +69,15 @@ PUBLISHED:
                          PN_stdfloat delay_factor);
   void clear_lod_animation();
 
+  void add_lod_animation_level(PN_stdfloat max_size, double update_delay,
+                               int max_joint_depth = -1,
+                               bool frame_blend = false,
+                               bool interpolate = true);
+  void clear_lod_animation_levels();
+  INLINE int get_num_lod_animation_levels() const;
+  INLINE int get_lod_animation_level() const;
+  INLINE PN_stdfloat get_lod_animation_size() const;
+
   CharacterJoint *find_joint(const std::string &name) const;
   CharacterSlider *find_slider(const std::string &name) const;
 
@@ -88,6 +98,8 @@ protected:
 private:
   void do_update();
   void set_lod_current_delay(double delay);
+  PN_stdfloat compute_lod_size(CullTraverser *trav, CullTraverserData &data);
+  void set_lod_level(int level);
 
   typedef pmap<const PandaNode *, PandaNode *> NodeMap;
   typedef pmap<const PartGroup *, PartGroup *> JointMap;
@@ -110,6 +122,8 @@ private:
                      GeomJointMap &gjmap, GeomSliderMap &gsmap);
   void copy_node_pointers(const Character::NodeMap &node_map,
                           PartGroup *dest, const PartGroup *source);
+  void record_copied_tables(const GeomVertexMap &gvmap, const Character *from);
+  void share_tables();
 
   CPT(TransformTable) redirect_transform_table(const TransformTable *source,
                                                const JointMap &joint_map,
@@ -132,6 +146,12 @@ private:
 
   double _last_auto_update;
 
+  // The TransformTables of the vertex data of this Character, each with the
+  // table of the original model that it was copied from.  These may share
+  // the palette of the tables of other copies; see share_tables().
+  typedef pvector<std::pair<CPT(TransformTable), CPT(TransformTable)> > CopiedTables;
+  CopiedTables _copied_tables;
+
   int _view_frame;
   double _view_distance2;
 
@@ -140,12 +160,40 @@ private:
   PN_stdfloat _lod_near_distance;
   PN_stdfloat _lod_delay_factor;
   bool _do_lod_animation;
+  double _lod_distance_delay;
+  double _lod_level_delay;
+
+  // The levels of detail added by add_lod_animation_level(), in order of
+  // decreasing size.
+  class LodLevel {
+  public:
+    PN_stdfloat _max_size;
+    double _update_delay;
+    int _max_joint_depth;
+    bool _frame_blend;
+    bool _interpolate;
+  };
+  typedef pvector<LodLevel> LodLevels;
+  LodLevels _lod_levels;
+  int _lod_level;
+  int _lod_level_frame;
+  PN_stdfloat _lod_size;
+
+  // The frame in which the AnimationScheduler was last told that this
+  // Character is in view.
+  int _scheduled_frame;
 
   // Statistics
   PStatCollector _joints_pcollector;
   PStatCollector _skinning_pcollector;
   static PStatCollector _animation_pcollector;
 
+  // The number of Characters at each level of detail in the current frame.
+  // The last one counts all of the levels from there on.
+  enum { num_lod_level_pcollectors = 4 };
+  static PStatCollector _lod_level_pcollectors[num_lod_level_pcollectors];
+  static AtomicAdjust::Integer _lod_pstats_frame;
+
   // This variable is only used temporarily, while reading from the bam file.
   unsigned int _temp_num_parts;
 
@@ -175,6 +223,8 @@ public:
 
 private:
   static TypeHandle _type_handle;
+
+  friend class AnimationScheduler;
 };
 
 #include "character.I"
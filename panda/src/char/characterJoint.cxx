@@ -132,6 +132,31 @@ update_internals(PartBundle *root, PartGroup *parent, bool self_changed,
     }
   }
 
+  return update_dependents(self_changed, net_changed, current_thread);
+}
+
+/**
+ * Called by the JointTable in place of update_internals(), when the bundle is
+ * updated from a compiled table.  The table has already computed the net
+ * transform of the joint, so it only needs to be stored.
+ */
+bool CharacterJoint::
+apply_net_transform(const LMatrix4 &net_transform, bool self_changed,
+                    bool net_changed, Thread *current_thread) {
+  if (net_changed) {
+    _net_transform = net_transform;
+  }
+
+  return update_dependents(self_changed, net_changed, current_thread);
+}
+
+/**
+ * Updates the nodes and vertices that depend on this joint, after its local
+ * transform, net transform, or both have changed.  Returns true if either
+ * changed.
+ */
+bool CharacterJoint::
+update_dependents(bool self_changed, bool net_changed, Thread *current_thread) {
   if (net_changed) {
     if (!_net_transform_nodes.empty()) {
       CPT(TransformState) t = TransformState::make_mat(_net_transform);
@@ -47,6 +47,9 @@ public:
   virtual bool update_internals(PartBundle *root, PartGroup *parent,
                                 bool self_changed, bool parent_changed,
                                 Thread *current_thread);
+  virtual bool apply_net_transform(const LMatrix4 &net_transform,
+                                   bool self_changed, bool net_changed,
+                                   Thread *current_thread);
   virtual void do_xform(const LMatrix4 &mat, const LMatrix4 &inv_mat);
 
 PUBLISHED:
@@ -72,6 +75,8 @@ PUBLISHED:
 
 private:
   void set_character(Character *character);
+  bool update_dependents(bool self_changed, bool net_changed,
+                         Thread *current_thread);
 
 private:
   // Not a reference-counted pointer.
@@ -131,6 +136,7 @@ public:
 private:
   static TypeHandle _type_handle;
 
+  friend class AnimationScheduler;
   friend class Character;
   friend class CharacterJointBundle;
   friend class JointVertexTransform;
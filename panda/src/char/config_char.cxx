@@ -12,6 +12,7 @@
  */
 
 #include "config_char.h"
+#include "animationScheduler.h"
 #include "character.h"
 #include "characterJoint.h"
 #include "characterJointBundle.h"
@@ -40,6 +41,28 @@ ConfigVariableBool even_animation
           "The default is to compute vertices only when they need to be "
           "computed, which can lead to an uneven frame rate."));
 
+ConfigVariableBool animation_scheduler
+("animation-scheduler", false,
+ PRC_DESC("Set this true to have the AnimationScheduler update all of the "
+          "characters that are in view together, in parallel, each frame "
+          "before the frame is rendered, instead of one at a time as the "
+          "cull traversal finds them.  This may also be changed at runtime "
+          "with AnimationScheduler::set_active()."));
+
+ConfigVariableInt animation_scheduler_threads
+("animation-scheduler-threads", 2,
+ PRC_DESC("The number of threads the AnimationScheduler uses to update the "
+          "characters.  These are the threads of the \"animation\" task "
+          "chain.  If this is 0, the characters are updated on the main "
+          "thread, which is only useful for debugging."));
+
+ConfigVariableInt animation_scheduler_sort
+("animation-scheduler-sort", 40,
+ PRC_DESC("The sort value of the AnimationScheduler's task on the global "
+          "task manager.  It should run after the tasks that change the "
+          "animations, and before the task that renders the frame, which "
+          "is igLoop, with a sort of 50, in ShowBase."));
+
 
 /**
  * Initializes the library.  This must be called at least once before any of
@@ -1,3 +1,4 @@
+#include "animationScheduler.cxx"
 #include "config_char.cxx"
 #include "character.cxx"
 #include "characterJoint.cxx"
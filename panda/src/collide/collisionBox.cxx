@@ -19,6 +19,7 @@
 #include "collisionTube.h"
 #include "collisionHandler.h"
 #include "collisionEntry.h"
+#include "collisionConvex.h"
 #include "config_collide.h"
 #include "boundingSphere.h"
 #include "datagram.h"
@@ -893,6 +894,52 @@ test_intersection_from_box(const CollisionEntry &entry) const {
   return new_entry;
 }
 
+/**
+ * Double dispatch point for convex as a FROM object
+ */
+PT(CollisionEntry) CollisionBox::
+test_intersection_from_convex(const CollisionEntry &entry) const {
+  const CollisionConvex *convex;
+  DCAST_INTO_R(convex, entry.get_from(), nullptr);
+
+  CollisionConvex::SupportShape from_shape;
+  convex->get_support_shape(from_shape, entry.get_wrt_mat());
+  if (from_shape._points.empty()) {
+    return nullptr;
+  }
+
+  CollisionConvex::SupportShape into_shape;
+  into_shape._points.reserve(8);
+  for (int i = 0; i < 8; ++i) {
+    into_shape._points.push_back(get_point(i));
+  }
+
+  LVector3 normal;
+  PN_stdfloat depth;
+  LPoint3 interior_point;
+  if (!CollisionConvex::compute_penetration(from_shape, into_shape, normal,
+                                            depth, interior_point)) {
+    return nullptr;
+  }
+
+  if (collide_cat.is_debug()) {
+    collide_cat.debug()
+      << "intersection detected from " << entry.get_from_node_path()
+      << " into " << entry.get_into_node_path() << "\n";
+  }
+  PT(CollisionEntry) new_entry = new CollisionEntry(entry);
+
+  if (has_effective_normal() && convex->get_respect_effective_normal()) {
+    new_entry->set_surface_normal(get_effective_normal());
+  } else {
+    new_entry->set_surface_normal(normal);
+  }
+  new_entry->set_surface_point(interior_point + normal * depth);
+  new_entry->set_interior_point(interior_point);
+
+  return new_entry;
+}
+
 /**
  * Fills the _viz_geom GeomNode up with Geoms suitable for rendering this
  * solid.
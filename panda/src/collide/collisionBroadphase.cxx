@@ -0,0 +1,323 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file collisionBroadphase.cxx
+ * @author agent
+ * @date 2026-10-18
+ */
+
+#include "collisionBroadphase.h"
+#include "collisionNode.h"
+#include "geometricBoundingVolume.h"
+#include "finiteBoundingVolume.h"
+#include "config_collide.h"
+#include <algorithm>
+
+// This function object class is used in find_pairs(), below, to sort the
+// pairs into the order in which a single-pass traversal would visit them:
+// by into node, in scene graph order, and then by collider.
+class SortPairsByProxySort {
+public:
+  SortPairsByProxySort(const CollisionBroadphase &broadphase) :
+    _broadphase(broadphase)
+  {
+  }
+
+  inline bool operator () (const CollisionBroadphase::Pair &a,
+                           const CollisionBroadphase::Pair &b) const {
+    int into_a = _broadphase.get_proxy(a._into)._sort;
+    int into_b = _broadphase.get_proxy(b._into)._sort;
+    if (into_a != into_b) {
+      return into_a < into_b;
+    }
+    return _broadphase.get_proxy(a._from)._sort < _broadphase.get_proxy(b._from)._sort;
+  }
+
+  const CollisionBroadphase &_broadphase;
+};
+
+// This one is used in end_update() to sort the proxies along the X axis.
+class SortProxiesByMinX {
+public:
+  SortProxiesByMinX(const CollisionBroadphase &broadphase) :
+    _broadphase(broadphase)
+  {
+  }
+
+  inline bool operator () (int a, int b) const {
+    return _broadphase.get_proxy(a)._min[0] < _broadphase.get_proxy(b)._min[0];
+  }
+
+  const CollisionBroadphase &_broadphase;
+};
+
+/**
+ *
+ */
+CollisionBroadphase::
+CollisionBroadphase() {
+}
+
+/**
+ * Begins a new update of the proxies.  This should be followed by a call to
+ * add_collider() or add_into_node() for each object that is present in this
+ * traversal, and then by end_update().
+ */
+void CollisionBroadphase::
+begin_update() {
+  Proxies::iterator pi;
+  for (pi = _proxies.begin(); pi != _proxies.end(); ++pi) {
+    (*pi)._seen = false;
+  }
+}
+
+/**
+ * Records the indicated collider solid as present in this traversal.  The
+ * transform is the net transform of the collider node relative to the space
+ * of the traversal, and pos_delta is the node's motion since the previous
+ * frame, if any, by which the box is extended.  The sort value orders
+ * colliders for the purpose of find_pairs().
+ */
+void CollisionBroadphase::
+add_collider(const NodePath &node_path, int solid_index,
+             const CollisionSolid *solid, const TransformState *transform,
+             const LVector3 &pos_delta, int sort) {
+  Proxy &proxy = find_proxy(node_path, solid_index);
+  proxy._seen = true;
+  proxy._sort = sort;
+  proxy._mask = DCAST(CollisionNode, node_path.node())->get_from_collide_mask();
+
+  CPT(BoundingVolume) bounds = solid->get_bounds();
+  if (proxy._solid != solid || proxy._transform != transform ||
+      proxy._bounds != bounds || proxy._pos_delta != pos_delta) {
+    proxy._solid = solid;
+    proxy._transform = transform;
+    proxy._bounds = bounds;
+    proxy._pos_delta = pos_delta;
+    compute_box(proxy);
+  }
+}
+
+/**
+ * Records the indicated CollisionNode or GeomNode as present in this
+ * traversal, as a node that may be collided into.  The into_mask should
+ * already have been restricted by any mask inherited from an LODNode.  The
+ * sort value orders nodes for the purpose of find_pairs(), and should
+ * increase in scene graph order.
+ */
+void CollisionBroadphase::
+add_into_node(const NodePath &node_path, const TransformState *transform,
+              CollideMask into_mask, int sort) {
+  Proxy &proxy = find_proxy(node_path, -1);
+  proxy._seen = true;
+  proxy._sort = sort;
+  proxy._mask = into_mask;
+
+  CPT(BoundingVolume) bounds = node_path.node()->get_internal_bounds();
+  if (proxy._transform != transform || proxy._bounds != bounds) {
+    proxy._transform = transform;
+    proxy._bounds = bounds;
+    compute_box(proxy);
+  }
+}
+
+/**
+ * Finishes the update begun by begin_update().  Removes the proxies that were
+ * not seen in this traversal, and brings the sorted order up to date.
+ */
+void CollisionBroadphase::
+end_update() {
+  int num_sorted = (int)_order.size();
+  int num_proxies = (int)_proxies.size();
+
+  // Compact away the proxies that have disappeared.
+  pvector<int> remap(num_proxies, -1);
+  int num_kept = 0;
+  for (int i = 0; i < num_proxies; ++i) {
+    if (_proxies[i]._seen) {
+      if (num_kept != i) {
+        _proxies[num_kept] = _proxies[i];
+      }
+      remap[i] = num_kept++;
+    }
+  }
+
+  if (num_kept != num_proxies) {
+    // The indices have shifted; rebuild the index.
+    _proxies.resize(num_kept);
+    _index.clear();
+    for (int i = 0; i < num_kept; ++i) {
+      ProxyKey key;
+      key._node_path = _proxies[i]._node_path;
+      key._solid_index = _proxies[i]._solid_index;
+      _index[key] = i;
+    }
+  }
+
+  // Keep the previous order of the surviving proxies, and append the new
+  // ones at the end.
+  pvector<int> order;
+  order.reserve(num_kept);
+  for (int i = 0; i < num_sorted; ++i) {
+    int index = remap[_order[i]];
+    if (index >= 0) {
+      order.push_back(index);
+    }
+  }
+  int num_new = 0;
+  for (int i = num_sorted; i < num_proxies; ++i) {
+    if (remap[i] >= 0) {
+      order.push_back(remap[i]);
+      ++num_new;
+    }
+  }
+  _order.swap(order);
+
+  if (num_new * 4 > num_kept) {
+    // Many proxies were added; just sort them from scratch.
+    std::sort(_order.begin(), _order.end(), SortProxiesByMinX(*this));
+
+  } else {
+    // Otherwise, the order is probably still nearly sorted, since most
+    // objects don't move much from one frame to the next.
+    for (int i = 1; i < num_kept; ++i) {
+      int index = _order[i];
+      PN_stdfloat x = _proxies[index]._min[0];
+      int j = i;
+      while (j > 0 && _proxies[_order[j - 1]]._min[0] > x) {
+        _order[j] = _order[j - 1];
+        --j;
+      }
+      _order[j] = index;
+    }
+  }
+}
+
+/**
+ * Fills pairs with each (collider, into node) combination whose boxes
+ * overlap and whose collide masks have bits in common, sorted by into node
+ * and then by collider.
+ */
+void CollisionBroadphase::
+find_pairs(Pairs &pairs) const {
+  int num_proxies = (int)_order.size();
+  for (int a = 0; a < num_proxies; ++a) {
+    int ia = _order[a];
+    const Proxy &pa = _proxies[ia];
+    if (pa._is_empty) {
+      continue;
+    }
+
+    for (int b = a + 1; b < num_proxies; ++b) {
+      int ib = _order[b];
+      const Proxy &pb = _proxies[ib];
+      if (pb._min[0] > pa._max[0]) {
+        // No later proxy can overlap this one along the X axis.
+        break;
+      }
+      if (pb._is_empty ||
+          pb._min[1] > pa._max[1] || pa._min[1] > pb._max[1] ||
+          pb._min[2] > pa._max[2] || pa._min[2] > pb._max[2]) {
+        continue;
+      }
+      if ((pa._mask & pb._mask).is_zero() ||
+          pa._node_path.node() == pb._node_path.node()) {
+        // Never test a node with itself.
+        continue;
+      }
+
+      bool a_is_from = (pa._solid != nullptr);
+      bool b_is_from = (pb._solid != nullptr);
+      if (a_is_from && !b_is_from) {
+        Pair pair;
+        pair._from = ia;
+        pair._into = ib;
+        pairs.push_back(pair);
+      } else if (b_is_from && !a_is_from) {
+        Pair pair;
+        pair._from = ib;
+        pair._into = ia;
+        pairs.push_back(pair);
+      }
+    }
+  }
+
+  std::sort(pairs.begin(), pairs.end(), SortPairsByProxySort(*this));
+}
+
+/**
+ * Returns the proxy with the indicated key, creating a new one if there is
+ * none yet.  The returned reference is invalidated by the next call.
+ */
+CollisionBroadphase::Proxy &CollisionBroadphase::
+find_proxy(const NodePath &node_path, int solid_index) {
+  ProxyKey key;
+  key._node_path = node_path;
+  key._solid_index = solid_index;
+
+  std::pair<ProxyIndex::iterator, bool> result =
+    _index.insert(ProxyIndex::value_type(key, (int)_proxies.size()));
+  if (result.second) {
+    Proxy proxy;
+    proxy._node_path = node_path;
+    proxy._solid_index = solid_index;
+    proxy._pos_delta = LVector3::zero();
+    proxy._min.set(FLT_MAX, FLT_MAX, FLT_MAX);
+    proxy._max.set(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    proxy._is_empty = true;
+    proxy._sort = 0;
+    proxy._seen = false;
+    _proxies.push_back(proxy);
+  }
+  return _proxies[(*result.first).second];
+}
+
+/**
+ * Recomputes the axis-aligned box of the indicated proxy from its bounding
+ * volume and transform.
+ */
+void CollisionBroadphase::
+compute_box(Proxy &proxy) {
+  const BoundingVolume *bounds = proxy._bounds;
+  proxy._is_empty = bounds->is_empty();
+  if (proxy._is_empty) {
+    // Sort empty volumes to the end, where they will not hold up the sweep.
+    proxy._min.set(FLT_MAX, FLT_MAX, FLT_MAX);
+    proxy._max.set(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    return;
+  }
+
+  const FiniteBoundingVolume *fbv = nullptr;
+  PT(BoundingVolume) xformed;
+  if (!bounds->is_infinite() &&
+      bounds->is_of_type(GeometricBoundingVolume::get_class_type())) {
+    xformed = bounds->make_copy();
+    ((GeometricBoundingVolume *)xformed.p())->xform(proxy._transform->get_mat());
+    fbv = xformed->as_finite_bounding_volume();
+  }
+
+  if (fbv == nullptr) {
+    // An infinite (or otherwise unbounded) volume overlaps everything.
+    proxy._min.set(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    proxy._max.set(FLT_MAX, FLT_MAX, FLT_MAX);
+    return;
+  }
+
+  proxy._min = fbv->get_min();
+  proxy._max = fbv->get_max();
+
+  // A moving collider must also cover its position in the previous frame.
+  const LVector3 &delta = proxy._pos_delta;
+  for (int i = 0; i < 3; ++i) {
+    if (delta[i] > 0.0f) {
+      proxy._min[i] -= delta[i];
+    } else {
+      proxy._max[i] -= delta[i];
+    }
+  }
+}
@@ -0,0 +1,112 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file collisionBroadphase.h
+ * @author agent
+ * @date 2026-10-18
+ */
+
+#ifndef COLLISIONBROADPHASE_H
+#define COLLISIONBROADPHASE_H
+
+#include "pandabase.h"
+
+#include "collisionSolid.h"
+#include "nodePath.h"
+#include "transformState.h"
+#include "boundingVolume.h"
+#include "collideMask.h"
+#include "pvector.h"
+#include "pmap.h"
+
+/**
+ * A persistent sweep-and-prune structure used by the CollisionTraverser when
+ * set_use_broadphase() is enabled.  It holds one axis-aligned box for each
+ * collider solid and for each CollisionNode or GeomNode that may be collided
+ * into, all expressed in the space of the traversal root.
+ *
+ * The boxes are kept from one traversal to the next.  A box is recomputed
+ * only when the net transform or the bounding volume of its node changes,
+ * and the sorted order along the X axis is repaired with an insertion sort,
+ * which is nearly linear when objects move coherently from frame to frame.
+ *
+ * This class is used internally by the CollisionTraverser; it is not
+ * intended to be used directly.
+ */
+class EXPCL_PANDA_COLLIDE CollisionBroadphase {
+public:
+  CollisionBroadphase();
+
+  // A collider solid, or a node that may be collided into.  For the former,
+  // _solid is the collider and _mask is its from mask; for the latter, _solid
+  // is NULL and _mask is the node's into mask.
+  class Proxy {
+  public:
+    NodePath _node_path;
+    int _solid_index;
+    CPT(CollisionSolid) _solid;
+    CPT(TransformState) _transform;
+    CPT(BoundingVolume) _bounds;
+    LVector3 _pos_delta;
+    LPoint3 _min;
+    LPoint3 _max;
+    CollideMask _mask;
+    int _sort;
+    bool _is_empty;
+    bool _seen;
+  };
+
+  class Pair {
+  public:
+    int _from;
+    int _into;
+  };
+  typedef pvector<Pair> Pairs;
+
+  void begin_update();
+  void add_collider(const NodePath &node_path, int solid_index,
+                    const CollisionSolid *solid, const TransformState *transform,
+                    const LVector3 &pos_delta, int sort);
+  void add_into_node(const NodePath &node_path, const TransformState *transform,
+                     CollideMask into_mask, int sort);
+  void end_update();
+
+  void find_pairs(Pairs &pairs) const;
+
+  INLINE int get_num_proxies() const;
+  INLINE const Proxy &get_proxy(int n) const;
+  INLINE void clear();
+
+private:
+  Proxy &find_proxy(const NodePath &node_path, int solid_index);
+  static void compute_box(Proxy &proxy);
+
+private:
+  // Identifies a proxy from one traversal to the next.  Into nodes use a
+  // solid index of -1.
+  class ProxyKey {
+  public:
+    INLINE bool operator < (const ProxyKey &other) const;
+
+    NodePath _node_path;
+    int _solid_index;
+  };
+  typedef pmap<ProxyKey, int> ProxyIndex;
+
+  typedef pvector<Proxy> Proxies;
+  Proxies _proxies;
+  ProxyIndex _index;
+
+  // The proxies, sorted by the X coordinate of the minimum corner of their
+  // box.
+  pvector<int> _order;
+};
+
+#include "collisionBroadphase.I"
+
+#endif
@@ -0,0 +1,1404 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file collisionConvex.cxx
+ * @author agent
+ * @date 2026-10-18
+ */
+
+#include "collisionConvex.h"
+#include "collisionEntry.h"
+#include "collisionSphere.h"
+#include "collisionLine.h"
+#include "collisionRay.h"
+#include "collisionSegment.h"
+#include "collisionTube.h"
+#include "collisionBox.h"
+#include "config_collide.h"
+#include "geom.h"
+#include "geomNode.h"
+#include "geomTriangles.h"
+#include "geomVertexReader.h"
+#include "geomVertexWriter.h"
+#include "datagram.h"
+#include "datagramIterator.h"
+#include "bamReader.h"
+#include "bamWriter.h"
+#include "boundingBox.h"
+#include "indent.h"
+#include <algorithm>
+
+using std::max;
+using std::min;
+
+PStatCollector CollisionConvex::_volume_pcollector("Collision Volumes:CollisionConvex");
+PStatCollector CollisionConvex::_test_pcollector("Collision Tests:CollisionConvex");
+TypeHandle CollisionConvex::_type_handle;
+
+// The GJK and EPA iterations stop once they improve their answer by less than
+// this distance, or after this many iterations, whichever comes first.
+static const PN_stdfloat convex_tolerance = 1.0e-5f;
+static const int convex_max_iterations = 64;
+
+/**
+ * One vertex of a simplex of the Minkowski difference of two shapes a and b,
+ * along with the points of a and b it is the difference of.
+ */
+class ConvexSimplexVertex {
+public:
+  LVector3 _w;
+  LPoint3 _a;
+  LPoint3 _b;
+};
+
+/**
+ * The simplex (a point, segment, triangle or tetrahedron) maintained by the
+ * GJK algorithm.  After reduce(), _lambda holds the barycentric coordinates of
+ * the point of the simplex closest to the origin.
+ */
+class ConvexSimplex {
+public:
+  ConvexSimplex() : _num_vertices(0) {}
+
+  bool reduce(LVector3 &closest);
+  void get_points(LPoint3 &a, LPoint3 &b) const;
+
+  ConvexSimplexVertex _v[4];
+  PN_stdfloat _lambda[4];
+  int _num_vertices;
+};
+
+/**
+ * One triangle of the polytope that is expanded by the EPA algorithm.  The
+ * normal points away from the origin, and dist is the distance of the plane
+ * of the triangle from the origin.
+ */
+class ConvexPolytopeFace {
+public:
+  int _v[3];
+  LVector3 _normal;
+  PN_stdfloat _dist;
+};
+
+typedef pvector<ConvexSimplexVertex> ConvexPolytopeVertices;
+typedef pvector<ConvexPolytopeFace> ConvexPolytopeFaces;
+typedef pvector<std::pair<int, int> > ConvexEdges;
+
+/**
+ * Returns the point of the Minkowski difference of a and b that is farthest
+ * in the indicated direction, optionally including the radius of the shapes.
+ */
+static ConvexSimplexVertex
+convex_support(const CollisionConvex::SupportShape &a,
+               const CollisionConvex::SupportShape &b,
+               const LVector3 &dir, bool with_radius) {
+  ConvexSimplexVertex vertex;
+  if (with_radius) {
+    vertex._a = a.get_support_with_radius(dir);
+    vertex._b = b.get_support_with_radius(-dir);
+  } else {
+    vertex._a = a.get_support(dir);
+    vertex._b = b.get_support(-dir);
+  }
+  vertex._w = vertex._a - vertex._b;
+  return vertex;
+}
+
+/**
+ * Adds the edge from a to b to the boundary of a set of triangles being
+ * removed from a polytope.  If the opposite edge is already on the boundary,
+ * the edge is shared by two of the removed triangles and is removed instead.
+ */
+static void
+convex_add_edge(ConvexEdges &edges, int a, int b) {
+  ConvexEdges::iterator ei;
+  for (ei = edges.begin(); ei != edges.end(); ++ei) {
+    if ((*ei).first == b && (*ei).second == a) {
+      edges.erase(ei);
+      return;
+    }
+  }
+  edges.push_back(std::pair<int, int>(a, b));
+}
+
+/**
+ * Returns the point of the segment a, b closest to the origin, and fills in
+ * its barycentric coordinates.
+ */
+static LVector3
+convex_closest_on_segment(const LVector3 &a, const LVector3 &b,
+                          PN_stdfloat lambda[2]) {
+  LVector3 ab = b - a;
+  PN_stdfloat denom = ab.length_squared();
+  PN_stdfloat t = 0.0f;
+  if (denom > 0.0f) {
+    t = min(max(-a.dot(ab) / denom, (PN_stdfloat)0.0f), (PN_stdfloat)1.0f);
+  }
+  lambda[0] = 1.0f - t;
+  lambda[1] = t;
+  return a + ab * t;
+}
+
+/**
+ * Returns the point of the triangle a, b, c closest to the origin, and fills
+ * in its barycentric coordinates.  This is the Voronoi region test described
+ * by Ericson in "Real-Time Collision Detection".
+ */
+static LVector3
+convex_closest_on_triangle(const LVector3 &a, const LVector3 &b,
+                           const LVector3 &c, PN_stdfloat lambda[3]) {
+  LVector3 ab = b - a;
+  LVector3 ac = c - a;
+  lambda[0] = lambda[1] = lambda[2] = 0.0f;
+
+  PN_stdfloat d1 = -ab.dot(a);
+  PN_stdfloat d2 = -ac.dot(a);
+  if (d1 <= 0.0f && d2 <= 0.0f) {
+    lambda[0] = 1.0f;
+    return a;
+  }
+
+  PN_stdfloat d3 = -ab.dot(b);
+  PN_stdfloat d4 = -ac.dot(b);
+  if (d3 >= 0.0f && d4 <= d3) {
+    lambda[1] = 1.0f;
+    return b;
+  }
+
+  PN_stdfloat vc = d1 * d4 - d3 * d2;
+  if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+    PN_stdfloat v = d1 / (d1 - d3);
+    lambda[0] = 1.0f - v;
+    lambda[1] = v;
+    return a + ab * v;
+  }
+
+  PN_stdfloat d5 = -ab.dot(c);
+  PN_stdfloat d6 = -ac.dot(c);
+  if (d6 >= 0.0f && d5 <= d6) {
+    lambda[2] = 1.0f;
+    return c;
+  }
+
+  PN_stdfloat vb = d5 * d2 - d1 * d6;
+  if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+    PN_stdfloat w = d2 / (d2 - d6);
+    lambda[0] = 1.0f - w;
+    lambda[2] = w;
+    return a + ac * w;
+  }
+
+  PN_stdfloat va = d3 * d6 - d5 * d4;
+  if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+    PN_stdfloat w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+    lambda[1] = 1.0f - w;
+    lambda[2] = w;
+    return b + (c - b) * w;
+  }
+
+  PN_stdfloat denom = va + vb + vc;
+  if (denom <= 0.0f) {
+    // The triangle is degenerate; fall back to its longest edge.
+    PN_stdfloat seg[2];
+    LVector3 ab_len = b - a, bc_len = c - b, ca_len = a - c;
+    PN_stdfloat lab = ab_len.length_squared();
+    PN_stdfloat lbc = bc_len.length_squared();
+    PN_stdfloat lca = ca_len.length_squared();
+    if (lab >= lbc && lab >= lca) {
+      LVector3 result = convex_closest_on_segment(a, b, seg);
+      lambda[0] = seg[0];
+      lambda[1] = seg[1];
+      return result;
+    } else if (lbc >= lca) {
+      LVector3 result = convex_closest_on_segment(b, c, seg);
+      lambda[1] = seg[0];
+      lambda[2] = seg[1];
+      return result;
+    } else {
+      LVector3 result = convex_closest_on_segment(c, a, seg);
+      lambda[2] = seg[0];
+      lambda[0] = seg[1];
+      return result;
+    }
+  }
+
+  PN_stdfloat v = vb / denom;
+  PN_stdfloat w = vc / denom;
+  lambda[0] = 1.0f - v - w;
+  lambda[1] = v;
+  lambda[2] = w;
+  return a + ab * v + ac * w;
+}
+
+/**
+ * Returns true if the origin lies on the other side of the plane of the
+ * triangle a, b, c from the point d.  If the tetrahedron is flat, this is
+ * conservatively assumed to be the case.
+ */
+static bool
+convex_origin_outside(const LVector3 &a, const LVector3 &b, const LVector3 &c,
+                      const LVector3 &d) {
+  LVector3 normal = (b - a).cross(c - a);
+  PN_stdfloat sign_origin = -a.dot(normal);
+  PN_stdfloat sign_d = (d - a).dot(normal);
+  if (sign_d * sign_d <= 1.0e-12f * normal.length_squared()) {
+    return true;
+  }
+  return sign_origin * sign_d < 0.0f;
+}
+
+/**
+ * Finds the point of the simplex closest to the origin, and removes the
+ * vertices that are not needed to express it.  Returns true if the simplex is
+ * a tetrahedron that contains the origin, in which case it is left alone.
+ */
+bool ConvexSimplex::
+reduce(LVector3 &closest) {
+  PN_stdfloat lambda[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+
+  switch (_num_vertices) {
+  case 1:
+    lambda[0] = 1.0f;
+    closest = _v[0]._w;
+    break;
+
+  case 2:
+    closest = convex_closest_on_segment(_v[0]._w, _v[1]._w, lambda);
+    break;
+
+  case 3:
+    closest = convex_closest_on_triangle(_v[0]._w, _v[1]._w, _v[2]._w, lambda);
+    break;
+
+  case 4:
+    {
+      static const int faces[4][4] = {
+        {0, 1, 2, 3}, {0, 2, 3, 1}, {0, 3, 1, 2}, {1, 3, 2, 0},
+      };
+      bool found = false;
+      PN_stdfloat best_dist_2 = 0.0f;
+      for (int f = 0; f < 4; ++f) {
+        const int *face = faces[f];
+        if (!convex_origin_outside(_v[face[0]]._w, _v[face[1]]._w,
+                                   _v[face[2]]._w, _v[face[3]]._w)) {
+          continue;
+        }
+        PN_stdfloat face_lambda[3];
+        LVector3 point = convex_closest_on_triangle
+          (_v[face[0]]._w, _v[face[1]]._w, _v[face[2]]._w, face_lambda);
+        PN_stdfloat dist_2 = point.length_squared();
+        if (!found || dist_2 < best_dist_2) {
+          found = true;
+          best_dist_2 = dist_2;
+          closest = point;
+          lambda[face[0]] = face_lambda[0];
+          lambda[face[1]] = face_lambda[1];
+          lambda[face[2]] = face_lambda[2];
+          lambda[face[3]] = 0.0f;
+        }
+      }
+      if (!found) {
+        closest = LVector3::zero();
+        _lambda[0] = _lambda[1] = _lambda[2] = _lambda[3] = 0.25f;
+        return true;
+      }
+    }
+    break;
+
+  default:
+    nassert_raise("invalid simplex");
+    return false;
+  }
+
+  int num_vertices = 0;
+  for (int i = 0; i < _num_vertices; ++i) {
+    if (lambda[i] > 0.0f) {
+      _v[num_vertices] = _v[i];
+      _lambda[num_vertices] = lambda[i];
+      ++num_vertices;
+    }
+  }
+  if (num_vertices == 0) {
+    _lambda[0] = 1.0f;
+    num_vertices = 1;
+  }
+  _num_vertices = num_vertices;
+  return false;
+}
+
+/**
+ * Returns the points of the two shapes that correspond to the closest point
+ * found by the last call to reduce().
+ */
+void ConvexSimplex::
+get_points(LPoint3 &a, LPoint3 &b) const {
+  a = LPoint3::zero();
+  b = LPoint3::zero();
+  for (int i = 0; i < _num_vertices; ++i) {
+    a += _v[i]._a * _lambda[i];
+    b += _v[i]._b * _lambda[i];
+  }
+}
+
+/**
+ * Runs the GJK algorithm on the two shapes, ignoring their radii.  Returns
+ * the distance between them, or 0 if they overlap.  The simplex is left with
+ * the vertices that determine the closest points, or that enclose the origin.
+ */
+static PN_stdfloat
+convex_gjk(const CollisionConvex::SupportShape &a,
+           const CollisionConvex::SupportShape &b, ConvexSimplex &simplex) {
+  LVector3 dir = b._points[0] - a._points[0];
+  if (dir.length_squared() == 0.0f) {
+    dir.set(1.0f, 0.0f, 0.0f);
+  }
+  simplex._v[0] = convex_support(a, b, dir, false);
+  simplex._num_vertices = 1;
+
+  LVector3 closest;
+  for (int iteration = 0; iteration < convex_max_iterations; ++iteration) {
+    if (simplex.reduce(closest)) {
+      return 0.0f;
+    }
+    PN_stdfloat dist_2 = closest.length_squared();
+    if (dist_2 <= convex_tolerance * convex_tolerance) {
+      return 0.0f;
+    }
+
+    // Look for a point of the difference that is closer to the origin.  If
+    // there isn't one, we already have the closest point.
+    ConvexSimplexVertex vertex = convex_support(a, b, -closest, false);
+    if (dist_2 - closest.dot(vertex._w) <= convex_tolerance * csqrt(dist_2)) {
+      break;
+    }
+    bool duplicate = false;
+    for (int i = 0; i < simplex._num_vertices; ++i) {
+      if ((simplex._v[i]._w - vertex._w).length_squared() <=
+          convex_tolerance * convex_tolerance) {
+        duplicate = true;
+        break;
+      }
+    }
+    if (duplicate) {
+      break;
+    }
+    simplex._v[simplex._num_vertices++] = vertex;
+  }
+
+  return closest.length();
+}
+
+/**
+ * Adds vertices to a GJK simplex that encloses the origin until it is a
+ * tetrahedron, so that it can serve as the starting polytope for EPA.
+ * Returns false if the shapes are too flat for this to be possible.
+ */
+static bool
+convex_expand_simplex(const CollisionConvex::SupportShape &a,
+                      const CollisionConvex::SupportShape &b,
+                      ConvexPolytopeVertices &verts) {
+  static const LVector3 axes[6] = {
+    LVector3(1, 0, 0), LVector3(-1, 0, 0),
+    LVector3(0, 1, 0), LVector3(0, -1, 0),
+    LVector3(0, 0, 1), LVector3(0, 0, -1),
+  };
+
+  if (verts.size() == 1) {
+    for (int i = 0; i < 6 && verts.size() == 1; ++i) {
+      ConvexSimplexVertex vertex = convex_support(a, b, axes[i], true);
+      if ((vertex._w - verts[0]._w).length() > convex_tolerance) {
+        verts.push_back(vertex);
+      }
+    }
+  }
+
+  if (verts.size() == 2) {
+    LVector3 line = verts[1]._w - verts[0]._w;
+    line.normalize();
+    for (int i = 0; i < 6 && verts.size() == 2; i += 2) {
+      LVector3 perp = line.cross(axes[i]);
+      if (!perp.normalize()) {
+        continue;
+      }
+      for (int sign = 0; sign < 2 && verts.size() == 2; ++sign) {
+        ConvexSimplexVertex vertex =
+          convex_support(a, b, sign ? -perp : perp, true);
+        if ((vertex._w - verts[0]._w).cross(line).length() > convex_tolerance) {
+          verts.push_back(vertex);
+        }
+      }
+    }
+  }
+
+  if (verts.size() == 3) {
+    LVector3 normal = (verts[1]._w - verts[0]._w).cross(verts[2]._w - verts[0]._w);
+    if (normal.normalize()) {
+      for (int sign = 0; sign < 2 && verts.size() == 3; ++sign) {
+        ConvexSimplexVertex vertex =
+          convex_support(a, b, sign ? -normal : normal, true);
+        if (cabs((vertex._w - verts[0]._w).dot(normal)) > convex_tolerance) {
+          verts.push_back(vertex);
+        }
+      }
+    }
+  }
+
+  return verts.size() == 4;
+}
+
+/**
+ * Adds the triangle a, b, c to the polytope.  Returns false if it is
+ * degenerate.
+ */
+static bool
+convex_add_face(ConvexPolytopeFaces &faces, const ConvexPolytopeVertices &verts,
+                int a, int b, int c) {
+  ConvexPolytopeFace face;
+  face._v[0] = a;
+  face._v[1] = b;
+  face._v[2] = c;
+  face._normal = (verts[b]._w - verts[a]._w).cross(verts[c]._w - verts[a]._w);
+  if (!face._normal.normalize()) {
+    return false;
+  }
+  face._dist = face._normal.dot(verts[a]._w);
+  faces.push_back(face);
+  return true;
+}
+
+/**
+ * Returns the index of the face of the polytope closest to the origin.
+ */
+static size_t
+convex_closest_face(const ConvexPolytopeFaces &faces) {
+  size_t best = 0;
+  for (size_t i = 1; i < faces.size(); ++i) {
+    if (faces[i]._dist < faces[best]._dist) {
+      best = i;
+    }
+  }
+  return best;
+}
+
+/**
+ * Runs the EPA algorithm on two overlapping shapes, starting from the simplex
+ * left by convex_gjk(), to find the smallest translation that separates them.
+ */
+static bool
+convex_epa(const CollisionConvex::SupportShape &from,
+           const CollisionConvex::SupportShape &into,
+           const ConvexSimplex &simplex, LVector3 &normal, PN_stdfloat &depth,
+           LPoint3 &interior_point) {
+  ConvexPolytopeVertices verts(simplex._v, simplex._v + simplex._num_vertices);
+  if (!convex_expand_simplex(from, into, verts)) {
+    return false;
+  }
+
+  // Orient the faces of the starting tetrahedron outward.
+  LVector3 center = (verts[0]._w + verts[1]._w + verts[2]._w + verts[3]._w) * 0.25f;
+  static const int tetra[4][3] = {{0, 1, 2}, {0, 3, 1}, {0, 2, 3}, {1, 3, 2}};
+  ConvexPolytopeFaces faces;
+  for (int f = 0; f < 4; ++f) {
+    int a = tetra[f][0], b = tetra[f][1], c = tetra[f][2];
+    LVector3 n = (verts[b]._w - verts[a]._w).cross(verts[c]._w - verts[a]._w);
+    if (n.dot(verts[a]._w - center) < 0.0f) {
+      std::swap(b, c);
+    }
+    if (!convex_add_face(faces, verts, a, b, c)) {
+      return false;
+    }
+  }
+
+  for (int iteration = 0; iteration < convex_max_iterations; ++iteration) {
+    const ConvexPolytopeFace &closest = faces[convex_closest_face(faces)];
+    ConvexSimplexVertex vertex = convex_support(from, into, closest._normal, true);
+    PN_stdfloat dist = vertex._w.dot(closest._normal);
+    if (dist - closest._dist <= convex_tolerance * max(dist, (PN_stdfloat)1.0f)) {
+      break;
+    }
+
+    // Remove the faces that can see the new vertex, and stitch the hole
+    // closed with new faces fanning out from it.
+    int index = (int)verts.size();
+    verts.push_back(vertex);
+    ConvexEdges edges;
+    size_t fi = 0;
+    while (fi < faces.size()) {
+      const ConvexPolytopeFace &face = faces[fi];
+      if (face._normal.dot(vertex._w - verts[face._v[0]]._w) > 0.0f) {
+        convex_add_edge(edges, face._v[0], face._v[1]);
+        convex_add_edge(edges, face._v[1], face._v[2]);
+        convex_add_edge(edges, face._v[2], face._v[0]);
+        faces[fi] = faces.back();
+        faces.pop_back();
+      } else {
+        ++fi;
+      }
+    }
+    ConvexEdges::const_iterator ei;
+    for (ei = edges.begin(); ei != edges.end(); ++ei) {
+      convex_add_face(faces, verts, (*ei).first, (*ei).second, index);
+    }
+    if (faces.empty()) {
+      return false;
+    }
+  }
+
+  // The separating translation is the point of the closest face nearest the
+  // origin.  The same barycentric coordinates locate the deepest point of the
+  // "from" shape.
+  const ConvexPolytopeFace &face = faces[convex_closest_face(faces)];
+  const ConvexSimplexVertex &va = verts[face._v[0]];
+  const ConvexSimplexVertex &vb = verts[face._v[1]];
+  const ConvexSimplexVertex &vc = verts[face._v[2]];
+
+  LVector3 p = face._normal * face._dist;
+  LVector3 e0 = vb._w - va._w;
+  LVector3 e1 = vc._w - va._w;
+  LVector3 e2 = p - va._w;
+  PN_stdfloat d00 = e0.dot(e0);
+  PN_stdfloat d01 = e0.dot(e1);
+  PN_stdfloat d11 = e1.dot(e1);
+  PN_stdfloat d20 = e2.dot(e0);
+  PN_stdfloat d21 = e2.dot(e1);
+  PN_stdfloat denom = d00 * d11 - d01 * d01;
+  PN_stdfloat v = 1.0f / 3.0f;
+  PN_stdfloat w = 1.0f / 3.0f;
+  if (denom > 0.0f) {
+    v = (d11 * d20 - d01 * d21) / denom;
+    w = (d00 * d21 - d01 * d20) / denom;
+  }
+  PN_stdfloat u = 1.0f - v - w;
+
+  normal = -face._normal;
+  depth = face._dist;
+  interior_point = va._a * u + vb._a * v + vc._a * w;
+  return true;
+}
+
+/**
+ * Returns the point of the hull of the points that is farthest in the
+ * indicated direction, not counting the radius.
+ */
+LPoint3 CollisionConvex::SupportShape::
+get_support(const LVector3 &dir) const {
+  nassertr(!_points.empty(), LPoint3::zero());
+  Points::const_iterator best = _points.begin();
+  PN_stdfloat best_dot = (*best).dot(dir);
+  Points::const_iterator pi;
+  for (pi = _points.begin() + 1; pi != _points.end(); ++pi) {
+    PN_stdfloat dot = (*pi).dot(dir);
+    if (dot > best_dot) {
+      best_dot = dot;
+      best = pi;
+    }
+  }
+  return *best;
+}
+
+/**
+ * Creates a solid from the vertices of all of the Geoms of the indicated
+ * GeomNode.  The transform of the GeomNode itself is not applied.
+ */
+CollisionConvex::
+CollisionConvex(const GeomNode *node) : _hull_stale(true) {
+  add_geom_node(node);
+}
+
+/**
+ *
+ */
+CollisionConvex::
+CollisionConvex(const CollisionConvex &copy) :
+  CollisionSolid(copy),
+  _points(copy._points),
+  _hull_stale(true)
+{
+}
+
+/**
+ *
+ */
+CollisionSolid *CollisionConvex::
+make_copy() {
+  return new CollisionConvex(*this);
+}
+
+/**
+ *
+ */
+PT(CollisionEntry) CollisionConvex::
+test_intersection(const CollisionEntry &entry) const {
+  return entry.get_into()->test_intersection_from_convex(entry);
+}
+
+/**
+ * Adds all of the vertices of the indicated Geom to the set of points,
+ * transformed by the indicated matrix.
+ */
+void CollisionConvex::
+add_geom(const Geom *geom, const LMatrix4 &mat) {
+  nassertv(geom != nullptr);
+  CPT(GeomVertexData) vdata = geom->get_vertex_data();
+  if (!vdata->has_column(InternalName::get_vertex())) {
+    return;
+  }
+
+  GeomVertexReader vertex(vdata, InternalName::get_vertex());
+  while (!vertex.is_at_end()) {
+    _points.push_back(mat.xform_point(vertex.get_data3()));
+  }
+
+  mark_hull_stale();
+  mark_internal_bounds_stale();
+  mark_viz_stale();
+}
+
+/**
+ * Adds all of the vertices of all of the Geoms of the indicated GeomNode to
+ * the set of points, transformed by the indicated matrix.  The transform of
+ * the GeomNode itself is not applied.
+ */
+void CollisionConvex::
+add_geom_node(const GeomNode *node, const LMatrix4 &mat) {
+  nassertv(node != nullptr);
+  int num_geoms = node->get_num_geoms();
+  for (int i = 0; i < num_geoms; ++i) {
+    add_geom(node->get_geom(i), mat);
+  }
+}
+
+/**
+ * Returns the number of vertices of the convex hull of the points.  This is
+ * not more than the number of points, and less if some of them lie inside
+ * the hull.
+ */
+int CollisionConvex::
+get_num_hull_vertices() const {
+  check_hull();
+  return (int)_hull_vertices.size();
+}
+
+/**
+ * Returns the nth vertex of the convex hull of the points.
+ */
+LPoint3 CollisionConvex::
+get_hull_vertex(int n) const {
+  check_hull();
+  nassertr(n >= 0 && n < (int)_hull_vertices.size(), LPoint3::zero());
+  return _hull_vertices[n];
+}
+
+/**
+ * Returns the number of triangles of the convex hull of the points.  This is
+ * 0 if the points all lie in one plane.
+ */
+int CollisionConvex::
+get_num_hull_faces() const {
+  check_hull();
+  return (int)_hull_faces.size();
+}
+
+/**
+ * Transforms the solid by the indicated matrix.
+ */
+void CollisionConvex::
+xform(const LMatrix4 &mat) {
+  Points::iterator pi;
+  for (pi = _points.begin(); pi != _points.end(); ++pi) {
+    (*pi) = (*pi) * mat;
+  }
+  mark_hull_stale();
+  CollisionSolid::xform(mat);
+}
+
+/**
+ * Returns the point in space deemed to be the "origin" of the solid for
+ * collision purposes.  The closest intersection point to this origin point is
+ * considered to be the most significant.
+ */
+LPoint3 CollisionConvex::
+get_collision_origin() const {
+  if (_points.empty()) {
+    return LPoint3::origin();
+  }
+  LPoint3 sum = LPoint3::zero();
+  Points::const_iterator pi;
+  for (pi = _points.begin(); pi != _points.end(); ++pi) {
+    sum += (*pi);
+  }
+  return sum / (PN_stdfloat)_points.size();
+}
+
+/**
+ * Returns a PStatCollector that is used to count the number of bounding
+ * volume tests made against a solid of this type in a given frame.
+ */
+PStatCollector &CollisionConvex::
+get_volume_pcollector() {
+  return _volume_pcollector;
+}
+
+/**
+ * Returns a PStatCollector that is used to count the number of intersection
+ * tests made against a solid of this type in a given frame.
+ */
+PStatCollector &CollisionConvex::
+get_test_pcollector() {
+  return _test_pcollector;
+}
+
+/**
+ *
+ */
+void CollisionConvex::
+output(std::ostream &out) const {
+  out << "convex, " << _points.size() << " points";
+}
+
+/**
+ *
+ */
+void CollisionConvex::
+write(std::ostream &out, int indent_level) const {
+  indent(out, indent_level) << (*this) << "\n";
+}
+
+/**
+ * Fills in the indicated shape with the vertices of the hull, transformed by
+ * the indicated matrix.
+ */
+void CollisionConvex::
+get_support_shape(SupportShape &shape, const LMatrix4 &mat) const {
+  check_hull();
+  shape._points.clear();
+  shape._points.reserve(_hull_vertices.size());
+  Points::const_iterator vi;
+  for (vi = _hull_vertices.begin(); vi != _hull_vertices.end(); ++vi) {
+    shape._points.push_back((*vi) * mat);
+  }
+  shape._radius = 0.0f;
+}
+
+/**
+ * Uses the GJK algorithm to compute the distance between the two shapes,
+ * including their radii, and fills in the closest point of each.  Returns 0
+ * if the shapes overlap, in which case the points are meaningless.
+ */
+PN_stdfloat CollisionConvex::
+compute_distance(const SupportShape &a, const SupportShape &b,
+                 LPoint3 &point_a, LPoint3 &point_b) {
+  nassertr(!a._points.empty() && !b._points.empty(), 0.0f);
+
+  ConvexSimplex simplex;
+  PN_stdfloat dist = convex_gjk(a, b, simplex);
+  if (dist <= a._radius + b._radius) {
+    return 0.0f;
+  }
+
+  simplex.get_points(point_a, point_b);
+  LVector3 dir = (point_b - point_a) / dist;
+  point_a += dir * a._radius;
+  point_b -= dir * b._radius;
+  return dist - a._radius - b._radius;
+}
+
+/**
+ * Determines whether the two shapes overlap, and if so, fills in the
+ * smallest translation of the "from" shape that separates them, as a unit
+ * normal and a depth, along with the point of the "from" shape that lies
+ * deepest inside the "into" shape.  The normal points out of the "into"
+ * shape, and is the direction in which the "from" shape should be pushed.
+ *
+ * The GJK algorithm is used to find the distance between the shapes without
+ * their radii; if this is less than the sum of their radii, only the rounded
+ * parts overlap and the answer follows directly.  Otherwise, the EPA
+ * algorithm is used to find the penetration depth.
+ */
+bool CollisionConvex::
+compute_penetration(const SupportShape &from, const SupportShape &into,
+                    LVector3 &normal, PN_stdfloat &depth,
+                    LPoint3 &interior_point) {
+  nassertr(!from._points.empty() && !into._points.empty(), false);
+
+  ConvexSimplex simplex;
+  PN_stdfloat dist = convex_gjk(from, into, simplex);
+  PN_stdfloat radius = from._radius + into._radius;
+  if (dist > radius) {
+    return false;
+  }
+
+  if (dist > convex_tolerance) {
+    LPoint3 point_a, point_b;
+    simplex.get_points(point_a, point_b);
+    normal = (point_a - point_b) / dist;
+    depth = radius - dist;
+    interior_point = point_a - normal * from._radius;
+    return true;
+  }
+
+  return convex_epa(from, into, simplex, normal, depth, interior_point);
+}
+
+/**
+ *
+ */
+PT(BoundingVolume) CollisionConvex::
+compute_internal_bounds() const {
+  if (_points.empty()) {
+    return new BoundingBox;
+  }
+
+  LPoint3 min_point = _points[0];
+  LPoint3 max_point = _points[0];
+  Points::const_iterator pi;
+  for (pi = _points.begin() + 1; pi != _points.end(); ++pi) {
+    min_point = min_point.fmin(*pi);
+    max_point = max_point.fmax(*pi);
+  }
+  return new BoundingBox(min_point, max_point);
+}
+
+/**
+ *
+ */
+PT(CollisionEntry) CollisionConvex::
+test_intersection_from_sphere(const CollisionEntry &entry) const {
+  const CollisionSphere *sphere;
+  DCAST_INTO_R(sphere, entry.get_from(), nullptr);
+
+  const LMatrix4 &wrt_mat = entry.get_wrt_mat();
+
+  SupportShape from_shape;
+  from_shape._points.push_back(sphere->get_center() * wrt_mat);
+  LVector3 from_radius_v =
+    LVector3(sphere->get_radius(), 0.0f, 0.0f) * wrt_mat;
+  from_shape._radius = from_radius_v.length();
+
+  return make_shape_entry(entry, sphere, from_shape);
+}
+
+/**
+ *
+ */
+PT(CollisionEntry) CollisionConvex::
+test_intersection_from_line(const CollisionEntry &entry) const {
+  const CollisionLine *line;
+  DCAST_INTO_R(line, entry.get_from(), nullptr);
+
+  const LMatrix4 &wrt_mat = entry.get_wrt_mat();
+
+  LPoint3 from_origin = line->get_origin() * wrt_mat;
+  LVector3 from_direction = line->get_direction() * wrt_mat;
+
+  PN_stdfloat t1, t2;
+  int face1, face2;
+  if (!clip_line(t1, t2, face1, face2, from_origin, from_direction)) {
+    return nullptr;
+  }
+
+  return make_line_entry(entry, line, t1, face1, from_origin, from_direction,
+                         false);
+}
+
+/**
+ *
+ */
+PT(CollisionEntry) CollisionConvex::
+test_intersection_from_ray(const CollisionEntry &entry) const {
+  const CollisionRay *ray;
+  DCAST_INTO_R(ray, entry.get_from(), nullptr);
+
+  const LMatrix4 &wrt_mat = entry.get_wrt_mat();
+
+  LPoint3 from_origin = ray->get_origin() * wrt_mat;
+  LVector3 from_direction = ray->get_direction() * wrt_mat;
+
+  PN_stdfloat t1, t2;
+  int face1, face2;
+  if (!clip_line(t1, t2, face1, face2, from_origin, from_direction) ||
+      t2 < 0.0f) {
+    return nullptr;
+  }
+
+  if (t1 < 0.0f) {
+    // The origin is inside the hull, so we take the exit as our surface
+    // point.
+    return make_line_entry(entry, ray, t2, face2, from_origin, from_direction,
+                           true);
+  }
+  return make_line_entry(entry, ray, t1, face1, from_origin, from_direction,
+                         false);
+}
+
+/**
+ *
+ */
+PT(CollisionEntry) CollisionConvex::
+test_intersection_from_segment(const CollisionEntry &entry) const {
+  const CollisionSegment *segment;
+  DCAST_INTO_R(segment, entry.get_from(), nullptr);
+
+  const LMatrix4 &wrt_mat = entry.get_wrt_mat();
+
+  LPoint3 from_a = segment->get_point_a() * wrt_mat;
+  LPoint3 from_b = segment->get_point_b() * wrt_mat;
+  LVector3 from_direction = from_b - from_a;
+
+  PN_stdfloat t1, t2;
+  int face1, face2;
+  if (!clip_line(t1, t2, face1, face2, from_a, from_direction) ||
+      t2 < 0.0f || t1 > 1.0f) {
+    return nullptr;
+  }
+
+  if (t1 < 0.0f) {
+    return make_line_entry(entry, segment, t2, face2, from_a, from_direction,
+                           true);
+  }
+  return make_line_entry(entry, segment, t1, face1, from_a, from_direction,
+                         false);
+}
+
+/**
+ *
+ */
+PT(CollisionEntry) CollisionConvex::
+test_intersection_from_tube(const CollisionEntry &entry) const {
+  const CollisionTube *tube;
+  DCAST_INTO_R(tube, entry.get_from(), nullptr);
+
+  const LMatrix4 &wrt_mat = entry.get_wrt_mat();
+
+  SupportShape from_shape;
+  from_shape._points.push_back(tube->get_point_a() * wrt_mat);
+  from_shape._points.push_back(tube->get_point_b() * wrt_mat);
+  LVector3 from_radius_v =
+    LVector3(tube->get_radius(), 0.0f, 0.0f) * wrt_mat;
+  from_shape._radius = from_radius_v.length();
+
+  return make_shape_entry(entry, tube, from_shape);
+}
+
+/**
+ *
+ */
+PT(CollisionEntry) CollisionConvex::
+test_intersection_from_box(const CollisionEntry &entry) const {
+  const CollisionBox *box;
+  DCAST_INTO_R(box, entry.get_from(), nullptr);
+
+  const LMatrix4 &wrt_mat = entry.get_wrt_mat();
+
+  SupportShape from_shape;
+  from_shape._points.reserve(8);
+  for (int i = 0; i < 8; ++i) {
+    from_shape._points.push_back(box->get_point(i) * wrt_mat);
+  }
+
+  return make_shape_entry(entry, box, from_shape);
+}
+
+/**
+ *
+ */
+PT(CollisionEntry) CollisionConvex::
+test_intersection_from_convex(const CollisionEntry &entry) const {
+  const CollisionConvex *convex;
+  DCAST_INTO_R(convex, entry.get_from(), nullptr);
+
+  SupportShape from_shape;
+  convex->get_support_shape(from_shape, entry.get_wrt_mat());
+
+  return make_shape_entry(entry, convex, from_shape);
+}
+
+/**
+ * Fills the _viz_geom GeomNode up with Geoms suitable for rendering this
+ * solid.
+ */
+void CollisionConvex::
+fill_viz_geom() {
+  if (collide_cat.is_debug()) {
+    collide_cat.debug()
+      << "Recomputing viz for " << *this << "\n";
+  }
+
+  check_hull();
+  if (_hull_faces.empty()) {
+    return;
+  }
+
+  PT(GeomVertexData) vdata = new GeomVertexData
+    ("collision", GeomVertexFormat::get_v3(),
+     Geom::UH_static);
+  vdata->unclean_set_num_rows(_hull_vertices.size());
+  GeomVertexWriter vertex(vdata, InternalName::get_vertex());
+
+  Points::const_iterator vi;
+  for (vi = _hull_vertices.begin(); vi != _hull_vertices.end(); ++vi) {
+    vertex.set_data3(*vi);
+  }
+
+  PT(GeomTriangles) mesh = new GeomTriangles(Geom::UH_static);
+  Faces::const_iterator fi;
+  for (fi = _hull_faces.begin(); fi != _hull_faces.end(); ++fi) {
+    mesh->add_vertices((*fi)._v[0], (*fi)._v[1], (*fi)._v[2]);
+  }
+
+  PT(Geom) geom = new Geom(vdata);
+  geom->add_primitive(mesh);
+  _viz_geom->add_geom(geom, get_solid_viz_state());
+  _viz_geom->add_geom(geom, get_wireframe_viz_state());
+
+  _bounds_viz_geom->add_geom(geom, get_solid_bounds_viz_state());
+  _bounds_viz_geom->add_geom(geom, get_wireframe_bounds_viz_state());
+}
+
+/**
+ * Recomputes the hull, if it is out of date.
+ */
+void CollisionConvex::
+check_hull() const {
+  LightMutexHolder holder(_hull_lock);
+  if (_hull_stale) {
+    ((CollisionConvex *)this)->build_hull();
+  }
+}
+
+/**
+ * Computes the convex hull of the points from scratch, by starting with a
+ * tetrahedron of four of them and adding the others one at a time.  Assumes
+ * the lock is held.
+ *
+ * If the points all lie in one plane, the hull has no faces, and its
+ * vertices are simply all of the points.
+ */
+void CollisionConvex::
+build_hull() {
+  _hull_vertices.clear();
+  _hull_faces.clear();
+  _hull_stale = false;
+
+  int num_points = (int)_points.size();
+  if (num_points == 0) {
+    return;
+  }
+
+  LPoint3 min_point = _points[0];
+  LPoint3 max_point = _points[0];
+  int i0 = 0;
+  for (int i = 1; i < num_points; ++i) {
+    min_point = min_point.fmin(_points[i]);
+    max_point = max_point.fmax(_points[i]);
+    if (_points[i][0] < _points[i0][0]) {
+      i0 = i;
+    }
+  }
+  PN_stdfloat eps = (max_point - min_point).length() * 1.0e-5f;
+
+  // Find four points that span a tetrahedron of reasonable volume: the
+  // farthest point from the first, the farthest from the line through those
+  // two, and the farthest from the plane through all three.
+  int i1 = i0;
+  PN_stdfloat best = 0.0f;
+  for (int i = 0; i < num_points; ++i) {
+    PN_stdfloat dist = (_points[i] - _points[i0]).length();
+    if (dist > best) {
+      best = dist;
+      i1 = i;
+    }
+  }
+  if (best <= eps) {
+    _hull_vertices.push_back(_points[i0]);
+    return;
+  }
+
+  LVector3 axis = _points[i1] - _points[i0];
+  axis.normalize();
+  int i2 = i0;
+  best = 0.0f;
+  for (int i = 0; i < num_points; ++i) {
+    PN_stdfloat dist = (_points[i] - _points[i0]).cross(axis).length();
+    if (dist > best) {
+      best = dist;
+      i2 = i;
+    }
+  }
+  if (best <= eps) {
+    _hull_vertices.push_back(_points[i0]);
+    _hull_vertices.push_back(_points[i1]);
+    return;
+  }
+
+  LVector3 normal = (_points[i1] - _points[i0]).cross(_points[i2] - _points[i0]);
+  normal.normalize();
+  int i3 = i0;
+  best = 0.0f;
+  for (int i = 0; i < num_points; ++i) {
+    PN_stdfloat dist = cabs((_points[i] - _points[i0]).dot(normal));
+    if (dist > best) {
+      best = dist;
+      i3 = i;
+    }
+  }
+  if (best <= eps) {
+    _hull_vertices = _points;
+    return;
+  }
+
+  // The faces are built with indices into _points for now.
+  Faces faces;
+  LPoint3 center = (_points[i0] + _points[i1] + _points[i2] + _points[i3]) * 0.25f;
+  int tetra[4][3] = {{i0, i1, i2}, {i0, i3, i1}, {i0, i2, i3}, {i1, i3, i2}};
+  for (int f = 0; f < 4; ++f) {
+    Face face;
+    face._v[0] = tetra[f][0];
+    face._v[1] = tetra[f][1];
+    face._v[2] = tetra[f][2];
+    face._plane = LPlane(_points[face._v[0]], _points[face._v[1]], _points[face._v[2]]);
+    if (face._plane.dist_to_plane(center) > 0.0f) {
+      std::swap(face._v[1], face._v[2]);
+      face._plane.flip();
+    }
+    faces.push_back(face);
+  }
+
+  ConvexEdges edges;
+  for (int i = 0; i < num_points; ++i) {
+    if (i == i0 || i == i1 || i == i2 || i == i3) {
+      continue;
+    }
+    const LPoint3 &point = _points[i];
+
+    // Remove the faces that can see the point, remembering the edges around
+    // the hole they leave, and fill the hole with faces fanning out from the
+    // new point.  A point that no face can see is inside the hull.
+    edges.clear();
+    size_t fi = 0;
+    while (fi < faces.size()) {
+      const Face &face = faces[fi];
+      if (face._plane.dist_to_plane(point) > eps) {
+        convex_add_edge(edges, face._v[0], face._v[1]);
+        convex_add_edge(edges, face._v[1], face._v[2]);
+        convex_add_edge(edges, face._v[2], face._v[0]);
+        faces[fi] = faces.back();
+        faces.pop_back();
+      } else {
+        ++fi;
+      }
+    }
+
+    ConvexEdges::const_iterator ei;
+    for (ei = edges.begin(); ei != edges.end(); ++ei) {
+      Face face;
+      face._v[0] = (*ei).first;
+      face._v[1] = (*ei).second;
+      face._v[2] = i;
+      LVector3 face_normal = (_points[face._v[1]] - _points[face._v[0]]).cross
+        (point - _points[face._v[0]]);
+      face_normal.normalize();
+      face._plane = LPlane(face_normal, point);
+      faces.push_back(face);
+    }
+  }
+
+  // Now keep only the points that are used by the faces.
+  pvector<int> remap(num_points, -1);
+  Faces::iterator fi;
+  for (fi = faces.begin(); fi != faces.end(); ++fi) {
+    for (int k = 0; k < 3; ++k) {
+      int &index = (*fi)._v[k];
+      if (remap[index] < 0) {
+        remap[index] = (int)_hull_vertices.size();
+        _hull_vertices.push_back(_points[index]);
+      }
+      index = remap[index];
+    }
+  }
+  _hull_faces.swap(faces);
+}
+
+/**
+ * Clips the line origin + t * direction to the hull.  Returns true if it
+ * passes through the hull, and fills in the parametric values at which it
+ * enters and leaves it, and the faces it crosses there.
+ */
+bool CollisionConvex::
+clip_line(PN_stdfloat &t1, PN_stdfloat &t2, int &face1, int &face2,
+          const LPoint3 &origin, const LVector3 &direction) const {
+  check_hull();
+  if (_hull_faces.empty()) {
+    return false;
+  }
+
+  bool have_t1 = false;
+  bool have_t2 = false;
+  t1 = 0.0f;
+  t2 = 0.0f;
+  face1 = 0;
+  face2 = 0;
+
+  for (size_t i = 0; i < _hull_faces.size(); ++i) {
+    const LPlane &plane = _hull_faces[i]._plane;
+    PN_stdfloat dist = plane.dist_to_plane(origin);
+    PN_stdfloat denom = plane.get_normal().dot(direction);
+    if (IS_NEARLY_ZERO(denom)) {
+      // The line is parallel to this face; it misses the hull entirely if
+      // it is in front of it.
+      if (dist > 0.0f) {
+        return false;
+      }
+      continue;
+    }
+
+    PN_stdfloat t = -dist / denom;
+    if (denom < 0.0f) {
+      if (!have_t1 || t > t1) {
+        have_t1 = true;
+        t1 = t;
+        face1 = (int)i;
+      }
+    } else {
+      if (!have_t2 || t < t2) {
+        have_t2 = true;
+        t2 = t;
+        face2 = (int)i;
+      }
+    }
+    if (have_t1 && have_t2 && t1 > t2) {
+      return false;
+    }
+  }
+
+  return have_t1 && have_t2;
+}
+
+/**
+ * Constructs the CollisionEntry for a ray, line or segment that crosses the
+ * indicated face at the indicated parametric point.  If origin_inside is
+ * true, the origin of the ray or segment is inside the hull.
+ */
+PT(CollisionEntry) CollisionConvex::
+make_line_entry(const CollisionEntry &entry, const CollisionSolid *from,
+                PN_stdfloat t, int face, const LPoint3 &origin,
+                const LVector3 &direction, bool origin_inside) const {
+  if (collide_cat.is_debug()) {
+    collide_cat.debug()
+      << "intersection detected from " << entry.get_from_node_path()
+      << " into " << entry.get_into_node_path() << "\n";
+  }
+  PT(CollisionEntry) new_entry = new CollisionEntry(entry);
+
+  if (origin_inside) {
+    new_entry->set_interior_point(origin);
+  }
+  new_entry->set_surface_point(origin + t * direction);
+
+  if (has_effective_normal() && from->get_respect_effective_normal()) {
+    new_entry->set_surface_normal(get_effective_normal());
+  } else {
+    new_entry->set_surface_normal(_hull_faces[face]._plane.get_normal());
+  }
+
+  return new_entry;
+}
+
+/**
+ * Constructs the CollisionEntry for a solid described by the indicated
+ * shape, in the space of this solid, if it overlaps the hull.
+ */
+PT(CollisionEntry) CollisionConvex::
+make_shape_entry(const CollisionEntry &entry, const CollisionSolid *from,
+                 const SupportShape &from_shape) const {
+  check_hull();
+  if (_hull_vertices.empty() || from_shape._points.empty()) {
+    return nullptr;
+  }
+
+  SupportShape into_shape;
+  into_shape._points = _hull_vertices;
+
+  LVector3 normal;
+  PN_stdfloat depth;
+  LPoint3 interior_point;
+  if (!compute_penetration(from_shape, into_shape, normal, depth,
+                           interior_point)) {
+    return nullptr;
+  }
+
+  if (collide_cat.is_debug()) {
+    collide_cat.debug()
+      << "intersection detected from " << entry.get_from_node_path()
+      << " into " << entry.get_into_node_path() << "\n";
+  }
+  PT(CollisionEntry) new_entry = new CollisionEntry(entry);
+
+  if (has_effective_normal() && from->get_respect_effective_normal()) {
+    new_entry->set_surface_normal(get_effective_normal());
+  } else {
+    new_entry->set_surface_normal(normal);
+  }
+  new_entry->set_surface_point(interior_point + normal * depth);
+  new_entry->set_interior_point(interior_point);
+
+  return new_entry;
+}
+
+/**
+ * Tells the BamReader how to create objects of type CollisionConvex.
+ */
+void CollisionConvex::
+register_with_read_factory() {
+  BamReader::get_factory()->register_factory(get_class_type(), make_CollisionConvex);
+}
+
+/**
+ * Writes the contents of this object to the datagram for shipping out to a
+ * Bam file.
+ */
+void CollisionConvex::
+write_datagram(BamWriter *manager, Datagram &me) {
+  CollisionSolid::write_datagram(manager, me);
+  me.add_uint32(_points.size());
+  for (size_t i = 0; i < _points.size(); ++i) {
+    _points[i].write_datagram(me);
+  }
+}
+
+/**
+ * This function is called by the BamReader's factory when a new object of
+ * type CollisionConvex is encountered in the Bam file.  It should create the
+ * CollisionConvex and extract its information from the file.
+ */
+TypedWritable *CollisionConvex::
+make_CollisionConvex(const FactoryParams &params) {
+  CollisionConvex *me = new CollisionConvex;
+  DatagramIterator scan;
+  BamReader *manager;
+
+  parse_params(params, scan, manager);
+  me->fillin(scan, manager);
+  return me;
+}
+
+/**
+ * This internal function is called by make_CollisionConvex to read in all of
+ * the relevant data from the BamFile for the new CollisionConvex.  The hull
+ * is not stored; it is recomputed from the points.
+ */
+void CollisionConvex::
+fillin(DatagramIterator &scan, BamReader *manager) {
+  CollisionSolid::fillin(scan, manager);
+  size_t num_points = scan.get_uint32();
+  _points.resize(num_points);
+  for (size_t i = 0; i < num_points; ++i) {
+    _points[i].read_datagram(scan);
+  }
+  _hull_stale = true;
+}
@@ -0,0 +1,199 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file collisionConvex.h
+ * @author agent
+ * @date 2026-10-18
+ */
+
+#ifndef COLLISIONCONVEX_H
+#define COLLISIONCONVEX_H
+
+#include "pandabase.h"
+
+#include "collisionSolid.h"
+#include "plane.h"
+#include "pvector.h"
+#include "lightMutex.h"
+#include "lightMutexHolder.h"
+
+class Geom;
+class GeomNode;
+
+/**
+ * A solid that is the convex hull of a set of points, such as the vertices of
+ * a character or a vehicle.  A single CollisionConvex can stand in for the
+ * many spheres that would otherwise be needed to approximate such a shape.
+ *
+ * The hull is computed from the points the first time it is needed, and only
+ * its vertices are used for the intersection tests, so interior points do not
+ * cost anything.  Tests between a CollisionConvex and the other convex solids
+ * use the GJK algorithm to find the distance between the two shapes, and, if
+ * they overlap, the EPA algorithm to find the direction and depth of the
+ * smallest translation that separates them.  This is what the
+ * CollisionHandlerPusher uses to push the solids apart.
+ *
+ * A CollisionConvex may be used as a "from" solid against spheres, tubes,
+ * boxes, planes, polygons and other CollisionConvex solids, and as an "into"
+ * solid for spheres, tubes, boxes, rays, lines, segments and other
+ * CollisionConvex solids.
+ */
+class EXPCL_PANDA_COLLIDE CollisionConvex : public CollisionSolid {
+PUBLISHED:
+  INLINE CollisionConvex();
+  explicit CollisionConvex(const GeomNode *node);
+
+  INLINE void add_point(const LPoint3 &point);
+  void add_geom(const Geom *geom, const LMatrix4 &mat = LMatrix4::ident_mat());
+  void add_geom_node(const GeomNode *node,
+                     const LMatrix4 &mat = LMatrix4::ident_mat());
+  INLINE void clear_points();
+
+  INLINE int get_num_points() const;
+  INLINE LPoint3 get_point(int n) const;
+  MAKE_SEQ(get_points, get_num_points, get_point);
+
+  int get_num_hull_vertices() const;
+  LPoint3 get_hull_vertex(int n) const;
+  MAKE_SEQ(get_hull_vertices, get_num_hull_vertices, get_hull_vertex);
+  int get_num_hull_faces() const;
+
+  virtual LPoint3 get_collision_origin() const;
+
+PUBLISHED:
+  MAKE_SEQ_PROPERTY(points, get_num_points, get_point);
+  MAKE_SEQ_PROPERTY(hull_vertices, get_num_hull_vertices, get_hull_vertex);
+
+public:
+  // A convex shape given by the convex hull of a set of points, grown in
+  // every direction by a radius.  This is how the other solids describe
+  // themselves to the GJK and EPA algorithms: a sphere is a single point with
+  // a radius, a tube two points, a box its eight corners.
+  class EXPCL_PANDA_COLLIDE SupportShape {
+  public:
+    INLINE SupportShape();
+
+    LPoint3 get_support(const LVector3 &dir) const;
+    INLINE LPoint3 get_support_with_radius(const LVector3 &dir) const;
+
+    pvector<LPoint3> _points;
+    PN_stdfloat _radius;
+  };
+
+  CollisionConvex(const CollisionConvex &copy);
+  virtual CollisionSolid *make_copy();
+
+  virtual PT(CollisionEntry)
+    test_intersection(const CollisionEntry &entry) const;
+
+  virtual void xform(const LMatrix4 &mat);
+
+  virtual PStatCollector &get_volume_pcollector();
+  virtual PStatCollector &get_test_pcollector();
+
+  virtual void output(std::ostream &out) const;
+  virtual void write(std::ostream &out, int indent_level = 0) const;
+
+  INLINE static void flush_level();
+
+  void get_support_shape(SupportShape &shape, const LMatrix4 &mat) const;
+
+  static PN_stdfloat compute_distance(const SupportShape &a,
+                                      const SupportShape &b,
+                                      LPoint3 &point_a, LPoint3 &point_b);
+  static bool compute_penetration(const SupportShape &from,
+                                  const SupportShape &into,
+                                  LVector3 &normal, PN_stdfloat &depth,
+                                  LPoint3 &interior_point);
+
+protected:
+  virtual PT(BoundingVolume) compute_internal_bounds() const;
+
+  virtual PT(CollisionEntry)
+    test_intersection_from_sphere(const CollisionEntry &entry) const;
+  virtual PT(CollisionEntry)
+    test_intersection_from_line(const CollisionEntry &entry) const;
+  virtual PT(CollisionEntry)
+    test_intersection_from_ray(const CollisionEntry &entry) const;
+  virtual PT(CollisionEntry)
+    test_intersection_from_segment(const CollisionEntry &entry) const;
+  virtual PT(CollisionEntry)
+    test_intersection_from_tube(const CollisionEntry &entry) const;
+  virtual PT(CollisionEntry)
+    test_intersection_from_box(const CollisionEntry &entry) const;
+  virtual PT(CollisionEntry)
+    test_intersection_from_convex(const CollisionEntry &entry) const;
+
+  virtual void fill_viz_geom();
+
+private:
+  // A triangle of the hull, with the plane it lies in.  The plane's normal
+  // points out of the hull.
+  class Face {
+  public:
+    int _v[3];
+    LPlane _plane;
+  };
+  typedef pvector<LPoint3> Points;
+  typedef pvector<Face> Faces;
+
+  INLINE void mark_hull_stale();
+  void check_hull() const;
+  void build_hull();
+
+  bool clip_line(PN_stdfloat &t1, PN_stdfloat &t2, int &face1, int &face2,
+                 const LPoint3 &origin, const LVector3 &direction) const;
+  PT(CollisionEntry) make_line_entry(const CollisionEntry &entry,
+                                     const CollisionSolid *from,
+                                     PN_stdfloat t, int face,
+                                     const LPoint3 &origin,
+                                     const LVector3 &direction,
+                                     bool origin_inside) const;
+  PT(CollisionEntry) make_shape_entry(const CollisionEntry &entry,
+                                      const CollisionSolid *from,
+                                      const SupportShape &from_shape) const;
+
+private:
+  Points _points;
+
+  Points _hull_vertices;
+  Faces _hull_faces;
+  bool _hull_stale;
+  LightMutex _hull_lock;
+
+  static PStatCollector _volume_pcollector;
+  static PStatCollector _test_pcollector;
+
+protected:
+  void fillin(DatagramIterator &scan, BamReader *manager);
+
+public:
+  static void register_with_read_factory();
+  virtual void write_datagram(BamWriter *manager, Datagram &me);
+
+  static TypedWritable *make_CollisionConvex(const FactoryParams &params);
+  static TypeHandle get_class_type() {
+    return _type_handle;
+  }
+  static void init_type() {
+    CollisionSolid::init_type();
+    register_type(_type_handle, "CollisionConvex",
+                  CollisionSolid::get_class_type());
+  }
+  virtual TypeHandle get_type() const {
+    return get_class_type();
+  }
+  virtual TypeHandle force_init_type() {init_type(); return get_class_type();}
+
+private:
+  static TypeHandle _type_handle;
+};
+
+#include "collisionConvex.I"
+
+#endif
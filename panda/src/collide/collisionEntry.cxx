@@ -12,6 +12,10 @@
  */
 
 #include "collisionEntry.h"
+#include "collisionTraverser.h"
+#include "collisionSphere.h"
+#include "collisionBox.h"
+#include "config_collide.h"
 #include "dcast.h"
 #include "indent.h"
 
@@ -271,3 +275,123 @@ check_clip_planes() {
   _into_clip_planes = DCAST(ClipPlaneAttrib, _into_node_path.get_net_state()->get_attrib(ClipPlaneAttrib::get_class_slot()));
   _flags |= F_checked_clip_planes;
 }
+
+/**
+ * Performs the intersection test for a collider whose previous transform is
+ * respected.  If continuous collision detection is enabled on the traverser,
+ * and the collider is a sphere or box that has moved farther than its own
+ * radius since the previous frame, the collider is tested at a sequence of
+ * positions along its path, so that it cannot pass through a thin solid
+ * unnoticed.  Otherwise, this simply performs the ordinary test.
+ */
+PT(CollisionEntry) CollisionEntry::
+compute_swept_intersection(const CollisionTraverser *trav) const {
+  const CollisionSolid *from = get_from();
+  if (!trav->get_continuous()) {
+    return from->test_intersection(*this);
+  }
+
+  const LMatrix4 &wrt_mat = get_wrt_mat();
+
+  // The radius of the largest sphere that fits in the collider, in the space
+  // of the into node.  The collider may be moved by this much at a time
+  // without skipping over anything.
+  PN_stdfloat radius;
+  TypeHandle type = from->get_type();
+  if (type == CollisionSphere::get_class_type()) {
+    radius = ((const CollisionSphere *)from)->get_radius() *
+      wrt_mat.get_row3(0).length();
+
+  } else if (type == CollisionBox::get_class_type()) {
+    const CollisionBox *box = (const CollisionBox *)from;
+    LVector3 half = (box->get_max() - box->get_min()) * 0.5f;
+    radius = std::min(std::min(half[0] * wrt_mat.get_row3(0).length(),
+                               half[1] * wrt_mat.get_row3(1).length()),
+                      half[2] * wrt_mat.get_row3(2).length());
+
+  } else {
+    return from->test_intersection(*this);
+  }
+
+  LPoint3 origin = from->get_collision_origin();
+  LPoint3 a = origin * get_wrt_prev_mat();
+  LPoint3 b = origin * wrt_mat;
+  LVector3 delta = b - a;
+  PN_stdfloat dist = delta.length();
+  if (radius <= 0.0f || dist <= radius) {
+    // It hasn't moved far enough to need this.
+    return from->test_intersection(*this);
+  }
+
+  int num_steps = (int)ceil(dist / radius);
+  num_steps = std::max(std::min(num_steps, (int)collision_ccd_max_steps), 1);
+
+  // The probe is a copy of the collider that we slide along the path.  The
+  // ordinary tests are applied to it, with its motion no longer respected.
+  PT(CollisionSolid) moved = ((CollisionSolid *)from)->make_copy();
+  CollisionEntry probe(*this);
+  probe._from = moved;
+  probe._flags &= ~F_respect_prev_transform;
+
+  const LMatrix4 &inv_wrt_mat = get_inv_wrt_mat();
+  PN_stdfloat probe_t = 1.0f;
+
+  // Find the first of the positions at which the collider intersects
+  // something.  The collider is known not to intersect anything at t0.
+  PT(CollisionEntry) hit;
+  PN_stdfloat t0 = 0.0f;
+  PN_stdfloat t1 = 1.0f;
+  for (int i = 1; i <= num_steps; ++i) {
+    PN_stdfloat t = (PN_stdfloat)i / (PN_stdfloat)num_steps;
+    moved->xform(LMatrix4::translate_mat(inv_wrt_mat.xform_vec(delta * (t - probe_t))));
+    probe_t = t;
+    hit = moved->test_intersection(probe);
+    if (hit != nullptr) {
+      t1 = t;
+      break;
+    }
+    t0 = t;
+  }
+
+  if (hit == nullptr) {
+    return nullptr;
+  }
+
+  // Now narrow down the time of impact.
+  int refine_steps = collision_ccd_refine_steps;
+  for (int i = 0; i < refine_steps; ++i) {
+    PN_stdfloat t = (t0 + t1) * 0.5f;
+    moved->xform(LMatrix4::translate_mat(inv_wrt_mat.xform_vec(delta * (t - probe_t))));
+    probe_t = t;
+    PT(CollisionEntry) mid = moved->test_intersection(probe);
+    if (mid != nullptr) {
+      hit = mid;
+      t1 = t;
+    } else {
+      t0 = t;
+    }
+  }
+
+  // The hit was computed for the collider at t1; report it in terms of the
+  // actual collider at its current position.  The interior point moves with
+  // the collider, so that a pusher will push it back out from where it is
+  // now, even if it has passed all the way through.
+  hit->_from = from;
+  hit->_flags |= F_respect_prev_transform;
+  if (hit->has_interior_point()) {
+    hit->_interior_point += delta * (1.0f - t1);
+  }
+  hit->set_contact_pos(a + delta * t0);
+  if (hit->has_surface_normal()) {
+    hit->set_contact_normal(hit->_surface_normal);
+  }
+  hit->set_t(t0);
+
+  if (collide_cat.is_debug()) {
+    collide_cat.debug()
+      << "swept " << *from << " from " << _from_node_path << " into "
+      << _into_node_path << " hits at t = " << t0 << " after "
+      << num_steps << " steps\n";
+  }
+  return hit;
+}
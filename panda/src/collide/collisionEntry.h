@@ -28,6 +28,7 @@
 #include "pandaNode.h"
 #include "nodePath.h"
 #include "clipPlaneAttrib.h"
+#include "deletedChain.h"
 
 /**
  * Defines a single collision event.  One of these is created for each
@@ -44,6 +45,7 @@ public:
   INLINE CollisionEntry();
   CollisionEntry(const CollisionEntry &copy);
   void operator = (const CollisionEntry &copy);
+  ALLOC_DELETED_CHAIN(CollisionEntry);
 
 PUBLISHED:
   INLINE const CollisionSolid *get_from() const;
@@ -118,6 +120,9 @@ public:
 private:
   INLINE void test_intersection(CollisionHandler *record,
                                 const CollisionTraverser *trav) const;
+  INLINE PT(CollisionEntry) compute_intersection(CollisionHandler *record,
+                                                 const CollisionTraverser *trav) const;
+  PT(CollisionEntry) compute_swept_intersection(const CollisionTraverser *trav) const;
   void check_clip_planes();
 
   CPT(CollisionSolid) _from;
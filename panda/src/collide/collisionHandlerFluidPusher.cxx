@@ -104,6 +104,9 @@ handle_entries() {
   for (fei = _from_entries.begin(); fei != _from_entries.end(); ++fei) {
     NodePath from_node_path = fei->first;
     Entries *orig_entries = &fei->second;
+    if (orig_entries->empty()) {
+      continue;
+    }
 
     Colliders::iterator ci;
     ci = _colliders.find(from_node_path);
@@ -220,6 +220,9 @@ handle_entries() {
   for (fi = _from_entries.begin(); fi != _from_entries.end(); ++fi) {
     const NodePath &from_node_path = (*fi).first;
     const Entries &entries = (*fi).second;
+    if (entries.empty()) {
+      continue;
+    }
 
     Colliders::iterator ci;
     ci = _colliders.find(from_node_path);
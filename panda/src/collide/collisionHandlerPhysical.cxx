@@ -42,7 +42,19 @@ CollisionHandlerPhysical::
 void CollisionHandlerPhysical::
 begin_group() {
   CollisionHandlerEvent::begin_group();
-  _from_entries.clear();
+
+  // Empty the entry lists, but keep the lists themselves around, so that
+  // their storage may be reused by colliders that are still in contact with
+  // something.  A collider that had no entries last pass is dropped.
+  FromEntries::iterator fi = _from_entries.begin();
+  while (fi != _from_entries.end()) {
+    if ((*fi).second.empty()) {
+      _from_entries.erase(fi++);
+    } else {
+      (*fi).second.clear();
+      ++fi;
+    }
+  }
   _has_contact = false;
 }
 
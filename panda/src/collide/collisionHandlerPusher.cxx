@@ -15,9 +15,11 @@
 #include "collisionNode.h"
 #include "collisionEntry.h"
 #include "collisionPolygon.h"
+#include "collisionSphere.h"
 #include "config_collide.h"
 #include "dcast.h"
 #include "epvector.h"
+#include "cmath.h"
 
 TypeHandle CollisionHandlerPusher::_type_handle;
 
@@ -34,12 +36,37 @@ public:
   CollisionEntry *_entry;
 };
 
+/**
+ * The CrowdSphere class is used within
+ * CollisionHandlerPusher::find_crowd_shoves(), to describe one sphere of the
+ * crowd in world space.  It's not exported outside this file.
+ */
+class CrowdSphere {
+public:
+  LPoint3 _center;
+  PN_stdfloat _radius;
+  int _agent;
+  int _cell[3];
+};
+
+/**
+ * Returns the hash bucket of the indicated cell of the crowd's spatial hash.
+ */
+static size_t
+crowd_hash_cell(int x, int y, int z, size_t mask) {
+  size_t hash = ((size_t)(unsigned int)x * 73856093u) ^
+                ((size_t)(unsigned int)y * 19349663u) ^
+                ((size_t)(unsigned int)z * 83492791u);
+  return hash & mask;
+}
+
 /**
  *
  */
 CollisionHandlerPusher::
 CollisionHandlerPusher() {
   _horizontal = pushers_horizontal;
+  _crowd_cell_size = 0.0f;
 }
 
 /**
@@ -61,10 +88,32 @@ bool CollisionHandlerPusher::
 handle_entries() {
   bool okflag = true;
 
+  // First find the members of the crowd that overlap each other.  The
+  // colliders they shove on are handled below along with the others, even
+  // if the traverser found no collisions for them.
+  CrowdShoveMap crowd_shoves;
+  if (!_crowd_colliders.empty()) {
+    find_crowd_shoves(crowd_shoves);
+    CrowdShoveMap::const_iterator csi;
+    for (csi = crowd_shoves.begin(); csi != crowd_shoves.end(); ++csi) {
+      _from_entries[(*csi).first];
+    }
+  }
+
   FromEntries::const_iterator fi;
   for (fi = _from_entries.begin(); fi != _from_entries.end(); ++fi) {
     const NodePath &from_node_path = (*fi).first;
     const Entries &entries = (*fi).second;
+    const CrowdShoves *crowd = nullptr;
+    if (!crowd_shoves.empty()) {
+      CrowdShoveMap::const_iterator csi = crowd_shoves.find(from_node_path);
+      if (csi != crowd_shoves.end()) {
+        crowd = &(*csi).second;
+      }
+    }
+    if (entries.empty() && crowd == nullptr) {
+      continue;
+    }
 
     Colliders::iterator ci;
     ci = _colliders.find(from_node_path);
@@ -137,6 +186,18 @@ handle_entries() {
           }
         }
 
+        if (crowd != nullptr) {
+          CrowdShoves::const_iterator csi;
+          for (csi = crowd->begin(); csi != crowd->end(); ++csi) {
+            ShoveData sd;
+            sd._vector = (*csi)._vector;
+            sd._length = (*csi)._length;
+            sd._valid = true;
+            sd._entry = nullptr;
+            shoves.push_back(sd);
+          }
+        }
+
         if (!shoves.empty()) {
           // Now we look for two shoves that are largely in the same
           // direction, so we can combine them into a single shove of the same
@@ -168,7 +229,10 @@ handle_entries() {
                   // These two shoves are not in the same direction.  If they
                   // are both from polygons that are a child of the same node,
                   // try to determine the shape of the corner (convex or
-                  // concave).
+                  // concave).  Shoves from the crowd have no entry.
+                  if (sd._entry == nullptr || sd2._entry == nullptr) {
+                    continue;
+                  }
                   const CollisionSolid *s1 = sd._entry->get_into();
                   const CollisionSolid *s2 = sd2._entry->get_into();
                   if (s1 != nullptr &&
@@ -246,6 +310,43 @@ handle_entries() {
   return okflag;
 }
 
+/**
+ * Adds the indicated collider to the crowd.  It must also be added to the
+ * pusher with add_collider(), and to the CollisionTraverser.  Its
+ * CollisionSpheres are then pushed apart from those of the other members of
+ * the crowd; its other solids are ignored for this purpose.
+ */
+void CollisionHandlerPusher::
+add_crowd_collider(const NodePath &collider) {
+  nassertv(!collider.is_empty() && collider.node()->is_collision_node());
+  _crowd_colliders.insert(collider);
+}
+
+/**
+ * Removes the indicated collider from the crowd.  Returns true if it was a
+ * member of the crowd, false otherwise.  It remains a collider of the pusher.
+ */
+bool CollisionHandlerPusher::
+remove_crowd_collider(const NodePath &collider) {
+  return _crowd_colliders.erase(collider) != 0;
+}
+
+/**
+ * Returns true if the indicated collider is a member of the crowd.
+ */
+bool CollisionHandlerPusher::
+has_crowd_collider(const NodePath &collider) const {
+  return _crowd_colliders.find(collider) != _crowd_colliders.end();
+}
+
+/**
+ * Removes all of the colliders from the crowd.
+ */
+void CollisionHandlerPusher::
+clear_crowd_colliders() {
+  _crowd_colliders.clear();
+}
+
 /**
  * This is an optional hook for derived classes to do some work with the
  * ColliderDef and the force vector.
@@ -262,3 +363,160 @@ apply_net_shove(ColliderDef &def, const LVector3 &net_shove,
 void CollisionHandlerPusher::
 apply_linear_force(ColliderDef &def, const LVector3 &force_normal) {
 }
+
+/**
+ * Finds the pairs of spheres of the crowd that overlap, and fills in the
+ * shoves they cause on each collider, in the same way the CollisionTraverser
+ * would have if it had tested them against each other.
+ *
+ * The sphere centers are sorted into the cells of a uniform grid, through a
+ * hash table, so that each sphere need only be tested against the spheres in
+ * the neighboring cells.  This takes time proportional to the number of
+ * spheres, rather than to its square, as long as they are not piled up on top
+ * of each other.
+ */
+void CollisionHandlerPusher::
+find_crowd_shoves(CrowdShoveMap &shoves) const {
+  // Gather the spheres of the crowd, in world space.
+  pvector<CrowdSphere> spheres;
+  pvector<NodePath> agents;
+  epvector<LMatrix4> agent_mats;
+  PN_stdfloat max_radius = 0.0f;
+
+  CrowdColliders::const_iterator ci;
+  for (ci = _crowd_colliders.begin(); ci != _crowd_colliders.end(); ++ci) {
+    const NodePath &collider = (*ci);
+    if (collider.is_empty()) {
+      continue;
+    }
+    Colliders::const_iterator di = _colliders.find(collider);
+    if (di == _colliders.end()) {
+      continue;
+    }
+    const ColliderDef &def = (*di).second;
+
+    CollisionNode *cnode = DCAST(CollisionNode, collider.node());
+    LMatrix4 mat = collider.get_net_transform()->get_mat();
+    int agent = (int)agents.size();
+    size_t first_sphere = spheres.size();
+
+    int num_solids = (int)cnode->get_num_solids();
+    for (int i = 0; i < num_solids; ++i) {
+      CPT(CollisionSolid) solid = cnode->get_solid(i);
+      if (!solid->is_of_type(CollisionSphere::get_class_type()) ||
+          !solid->is_tangible()) {
+        continue;
+      }
+      const CollisionSphere *sphere = DCAST(CollisionSphere, solid);
+      CrowdSphere cs;
+      cs._center = sphere->get_center() * mat;
+      cs._radius = (LVector3(sphere->get_radius(), 0.0f, 0.0f) * mat).length();
+      cs._agent = agent;
+      max_radius = std::max(max_radius, cs._radius);
+      spheres.push_back(cs);
+    }
+
+    if (spheres.size() > first_sphere) {
+      // Shoves are expressed relative to the collider's target.
+      agents.push_back(collider);
+      agent_mats.push_back(def._target.get_net_transform()->get_inverse()->get_mat());
+    }
+  }
+
+  if (agents.size() < 2 || max_radius <= 0.0f) {
+    return;
+  }
+
+  PN_stdfloat cell_size = _crowd_cell_size;
+  if (cell_size <= 0.0f) {
+    cell_size = max_radius * 2.0f;
+  }
+  int reach = (int)cceil(max_radius * 2.0f / cell_size);
+
+  // Sort the spheres into the buckets of the hash table, by counting.
+  size_t num_spheres = spheres.size();
+  size_t num_buckets = 1;
+  while (num_buckets < num_spheres * 2) {
+    num_buckets <<= 1;
+  }
+  size_t mask = num_buckets - 1;
+
+  pvector<size_t> bucket_start(num_buckets + 1, 0);
+  pvector<size_t> sphere_bucket(num_spheres);
+  for (size_t i = 0; i < num_spheres; ++i) {
+    CrowdSphere &cs = spheres[i];
+    for (int k = 0; k < 3; ++k) {
+      cs._cell[k] = (int)cfloor(cs._center[k] / cell_size);
+    }
+    sphere_bucket[i] = crowd_hash_cell(cs._cell[0], cs._cell[1], cs._cell[2], mask);
+    ++bucket_start[sphere_bucket[i] + 1];
+  }
+  for (size_t b = 0; b < num_buckets; ++b) {
+    bucket_start[b + 1] += bucket_start[b];
+  }
+  pvector<size_t> bucket_fill(bucket_start);
+  pvector<int> sorted(num_spheres);
+  for (size_t i = 0; i < num_spheres; ++i) {
+    sorted[bucket_fill[sphere_bucket[i]]++] = (int)i;
+  }
+
+  // Now test each sphere against the later spheres in the cells around it.
+  // Each pair is found exactly once, by comparing the exact cell, since
+  // several cells may share a bucket.
+  for (size_t i = 0; i < num_spheres; ++i) {
+    const CrowdSphere &a = spheres[i];
+    for (int dx = -reach; dx <= reach; ++dx) {
+      for (int dy = -reach; dy <= reach; ++dy) {
+        for (int dz = -reach; dz <= reach; ++dz) {
+          int cx = a._cell[0] + dx;
+          int cy = a._cell[1] + dy;
+          int cz = a._cell[2] + dz;
+          size_t bucket = crowd_hash_cell(cx, cy, cz, mask);
+          for (size_t k = bucket_start[bucket]; k < bucket_start[bucket + 1]; ++k) {
+            size_t j = (size_t)sorted[k];
+            const CrowdSphere &b = spheres[j];
+            if (j <= i || b._agent == a._agent ||
+                b._cell[0] != cx || b._cell[1] != cy || b._cell[2] != cz) {
+              continue;
+            }
+
+            LVector3 v = a._center - b._center;
+            PN_stdfloat radius = a._radius + b._radius;
+            PN_stdfloat dist_2 = v.length_squared();
+            if (dist_2 >= radius * radius) {
+              continue;
+            }
+
+            // Like a sphere colliding into a sphere, each is shoved away
+            // from the other's center by the full amount of the overlap.
+            PN_stdfloat dist = csqrt(dist_2);
+            LVector3 normal;
+            if (IS_NEARLY_ZERO(dist)) {
+              // The centers are coincident; any direction is as good as any
+              // other, as long as they are shoved apart.
+              normal.set(1.0f, 0.0f, 0.0f);
+            } else {
+              normal = v / dist;
+            }
+            LVector3 shove = normal * (radius - dist);
+
+            for (int side = 0; side < 2; ++side) {
+              int agent = side ? b._agent : a._agent;
+              LVector3 local = agent_mats[agent].xform_vec(side ? -shove : shove);
+
+              CrowdShove cs;
+              cs._length = local.length();
+              cs._vector = local;
+              if (_horizontal) {
+                cs._vector[2] = 0.0f;
+              }
+              if (cs._length > 0.0f && cs._vector.normalize()) {
+                shoves[agents[agent]].push_back(cs);
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+}
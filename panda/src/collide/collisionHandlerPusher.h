@@ -17,11 +17,23 @@
 #include "pandabase.h"
 
 #include "collisionHandlerPhysical.h"
+#include "pset.h"
 
 /**
  * A specialized kind of CollisionHandler that simply pushes back on things
  * that attempt to move into solid walls.  This is the simplest kind of "real-
  * world" collisions you can have.
+ *
+ * Colliders may also be added to the pusher's crowd, with
+ * add_crowd_collider().  The CollisionSpheres of the crowd are pushed apart
+ * from each other by the pusher itself, using a spatial hash of their
+ * centers, rather than by testing every pair of them in the
+ * CollisionTraverser.  Each pair of overlapping spheres shoves on both
+ * colliders just as if they had collided in the traverser, and these shoves
+ * are combined with those from the walls.  For this to save any time, the
+ * into mask of the crowd's CollisionNodes should not include their from
+ * mask, so that the traverser no longer tests them against each other.  No
+ * collision events are thrown for the collisions within the crowd.
  */
 class EXPCL_PANDA_COLLIDE CollisionHandlerPusher : public CollisionHandlerPhysical {
 PUBLISHED:
@@ -31,8 +43,17 @@ PUBLISHED:
   INLINE void set_horizontal(bool flag);
   INLINE bool get_horizontal() const;
 
+  void add_crowd_collider(const NodePath &collider);
+  bool remove_crowd_collider(const NodePath &collider);
+  bool has_crowd_collider(const NodePath &collider) const;
+  void clear_crowd_colliders();
+
+  INLINE void set_crowd_cell_size(PN_stdfloat cell_size);
+  INLINE PN_stdfloat get_crowd_cell_size() const;
+
 PUBLISHED:
   MAKE_PROPERTY(horizontal, get_horizontal, set_horizontal);
+  MAKE_PROPERTY(crowd_cell_size, get_crowd_cell_size, set_crowd_cell_size);
 
 protected:
   virtual bool handle_entries();
@@ -43,6 +64,22 @@ protected:
 
   bool _horizontal;
 
+private:
+  // A shove on a member of the crowd from another one, in the coordinate
+  // space of the collider's target.
+  class CrowdShove {
+  public:
+    LVector3 _vector;
+    PN_stdfloat _length;
+  };
+  typedef pvector<CrowdShove> CrowdShoves;
+  typedef pmap<NodePath, CrowdShoves> CrowdShoveMap;
+
+  void find_crowd_shoves(CrowdShoveMap &shoves) const;
+
+  typedef pset<NodePath> CrowdColliders;
+  CrowdColliders _crowd_colliders;
+  PN_stdfloat _crowd_cell_size;
 
 public:
   static TypeHandle get_class_type() {
@@ -0,0 +1,1051 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file collisionHeightfield.cxx
+ * @author agent
+ * @date 2026-10-18
+ */
+
+#include "collisionHeightfield.h"
+#include "collisionEntry.h"
+#include "collisionSphere.h"
+#include "collisionLine.h"
+#include "collisionRay.h"
+#include "collisionSegment.h"
+#include "collisionBox.h"
+#include "config_collide.h"
+#include "texture.h"
+#include "geom.h"
+#include "geomTriangles.h"
+#include "geomVertexWriter.h"
+#include "datagram.h"
+#include "datagramIterator.h"
+#include "bamReader.h"
+#include "bamWriter.h"
+#include "boundingBox.h"
+#include "indent.h"
+#include <algorithm>
+
+using std::max;
+using std::min;
+
+PStatCollector CollisionHeightfield::_volume_pcollector("Collision Volumes:CollisionHeightfield");
+PStatCollector CollisionHeightfield::_test_pcollector("Collision Tests:CollisionHeightfield");
+TypeHandle CollisionHeightfield::_type_handle;
+
+// Each cell of the lowest level of the quadtree covers 1 << hfield_leaf_shift
+// squares of the heightfield in each direction.
+static const int hfield_leaf_shift = 2;
+
+// The amount by which the boxes of the quadtree are padded, to make up for
+// rounding errors in the triangle tests.
+static const PN_stdfloat hfield_box_pad = 0.001f;
+
+/**
+ * Returns true if the indicated point lies directly above or below the
+ * indicated half of the indicated square of the heightfield.
+ */
+static bool
+hfield_is_over_triangle(const LPoint3 &point, int x, int y, int half) {
+  PN_stdfloat fx = point[0] - (PN_stdfloat)x;
+  PN_stdfloat fy = point[1] - (PN_stdfloat)y;
+  if (fx < 0.0f || fx > 1.0f || fy < 0.0f || fy > 1.0f) {
+    return false;
+  }
+  return (half == 0) ? (fx >= fy) : (fx <= fy);
+}
+
+/**
+ * Intersects the line origin + t * direction with the triangle a, b, c, from
+ * either side.  Returns true if they intersect, and fills in t.
+ */
+static bool
+hfield_intersects_ray(PN_stdfloat &t, const LPoint3 &a, const LPoint3 &b,
+                      const LPoint3 &c, const LPoint3 &origin,
+                      const LVector3 &direction) {
+  LVector3 e1 = b - a;
+  LVector3 e2 = c - a;
+  LVector3 pvec = direction.cross(e2);
+  PN_stdfloat det = e1.dot(pvec);
+  if (IS_NEARLY_ZERO(det)) {
+    return false;
+  }
+  PN_stdfloat inv_det = 1.0f / det;
+
+  LVector3 tvec = origin - a;
+  PN_stdfloat u = tvec.dot(pvec) * inv_det;
+  if (u < 0.0f || u > 1.0f) {
+    return false;
+  }
+
+  LVector3 qvec = tvec.cross(e1);
+  PN_stdfloat v = direction.dot(qvec) * inv_det;
+  if (v < 0.0f || u + v > 1.0f) {
+    return false;
+  }
+
+  t = e2.dot(qvec) * inv_det;
+  return true;
+}
+
+/**
+ * Returns the point on the triangle a, b, c that is nearest to the given
+ * point.
+ */
+static LPoint3
+hfield_closest_point_on_triangle(const LPoint3 &a, const LPoint3 &b,
+                                 const LPoint3 &c, const LPoint3 &p) {
+  LVector3 ab = b - a;
+  LVector3 ac = c - a;
+  LVector3 ap = p - a;
+  PN_stdfloat d1 = ab.dot(ap);
+  PN_stdfloat d2 = ac.dot(ap);
+  if (d1 <= 0.0f && d2 <= 0.0f) {
+    return a;
+  }
+
+  LVector3 bp = p - b;
+  PN_stdfloat d3 = ab.dot(bp);
+  PN_stdfloat d4 = ac.dot(bp);
+  if (d3 >= 0.0f && d4 <= d3) {
+    return b;
+  }
+
+  PN_stdfloat vc = d1 * d4 - d3 * d2;
+  if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+    return a + ab * (d1 / (d1 - d3));
+  }
+
+  LVector3 cp = p - c;
+  PN_stdfloat d5 = ab.dot(cp);
+  PN_stdfloat d6 = ac.dot(cp);
+  if (d6 >= 0.0f && d5 <= d6) {
+    return c;
+  }
+
+  PN_stdfloat vb = d5 * d2 - d1 * d6;
+  if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+    return a + ac * (d2 / (d2 - d6));
+  }
+
+  PN_stdfloat va = d3 * d6 - d5 * d4;
+  if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+    return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+  }
+
+  PN_stdfloat denom = 1.0f / (va + vb + vc);
+  return a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+/**
+ * Returns true if the indicated axis separates the triangle a, b, c from the
+ * oriented box with the given center and half-axes.
+ */
+static bool
+hfield_box_axis_separates(const LVector3 &axis,
+                          const LPoint3 &a, const LPoint3 &b, const LPoint3 &c,
+                          const LPoint3 &center, const LVector3 &box_x,
+                          const LVector3 &box_y, const LVector3 &box_z) {
+  if (axis.length_squared() < 1.0e-12f) {
+    return false;
+  }
+  PN_stdfloat pa = axis.dot(a);
+  PN_stdfloat pb = axis.dot(b);
+  PN_stdfloat pc = axis.dot(c);
+  PN_stdfloat tri_min = min(min(pa, pb), pc);
+  PN_stdfloat tri_max = max(max(pa, pb), pc);
+
+  PN_stdfloat box_center = axis.dot(center);
+  PN_stdfloat box_radius =
+    cabs(axis.dot(box_x)) + cabs(axis.dot(box_y)) + cabs(axis.dot(box_z));
+
+  return (box_center - box_radius > tri_max || box_center + box_radius < tri_min);
+}
+
+/**
+ * Creates a heightfield solid sampled from the indicated image.  The image
+ * must be at least two pixels wide and two pixels high.
+ */
+CollisionHeightfield::
+CollisionHeightfield(const PNMImage &heightfield, PN_stdfloat max_height) :
+  _x_size(0),
+  _y_size(0),
+  _max_height(max_height)
+{
+  set_heightfield(heightfield);
+}
+
+/**
+ *
+ */
+CollisionHeightfield::
+CollisionHeightfield(const CollisionHeightfield &copy) :
+  CollisionSolid(copy),
+  _x_size(copy._x_size),
+  _y_size(copy._y_size),
+  _max_height(copy._max_height),
+  _samples(copy._samples),
+  _levels(copy._levels)
+{
+}
+
+/**
+ *
+ */
+CollisionSolid *CollisionHeightfield::
+make_copy() {
+  return new CollisionHeightfield(*this);
+}
+
+/**
+ * Replaces the elevation data with the contents of the indicated image.  The
+ * image is not referenced afterwards.
+ */
+void CollisionHeightfield::
+set_heightfield(const PNMImage &heightfield) {
+  nassertv(heightfield.get_x_size() >= 2 && heightfield.get_y_size() >= 2);
+
+  _x_size = heightfield.get_x_size();
+  _y_size = heightfield.get_y_size();
+  _samples.resize((size_t)_x_size * (size_t)_y_size);
+
+  // As in GeoMipTerrain, the top row of the image is at the far end of the Y
+  // axis, and a color image holds one 24-bit value per pixel.
+  bool grayscale = heightfield.is_grayscale();
+  for (int y = 0; y < _y_size; ++y) {
+    int row = _y_size - 1 - y;
+    float *samples = &_samples[(size_t)y * _x_size];
+    for (int x = 0; x < _x_size; ++x) {
+      if (grayscale) {
+        samples[x] = heightfield.get_bright(x, row);
+      } else {
+        samples[x] = heightfield.get_red(x, row)
+                   + heightfield.get_green(x, row) / 256.0f
+                   + heightfield.get_blue(x, row) / 65536.0f;
+      }
+    }
+  }
+
+  build_quadtree();
+  mark_internal_bounds_stale();
+  mark_viz_stale();
+}
+
+/**
+ * Replaces the elevation data with the contents of the indicated texture,
+ * which must have its RAM image available.  Returns true on success, false if
+ * the texture could not be read.
+ */
+bool CollisionHeightfield::
+set_heightfield(const Texture *tex) {
+  nassertr(tex != nullptr, false);
+  PNMImage image;
+  if (!tex->store(image)) {
+    collide_cat.error()
+      << "Could not read heightfield from texture " << tex->get_name() << "\n";
+    return false;
+  }
+  set_heightfield(image);
+  return true;
+}
+
+/**
+ * Returns the elevation of the surface at the indicated point, expressed in
+ * the coordinate space of the solid.  Points beyond the edges of the
+ * heightfield are clamped to the nearest edge.
+ */
+PN_stdfloat CollisionHeightfield::
+get_height(PN_stdfloat x, PN_stdfloat y) const {
+  if (_samples.empty()) {
+    return 0.0f;
+  }
+  x = min(max(x, (PN_stdfloat)0.0f), (PN_stdfloat)(_x_size - 1));
+  y = min(max(y, (PN_stdfloat)0.0f), (PN_stdfloat)(_y_size - 1));
+  int cx = min((int)x, _x_size - 2);
+  int cy = min((int)y, _y_size - 2);
+  PN_stdfloat fx = x - cx;
+  PN_stdfloat fy = y - cy;
+
+  float h00 = get_raw_sample(cx, cy);
+  float h10 = get_raw_sample(cx + 1, cy);
+  float h01 = get_raw_sample(cx, cy + 1);
+  float h11 = get_raw_sample(cx + 1, cy + 1);
+
+  // Interpolate across whichever of the two triangles contains the point.
+  PN_stdfloat h;
+  if (fx >= fy) {
+    h = h00 + fx * (h10 - h00) + fy * (h11 - h10);
+  } else {
+    h = h00 + fy * (h01 - h00) + fx * (h11 - h01);
+  }
+  return h * _max_height;
+}
+
+/**
+ * Transforms the solid by the indicated matrix.  This is not supported, since
+ * the heightfield must remain aligned with the axes; put the transform on the
+ * node instead.
+ */
+void CollisionHeightfield::
+xform(const LMatrix4 &mat) {
+  if (!mat.almost_equal(LMatrix4::ident_mat())) {
+    collide_cat.warning()
+      << "Cannot apply a transform to " << *this
+      << "; the transform should be left on the CollisionNode instead.\n";
+  }
+}
+
+/**
+ * Returns the point in space deemed to be the "origin" of the solid for
+ * collision purposes.  The closest intersection point to this origin point is
+ * considered to be the most significant.
+ */
+LPoint3 CollisionHeightfield::
+get_collision_origin() const {
+  return LPoint3((_x_size - 1) * 0.5f, (_y_size - 1) * 0.5f, 0.0f);
+}
+
+/**
+ * Returns a PStatCollector that is used to count the number of bounding
+ * volume tests made against a solid of this type in a given frame.
+ */
+PStatCollector &CollisionHeightfield::
+get_volume_pcollector() {
+  return _volume_pcollector;
+}
+
+/**
+ * Returns a PStatCollector that is used to count the number of intersection
+ * tests made against a solid of this type in a given frame.
+ */
+PStatCollector &CollisionHeightfield::
+get_test_pcollector() {
+  return _test_pcollector;
+}
+
+/**
+ *
+ */
+void CollisionHeightfield::
+output(std::ostream &out) const {
+  out << "heightfield, " << _x_size << " x " << _y_size << ", max height "
+      << _max_height;
+}
+
+/**
+ *
+ */
+void CollisionHeightfield::
+write(std::ostream &out, int indent_level) const {
+  indent(out, indent_level) << (*this) << "\n";
+}
+
+/**
+ *
+ */
+PT(BoundingVolume) CollisionHeightfield::
+compute_internal_bounds() const {
+  if (_levels.empty()) {
+    return new BoundingBox;
+  }
+
+  const MinMax &mm = _levels.back()._cells[0];
+  PN_stdfloat z0 = mm._min * _max_height;
+  PN_stdfloat z1 = mm._max * _max_height;
+  return new BoundingBox(LPoint3(0.0f, 0.0f, min(z0, z1)),
+                         LPoint3(_x_size - 1, _y_size - 1, max(z0, z1)));
+}
+
+/**
+ *
+ */
+PT(CollisionEntry) CollisionHeightfield::
+test_intersection_from_sphere(const CollisionEntry &entry) const {
+  const CollisionSphere *sphere;
+  DCAST_INTO_R(sphere, entry.get_from(), nullptr);
+
+  const LMatrix4 &wrt_mat = entry.get_wrt_mat();
+
+  LPoint3 from_center = sphere->get_center() * wrt_mat;
+  LVector3 from_radius_v =
+    LVector3(sphere->get_radius(), 0.0f, 0.0f) * wrt_mat;
+  PN_stdfloat from_radius_2 = from_radius_v.length_squared();
+  PN_stdfloat from_radius = csqrt(from_radius_2);
+
+  LVector3 extent(from_radius, from_radius, from_radius);
+  pvector<int> cells;
+  find_cells(cells, from_center - extent, from_center + extent);
+
+  // Of all the triangles the sphere touches, report the one into which it
+  // penetrates most deeply.  A sphere whose center is below the surface
+  // penetrates the triangle directly above it, however far down it is.
+  int cells_x = _x_size - 1;
+  bool found = false;
+  Triangle best_tri;
+  PN_stdfloat best_depth = 0.0f;
+  PN_stdfloat best_dist = 0.0f;
+  LVector3 best_normal = LVector3::zero();
+
+  pvector<int>::const_iterator ci;
+  for (ci = cells.begin(); ci != cells.end(); ++ci) {
+    int x = (*ci) % cells_x;
+    int y = (*ci) / cells_x;
+    for (int half = 0; half < 2; ++half) {
+      Triangle tri;
+      get_triangle(tri, x, y, half);
+      LVector3 normal = (tri._v[1] - tri._v[0]).cross(tri._v[2] - tri._v[0]);
+      if (!normal.normalize()) {
+        continue;
+      }
+
+      LPoint3 closest = hfield_closest_point_on_triangle
+        (tri._v[0], tri._v[1], tri._v[2], from_center);
+      PN_stdfloat dist_2 = (from_center - closest).length_squared();
+      PN_stdfloat dist = (from_center - tri._v[0]).dot(normal);
+
+      PN_stdfloat depth;
+      if (dist_2 <= from_radius_2) {
+        // As in CollisionPolygon, the sphere must stay farther from the plane
+        // the nearer it is to an edge of the triangle.
+        PN_stdfloat edge_2 = max(dist_2 - dist * dist, (PN_stdfloat)0.0f);
+        PN_stdfloat max_dist = csqrt(max(from_radius_2 - edge_2, (PN_stdfloat)0.0f));
+        depth = max_dist - dist;
+
+      } else if (dist < 0.0f && hfield_is_over_triangle(from_center, x, y, half)) {
+        depth = from_radius - dist;
+
+      } else {
+        continue;
+      }
+
+      if (!found || depth > best_depth) {
+        found = true;
+        best_tri = tri;
+        best_depth = depth;
+        best_dist = dist;
+        best_normal = normal;
+      }
+    }
+  }
+
+  if (!found) {
+    return nullptr;
+  }
+
+  if (collide_cat.is_debug()) {
+    collide_cat.debug()
+      << "intersection detected from " << entry.get_from_node_path()
+      << " into " << entry.get_into_node_path() << "\n";
+  }
+  PT(CollisionEntry) new_entry = new CollisionEntry(entry);
+
+  new_entry->set_surface_normal(get_surface_normal(best_tri, sphere));
+  new_entry->set_surface_point(from_center - best_normal * best_dist);
+  new_entry->set_interior_point(from_center - best_normal * (best_dist + best_depth));
+  new_entry->set_contact_pos(from_center);
+  new_entry->set_contact_normal(best_normal);
+  new_entry->set_t(1.0f);
+
+  return new_entry;
+}
+
+/**
+ *
+ */
+PT(CollisionEntry) CollisionHeightfield::
+test_intersection_from_line(const CollisionEntry &entry) const {
+  const CollisionLine *line;
+  DCAST_INTO_R(line, entry.get_from(), nullptr);
+
+  const LMatrix4 &wrt_mat = entry.get_wrt_mat();
+
+  LPoint3 from_origin = line->get_origin() * wrt_mat;
+  LVector3 from_direction = line->get_direction() * wrt_mat;
+
+  Triangle tri;
+  PN_stdfloat t;
+  if (!find_nearest_hit(tri, t, from_origin, from_direction,
+                        -FLT_MAX, FLT_MAX)) {
+    return nullptr;
+  }
+
+  return make_line_entry(entry, line, tri, t, from_origin, from_direction);
+}
+
+/**
+ *
+ */
+PT(CollisionEntry) CollisionHeightfield::
+test_intersection_from_ray(const CollisionEntry &entry) const {
+  const CollisionRay *ray;
+  DCAST_INTO_R(ray, entry.get_from(), nullptr);
+
+  const LMatrix4 &wrt_mat = entry.get_wrt_mat();
+
+  LPoint3 from_origin = ray->get_origin() * wrt_mat;
+  LVector3 from_direction = ray->get_direction() * wrt_mat;
+
+  Triangle tri;
+  PN_stdfloat t;
+  if (!find_nearest_hit(tri, t, from_origin, from_direction,
+                        0.0f, FLT_MAX)) {
+    return nullptr;
+  }
+
+  return make_line_entry(entry, ray, tri, t, from_origin, from_direction);
+}
+
+/**
+ *
+ */
+PT(CollisionEntry) CollisionHeightfield::
+test_intersection_from_segment(const CollisionEntry &entry) const {
+  const CollisionSegment *segment;
+  DCAST_INTO_R(segment, entry.get_from(), nullptr);
+
+  const LMatrix4 &wrt_mat = entry.get_wrt_mat();
+
+  LPoint3 from_a = segment->get_point_a() * wrt_mat;
+  LPoint3 from_b = segment->get_point_b() * wrt_mat;
+  LVector3 from_direction = from_b - from_a;
+
+  Triangle tri;
+  PN_stdfloat t;
+  if (!find_nearest_hit(tri, t, from_a, from_direction, 0.0f, 1.0f)) {
+    return nullptr;
+  }
+
+  return make_line_entry(entry, segment, tri, t, from_a, from_direction);
+}
+
+/**
+ * Double dispatch point for box as a FROM object
+ */
+PT(CollisionEntry) CollisionHeightfield::
+test_intersection_from_box(const CollisionEntry &entry) const {
+  const CollisionBox *box;
+  DCAST_INTO_R(box, entry.get_from(), nullptr);
+
+  const LMatrix4 &wrt_mat = entry.get_wrt_mat();
+
+  LPoint3 from_center = box->get_center() * wrt_mat;
+  LVector3 from_extents = box->get_dimensions() * 0.5f;
+
+  // Determine the half-axes describing the box in the space of the
+  // heightfield.
+  LVector3 box_x = wrt_mat.get_row3(0) * from_extents[0];
+  LVector3 box_y = wrt_mat.get_row3(1) * from_extents[1];
+  LVector3 box_z = wrt_mat.get_row3(2) * from_extents[2];
+  const LVector3 *box_axes[3] = {&box_x, &box_y, &box_z};
+
+  LVector3 extent(cabs(box_x[0]) + cabs(box_y[0]) + cabs(box_z[0]),
+                  cabs(box_x[1]) + cabs(box_y[1]) + cabs(box_z[1]),
+                  cabs(box_x[2]) + cabs(box_y[2]) + cabs(box_z[2]));
+  pvector<int> cells;
+  find_cells(cells, from_center - extent, from_center + extent);
+
+  int cells_x = _x_size - 1;
+  bool found = false;
+  Triangle best_tri;
+  PN_stdfloat best_depth = 0.0f;
+  LPoint3 best_interior;
+  LVector3 best_normal = LVector3::zero();
+
+  pvector<int>::const_iterator ci;
+  for (ci = cells.begin(); ci != cells.end(); ++ci) {
+    int x = (*ci) % cells_x;
+    int y = (*ci) / cells_x;
+    for (int half = 0; half < 2; ++half) {
+      Triangle tri;
+      get_triangle(tri, x, y, half);
+      const LPoint3 &a = tri._v[0];
+      const LPoint3 &b = tri._v[1];
+      const LPoint3 &c = tri._v[2];
+
+      LVector3 normal = (b - a).cross(c - a);
+      if (!normal.normalize()) {
+        continue;
+      }
+
+      // A box whose center is below the surface is inside the terrain, even
+      // if it does not reach the triangle above it.  Otherwise, look for a
+      // separating axis among the triangle normal, the box axes and the cross
+      // products of the box axes with the triangle edges.
+      if ((from_center - a).dot(normal) >= 0.0f ||
+          !hfield_is_over_triangle(from_center, x, y, half)) {
+        bool separated = hfield_box_axis_separates
+          (normal, a, b, c, from_center, box_x, box_y, box_z);
+        for (int i = 0; i < 3 && !separated; ++i) {
+          separated = hfield_box_axis_separates
+            (*box_axes[i], a, b, c, from_center, box_x, box_y, box_z);
+        }
+
+        LVector3 edges[3] = {b - a, c - b, a - c};
+        for (int i = 0; i < 3 && !separated; ++i) {
+          for (int e = 0; e < 3 && !separated; ++e) {
+            separated = hfield_box_axis_separates
+              (box_axes[i]->cross(edges[e]), a, b, c,
+               from_center, box_x, box_y, box_z);
+          }
+        }
+        if (separated) {
+          continue;
+        }
+      }
+
+      // The deepest corner of the box, with respect to the triangle's plane,
+      // determines how far it must be pushed out.
+      LPoint3 corner = from_center;
+      corner -= (box_x.dot(normal) > 0.0f) ? box_x : -box_x;
+      corner -= (box_y.dot(normal) > 0.0f) ? box_y : -box_y;
+      corner -= (box_z.dot(normal) > 0.0f) ? box_z : -box_z;
+      PN_stdfloat depth = -(corner - a).dot(normal);
+
+      if (!found || depth > best_depth) {
+        found = true;
+        best_tri = tri;
+        best_depth = depth;
+        best_interior = corner;
+        best_normal = normal;
+      }
+    }
+  }
+
+  if (!found) {
+    return nullptr;
+  }
+
+  if (collide_cat.is_debug()) {
+    collide_cat.debug()
+      << "intersection detected from " << entry.get_from_node_path()
+      << " into " << entry.get_into_node_path() << "\n";
+  }
+  PT(CollisionEntry) new_entry = new CollisionEntry(entry);
+
+  new_entry->set_surface_normal(get_surface_normal(best_tri, box));
+  new_entry->set_surface_point(best_interior + best_normal * best_depth);
+  new_entry->set_interior_point(best_interior);
+
+  return new_entry;
+}
+
+/**
+ * Fills the _viz_geom GeomNode up with Geoms suitable for rendering this
+ * solid.
+ */
+void CollisionHeightfield::
+fill_viz_geom() {
+  if (collide_cat.is_debug()) {
+    collide_cat.debug()
+      << "Recomputing viz for " << *this << "\n";
+  }
+
+  if (_samples.empty()) {
+    return;
+  }
+
+  PT(GeomVertexData) vdata = new GeomVertexData
+    ("collision", GeomVertexFormat::get_v3(),
+     Geom::UH_static);
+  vdata->unclean_set_num_rows(_samples.size());
+  GeomVertexWriter vertex(vdata, InternalName::get_vertex());
+
+  for (int y = 0; y < _y_size; ++y) {
+    for (int x = 0; x < _x_size; ++x) {
+      vertex.set_data3(x, y, get_raw_sample(x, y) * _max_height);
+    }
+  }
+
+  PT(GeomTriangles) mesh = new GeomTriangles(Geom::UH_static);
+  for (int y = 0; y < _y_size - 1; ++y) {
+    for (int x = 0; x < _x_size - 1; ++x) {
+      int v00 = y * _x_size + x;
+      int v10 = v00 + 1;
+      int v01 = v00 + _x_size;
+      int v11 = v01 + 1;
+      mesh->add_vertices(v00, v10, v11);
+      mesh->add_vertices(v00, v11, v01);
+    }
+  }
+
+  PT(Geom) geom = new Geom(vdata);
+  geom->add_primitive(mesh);
+  _viz_geom->add_geom(geom, get_solid_viz_state());
+  _viz_geom->add_geom(geom, get_wireframe_viz_state());
+
+  _bounds_viz_geom->add_geom(geom, get_solid_bounds_viz_state());
+  _bounds_viz_geom->add_geom(geom, get_wireframe_bounds_viz_state());
+}
+
+/**
+ * Fills in the indicated half of the square between the samples (x, y) and
+ * (x + 1, y + 1).  The first half is the triangle below the diagonal, the
+ * second the one above it; both face up.
+ */
+void CollisionHeightfield::
+get_triangle(Triangle &tri, int x, int y, int half) const {
+  tri._v[0].set(x, y, get_raw_sample(x, y) * _max_height);
+  if (half == 0) {
+    tri._v[1].set(x + 1, y, get_raw_sample(x + 1, y) * _max_height);
+    tri._v[2].set(x + 1, y + 1, get_raw_sample(x + 1, y + 1) * _max_height);
+  } else {
+    tri._v[1].set(x + 1, y + 1, get_raw_sample(x + 1, y + 1) * _max_height);
+    tri._v[2].set(x, y + 1, get_raw_sample(x, y + 1) * _max_height);
+  }
+}
+
+/**
+ * Rebuilds the quadtree of minimum and maximum heights from the samples.
+ */
+void CollisionHeightfield::
+build_quadtree() {
+  _levels.clear();
+
+  int cells_x = _x_size - 1;
+  int cells_y = _y_size - 1;
+  if (cells_x <= 0 || cells_y <= 0) {
+    return;
+  }
+
+  // The lowest level is computed from the samples.  Its cells share the
+  // samples along their edges.
+  Level leaves;
+  leaves._shift = hfield_leaf_shift;
+  leaves._x_size = ((cells_x - 1) >> hfield_leaf_shift) + 1;
+  leaves._y_size = ((cells_y - 1) >> hfield_leaf_shift) + 1;
+  leaves._cells.resize(leaves._x_size * leaves._y_size);
+
+  for (int ly = 0; ly < leaves._y_size; ++ly) {
+    int y0 = ly << hfield_leaf_shift;
+    int y1 = min(y0 + (1 << hfield_leaf_shift), cells_y);
+    for (int lx = 0; lx < leaves._x_size; ++lx) {
+      int x0 = lx << hfield_leaf_shift;
+      int x1 = min(x0 + (1 << hfield_leaf_shift), cells_x);
+
+      MinMax &mm = leaves._cells[ly * leaves._x_size + lx];
+      mm._min = mm._max = get_raw_sample(x0, y0);
+      for (int y = y0; y <= y1; ++y) {
+        for (int x = x0; x <= x1; ++x) {
+          float h = get_raw_sample(x, y);
+          mm._min = min(mm._min, h);
+          mm._max = max(mm._max, h);
+        }
+      }
+    }
+  }
+  _levels.push_back(leaves);
+
+  // Each level above combines two by two cells of the one below, until a
+  // single cell covers the whole heightfield.
+  while (_levels.back()._x_size > 1 || _levels.back()._y_size > 1) {
+    Level next;
+    next._shift = _levels.back()._shift + 1;
+    next._x_size = (_levels.back()._x_size + 1) / 2;
+    next._y_size = (_levels.back()._y_size + 1) / 2;
+    next._cells.resize(next._x_size * next._y_size);
+
+    const Level &below = _levels.back();
+    for (int ny = 0; ny < next._y_size; ++ny) {
+      for (int nx = 0; nx < next._x_size; ++nx) {
+        MinMax &mm = next._cells[ny * next._x_size + nx];
+        mm = below._cells[(ny * 2) * below._x_size + nx * 2];
+        for (int i = 0; i < 4; ++i) {
+          int bx = nx * 2 + (i & 1);
+          int by = ny * 2 + (i >> 1);
+          if (bx < below._x_size && by < below._y_size) {
+            const MinMax &child = below._cells[by * below._x_size + bx];
+            mm._min = min(mm._min, child._min);
+            mm._max = max(mm._max, child._max);
+          }
+        }
+      }
+    }
+    _levels.push_back(std::move(next));
+  }
+}
+
+/**
+ * Finds the triangle intersected by the line origin + t * direction with the
+ * smallest t in the range [min_t, max_t].  Returns true if there is one, and
+ * fills in hit and t.
+ */
+bool CollisionHeightfield::
+find_nearest_hit(Triangle &hit, PN_stdfloat &t,
+                 const LPoint3 &origin, const LVector3 &direction,
+                 PN_stdfloat min_t, PN_stdfloat max_t) const {
+  if (_levels.empty()) {
+    return false;
+  }
+
+  t = max_t;
+  return r_find_nearest_hit(hit, t, (int)_levels.size() - 1, 0, 0,
+                            origin, direction, min_t);
+}
+
+/**
+ * The recursive implementation of find_nearest_hit().  Tests the line against
+ * the indicated cell of the indicated level of the quadtree, and updates hit
+ * and t if it finds a nearer intersection than t.
+ */
+bool CollisionHeightfield::
+r_find_nearest_hit(Triangle &hit, PN_stdfloat &t, int level, int cx, int cy,
+                   const LPoint3 &origin, const LVector3 &direction,
+                   PN_stdfloat min_t) const {
+  const Level &lev = _levels[level];
+  const MinMax &mm = lev._cells[cy * lev._x_size + cx];
+
+  int x0 = cx << lev._shift;
+  int y0 = cy << lev._shift;
+  int x1 = min(x0 + (1 << lev._shift), _x_size - 1);
+  int y1 = min(y0 + (1 << lev._shift), _y_size - 1);
+  PN_stdfloat z0 = mm._min * _max_height;
+  PN_stdfloat z1 = mm._max * _max_height;
+
+  LPoint3 min_point(x0, y0, min(z0, z1));
+  LPoint3 max_point(x1, y1, max(z0, z1));
+  LVector3 pad(hfield_box_pad, hfield_box_pad, hfield_box_pad);
+
+  PN_stdfloat t0 = min_t;
+  PN_stdfloat t1 = t;
+  if (!clip_line(t0, t1, min_point - pad, max_point + pad, origin, direction)) {
+    return false;
+  }
+
+  bool found = false;
+  if (level == 0) {
+    for (int y = y0; y < y1; ++y) {
+      for (int x = x0; x < x1; ++x) {
+        for (int half = 0; half < 2; ++half) {
+          Triangle tri;
+          get_triangle(tri, x, y, half);
+          PN_stdfloat hit_t;
+          if (hfield_intersects_ray(hit_t, tri._v[0], tri._v[1], tri._v[2],
+                                    origin, direction) &&
+              hit_t >= min_t && hit_t <= t) {
+            hit = tri;
+            t = hit_t;
+            found = true;
+          }
+        }
+      }
+    }
+    return found;
+  }
+
+  // Visit the children nearest the start of the line first, so that the
+  // farther ones are skipped once something has been hit.
+  const Level &below = _levels[level - 1];
+  int flip_x = (direction[0] < 0.0f) ? 1 : 0;
+  int flip_y = (direction[1] < 0.0f) ? 1 : 0;
+  for (int i = 0; i < 4; ++i) {
+    int bx = cx * 2 + ((i & 1) ^ flip_x);
+    int by = cy * 2 + ((i >> 1) ^ flip_y);
+    if (bx < below._x_size && by < below._y_size) {
+      if (r_find_nearest_hit(hit, t, level - 1, bx, by,
+                             origin, direction, min_t)) {
+        found = true;
+      }
+    }
+  }
+  return found;
+}
+
+/**
+ * Clips the range [t0, t1] of the line origin + t * direction to the
+ * indicated box.  Returns false if nothing is left.
+ */
+bool CollisionHeightfield::
+clip_line(PN_stdfloat &t0, PN_stdfloat &t1,
+          const LPoint3 &min_point, const LPoint3 &max_point,
+          const LPoint3 &origin, const LVector3 &direction) const {
+  for (int i = 0; i < 3; ++i) {
+    if (cabs(direction[i]) < 1.0e-12f) {
+      if (origin[i] < min_point[i] || origin[i] > max_point[i]) {
+        return false;
+      }
+    } else {
+      PN_stdfloat inv = 1.0f / direction[i];
+      PN_stdfloat near_t = (min_point[i] - origin[i]) * inv;
+      PN_stdfloat far_t = (max_point[i] - origin[i]) * inv;
+      if (near_t > far_t) {
+        std::swap(near_t, far_t);
+      }
+      t0 = max(t0, near_t);
+      t1 = min(t1, far_t);
+      if (t0 > t1) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * Fills result with the indices of all squares of the heightfield that
+ * overlap the indicated box in X and Y, and which are not entirely below the
+ * bottom of the box.  The triangles themselves are not tested.
+ */
+void CollisionHeightfield::
+find_cells(pvector<int> &result, const LPoint3 &min_point,
+           const LPoint3 &max_point) const {
+  if (_levels.empty()) {
+    return;
+  }
+
+  int cells_x = _x_size - 1;
+  int cells_y = _y_size - 1;
+  if (max_point[0] < 0.0f || max_point[1] < 0.0f ||
+      min_point[0] > cells_x || min_point[1] > cells_y) {
+    return;
+  }
+
+  int x0 = (int)cfloor(max(min_point[0], (PN_stdfloat)0.0f));
+  int y0 = (int)cfloor(max(min_point[1], (PN_stdfloat)0.0f));
+  int x1 = min((int)cfloor(min(max_point[0], (PN_stdfloat)cells_x)), cells_x - 1);
+  int y1 = min((int)cfloor(min(max_point[1], (PN_stdfloat)cells_y)), cells_y - 1);
+
+  r_find_cells(result, (int)_levels.size() - 1, 0, 0, x0, y0, x1, y1,
+               min_point[2] - hfield_box_pad);
+}
+
+/**
+ * The recursive implementation of find_cells().  x0, y0, x1 and y1 give the
+ * inclusive range of squares being looked for.
+ */
+void CollisionHeightfield::
+r_find_cells(pvector<int> &result, int level, int cx, int cy,
+             int x0, int y0, int x1, int y1, float min_z) const {
+  const Level &lev = _levels[level];
+  const MinMax &mm = lev._cells[cy * lev._x_size + cx];
+
+  int nx0 = cx << lev._shift;
+  int ny0 = cy << lev._shift;
+  int nx1 = min(nx0 + (1 << lev._shift), _x_size - 1) - 1;
+  int ny1 = min(ny0 + (1 << lev._shift), _y_size - 1) - 1;
+  if (nx0 > x1 || nx1 < x0 || ny0 > y1 || ny1 < y0) {
+    return;
+  }
+
+  // Everything below the surface is solid, so only a region that is entirely
+  // below the box can be skipped.
+  if (max(mm._min * _max_height, mm._max * _max_height) < min_z) {
+    return;
+  }
+
+  if (level == 0) {
+    int cells_x = _x_size - 1;
+    for (int y = max(ny0, y0); y <= min(ny1, y1); ++y) {
+      for (int x = max(nx0, x0); x <= min(nx1, x1); ++x) {
+        result.push_back(y * cells_x + x);
+      }
+    }
+    return;
+  }
+
+  const Level &below = _levels[level - 1];
+  for (int i = 0; i < 4; ++i) {
+    int bx = cx * 2 + (i & 1);
+    int by = cy * 2 + (i >> 1);
+    if (bx < below._x_size && by < below._y_size) {
+      r_find_cells(result, level - 1, bx, by, x0, y0, x1, y1, min_z);
+    }
+  }
+}
+
+/**
+ * Constructs the CollisionEntry for a ray, line or segment that hits the
+ * indicated triangle at the indicated parametric point.
+ */
+PT(CollisionEntry) CollisionHeightfield::
+make_line_entry(const CollisionEntry &entry, const CollisionSolid *from,
+                const Triangle &tri, PN_stdfloat t, const LPoint3 &origin,
+                const LVector3 &direction) const {
+  if (collide_cat.is_debug()) {
+    collide_cat.debug()
+      << "intersection detected from " << entry.get_from_node_path()
+      << " into " << entry.get_into_node_path() << "\n";
+  }
+  PT(CollisionEntry) new_entry = new CollisionEntry(entry);
+
+  new_entry->set_surface_normal(get_surface_normal(tri, from));
+  new_entry->set_surface_point(origin + t * direction);
+
+  return new_entry;
+}
+
+/**
+ * Returns the normal that should be reported for a collision with the
+ * indicated triangle: either the effective normal, if it is set and the from
+ * solid respects it, or the triangle's own normal.
+ */
+LVector3 CollisionHeightfield::
+get_surface_normal(const Triangle &tri, const CollisionSolid *from) const {
+  if (has_effective_normal() && from->get_respect_effective_normal()) {
+    return get_effective_normal();
+  }
+  LVector3 normal = (tri._v[1] - tri._v[0]).cross(tri._v[2] - tri._v[0]);
+  normal.normalize();
+  return normal;
+}
+
+/**
+ * Tells the BamReader how to create objects of type CollisionHeightfield.
+ */
+void CollisionHeightfield::
+register_with_read_factory() {
+  BamReader::get_factory()->register_factory(get_class_type(), make_CollisionHeightfield);
+}
+
+/**
+ * Writes the contents of this object to the datagram for shipping out to a
+ * Bam file.
+ */
+void CollisionHeightfield::
+write_datagram(BamWriter *manager, Datagram &me) {
+  CollisionSolid::write_datagram(manager, me);
+  me.add_uint32(_x_size);
+  me.add_uint32(_y_size);
+  me.add_stdfloat(_max_height);
+  for (size_t i = 0; i < _samples.size(); ++i) {
+    me.add_float32(_samples[i]);
+  }
+}
+
+/**
+ * This function is called by the BamReader's factory when a new object of
+ * type CollisionHeightfield is encountered in the Bam file.  It should create
+ * the CollisionHeightfield and extract its information from the file.
+ */
+TypedWritable *CollisionHeightfield::
+make_CollisionHeightfield(const FactoryParams &params) {
+  CollisionHeightfield *me = new CollisionHeightfield;
+  DatagramIterator scan;
+  BamReader *manager;
+
+  parse_params(params, scan, manager);
+  me->fillin(scan, manager);
+  return me;
+}
+
+/**
+ * This internal function is called by make_CollisionHeightfield to read in
+ * all of the relevant data from the BamFile for the new CollisionHeightfield.
+ * The quadtree is not stored; it is rebuilt from the samples.
+ */
+void CollisionHeightfield::
+fillin(DatagramIterator &scan, BamReader *manager) {
+  CollisionSolid::fillin(scan, manager);
+  _x_size = scan.get_uint32();
+  _y_size = scan.get_uint32();
+  _max_height = scan.get_stdfloat();
+  _samples.resize((size_t)_x_size * (size_t)_y_size);
+  for (size_t i = 0; i < _samples.size(); ++i) {
+    _samples[i] = scan.get_float32();
+  }
+  build_quadtree();
+}
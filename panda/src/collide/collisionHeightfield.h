@@ -0,0 +1,195 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file collisionHeightfield.h
+ * @author agent
+ * @date 2026-10-18
+ */
+
+#ifndef COLLISIONHEIGHTFIELD_H
+#define COLLISIONHEIGHTFIELD_H
+
+#include "pandabase.h"
+
+#include "collisionSolid.h"
+#include "pnmImage.h"
+#include "pvector.h"
+
+class Texture;
+
+/**
+ * A solid representing terrain, whose elevation is sampled from a heightfield
+ * image.  Rather than storing a polygon per triangle, only one height per
+ * pixel is stored, along with a small quadtree of the minimum and maximum
+ * heights of each region of the image, which is used to quickly discard the
+ * parts of the terrain that cannot be touched by a given solid.
+ *
+ * The heightfield is laid out in the same way as it is by GeoMipTerrain: the
+ * pixel at column x, row y is found at (x, y_size - 1 - y), one unit apart,
+ * so that the image appears the right way up when viewed from above.  The
+ * brightness of a pixel (or, for a color image, the red, green and blue
+ * channels taken as one high-precision value) is multiplied by the max_height
+ * to give its elevation.  Each square between four pixels is split into two
+ * triangles, the same way for every square.  Scale the node to change the
+ * spacing of the pixels.
+ *
+ * Rays, lines, segments, spheres and boxes may be tested against a
+ * CollisionHeightfield, and each test reports at most one CollisionEntry.
+ * Everything below the surface is considered to be inside the solid, so
+ * spheres and boxes are always pushed back up out of the terrain.
+ */
+class EXPCL_PANDA_COLLIDE CollisionHeightfield : public CollisionSolid {
+PUBLISHED:
+  explicit CollisionHeightfield(const PNMImage &heightfield,
+                                PN_stdfloat max_height = 1.0f);
+
+  void set_heightfield(const PNMImage &heightfield);
+  bool set_heightfield(const Texture *tex);
+
+  INLINE int get_x_size() const;
+  INLINE int get_y_size() const;
+
+  INLINE void set_max_height(PN_stdfloat max_height);
+  INLINE PN_stdfloat get_max_height() const;
+
+  PN_stdfloat get_height(PN_stdfloat x, PN_stdfloat y) const;
+  INLINE PN_stdfloat get_sample(int x, int y) const;
+
+  virtual LPoint3 get_collision_origin() const;
+
+PUBLISHED:
+  MAKE_PROPERTY(x_size, get_x_size);
+  MAKE_PROPERTY(y_size, get_y_size);
+  MAKE_PROPERTY(max_height, get_max_height, set_max_height);
+
+protected:
+  INLINE CollisionHeightfield();
+
+public:
+  CollisionHeightfield(const CollisionHeightfield &copy);
+  virtual CollisionSolid *make_copy();
+
+  virtual void xform(const LMatrix4 &mat);
+
+  virtual PStatCollector &get_volume_pcollector();
+  virtual PStatCollector &get_test_pcollector();
+
+  virtual void output(std::ostream &out) const;
+  virtual void write(std::ostream &out, int indent_level = 0) const;
+
+  INLINE static void flush_level();
+
+protected:
+  virtual PT(BoundingVolume) compute_internal_bounds() const;
+
+  virtual PT(CollisionEntry)
+    test_intersection_from_sphere(const CollisionEntry &entry) const;
+  virtual PT(CollisionEntry)
+    test_intersection_from_line(const CollisionEntry &entry) const;
+  virtual PT(CollisionEntry)
+    test_intersection_from_ray(const CollisionEntry &entry) const;
+  virtual PT(CollisionEntry)
+    test_intersection_from_segment(const CollisionEntry &entry) const;
+  virtual PT(CollisionEntry)
+    test_intersection_from_box(const CollisionEntry &entry) const;
+
+  virtual void fill_viz_geom();
+
+private:
+  // The lowest and highest unscaled sample within one region of the
+  // heightfield.
+  class MinMax {
+  public:
+    float _min;
+    float _max;
+  };
+  typedef pvector<MinMax> MinMaxes;
+
+  // One level of the quadtree.  The cells of the lowest level each cover
+  // cells_per_leaf by cells_per_leaf squares of the heightfield; each cell of
+  // the next level covers two by two cells of the one below it.
+  class Level {
+  public:
+    int _x_size;
+    int _y_size;
+    int _shift;
+    MinMaxes _cells;
+  };
+  typedef pvector<Level> Levels;
+
+  // A triangle of the surface, which is the one that was hit by a test.
+  class Triangle {
+  public:
+    LPoint3 _v[3];
+  };
+
+  INLINE float get_raw_sample(int x, int y) const;
+  void get_triangle(Triangle &tri, int x, int y, int half) const;
+  void build_quadtree();
+
+  bool find_nearest_hit(Triangle &hit, PN_stdfloat &t,
+                        const LPoint3 &origin, const LVector3 &direction,
+                        PN_stdfloat min_t, PN_stdfloat max_t) const;
+  bool r_find_nearest_hit(Triangle &hit, PN_stdfloat &t, int level,
+                          int cx, int cy, const LPoint3 &origin,
+                          const LVector3 &direction, PN_stdfloat min_t) const;
+  bool clip_line(PN_stdfloat &t0, PN_stdfloat &t1,
+                 const LPoint3 &min_point, const LPoint3 &max_point,
+                 const LPoint3 &origin, const LVector3 &direction) const;
+
+  void find_cells(pvector<int> &result, const LPoint3 &min_point,
+                  const LPoint3 &max_point) const;
+  void r_find_cells(pvector<int> &result, int level, int cx, int cy,
+                    int x0, int y0, int x1, int y1, float min_z) const;
+
+  PT(CollisionEntry) make_line_entry(const CollisionEntry &entry,
+                                     const CollisionSolid *from,
+                                     const Triangle &tri, PN_stdfloat t,
+                                     const LPoint3 &origin,
+                                     const LVector3 &direction) const;
+  LVector3 get_surface_normal(const Triangle &tri,
+                              const CollisionSolid *from) const;
+
+private:
+  int _x_size;
+  int _y_size;
+  PN_stdfloat _max_height;
+  pvector<float> _samples;
+  Levels _levels;
+
+  static PStatCollector _volume_pcollector;
+  static PStatCollector _test_pcollector;
+
+protected:
+  void fillin(DatagramIterator &scan, BamReader *manager);
+
+public:
+  static void register_with_read_factory();
+  virtual void write_datagram(BamWriter *manager, Datagram &me);
+
+  static TypedWritable *make_CollisionHeightfield(const FactoryParams &params);
+  static TypeHandle get_class_type() {
+    return _type_handle;
+  }
+  static void init_type() {
+    CollisionSolid::init_type();
+    register_type(_type_handle, "CollisionHeightfield",
+                  CollisionSolid::get_class_type());
+  }
+  virtual TypeHandle get_type() const {
+    return get_class_type();
+  }
+  virtual TypeHandle force_init_type() {init_type(); return get_class_type();}
+
+private:
+  static TypeHandle _type_handle;
+};
+
+#include "collisionHeightfield.I"
+
+#endif
@@ -0,0 +1,1141 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file collisionMesh.cxx
+ * @author agent
+ * @date 2026-10-18
+ */
+
+#include "collisionMesh.h"
+#include "collisionEntry.h"
+#include "collisionSphere.h"
+#include "collisionLine.h"
+#include "collisionRay.h"
+#include "collisionSegment.h"
+#include "collisionTube.h"
+#include "collisionBox.h"
+#include "config_collide.h"
+#include "lightMutexHolder.h"
+#include "geomNode.h"
+#include "geom.h"
+#include "geomPrimitive.h"
+#include "geomTriangles.h"
+#include "geomLinestrips.h"
+#include "geomVertexReader.h"
+#include "geomVertexWriter.h"
+#include "datagram.h"
+#include "datagramIterator.h"
+#include "bamReader.h"
+#include "bamWriter.h"
+#include "boundingBox.h"
+#include "indent.h"
+#include <algorithm>
+
+using std::max;
+using std::min;
+
+PStatCollector CollisionMesh::_volume_pcollector("Collision Volumes:CollisionMesh");
+PStatCollector CollisionMesh::_test_pcollector("Collision Tests:CollisionMesh");
+TypeHandle CollisionMesh::_type_handle;
+
+// The maximum number of triangles stored in a leaf of the BVH.
+static const int max_triangles_per_leaf = 4;
+
+/**
+ * Orders triangle indices by the position of their centroids along one axis,
+ * for splitting a node of the BVH.
+ */
+class CollisionMeshCentroidCompare {
+public:
+  CollisionMeshCentroidCompare(const pvector<LPoint3> &centroids, int axis) :
+    _centroids(centroids), _axis(axis) {}
+
+  bool operator () (int a, int b) const {
+    return _centroids[a][_axis] < _centroids[b][_axis];
+  }
+
+private:
+  const pvector<LPoint3> &_centroids;
+  int _axis;
+};
+
+/**
+ * Computes the closest points between the segments p1-q1 and p2-q2, storing
+ * them in c1 and c2.
+ */
+static void
+mesh_closest_points_segments(LPoint3 &c1, LPoint3 &c2,
+                             const LPoint3 &p1, const LPoint3 &q1,
+                             const LPoint3 &p2, const LPoint3 &q2) {
+  LVector3 d1 = q1 - p1;
+  LVector3 d2 = q2 - p2;
+  LVector3 r = p1 - p2;
+  PN_stdfloat a = d1.dot(d1);
+  PN_stdfloat e = d2.dot(d2);
+  PN_stdfloat f = d2.dot(r);
+
+  PN_stdfloat s, t;
+  if (a <= FLT_EPSILON && e <= FLT_EPSILON) {
+    s = t = 0.0f;
+  } else if (a <= FLT_EPSILON) {
+    s = 0.0f;
+    t = min(max(f / e, (PN_stdfloat)0.0f), (PN_stdfloat)1.0f);
+  } else {
+    PN_stdfloat c = d1.dot(r);
+    if (e <= FLT_EPSILON) {
+      t = 0.0f;
+      s = min(max(-c / a, (PN_stdfloat)0.0f), (PN_stdfloat)1.0f);
+    } else {
+      PN_stdfloat b = d1.dot(d2);
+      PN_stdfloat denom = a * e - b * b;
+      if (denom != 0.0f) {
+        s = min(max((b * f - c * e) / denom, (PN_stdfloat)0.0f), (PN_stdfloat)1.0f);
+      } else {
+        s = 0.0f;
+      }
+      t = (b * s + f) / e;
+      if (t < 0.0f) {
+        t = 0.0f;
+        s = min(max(-c / a, (PN_stdfloat)0.0f), (PN_stdfloat)1.0f);
+      } else if (t > 1.0f) {
+        t = 1.0f;
+        s = min(max((b - c) / a, (PN_stdfloat)0.0f), (PN_stdfloat)1.0f);
+      }
+    }
+  }
+
+  c1 = p1 + d1 * s;
+  c2 = p2 + d2 * t;
+}
+
+/**
+ * Returns true if the indicated axis separates the triangle a, b, c from the
+ * oriented box with the given center and half-axes.
+ */
+static bool
+mesh_box_axis_separates(const LVector3 &axis,
+                        const LPoint3 &a, const LPoint3 &b, const LPoint3 &c,
+                        const LPoint3 &center, const LVector3 &box_x,
+                        const LVector3 &box_y, const LVector3 &box_z) {
+  if (axis.length_squared() < 1.0e-12f) {
+    // Degenerate axis, from the cross product of two parallel vectors.
+    return false;
+  }
+  PN_stdfloat pa = axis.dot(a);
+  PN_stdfloat pb = axis.dot(b);
+  PN_stdfloat pc = axis.dot(c);
+  PN_stdfloat tri_min = min(min(pa, pb), pc);
+  PN_stdfloat tri_max = max(max(pa, pb), pc);
+
+  PN_stdfloat box_center = axis.dot(center);
+  PN_stdfloat box_radius =
+    cabs(axis.dot(box_x)) + cabs(axis.dot(box_y)) + cabs(axis.dot(box_z));
+
+  return (box_center - box_radius > tri_max || box_center + box_radius < tri_min);
+}
+
+/**
+ * Creates a mesh containing all of the triangles of all of the Geoms of the
+ * indicated GeomNode.
+ */
+CollisionMesh::
+CollisionMesh(const GeomNode *node) : _bvh_stale(true) {
+  add_geom_node(node);
+}
+
+/**
+ *
+ */
+CollisionMesh::
+CollisionMesh(const CollisionMesh &copy) :
+  CollisionSolid(copy),
+  _vertices(copy._vertices),
+  _triangles(copy._triangles),
+  _bvh_stale(true)
+{
+}
+
+/**
+ *
+ */
+CollisionSolid *CollisionMesh::
+make_copy() {
+  return new CollisionMesh(*this);
+}
+
+/**
+ * Adds all of the triangles of the indicated Geom to the mesh, transformed by
+ * the indicated matrix.  Primitives other than triangles are ignored.
+ */
+void CollisionMesh::
+add_geom(const Geom *geom, const LMatrix4 &mat) {
+  nassertv(geom != nullptr);
+  if (geom->get_primitive_type() != Geom::PT_polygons) {
+    return;
+  }
+
+  CPT(Geom) tris = geom->decompose();
+  CPT(GeomVertexData) vdata = tris->get_vertex_data();
+  if (!vdata->has_column(InternalName::get_vertex())) {
+    return;
+  }
+
+  // Collect and check all of the triangles first, so that a bad index
+  // doesn't leave the mesh half-modified.
+  int first_vertex = (int)_vertices.size();
+  int num_vertices = vdata->get_num_rows();
+  Triangles triangles;
+  for (size_t i = 0; i < tris->get_num_primitives(); ++i) {
+    CPT(GeomPrimitive) prim = tris->get_primitive(i);
+    int num_prim_vertices = prim->get_num_vertices();
+    for (int vi = 0; vi + 2 < num_prim_vertices; vi += 3) {
+      Triangle tri;
+      for (int k = 0; k < 3; ++k) {
+        int index = prim->get_vertex(vi + k);
+        nassertv(index >= 0 && index < num_vertices);
+        tri._v[k] = first_vertex + index;
+      }
+      triangles.push_back(tri);
+    }
+  }
+
+  GeomVertexReader vertex(vdata, InternalName::get_vertex());
+  while (!vertex.is_at_end()) {
+    _vertices.push_back(mat.xform_point(vertex.get_data3()));
+  }
+  _triangles.insert(_triangles.end(), triangles.begin(), triangles.end());
+
+  mark_bvh_stale();
+  mark_internal_bounds_stale();
+  mark_viz_stale();
+}
+
+/**
+ * Adds all of the triangles of all of the Geoms of the indicated GeomNode to
+ * the mesh, transformed by the indicated matrix.  The transform of the
+ * GeomNode itself is not applied.
+ */
+void CollisionMesh::
+add_geom_node(const GeomNode *node, const LMatrix4 &mat) {
+  nassertv(node != nullptr);
+  int num_geoms = node->get_num_geoms();
+  for (int i = 0; i < num_geoms; ++i) {
+    add_geom(node->get_geom(i), mat);
+  }
+}
+
+/**
+ * Transforms the solid by the indicated matrix.
+ */
+void CollisionMesh::
+xform(const LMatrix4 &mat) {
+  Vertices::iterator vi;
+  for (vi = _vertices.begin(); vi != _vertices.end(); ++vi) {
+    (*vi) = (*vi) * mat;
+  }
+  mark_bvh_stale();
+  CollisionSolid::xform(mat);
+}
+
+/**
+ * Returns the point in space deemed to be the "origin" of the solid for
+ * collision purposes.  The closest intersection point to this origin point is
+ * considered to be the most significant.
+ */
+LPoint3 CollisionMesh::
+get_collision_origin() const {
+  // There is no sensible origin for an arbitrary mesh; use the center of its
+  // bounding box.
+  if (_vertices.empty()) {
+    return LPoint3::origin();
+  }
+  CPT(BoundingVolume) bounds = get_bounds();
+  const BoundingBox *box = bounds->as_bounding_box();
+  if (box == nullptr || box->is_empty()) {
+    return LPoint3::origin();
+  }
+  return box->get_approx_center();
+}
+
+/**
+ * Returns a PStatCollector that is used to count the number of bounding
+ * volume tests made against a solid of this type in a given frame.
+ */
+PStatCollector &CollisionMesh::
+get_volume_pcollector() {
+  return _volume_pcollector;
+}
+
+/**
+ * Returns a PStatCollector that is used to count the number of intersection
+ * tests made against a solid of this type in a given frame.
+ */
+PStatCollector &CollisionMesh::
+get_test_pcollector() {
+  return _test_pcollector;
+}
+
+/**
+ *
+ */
+void CollisionMesh::
+output(std::ostream &out) const {
+  out << "cmesh, " << _triangles.size() << " triangles";
+}
+
+/**
+ *
+ */
+void CollisionMesh::
+write(std::ostream &out, int indent_level) const {
+  indent(out, indent_level) << (*this) << "\n";
+}
+
+/**
+ *
+ */
+PT(BoundingVolume) CollisionMesh::
+compute_internal_bounds() const {
+  if (_vertices.empty()) {
+    return new BoundingBox;
+  }
+
+  Vertices::const_iterator vi = _vertices.begin();
+  LPoint3 n = *vi;
+  LPoint3 x = *vi;
+  for (++vi; vi != _vertices.end(); ++vi) {
+    const LPoint3 &p = *vi;
+    n.set(min(n[0], p[0]), min(n[1], p[1]), min(n[2], p[2]));
+    x.set(max(x[0], p[0]), max(x[1], p[1]), max(x[2], p[2]));
+  }
+
+  return new BoundingBox(n, x);
+}
+
+/**
+ *
+ */
+PT(CollisionEntry) CollisionMesh::
+test_intersection_from_sphere(const CollisionEntry &entry) const {
+  const CollisionSphere *sphere;
+  DCAST_INTO_R(sphere, entry.get_from(), nullptr);
+
+  const LMatrix4 &wrt_mat = entry.get_wrt_mat();
+
+  LPoint3 from_center = sphere->get_center() * wrt_mat;
+  LVector3 from_radius_v =
+    LVector3(sphere->get_radius(), 0.0f, 0.0f) * wrt_mat;
+  PN_stdfloat from_radius_2 = from_radius_v.length_squared();
+  PN_stdfloat from_radius = csqrt(from_radius_2);
+
+  LVector3 extent(from_radius, from_radius, from_radius);
+  TriangleOrder candidates;
+  find_triangles(candidates, from_center - extent, from_center + extent);
+
+  // Of all the triangles the sphere touches, report the one into which it
+  // penetrates most deeply.
+  int best_tri = -1;
+  PN_stdfloat best_depth = 0.0f;
+  PN_stdfloat best_dist = 0.0f;
+  LVector3 best_normal;
+
+  TriangleOrder::const_iterator ci;
+  for (ci = candidates.begin(); ci != candidates.end(); ++ci) {
+    int tri_index = *ci;
+    LPoint3 closest = closest_point_on_triangle(tri_index, from_center);
+    PN_stdfloat dist_2 = (from_center - closest).length_squared();
+    if (dist_2 > from_radius_2) {
+      continue;
+    }
+
+    LVector3 normal = get_triangle_normal(tri_index);
+    if (!normal.normalize()) {
+      // A degenerate triangle.
+      continue;
+    }
+
+    // As in CollisionPolygon, the sphere must stay farther from the plane the
+    // nearer it is to an edge of the triangle.
+    PN_stdfloat dist = (from_center - closest).dot(normal);
+    if (dist < 0.0f) {
+      // The center is behind the triangle; it is one-sided, like a
+      // CollisionPolygon.
+      continue;
+    }
+    PN_stdfloat edge_2 = max(dist_2 - dist * dist, (PN_stdfloat)0.0f);
+    PN_stdfloat max_dist = csqrt(max(from_radius_2 - edge_2, (PN_stdfloat)0.0f));
+    PN_stdfloat depth = max_dist - dist;
+
+    if (best_tri < 0 || depth > best_depth) {
+      best_tri = tri_index;
+      best_depth = depth;
+      best_dist = dist;
+      best_normal = normal;
+    }
+  }
+
+  if (best_tri < 0) {
+    return nullptr;
+  }
+
+  if (collide_cat.is_debug()) {
+    collide_cat.debug()
+      << "intersection detected from " << entry.get_from_node_path()
+      << " into " << entry.get_into_node_path() << "\n";
+  }
+  PT(CollisionEntry) new_entry = new CollisionEntry(entry);
+
+  LVector3 normal = get_surface_normal(best_tri, sphere);
+
+  new_entry->set_surface_normal(normal);
+  new_entry->set_surface_point(from_center - best_normal * best_dist);
+  new_entry->set_interior_point(from_center - best_normal * (best_dist + best_depth));
+  new_entry->set_contact_pos(from_center);
+  new_entry->set_contact_normal(best_normal);
+  new_entry->set_t(1.0f);
+
+  return new_entry;
+}
+
+/**
+ *
+ */
+PT(CollisionEntry) CollisionMesh::
+test_intersection_from_line(const CollisionEntry &entry) const {
+  const CollisionLine *line;
+  DCAST_INTO_R(line, entry.get_from(), nullptr);
+
+  const LMatrix4 &wrt_mat = entry.get_wrt_mat();
+
+  LPoint3 from_origin = line->get_origin() * wrt_mat;
+  LVector3 from_direction = line->get_direction() * wrt_mat;
+
+  int tri_index;
+  PN_stdfloat t;
+  if (!find_nearest_hit(tri_index, t, from_origin, from_direction,
+                        -FLT_MAX, FLT_MAX)) {
+    return nullptr;
+  }
+
+  return make_line_entry(entry, line, tri_index, t, from_origin, from_direction);
+}
+
+/**
+ *
+ */
+PT(CollisionEntry) CollisionMesh::
+test_intersection_from_ray(const CollisionEntry &entry) const {
+  const CollisionRay *ray;
+  DCAST_INTO_R(ray, entry.get_from(), nullptr);
+
+  const LMatrix4 &wrt_mat = entry.get_wrt_mat();
+
+  LPoint3 from_origin = ray->get_origin() * wrt_mat;
+  LVector3 from_direction = ray->get_direction() * wrt_mat;
+
+  int tri_index;
+  PN_stdfloat t;
+  if (!find_nearest_hit(tri_index, t, from_origin, from_direction,
+                        0.0f, FLT_MAX)) {
+    return nullptr;
+  }
+
+  return make_line_entry(entry, ray, tri_index, t, from_origin, from_direction);
+}
+
+/**
+ *
+ */
+PT(CollisionEntry) CollisionMesh::
+test_intersection_from_segment(const CollisionEntry &entry) const {
+  const CollisionSegment *segment;
+  DCAST_INTO_R(segment, entry.get_from(), nullptr);
+
+  const LMatrix4 &wrt_mat = entry.get_wrt_mat();
+
+  LPoint3 from_a = segment->get_point_a() * wrt_mat;
+  LPoint3 from_b = segment->get_point_b() * wrt_mat;
+  LVector3 from_direction = from_b - from_a;
+
+  int tri_index;
+  PN_stdfloat t;
+  if (!find_nearest_hit(tri_index, t, from_a, from_direction, 0.0f, 1.0f)) {
+    return nullptr;
+  }
+
+  return make_line_entry(entry, segment, tri_index, t, from_a, from_direction);
+}
+
+/**
+ *
+ */
+PT(CollisionEntry) CollisionMesh::
+test_intersection_from_tube(const CollisionEntry &entry) const {
+  const CollisionTube *tube;
+  DCAST_INTO_R(tube, entry.get_from(), nullptr);
+
+  const LMatrix4 &wrt_mat = entry.get_wrt_mat();
+
+  LPoint3 from_a = tube->get_point_a() * wrt_mat;
+  LPoint3 from_b = tube->get_point_b() * wrt_mat;
+  LVector3 from_radius_v =
+    LVector3(tube->get_radius(), 0.0f, 0.0f) * wrt_mat;
+  PN_stdfloat from_radius_2 = from_radius_v.length_squared();
+  PN_stdfloat from_radius = csqrt(from_radius_2);
+
+  LVector3 extent(from_radius, from_radius, from_radius);
+  LPoint3 min_point(min(from_a[0], from_b[0]), min(from_a[1], from_b[1]),
+                    min(from_a[2], from_b[2]));
+  LPoint3 max_point(max(from_a[0], from_b[0]), max(from_a[1], from_b[1]),
+                    max(from_a[2], from_b[2]));
+  TriangleOrder candidates;
+  find_triangles(candidates, min_point - extent, max_point + extent);
+
+  int best_tri = -1;
+  PN_stdfloat best_depth = 0.0f;
+  LPoint3 best_surface;
+  LVector3 best_normal;
+
+  TriangleOrder::const_iterator ci;
+  for (ci = candidates.begin(); ci != candidates.end(); ++ci) {
+    int tri_index = *ci;
+    const Triangle &tri = _triangles[tri_index];
+    const LPoint3 &a = _vertices[tri._v[0]];
+    const LPoint3 &b = _vertices[tri._v[1]];
+    const LPoint3 &c = _vertices[tri._v[2]];
+
+    LVector3 normal = get_triangle_normal(tri_index);
+    if (!normal.normalize()) {
+      continue;
+    }
+
+    PN_stdfloat dist_a = (from_a - a).dot(normal);
+    PN_stdfloat dist_b = (from_b - a).dot(normal);
+
+    PN_stdfloat t;
+    PN_stdfloat depth;
+    LPoint3 surface;
+    if (intersects_ray(t, a, b, c, from_a, from_b - from_a) &&
+        t >= 0.0f && t <= 1.0f) {
+      // The axis of the tube passes through the triangle.  The tube must be
+      // pushed out until its deepest end clears the plane.
+      surface = from_a + (from_b - from_a) * t;
+      depth = from_radius - min(dist_a, dist_b);
+
+    } else {
+      // Otherwise, find the point on the tube's axis nearest the triangle,
+      // and treat it like the center of a sphere.
+      LPoint3 p = from_a;
+      LPoint3 q = closest_point_on_triangle(tri_index, from_a);
+      PN_stdfloat dist_2 = (p - q).length_squared();
+
+      LPoint3 q2 = closest_point_on_triangle(tri_index, from_b);
+      PN_stdfloat d2 = (from_b - q2).length_squared();
+      if (d2 < dist_2) {
+        p = from_b;
+        q = q2;
+        dist_2 = d2;
+      }
+      const LPoint3 *edges[3][2] = {{&a, &b}, {&b, &c}, {&c, &a}};
+      for (int e = 0; e < 3; ++e) {
+        LPoint3 p2, q2;
+        mesh_closest_points_segments(p2, q2, from_a, from_b,
+                                     *edges[e][0], *edges[e][1]);
+        d2 = (p2 - q2).length_squared();
+        if (d2 < dist_2) {
+          p = p2;
+          q = q2;
+          dist_2 = d2;
+        }
+      }
+
+      if (dist_2 > from_radius_2) {
+        continue;
+      }
+
+      PN_stdfloat dist = (p - q).dot(normal);
+      PN_stdfloat edge_2 = max(dist_2 - dist * dist, (PN_stdfloat)0.0f);
+      PN_stdfloat max_dist = csqrt(max(from_radius_2 - edge_2, (PN_stdfloat)0.0f));
+      surface = p - normal * dist;
+      depth = max_dist - dist;
+    }
+
+    if (best_tri < 0 || depth > best_depth) {
+      best_tri = tri_index;
+      best_depth = depth;
+      best_surface = surface;
+      best_normal = normal;
+    }
+  }
+
+  if (best_tri < 0) {
+    return nullptr;
+  }
+
+  if (collide_cat.is_debug()) {
+    collide_cat.debug()
+      << "intersection detected from " << entry.get_from_node_path()
+      << " into " << entry.get_into_node_path() << "\n";
+  }
+  PT(CollisionEntry) new_entry = new CollisionEntry(entry);
+
+  new_entry->set_surface_normal(get_surface_normal(best_tri, tube));
+  new_entry->set_surface_point(best_surface);
+  new_entry->set_interior_point(best_surface - best_normal * best_depth);
+
+  return new_entry;
+}
+
+/**
+ * Double dispatch point for box as a FROM object
+ */
+PT(CollisionEntry) CollisionMesh::
+test_intersection_from_box(const CollisionEntry &entry) const {
+  const CollisionBox *box;
+  DCAST_INTO_R(box, entry.get_from(), nullptr);
+
+  const LMatrix4 &wrt_mat = entry.get_wrt_mat();
+
+  LPoint3 from_center = box->get_center() * wrt_mat;
+  LVector3 from_extents = box->get_dimensions() * 0.5f;
+
+  // Determine the half-axes describing the box in the space of the mesh.
+  LVector3 box_x = wrt_mat.get_row3(0) * from_extents[0];
+  LVector3 box_y = wrt_mat.get_row3(1) * from_extents[1];
+  LVector3 box_z = wrt_mat.get_row3(2) * from_extents[2];
+  const LVector3 *box_axes[3] = {&box_x, &box_y, &box_z};
+
+  LVector3 extent(cabs(box_x[0]) + cabs(box_y[0]) + cabs(box_z[0]),
+                  cabs(box_x[1]) + cabs(box_y[1]) + cabs(box_z[1]),
+                  cabs(box_x[2]) + cabs(box_y[2]) + cabs(box_z[2]));
+  TriangleOrder candidates;
+  find_triangles(candidates, from_center - extent, from_center + extent);
+
+  int best_tri = -1;
+  PN_stdfloat best_depth = 0.0f;
+  LPoint3 best_interior;
+  LVector3 best_normal;
+
+  TriangleOrder::const_iterator ci;
+  for (ci = candidates.begin(); ci != candidates.end(); ++ci) {
+    int tri_index = *ci;
+    const Triangle &tri = _triangles[tri_index];
+    const LPoint3 &a = _vertices[tri._v[0]];
+    const LPoint3 &b = _vertices[tri._v[1]];
+    const LPoint3 &c = _vertices[tri._v[2]];
+
+    LVector3 normal = get_triangle_normal(tri_index);
+    if (!normal.normalize()) {
+      continue;
+    }
+
+    // Look for a separating axis among the triangle normal, the box axes and
+    // the cross products of the box axes with the triangle edges.
+    if (mesh_box_axis_separates(normal, a, b, c, from_center, box_x, box_y, box_z)) {
+      continue;
+    }
+
+    bool separated = false;
+    for (int i = 0; i < 3 && !separated; ++i) {
+      separated = mesh_box_axis_separates(*box_axes[i], a, b, c,
+                                          from_center, box_x, box_y, box_z);
+    }
+
+    LVector3 edges[3] = {b - a, c - b, a - c};
+    for (int i = 0; i < 3 && !separated; ++i) {
+      for (int e = 0; e < 3 && !separated; ++e) {
+        separated = mesh_box_axis_separates(box_axes[i]->cross(edges[e]), a, b, c,
+                                            from_center, box_x, box_y, box_z);
+      }
+    }
+    if (separated) {
+      continue;
+    }
+
+    // The box intersects the triangle.  Its deepest corner, with respect to
+    // the triangle's plane, determines how far it must be pushed out.
+    LPoint3 corner = from_center;
+    corner -= (box_x.dot(normal) > 0.0f) ? box_x : -box_x;
+    corner -= (box_y.dot(normal) > 0.0f) ? box_y : -box_y;
+    corner -= (box_z.dot(normal) > 0.0f) ? box_z : -box_z;
+    PN_stdfloat depth = -(corner - a).dot(normal);
+
+    if (best_tri < 0 || depth > best_depth) {
+      best_tri = tri_index;
+      best_depth = depth;
+      best_interior = corner;
+      best_normal = normal;
+    }
+  }
+
+  if (best_tri < 0) {
+    return nullptr;
+  }
+
+  if (collide_cat.is_debug()) {
+    collide_cat.debug()
+      << "intersection detected from " << entry.get_from_node_path()
+      << " into " << entry.get_into_node_path() << "\n";
+  }
+  PT(CollisionEntry) new_entry = new CollisionEntry(entry);
+
+  new_entry->set_surface_normal(get_surface_normal(best_tri, box));
+  new_entry->set_surface_point(best_interior + best_normal * best_depth);
+  new_entry->set_interior_point(best_interior);
+
+  return new_entry;
+}
+
+/**
+ * Fills the _viz_geom GeomNode up with Geoms suitable for rendering this
+ * solid.
+ */
+void CollisionMesh::
+fill_viz_geom() {
+  if (collide_cat.is_debug()) {
+    collide_cat.debug()
+      << "Recomputing viz for " << *this << "\n";
+  }
+
+  PT(GeomVertexData) vdata = new GeomVertexData
+    ("collision", GeomVertexFormat::get_v3(),
+     Geom::UH_static);
+  vdata->unclean_set_num_rows(_vertices.size());
+  GeomVertexWriter vertex(vdata, InternalName::get_vertex());
+
+  Vertices::const_iterator vi;
+  for (vi = _vertices.begin(); vi != _vertices.end(); ++vi) {
+    vertex.set_data3(*vi);
+  }
+
+  PT(GeomTriangles) mesh = new GeomTriangles(Geom::UH_static);
+  PT(GeomLinestrips) wire = new GeomLinestrips(Geom::UH_static);
+  Triangles::const_iterator ti;
+  for (ti = _triangles.begin(); ti != _triangles.end(); ++ti) {
+    const Triangle &tri = *ti;
+    mesh->add_vertices(tri._v[0], tri._v[1], tri._v[2]);
+    mesh->close_primitive();
+    wire->add_vertices(tri._v[0], tri._v[1], tri._v[2], tri._v[0]);
+    wire->close_primitive();
+  }
+
+  PT(Geom) geom = new Geom(vdata);
+  PT(Geom) geom2 = new Geom(vdata);
+  geom->add_primitive(mesh);
+  geom2->add_primitive(wire);
+  _viz_geom->add_geom(geom, get_solid_viz_state());
+  _viz_geom->add_geom(geom2, get_wireframe_viz_state());
+
+  _bounds_viz_geom->add_geom(geom, get_solid_bounds_viz_state());
+  _bounds_viz_geom->add_geom(geom2, get_wireframe_bounds_viz_state());
+}
+
+/**
+ * Rebuilds the bounding volume hierarchy, if it is out of date.
+ */
+void CollisionMesh::
+check_bvh() const {
+  LightMutexHolder holder(_bvh_lock);
+  if (_bvh_stale) {
+    ((CollisionMesh *)this)->build_bvh();
+  }
+}
+
+/**
+ * Builds the bounding volume hierarchy from scratch.  Assumes the lock is
+ * held.
+ */
+void CollisionMesh::
+build_bvh() {
+  _bvh_nodes.clear();
+  _tri_order.clear();
+
+  int num_triangles = (int)_triangles.size();
+  pvector<LPoint3> centroids;
+  centroids.reserve(num_triangles);
+  _tri_order.reserve(num_triangles);
+  for (int i = 0; i < num_triangles; ++i) {
+    const Triangle &tri = _triangles[i];
+    centroids.push_back((_vertices[tri._v[0]] + _vertices[tri._v[1]] +
+                         _vertices[tri._v[2]]) / 3.0f);
+    _tri_order.push_back(i);
+  }
+
+  if (num_triangles > 0) {
+    // A balanced binary tree has fewer than two nodes per leaf.
+    _bvh_nodes.reserve(2 * (num_triangles / max_triangles_per_leaf + 1));
+    r_build_bvh(0, num_triangles, centroids);
+  }
+  _bvh_stale = false;
+
+  if (collide_cat.is_debug()) {
+    collide_cat.debug()
+      << "Built BVH with " << _bvh_nodes.size() << " nodes for " << *this
+      << "\n";
+  }
+}
+
+/**
+ * Recursively builds the node covering the indicated range of _tri_order, by
+ * splitting the triangles at the median of their centroids along the longest
+ * axis.  Returns the index of the new node.
+ */
+int CollisionMesh::
+r_build_bvh(int begin, int end, const pvector<LPoint3> &centroids) {
+  LPoint3 min_point(FLT_MAX, FLT_MAX, FLT_MAX);
+  LPoint3 max_point(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+  LPoint3 min_centroid = min_point;
+  LPoint3 max_centroid = max_point;
+  for (int i = begin; i < end; ++i) {
+    int tri_index = _tri_order[i];
+    const Triangle &tri = _triangles[tri_index];
+    for (int k = 0; k < 3; ++k) {
+      const LPoint3 &p = _vertices[tri._v[k]];
+      min_point.set(min(min_point[0], p[0]), min(min_point[1], p[1]), min(min_point[2], p[2]));
+      max_point.set(max(max_point[0], p[0]), max(max_point[1], p[1]), max(max_point[2], p[2]));
+    }
+    const LPoint3 &c = centroids[tri_index];
+    min_centroid.set(min(min_centroid[0], c[0]), min(min_centroid[1], c[1]), min(min_centroid[2], c[2]));
+    max_centroid.set(max(max_centroid[0], c[0]), max(max_centroid[1], c[1]), max(max_centroid[2], c[2]));
+  }
+
+  int node_index = (int)_bvh_nodes.size();
+  _bvh_nodes.push_back(BVHNode());
+  _bvh_nodes[node_index]._min = min_point;
+  _bvh_nodes[node_index]._max = max_point;
+
+  if (end - begin <= max_triangles_per_leaf) {
+    _bvh_nodes[node_index]._index = begin;
+    _bvh_nodes[node_index]._num_triangles = end - begin;
+    return node_index;
+  }
+
+  LVector3 size = max_centroid - min_centroid;
+  int axis = 0;
+  if (size[1] > size[axis]) {
+    axis = 1;
+  }
+  if (size[2] > size[axis]) {
+    axis = 2;
+  }
+
+  int mid = (begin + end) / 2;
+  std::nth_element(_tri_order.begin() + begin, _tri_order.begin() + mid,
+                   _tri_order.begin() + end,
+                   CollisionMeshCentroidCompare(centroids, axis));
+
+  // The left child immediately follows this node.
+  r_build_bvh(begin, mid, centroids);
+  int right = r_build_bvh(mid, end, centroids);
+
+  _bvh_nodes[node_index]._index = right;
+  _bvh_nodes[node_index]._num_triangles = 0;
+  return node_index;
+}
+
+/**
+ * Fills result with the indices of all triangles whose BVH leaves overlap the
+ * indicated axis-aligned box.  The triangles themselves are not tested.
+ */
+void CollisionMesh::
+find_triangles(TriangleOrder &result,
+               const LPoint3 &min_point, const LPoint3 &max_point) const {
+  check_bvh();
+  if (_bvh_nodes.empty()) {
+    return;
+  }
+
+  int stack[64];
+  int stack_size = 0;
+  stack[stack_size++] = 0;
+
+  while (stack_size > 0) {
+    const BVHNode &node = _bvh_nodes[stack[--stack_size]];
+    if (node._min[0] > max_point[0] || node._max[0] < min_point[0] ||
+        node._min[1] > max_point[1] || node._max[1] < min_point[1] ||
+        node._min[2] > max_point[2] || node._max[2] < min_point[2]) {
+      continue;
+    }
+
+    if (node._num_triangles != 0) {
+      for (int i = 0; i < node._num_triangles; ++i) {
+        result.push_back(_tri_order[node._index + i]);
+      }
+    } else {
+      int node_index = (int)(&node - &_bvh_nodes[0]);
+      nassertv(stack_size + 2 <= 64);
+      stack[stack_size++] = node._index;
+      stack[stack_size++] = node_index + 1;
+    }
+  }
+}
+
+/**
+ * Finds the triangle intersected by the line origin + t * direction with the
+ * smallest t in the range [min_t, max_t].  Returns true if there is one, and
+ * fills in tri_index and t.
+ */
+bool CollisionMesh::
+find_nearest_hit(int &tri_index, PN_stdfloat &t,
+                 const LPoint3 &origin, const LVector3 &direction,
+                 PN_stdfloat min_t, PN_stdfloat max_t) const {
+  check_bvh();
+  if (_bvh_nodes.empty()) {
+    return false;
+  }
+
+  tri_index = -1;
+  t = max_t;
+
+  int stack[64];
+  int stack_size = 0;
+  stack[stack_size++] = 0;
+
+  while (stack_size > 0) {
+    int node_index = stack[--stack_size];
+    const BVHNode &node = _bvh_nodes[node_index];
+
+    // Clip the line against the slabs of the node's box.
+    PN_stdfloat t0 = min_t;
+    PN_stdfloat t1 = t;
+    bool miss = false;
+    for (int i = 0; i < 3 && !miss; ++i) {
+      if (cabs(direction[i]) < 1.0e-12f) {
+        miss = (origin[i] < node._min[i] || origin[i] > node._max[i]);
+      } else {
+        PN_stdfloat inv = 1.0f / direction[i];
+        PN_stdfloat near_t = (node._min[i] - origin[i]) * inv;
+        PN_stdfloat far_t = (node._max[i] - origin[i]) * inv;
+        if (near_t > far_t) {
+          std::swap(near_t, far_t);
+        }
+        t0 = max(t0, near_t);
+        t1 = min(t1, far_t);
+        miss = (t0 > t1);
+      }
+    }
+    if (miss) {
+      continue;
+    }
+
+    if (node._num_triangles != 0) {
+      for (int i = 0; i < node._num_triangles; ++i) {
+        int index = _tri_order[node._index + i];
+        const Triangle &tri = _triangles[index];
+        PN_stdfloat hit_t;
+        if (intersects_ray(hit_t, _vertices[tri._v[0]], _vertices[tri._v[1]],
+                           _vertices[tri._v[2]], origin, direction) &&
+            hit_t >= min_t && hit_t <= t) {
+          tri_index = index;
+          t = hit_t;
+        }
+      }
+    } else {
+      nassertr(stack_size + 2 <= 64, tri_index >= 0);
+      stack[stack_size++] = node._index;
+      stack[stack_size++] = node_index + 1;
+    }
+  }
+
+  return (tri_index >= 0);
+}
+
+/**
+ * Constructs the CollisionEntry for a ray, line or segment that hits the
+ * indicated triangle at the indicated parametric point.
+ */
+PT(CollisionEntry) CollisionMesh::
+make_line_entry(const CollisionEntry &entry, const CollisionSolid *from,
+                int tri_index, PN_stdfloat t, const LPoint3 &origin,
+                const LVector3 &direction) const {
+  if (collide_cat.is_debug()) {
+    collide_cat.debug()
+      << "intersection detected from " << entry.get_from_node_path()
+      << " into " << entry.get_into_node_path() << "\n";
+  }
+  PT(CollisionEntry) new_entry = new CollisionEntry(entry);
+
+  new_entry->set_surface_normal(get_surface_normal(tri_index, from));
+  new_entry->set_surface_point(origin + t * direction);
+
+  return new_entry;
+}
+
+/**
+ * Returns the normal that should be reported for a collision with the
+ * indicated triangle: either the effective normal, if it is set and the from
+ * solid respects it, or the triangle's own normal.
+ */
+LVector3 CollisionMesh::
+get_surface_normal(int tri_index, const CollisionSolid *from) const {
+  if (has_effective_normal() && from->get_respect_effective_normal()) {
+    return get_effective_normal();
+  }
+  LVector3 normal = get_triangle_normal(tri_index);
+  normal.normalize();
+  return normal;
+}
+
+/**
+ * Returns the point on the indicated triangle that is nearest to the given
+ * point.
+ */
+LPoint3 CollisionMesh::
+closest_point_on_triangle(int tri_index, const LPoint3 &p) const {
+  const Triangle &tri = _triangles[tri_index];
+  const LPoint3 &a = _vertices[tri._v[0]];
+  const LPoint3 &b = _vertices[tri._v[1]];
+  const LPoint3 &c = _vertices[tri._v[2]];
+
+  // Determine which Voronoi region of the triangle the point lies in.
+  LVector3 ab = b - a;
+  LVector3 ac = c - a;
+  LVector3 ap = p - a;
+  PN_stdfloat d1 = ab.dot(ap);
+  PN_stdfloat d2 = ac.dot(ap);
+  if (d1 <= 0.0f && d2 <= 0.0f) {
+    return a;
+  }
+
+  LVector3 bp = p - b;
+  PN_stdfloat d3 = ab.dot(bp);
+  PN_stdfloat d4 = ac.dot(bp);
+  if (d3 >= 0.0f && d4 <= d3) {
+    return b;
+  }
+
+  PN_stdfloat vc = d1 * d4 - d3 * d2;
+  if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+    return a + ab * (d1 / (d1 - d3));
+  }
+
+  LVector3 cp = p - c;
+  PN_stdfloat d5 = ab.dot(cp);
+  PN_stdfloat d6 = ac.dot(cp);
+  if (d6 >= 0.0f && d5 <= d6) {
+    return c;
+  }
+
+  PN_stdfloat vb = d5 * d2 - d1 * d6;
+  if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+    return a + ac * (d2 / (d2 - d6));
+  }
+
+  PN_stdfloat va = d3 * d6 - d5 * d4;
+  if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+    return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+  }
+
+  // The point projects to the inside of the triangle.
+  PN_stdfloat denom = 1.0f / (va + vb + vc);
+  return a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+/**
+ * Intersects the line origin + t * direction with the triangle a, b, c, from
+ * either side.  Returns true if they intersect, and fills in t.
+ */
+bool CollisionMesh::
+intersects_ray(PN_stdfloat &t, const LPoint3 &a, const LPoint3 &b,
+               const LPoint3 &c, const LPoint3 &origin,
+               const LVector3 &direction) {
+  LVector3 e1 = b - a;
+  LVector3 e2 = c - a;
+  LVector3 pvec = direction.cross(e2);
+  PN_stdfloat det = e1.dot(pvec);
+  if (IS_NEARLY_ZERO(det)) {
+    // The line is parallel to the triangle.
+    return false;
+  }
+  PN_stdfloat inv_det = 1.0f / det;
+
+  LVector3 tvec = origin - a;
+  PN_stdfloat u = tvec.dot(pvec) * inv_det;
+  if (u < 0.0f || u > 1.0f) {
+    return false;
+  }
+
+  LVector3 qvec = tvec.cross(e1);
+  PN_stdfloat v = direction.dot(qvec) * inv_det;
+  if (v < 0.0f || u + v > 1.0f) {
+    return false;
+  }
+
+  t = e2.dot(qvec) * inv_det;
+  return true;
+}
+
+/**
+ * Tells the BamReader how to create objects of type CollisionMesh.
+ */
+void CollisionMesh::
+register_with_read_factory() {
+  BamReader::get_factory()->register_factory(get_class_type(), make_CollisionMesh);
+}
+
+/**
+ * Writes the contents of this object to the datagram for shipping out to a
+ * Bam file.
+ */
+void CollisionMesh::
+write_datagram(BamWriter *manager, Datagram &me) {
+  CollisionSolid::write_datagram(manager, me);
+  me.add_uint32(_vertices.size());
+  for (size_t i = 0; i < _vertices.size(); ++i) {
+    _vertices[i].write_datagram(me);
+  }
+  me.add_uint32(_triangles.size());
+  for (size_t i = 0; i < _triangles.size(); ++i) {
+    me.add_uint32(_triangles[i]._v[0]);
+    me.add_uint32(_triangles[i]._v[1]);
+    me.add_uint32(_triangles[i]._v[2]);
+  }
+}
+
+/**
+ * This function is called by the BamReader's factory when a new object of
+ * type CollisionMesh is encountered in the Bam file.  It should create the
+ * CollisionMesh and extract its information from the file.
+ */
+TypedWritable *CollisionMesh::
+make_CollisionMesh(const FactoryParams &params) {
+  CollisionMesh *me = new CollisionMesh;
+  DatagramIterator scan;
+  BamReader *manager;
+
+  parse_params(params, scan, manager);
+  me->fillin(scan, manager);
+  return me;
+}
+
+/**
+ * This internal function is called by make_CollisionMesh to read in all of
+ * the relevant data from the BamFile for the new CollisionMesh.  The BVH is
+ * not stored; it is rebuilt when the mesh is first tested.
+ */
+void CollisionMesh::
+fillin(DatagramIterator &scan, BamReader *manager) {
+  CollisionSolid::fillin(scan, manager);
+  size_t num_vertices = scan.get_uint32();
+  _vertices.reserve(num_vertices);
+  for (size_t i = 0; i < num_vertices; ++i) {
+    LPoint3 vertex;
+    vertex.read_datagram(scan);
+    _vertices.push_back(vertex);
+  }
+  size_t num_triangles = scan.get_uint32();
+  _triangles.reserve(num_triangles);
+  for (size_t i = 0; i < num_triangles; ++i) {
+    Triangle tri;
+    tri._v[0] = scan.get_uint32();
+    tri._v[1] = scan.get_uint32();
+    tri._v[2] = scan.get_uint32();
+    _triangles.push_back(tri);
+  }
+  _bvh_stale = true;
+}
@@ -0,0 +1,186 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file collisionMesh.h
+ * @author agent
+ * @date 2026-10-18
+ */
+
+#ifndef COLLISIONMESH_H
+#define COLLISIONMESH_H
+
+#include "pandabase.h"
+
+#include "collisionSolid.h"
+#include "lightMutex.h"
+#include "lightMutexHolder.h"
+#include "pvector.h"
+
+class Geom;
+class GeomNode;
+
+/**
+ * A solid made of an arbitrary number of triangles, which share a single
+ * array of vertices.  This is intended for static level geometry, which
+ * would otherwise require a separate CollisionPolygon for every triangle.
+ *
+ * Internally, the triangles are organized into a bounding volume hierarchy
+ * (a tree of axis-aligned boxes), so that only the triangles near the "from"
+ * solid need to be tested.  The hierarchy is built automatically the first
+ * time the mesh is tested after it has been modified.
+ *
+ * Spheres, rays, lines, segments, boxes and tubes may be tested against a
+ * CollisionMesh.  Each test reports at most one CollisionEntry: the nearest
+ * intersection for rays, lines and segments, or the deepest one for the other
+ * solids.  Triangles are one-sided with respect to spheres, boxes and tubes,
+ * which are always pushed out towards the front side; the front side is the
+ * one from which the vertices appear in counterclockwise order.
+ */
+class EXPCL_PANDA_COLLIDE CollisionMesh : public CollisionSolid {
+PUBLISHED:
+  INLINE CollisionMesh();
+  explicit CollisionMesh(const GeomNode *node);
+
+  INLINE int add_vertex(const LPoint3 &vertex);
+  INLINE void add_triangle(int a, int b, int c);
+  void add_geom(const Geom *geom, const LMatrix4 &mat = LMatrix4::ident_mat());
+  void add_geom_node(const GeomNode *node,
+                     const LMatrix4 &mat = LMatrix4::ident_mat());
+  INLINE void clear();
+
+  INLINE int get_num_vertices() const;
+  INLINE const LPoint3 &get_vertex(int n) const;
+  MAKE_SEQ(get_vertices, get_num_vertices, get_vertex);
+  INLINE int get_num_triangles() const;
+  INLINE LVecBase3i get_triangle(int n) const;
+  MAKE_SEQ(get_triangles, get_num_triangles, get_triangle);
+
+  virtual LPoint3 get_collision_origin() const;
+
+PUBLISHED:
+  MAKE_SEQ_PROPERTY(vertices, get_num_vertices, get_vertex);
+  MAKE_SEQ_PROPERTY(triangles, get_num_triangles, get_triangle);
+
+public:
+  CollisionMesh(const CollisionMesh &copy);
+  virtual CollisionSolid *make_copy();
+
+  virtual void xform(const LMatrix4 &mat);
+
+  virtual PStatCollector &get_volume_pcollector();
+  virtual PStatCollector &get_test_pcollector();
+
+  virtual void output(std::ostream &out) const;
+  virtual void write(std::ostream &out, int indent_level = 0) const;
+
+  INLINE static void flush_level();
+
+protected:
+  virtual PT(BoundingVolume) compute_internal_bounds() const;
+
+  virtual PT(CollisionEntry)
+    test_intersection_from_sphere(const CollisionEntry &entry) const;
+  virtual PT(CollisionEntry)
+    test_intersection_from_line(const CollisionEntry &entry) const;
+  virtual PT(CollisionEntry)
+    test_intersection_from_ray(const CollisionEntry &entry) const;
+  virtual PT(CollisionEntry)
+    test_intersection_from_segment(const CollisionEntry &entry) const;
+  virtual PT(CollisionEntry)
+    test_intersection_from_tube(const CollisionEntry &entry) const;
+  virtual PT(CollisionEntry)
+    test_intersection_from_box(const CollisionEntry &entry) const;
+
+  virtual void fill_viz_geom();
+
+private:
+  class Triangle {
+  public:
+    int _v[3];
+  };
+
+  // A node of the bounding volume hierarchy.  An interior node has
+  // _num_triangles == 0, its left child immediately follows it, and
+  // _index is the index of its right child.  A leaf node covers the
+  // _num_triangles entries of _tri_order beginning at _index.
+  class BVHNode {
+  public:
+    LPoint3 _min;
+    LPoint3 _max;
+    int _index;
+    int _num_triangles;
+  };
+
+  typedef pvector<LPoint3> Vertices;
+  typedef pvector<Triangle> Triangles;
+  typedef pvector<BVHNode> BVHNodes;
+  typedef pvector<int> TriangleOrder;
+
+  INLINE void mark_bvh_stale();
+  void check_bvh() const;
+  void build_bvh();
+  int r_build_bvh(int begin, int end, const pvector<LPoint3> &centroids);
+
+  void find_triangles(TriangleOrder &result,
+                      const LPoint3 &min_point, const LPoint3 &max_point) const;
+  bool find_nearest_hit(int &tri_index, PN_stdfloat &t,
+                        const LPoint3 &origin, const LVector3 &direction,
+                        PN_stdfloat min_t, PN_stdfloat max_t) const;
+  PT(CollisionEntry) make_line_entry(const CollisionEntry &entry,
+                                     const CollisionSolid *from,
+                                     int tri_index, PN_stdfloat t,
+                                     const LPoint3 &origin,
+                                     const LVector3 &direction) const;
+
+  INLINE LVector3 get_triangle_normal(int tri_index) const;
+  LVector3 get_surface_normal(int tri_index, const CollisionSolid *from) const;
+  LPoint3 closest_point_on_triangle(int tri_index, const LPoint3 &point) const;
+  static bool intersects_ray(PN_stdfloat &t, const LPoint3 &a,
+                             const LPoint3 &b, const LPoint3 &c,
+                             const LPoint3 &origin, const LVector3 &direction);
+
+private:
+  Vertices _vertices;
+  Triangles _triangles;
+
+  bool _bvh_stale;
+  BVHNodes _bvh_nodes;
+  TriangleOrder _tri_order;
+  LightMutex _bvh_lock;
+
+  static PStatCollector _volume_pcollector;
+  static PStatCollector _test_pcollector;
+
+protected:
+  void fillin(DatagramIterator &scan, BamReader *manager);
+
+public:
+  static void register_with_read_factory();
+  virtual void write_datagram(BamWriter *manager, Datagram &me);
+
+  static TypedWritable *make_CollisionMesh(const FactoryParams &params);
+  static TypeHandle get_class_type() {
+    return _type_handle;
+  }
+  static void init_type() {
+    CollisionSolid::init_type();
+    register_type(_type_handle, "CollisionMesh",
+                  CollisionSolid::get_class_type());
+  }
+  virtual TypeHandle get_type() const {
+    return get_class_type();
+  }
+  virtual TypeHandle force_init_type() {init_type(); return get_class_type();}
+
+private:
+  static TypeHandle _type_handle;
+};
+
+#include "collisionMesh.I"
+
+#endif
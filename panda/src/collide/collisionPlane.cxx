@@ -20,6 +20,7 @@
 #include "collisionSegment.h"
 #include "collisionTube.h"
 #include "collisionParabola.h"
+#include "collisionConvex.h"
 #include "config_collide.h"
 #include "pointerToArray.h"
 #include "geomNode.h"
@@ -486,6 +487,45 @@ test_intersection_from_box(const CollisionEntry &entry) const {
   return new_entry;
 }
 
+/**
+ * This is part of the double-dispatch implementation of test_intersection().
+ * It is called when the "from" object is a convex hull.
+ */
+PT(CollisionEntry) CollisionPlane::
+test_intersection_from_convex(const CollisionEntry &entry) const {
+  const CollisionConvex *convex;
+  DCAST_INTO_R(convex, entry.get_from(), nullptr);
+
+  CollisionConvex::SupportShape from_shape;
+  convex->get_support_shape(from_shape, entry.get_wrt_mat());
+  if (from_shape._points.empty()) {
+    return nullptr;
+  }
+
+  // The interior point is the vertex of the hull that lies farthest behind
+  // the plane.
+  LPoint3 interior_point = from_shape.get_support(-get_normal());
+  PN_stdfloat depth = _plane.dist_to_plane(interior_point);
+  if (depth > 0) {
+    // No collision.
+    return nullptr;
+  }
+
+  if (collide_cat.is_debug()) {
+    collide_cat.debug()
+      << "intersection detected from " << entry.get_from_node_path()
+      << " into " << entry.get_into_node_path() << "\n";
+  }
+  PT(CollisionEntry) new_entry = new CollisionEntry(entry);
+
+  LVector3 normal = (has_effective_normal() && convex->get_respect_effective_normal()) ? get_effective_normal() : get_normal();
+  new_entry->set_surface_normal(normal);
+  new_entry->set_surface_point(interior_point - get_normal() * depth);
+  new_entry->set_interior_point(interior_point);
+
+  return new_entry;
+}
+
 /**
  * Fills the _viz_geom GeomNode up with Geoms suitable for rendering this
  * solid.
@@ -19,6 +19,7 @@
 #include "collisionRay.h"
 #include "collisionSegment.h"
 #include "collisionParabola.h"
+#include "collisionConvex.h"
 #include "config_collide.h"
 #include "cullTraverserData.h"
 #include "boundingBox.h"
@@ -951,6 +952,66 @@ test_intersection_from_box(const CollisionEntry &entry) const {
   return new_entry;
 }
 
+/**
+ * This is part of the double-dispatch implementation of test_intersection().
+ * It is called when the "from" object is a convex hull.
+ *
+ * The GJK algorithm determines whether the hull touches the polygon at all.
+ * If it does, the hull is pushed out along the polygon's normal, like every
+ * other solid, by the depth of its vertex farthest behind the plane.
+ */
+PT(CollisionEntry) CollisionPolygon::
+test_intersection_from_convex(const CollisionEntry &entry) const {
+  if (_points.size() < 3) {
+    return nullptr;
+  }
+
+  const CollisionConvex *convex;
+  DCAST_INTO_R(convex, entry.get_from(), nullptr);
+
+  CollisionConvex::SupportShape from_shape;
+  convex->get_support_shape(from_shape, entry.get_wrt_mat());
+  if (from_shape._points.empty()) {
+    return nullptr;
+  }
+
+  CollisionConvex::SupportShape into_shape;
+  LMatrix4 to_3d_mat;
+  rederive_to_3d_mat(to_3d_mat);
+  into_shape._points.reserve(_points.size());
+  Points::const_iterator pi;
+  for (pi = _points.begin(); pi != _points.end(); ++pi) {
+    into_shape._points.push_back(to_3d((*pi)._p, to_3d_mat));
+  }
+
+  LPoint3 from_point, into_point;
+  if (CollisionConvex::compute_distance(from_shape, into_shape,
+                                        from_point, into_point) > 0.0f) {
+    // No collision.
+    return nullptr;
+  }
+
+  LPoint3 interior_point = from_shape.get_support(-get_normal());
+  PN_stdfloat depth = dist_to_plane(interior_point);
+  if (depth > 0.0f) {
+    return nullptr;
+  }
+
+  if (collide_cat.is_debug()) {
+    collide_cat.debug()
+      << "intersection detected from " << entry.get_from_node_path()
+      << " into " << entry.get_into_node_path() << "\n";
+  }
+  PT(CollisionEntry) new_entry = new CollisionEntry(entry);
+
+  LVector3 normal = (has_effective_normal() && convex->get_respect_effective_normal()) ? get_effective_normal() : get_normal();
+  new_entry->set_surface_normal(normal);
+  new_entry->set_surface_point(interior_point - get_normal() * depth);
+  new_entry->set_interior_point(interior_point);
+
+  return new_entry;
+}
+
 /**
  * Fills the _viz_geom GeomNode up with Geoms suitable for rendering this
  * solid.
@@ -94,6 +94,8 @@ protected:
   test_intersection_from_parabola(const CollisionEntry &entry) const;
   virtual PT(CollisionEntry)
   test_intersection_from_box(const CollisionEntry &entry) const;
+  virtual PT(CollisionEntry)
+  test_intersection_from_convex(const CollisionEntry &entry) const;
 
   virtual void fill_viz_geom();
 
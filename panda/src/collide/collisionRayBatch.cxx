@@ -0,0 +1,864 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file collisionRayBatch.cxx
+ * @author agent
+ * @date 2026-10-18
+ */
+
+#include "collisionRayBatch.h"
+#include "collisionNode.h"
+#include "collisionSphere.h"
+#include "collisionPolygon.h"
+#include "collisionBox.h"
+#include "collisionFloorMesh.h"
+#include "collisionMesh.h"
+#include "config_collide.h"
+#include "geomNode.h"
+#include "geom.h"
+#include "geomPrimitive.h"
+#include "geomVertexReader.h"
+#include "lodNode.h"
+#include "vector_int.h"
+#include "pStatTimer.h"
+#include <algorithm>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using std::max;
+using std::min;
+
+PStatCollector CollisionRayBatch::_cast_pcollector("App:Collisions:Ray batch");
+
+// The maximum number of primitives stored in a leaf of the hierarchy.  This
+// is the width of a packet.
+static const int max_prims_per_leaf = 4;
+
+/**
+ * Orders primitive indices by the position of their centroids along one
+ * axis, for splitting a node of the hierarchy.
+ */
+class CollisionRayBatchCentroidCompare {
+public:
+  CollisionRayBatchCentroidCompare(const pvector<LPoint3f> &centroids, int axis) :
+    _centroids(centroids), _axis(axis) {}
+
+  bool operator () (int a, int b) const {
+    return _centroids[a][_axis] < _centroids[b][_axis];
+  }
+
+private:
+  const pvector<LPoint3f> &_centroids;
+  int _axis;
+};
+
+/**
+ *
+ */
+CollisionRayBatch::
+CollisionRayBatch() : _num_rays(0) {
+}
+
+/**
+ * Records the collision geometry of the indicated node and all of its
+ * descendants, replacing any geometry recorded previously.  Rays passed to
+ * cast() are expressed in the coordinate space of this node.
+ *
+ * As with the CollisionTraverser, only the visible child of a switch node,
+ * and only the lowest level of an LODNode's visible geometry, is recorded.
+ */
+void CollisionRayBatch::
+set_scene(const NodePath &root) {
+  nassertv(!root.is_empty());
+  clear_scene();
+
+  r_collect(root, TransformState::make_identity(), CollideMask::all_on());
+  build();
+}
+
+/**
+ * Removes all of the geometry recorded by set_scene().  Subsequent rays hit
+ * nothing.
+ */
+void CollisionRayBatch::
+clear_scene() {
+  _nodes.clear();
+  _triangles.clear();
+  _spheres.clear();
+  _tri_bvh.clear();
+  _sphere_bvh.clear();
+  _tri_packets.clear();
+  _sphere_packets.clear();
+}
+
+/**
+ * Casts the rays origins[i] + t * directions[i], for t >= 0, against the
+ * geometry recorded by set_scene() whose into collide mask shares bits with
+ * the indicated mask.  The nearest hit of each ray is written to the arrays
+ * returned by get_distances(), get_normals() and get_node_ids().  Returns the
+ * number of rays that hit something.
+ */
+int CollisionRayBatch::
+cast(CPTA_LVecBase3 origins, CPTA_LVecBase3 directions, CollideMask mask) {
+  nassertr(origins.size() == directions.size(), 0);
+  PStatTimer timer(_cast_pcollector);
+
+  int num_rays = (int)origins.size();
+  if ((int)_distances.size() != num_rays) {
+    // The result arrays are only reallocated when the number of rays changes.
+    _distances = PTA_stdfloat::empty_array(num_rays);
+    _normals = PTA_LVecBase3::empty_array(num_rays);
+    _node_ids = PTA_int::empty_array(num_rays);
+  }
+  _num_rays = num_rays;
+
+  Ray ray;
+  ray._mask = mask.get_word();
+
+  int num_hits = 0;
+  for (int i = 0; i < num_rays; ++i) {
+    const LVecBase3 &origin = origins[i];
+    const LVecBase3 &direction = directions[i];
+    for (int k = 0; k < 3; ++k) {
+      ray._origin[k] = (float)origin[k];
+      ray._direction[k] = (float)direction[k];
+
+      // Avoid an infinite reciprocal, which would produce NaNs in the box
+      // test for a ray lying exactly in the plane of a box face.
+      float d = ray._direction[k];
+      if (cabs(d) < 1.0e-20f) {
+        d = (d < 0.0f) ? -1.0e-20f : 1.0e-20f;
+      }
+      ray._inv_direction[k] = 1.0f / d;
+    }
+
+    float best_t = FLT_MAX;
+    int tri_packet = -1;
+    int tri_lane = -1;
+    int sphere_packet = -1;
+    int sphere_lane = -1;
+    if (!_tri_bvh.empty()) {
+      trace_bvh(_tri_bvh, false, ray, best_t, tri_packet, tri_lane);
+    }
+    if (!_sphere_bvh.empty()) {
+      // This only finds spheres that are nearer than the nearest triangle.
+      trace_bvh(_sphere_bvh, true, ray, best_t, sphere_packet, sphere_lane);
+    }
+
+    if (sphere_lane >= 0) {
+      const SpherePacket &packet = _sphere_packets[sphere_packet];
+      LVector3f normal;
+      if (best_t > 0.0f) {
+        LPoint3f center(packet._center[0][sphere_lane],
+                        packet._center[1][sphere_lane],
+                        packet._center[2][sphere_lane]);
+        LPoint3f point(ray._origin[0] + ray._direction[0] * best_t,
+                       ray._origin[1] + ray._direction[1] * best_t,
+                       ray._origin[2] + ray._direction[2] * best_t);
+        normal = point - center;
+      } else {
+        // The ray starts inside the sphere.
+        normal.set(-ray._direction[0], -ray._direction[1], -ray._direction[2]);
+      }
+      normal.normalize();
+      _distances[i] = best_t;
+      _normals[i] = LCAST(PN_stdfloat, normal);
+      _node_ids[i] = packet._node[sphere_lane];
+      ++num_hits;
+
+    } else if (tri_lane >= 0) {
+      const TrianglePacket &packet = _tri_packets[tri_packet];
+      _distances[i] = best_t;
+      _normals[i].set(packet._normal[0][tri_lane],
+                      packet._normal[1][tri_lane],
+                      packet._normal[2][tri_lane]);
+      _node_ids[i] = packet._node[tri_lane];
+      ++num_hits;
+
+    } else {
+      _distances[i] = -1.0f;
+      _normals[i] = LVecBase3::zero();
+      _node_ids[i] = -1;
+    }
+  }
+
+  return num_hits;
+}
+
+/**
+ * Tests the ray against the four triangles of the packet, using the
+ * Moller-Trumbore algorithm.  If one of them is hit with a parameter t less
+ * than best_t, updates best_t and returns the index of the nearest such
+ * triangle within the packet; otherwise, returns -1.  Triangles are
+ * double-sided.
+ */
+int CollisionRayBatch::
+intersect_triangles(const TrianglePacket &packet, const Ray &ray,
+                    float &best_t) {
+  int lanes = 0;
+  for (int i = 0; i < 4; ++i) {
+    if ((packet._mask[i] & ray._mask) != 0) {
+      lanes |= (1 << i);
+    }
+  }
+  if (lanes == 0) {
+    return -1;
+  }
+
+  float ts[4];
+  int hits;
+
+#ifdef __SSE2__
+  __m128 dx = _mm_set1_ps(ray._direction[0]);
+  __m128 dy = _mm_set1_ps(ray._direction[1]);
+  __m128 dz = _mm_set1_ps(ray._direction[2]);
+  __m128 e1x = _mm_loadu_ps(packet._e1[0]);
+  __m128 e1y = _mm_loadu_ps(packet._e1[1]);
+  __m128 e1z = _mm_loadu_ps(packet._e1[2]);
+  __m128 e2x = _mm_loadu_ps(packet._e2[0]);
+  __m128 e2y = _mm_loadu_ps(packet._e2[1]);
+  __m128 e2z = _mm_loadu_ps(packet._e2[2]);
+
+  // pvec = direction x e2
+  __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+  __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+  __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+  __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)),
+                          _mm_mul_ps(e1z, pz));
+  __m128 inv_det = _mm_div_ps(_mm_set1_ps(1.0f), det);
+
+  // tvec = origin - v0
+  __m128 tx = _mm_sub_ps(_mm_set1_ps(ray._origin[0]), _mm_loadu_ps(packet._v0[0]));
+  __m128 ty = _mm_sub_ps(_mm_set1_ps(ray._origin[1]), _mm_loadu_ps(packet._v0[1]));
+  __m128 tz = _mm_sub_ps(_mm_set1_ps(ray._origin[2]), _mm_loadu_ps(packet._v0[2]));
+  __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(tx, px), _mm_mul_ps(ty, py)),
+                                   _mm_mul_ps(tz, pz)), inv_det);
+
+  // qvec = tvec x e1
+  __m128 qx = _mm_sub_ps(_mm_mul_ps(ty, e1z), _mm_mul_ps(tz, e1y));
+  __m128 qy = _mm_sub_ps(_mm_mul_ps(tz, e1x), _mm_mul_ps(tx, e1z));
+  __m128 qz = _mm_sub_ps(_mm_mul_ps(tx, e1y), _mm_mul_ps(ty, e1x));
+  __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)),
+                                   _mm_mul_ps(dz, qz)), inv_det);
+  __m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)),
+                                   _mm_mul_ps(e2z, qz)), inv_det);
+
+  // Comparisons against NaN are false, so a degenerate lane never hits.
+  __m128 zero = _mm_setzero_ps();
+  __m128 abs_det = _mm_andnot_ps(_mm_set1_ps(-0.0f), det);
+  __m128 valid = _mm_cmpgt_ps(abs_det, _mm_set1_ps(1.0e-20f));
+  valid = _mm_and_ps(valid, _mm_cmpge_ps(u, zero));
+  valid = _mm_and_ps(valid, _mm_cmpge_ps(v, zero));
+  valid = _mm_and_ps(valid, _mm_cmple_ps(_mm_add_ps(u, v), _mm_set1_ps(1.0f)));
+  valid = _mm_and_ps(valid, _mm_cmpge_ps(t, zero));
+  valid = _mm_and_ps(valid, _mm_cmplt_ps(t, _mm_set1_ps(best_t)));
+  hits = _mm_movemask_ps(valid) & lanes;
+  _mm_storeu_ps(ts, t);
+
+#else  // __SSE2__
+  hits = 0;
+  const float *d = ray._direction;
+  for (int i = 0; i < 4; ++i) {
+    if ((lanes & (1 << i)) == 0) {
+      continue;
+    }
+    float e1[3] = {packet._e1[0][i], packet._e1[1][i], packet._e1[2][i]};
+    float e2[3] = {packet._e2[0][i], packet._e2[1][i], packet._e2[2][i]};
+    float p[3] = {d[1] * e2[2] - d[2] * e2[1],
+                  d[2] * e2[0] - d[0] * e2[2],
+                  d[0] * e2[1] - d[1] * e2[0]};
+    float det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+    if (cabs(det) <= 1.0e-20f) {
+      continue;
+    }
+    float inv_det = 1.0f / det;
+    float tv[3] = {ray._origin[0] - packet._v0[0][i],
+                   ray._origin[1] - packet._v0[1][i],
+                   ray._origin[2] - packet._v0[2][i]};
+    float u = (tv[0] * p[0] + tv[1] * p[1] + tv[2] * p[2]) * inv_det;
+    float q[3] = {tv[1] * e1[2] - tv[2] * e1[1],
+                  tv[2] * e1[0] - tv[0] * e1[2],
+                  tv[0] * e1[1] - tv[1] * e1[0]};
+    float v = (d[0] * q[0] + d[1] * q[1] + d[2] * q[2]) * inv_det;
+    ts[i] = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) * inv_det;
+    if (u >= 0.0f && v >= 0.0f && u + v <= 1.0f &&
+        ts[i] >= 0.0f && ts[i] < best_t) {
+      hits |= (1 << i);
+    }
+  }
+#endif  // __SSE2__
+
+  int best_lane = -1;
+  for (int i = 0; i < 4; ++i) {
+    if ((hits & (1 << i)) != 0 && ts[i] < best_t) {
+      best_t = ts[i];
+      best_lane = i;
+    }
+  }
+  return best_lane;
+}
+
+/**
+ * Tests the ray against the four spheres of the packet.  If one of them is
+ * hit with a parameter t less than best_t, updates best_t and returns the
+ * index of the nearest such sphere within the packet; otherwise, returns -1.
+ * A ray that starts inside a sphere hits it at t = 0.
+ */
+int CollisionRayBatch::
+intersect_spheres(const SpherePacket &packet, const Ray &ray, float &best_t) {
+  int lanes = 0;
+  for (int i = 0; i < 4; ++i) {
+    if ((packet._mask[i] & ray._mask) != 0) {
+      lanes |= (1 << i);
+    }
+  }
+  if (lanes == 0) {
+    return -1;
+  }
+
+  const float *d = ray._direction;
+  float a = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+  if (a == 0.0f) {
+    return -1;
+  }
+
+  float ts[4];
+  int hits;
+
+#ifdef __SSE2__
+  // Solve a t^2 + 2 b t + c = 0, where m = origin - center, b = m . d and
+  // c = m . m - r^2.
+  __m128 mx = _mm_sub_ps(_mm_set1_ps(ray._origin[0]), _mm_loadu_ps(packet._center[0]));
+  __m128 my = _mm_sub_ps(_mm_set1_ps(ray._origin[1]), _mm_loadu_ps(packet._center[1]));
+  __m128 mz = _mm_sub_ps(_mm_set1_ps(ray._origin[2]), _mm_loadu_ps(packet._center[2]));
+  __m128 b = _mm_add_ps(_mm_add_ps(_mm_mul_ps(mx, _mm_set1_ps(d[0])),
+                                   _mm_mul_ps(my, _mm_set1_ps(d[1]))),
+                        _mm_mul_ps(mz, _mm_set1_ps(d[2])));
+  __m128 c = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(mx, mx), _mm_mul_ps(my, my)),
+                                   _mm_mul_ps(mz, mz)),
+                        _mm_loadu_ps(packet._radius_sq));
+  __m128 av = _mm_set1_ps(a);
+  __m128 disc = _mm_sub_ps(_mm_mul_ps(b, b), _mm_mul_ps(av, c));
+
+  __m128 zero = _mm_setzero_ps();
+  __m128 root = _mm_sqrt_ps(_mm_max_ps(disc, zero));
+  __m128 t0 = _mm_div_ps(_mm_sub_ps(_mm_sub_ps(zero, b), root), av);
+
+  // If the nearer root is behind the origin, the ray only hits the sphere if
+  // it starts inside it.
+  __m128 valid = _mm_cmpge_ps(disc, zero);
+  valid = _mm_and_ps(valid, _mm_or_ps(_mm_cmpge_ps(t0, zero), _mm_cmple_ps(c, zero)));
+  __m128 t = _mm_max_ps(t0, zero);
+  valid = _mm_and_ps(valid, _mm_cmplt_ps(t, _mm_set1_ps(best_t)));
+  hits = _mm_movemask_ps(valid) & lanes;
+  _mm_storeu_ps(ts, t);
+
+#else  // __SSE2__
+  hits = 0;
+  for (int i = 0; i < 4; ++i) {
+    if ((lanes & (1 << i)) == 0) {
+      continue;
+    }
+    float m[3] = {ray._origin[0] - packet._center[0][i],
+                  ray._origin[1] - packet._center[1][i],
+                  ray._origin[2] - packet._center[2][i]};
+    float b = m[0] * d[0] + m[1] * d[1] + m[2] * d[2];
+    float c = m[0] * m[0] + m[1] * m[1] + m[2] * m[2] - packet._radius_sq[i];
+    float disc = b * b - a * c;
+    if (disc < 0.0f) {
+      continue;
+    }
+    float t0 = (-b - csqrt(disc)) / a;
+    if (t0 < 0.0f && c > 0.0f) {
+      continue;
+    }
+    ts[i] = max(t0, 0.0f);
+    if (ts[i] < best_t) {
+      hits |= (1 << i);
+    }
+  }
+#endif  // __SSE2__
+
+  int best_lane = -1;
+  for (int i = 0; i < 4; ++i) {
+    if ((hits & (1 << i)) != 0 && ts[i] < best_t) {
+      best_t = ts[i];
+      best_lane = i;
+    }
+  }
+  return best_lane;
+}
+
+/**
+ * Walks the scene graph below the indicated node, recording the geometry of
+ * each CollisionNode and GeomNode.  This visits the same nodes that the
+ * CollisionTraverser would.
+ */
+void CollisionRayBatch::
+r_collect(const NodePath &node_path, const TransformState *net_transform,
+          CollideMask include_mask) {
+  PandaNode *node = node_path.node();
+  if ((node->get_net_collide_mask() & include_mask).is_zero()) {
+    // Nothing at this node or below can be collided with.
+    return;
+  }
+
+  if (node->is_collision_node() || node->is_geom_node()) {
+    CollideMask into_mask = node->get_into_collide_mask() & include_mask;
+    if (!into_mask.is_zero()) {
+      int index = (int)_nodes.size();
+      size_t num_prims = _triangles.size() + _spheres.size();
+      const LMatrix4 &mat = net_transform->get_mat();
+
+      if (node->is_collision_node()) {
+        CollisionNode *cnode = DCAST(CollisionNode, node);
+        int num_solids = cnode->get_num_solids();
+        for (int i = 0; i < num_solids; ++i) {
+          add_solid(cnode->get_solid(i), mat, into_mask.get_word(), index);
+        }
+      } else {
+        GeomNode *gnode = DCAST(GeomNode, node);
+        int num_geoms = gnode->get_num_geoms();
+        for (int i = 0; i < num_geoms; ++i) {
+          add_geom(gnode->get_geom(i), mat, into_mask.get_word(), index);
+        }
+      }
+
+      if (_triangles.size() + _spheres.size() != num_prims) {
+        _nodes.push_back(node_path);
+      }
+    }
+  }
+
+  if (node->has_single_child_visibility()) {
+    int index = node->get_visible_child();
+    if (index >= 0 && index < node->get_num_children()) {
+      PandaNode *child = node->get_child(index);
+      r_collect(NodePath(node_path, child),
+                net_transform->compose(child->get_transform()), include_mask);
+    }
+
+  } else if (node->is_lod_node()) {
+    // Only the lowest level of detail may be collided with as visible
+    // geometry.
+    int index = DCAST(LODNode, node)->get_lowest_switch();
+    PandaNode::Children children = node->get_children();
+    int num_children = children.get_num_children();
+    for (int i = 0; i < num_children; ++i) {
+      PandaNode *child = children.get_child(i);
+      CollideMask child_mask = include_mask;
+      if (i != index) {
+        child_mask &= ~GeomNode::get_default_collide_mask();
+      }
+      r_collect(NodePath(node_path, child),
+                net_transform->compose(child->get_transform()), child_mask);
+    }
+
+  } else {
+    PandaNode::Children children = node->get_children();
+    int num_children = children.get_num_children();
+    for (int i = 0; i < num_children; ++i) {
+      PandaNode *child = children.get_child(i);
+      r_collect(NodePath(node_path, child),
+                net_transform->compose(child->get_transform()), include_mask);
+    }
+  }
+}
+
+/**
+ * Records the primitives of the indicated solid, transformed by the
+ * indicated matrix.  Solids of unsupported types are ignored.
+ */
+void CollisionRayBatch::
+add_solid(const CollisionSolid *solid, const LMatrix4 &mat,
+          uint32_t mask, int node) {
+  TypeHandle type = solid->get_type();
+
+  if (type == CollisionSphere::get_class_type()) {
+    const CollisionSphere *sphere = (const CollisionSphere *)solid;
+
+    // A non-uniform scale would turn the sphere into an ellipsoid; we
+    // approximate it with a sphere of the largest scaled radius.
+    PN_stdfloat scale = max(max(mat.get_row3(0).length(),
+                                mat.get_row3(1).length()),
+                            mat.get_row3(2).length());
+    Primitive prim;
+    prim._v[0] = LCAST(float, mat.xform_point(sphere->get_center()));
+    prim._v[1].set((float)(sphere->get_radius() * scale), 0.0f, 0.0f);
+    prim._v[2] = LPoint3f::zero();
+    prim._mask = mask;
+    prim._node = node;
+    _spheres.push_back(prim);
+
+  } else if (type == CollisionPolygon::get_class_type()) {
+    const CollisionPolygon *poly = (const CollisionPolygon *)solid;
+    size_t num_points = poly->get_num_points();
+    if (num_points >= 3) {
+      LPoint3 first = mat.xform_point(poly->get_point(0));
+      LPoint3 prev = mat.xform_point(poly->get_point(1));
+      for (size_t i = 2; i < num_points; ++i) {
+        LPoint3 next = mat.xform_point(poly->get_point(i));
+        add_triangle(first, prev, next, mask, node);
+        prev = next;
+      }
+    }
+
+  } else if (type == CollisionBox::get_class_type()) {
+    const CollisionBox *box = (const CollisionBox *)solid;
+    const LPoint3 &min_point = box->get_min();
+    const LPoint3 &max_point = box->get_max();
+
+    // Corner i has the maximum x if bit 0 is set, and so on.
+    LPoint3 corners[8];
+    for (int i = 0; i < 8; ++i) {
+      corners[i] = mat.xform_point(LPoint3((i & 1) ? max_point[0] : min_point[0],
+                                           (i & 2) ? max_point[1] : min_point[1],
+                                           (i & 4) ? max_point[2] : min_point[2]));
+    }
+
+    // The faces, counterclockwise as seen from outside the box.
+    static const int faces[6][4] = {
+      {0, 4, 6, 2}, {1, 3, 7, 5},
+      {0, 1, 5, 4}, {2, 6, 7, 3},
+      {0, 2, 3, 1}, {4, 5, 7, 6},
+    };
+    for (int f = 0; f < 6; ++f) {
+      const int *face = faces[f];
+      add_triangle(corners[face[0]], corners[face[1]], corners[face[2]], mask, node);
+      add_triangle(corners[face[0]], corners[face[2]], corners[face[3]], mask, node);
+    }
+
+  } else if (type == CollisionFloorMesh::get_class_type()) {
+    const CollisionFloorMesh *mesh = (const CollisionFloorMesh *)solid;
+    unsigned int num_triangles = mesh->get_num_triangles();
+    for (unsigned int i = 0; i < num_triangles; ++i) {
+      LPoint3i tri = mesh->get_triangle(i);
+      add_triangle(mat.xform_point(mesh->get_vertex(tri[0])),
+                   mat.xform_point(mesh->get_vertex(tri[1])),
+                   mat.xform_point(mesh->get_vertex(tri[2])), mask, node);
+    }
+
+  } else if (type == CollisionMesh::get_class_type()) {
+    const CollisionMesh *mesh = (const CollisionMesh *)solid;
+    int num_triangles = mesh->get_num_triangles();
+    for (int i = 0; i < num_triangles; ++i) {
+      LVecBase3i tri = mesh->get_triangle(i);
+      add_triangle(mat.xform_point(mesh->get_vertex(tri[0])),
+                   mat.xform_point(mesh->get_vertex(tri[1])),
+                   mat.xform_point(mesh->get_vertex(tri[2])), mask, node);
+    }
+
+  } else if (collide_cat.is_debug()) {
+    collide_cat.debug()
+      << "CollisionRayBatch ignoring " << *solid << "\n";
+  }
+}
+
+/**
+ * Records all of the triangles of the indicated Geom, transformed by the
+ * indicated matrix.  Primitives other than triangles are ignored.
+ */
+void CollisionRayBatch::
+add_geom(const Geom *geom, const LMatrix4 &mat, uint32_t mask, int node) {
+  if (geom->get_primitive_type() != Geom::PT_polygons) {
+    return;
+  }
+
+  // Use the animated vertices, as the CollisionTraverser does, so that the
+  // results agree on skinned or morphed geometry.
+  CPT(Geom) tris = geom->decompose();
+  CPT(GeomVertexData) vdata =
+    tris->get_vertex_data()->animate_vertices(true, Thread::get_current_thread());
+  if (!vdata->has_column(InternalName::get_vertex())) {
+    return;
+  }
+
+  // Check all of the indices first, so that a bad index doesn't leave only
+  // some of the triangles recorded.
+  int num_vertices = vdata->get_num_rows();
+  vector_int indices;
+  for (size_t i = 0; i < tris->get_num_primitives(); ++i) {
+    CPT(GeomPrimitive) prim = tris->get_primitive(i);
+    int num_prim_vertices = prim->get_num_vertices();
+    for (int vi = 0; vi + 2 < num_prim_vertices; vi += 3) {
+      for (int k = 0; k < 3; ++k) {
+        int index = prim->get_vertex(vi + k);
+        nassertv(index >= 0 && index < num_vertices);
+        indices.push_back(index);
+      }
+    }
+  }
+
+  pvector<LPoint3> vertices;
+  vertices.reserve(num_vertices);
+  GeomVertexReader vertex(vdata, InternalName::get_vertex());
+  while (!vertex.is_at_end()) {
+    vertices.push_back(mat.xform_point(vertex.get_data3()));
+  }
+
+  size_t num_indices = indices.size();
+  for (size_t i = 0; i + 2 < num_indices; i += 3) {
+    add_triangle(vertices[indices[i]], vertices[indices[i + 1]],
+                 vertices[indices[i + 2]], mask, node);
+  }
+}
+
+/**
+ * Records a single triangle.  Degenerate triangles are ignored.
+ */
+void CollisionRayBatch::
+add_triangle(const LPoint3 &a, const LPoint3 &b, const LPoint3 &c,
+             uint32_t mask, int node) {
+  LVector3 normal = (b - a).cross(c - a);
+  if (normal.length_squared() == 0.0f) {
+    return;
+  }
+
+  Primitive prim;
+  prim._v[0] = LCAST(float, a);
+  prim._v[1] = LCAST(float, b);
+  prim._v[2] = LCAST(float, c);
+  prim._mask = mask;
+  prim._node = node;
+  _triangles.push_back(prim);
+}
+
+/**
+ * Builds the bounding volume hierarchies and the packets from the recorded
+ * primitives.
+ */
+void CollisionRayBatch::
+build() {
+  const Primitives *prims[2] = {&_triangles, &_spheres};
+  BVHNodes *bvhs[2] = {&_tri_bvh, &_sphere_bvh};
+
+  for (int s = 0; s < 2; ++s) {
+    int num_prims = (int)prims[s]->size();
+    if (num_prims == 0) {
+      continue;
+    }
+
+    pvector<LPoint3f> centroids;
+    pvector<int> order;
+    centroids.reserve(num_prims);
+    order.reserve(num_prims);
+    for (int i = 0; i < num_prims; ++i) {
+      LPoint3f min_point, max_point;
+      get_bounds((*prims[s])[i], s != 0, min_point, max_point);
+      centroids.push_back((min_point + max_point) * 0.5f);
+      order.push_back(i);
+    }
+
+    // A balanced binary tree has fewer than two nodes per leaf.
+    bvhs[s]->reserve(2 * (num_prims / max_prims_per_leaf + 1));
+    r_build(*bvhs[s], order, 0, num_prims, *prims[s], centroids, s != 0);
+  }
+
+  if (collide_cat.is_debug()) {
+    collide_cat.debug()
+      << "CollisionRayBatch recorded " << _triangles.size() << " triangles in "
+      << _tri_packets.size() << " packets and " << _spheres.size()
+      << " spheres in " << _sphere_packets.size() << " packets from "
+      << _nodes.size() << " nodes\n";
+  }
+}
+
+/**
+ * Recursively builds the node covering the indicated range of order, by
+ * splitting the primitives at the median of their centroids along the
+ * longest axis.  Each leaf is stored as a packet.  Returns the index of the
+ * new node.
+ */
+int CollisionRayBatch::
+r_build(BVHNodes &nodes, pvector<int> &order, int begin, int end,
+        const Primitives &prims, const pvector<LPoint3f> &centroids,
+        bool spheres) {
+  LPoint3f min_point(FLT_MAX, FLT_MAX, FLT_MAX);
+  LPoint3f max_point(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+  LPoint3f min_centroid = min_point;
+  LPoint3f max_centroid = max_point;
+  uint32_t mask = 0;
+  for (int i = begin; i < end; ++i) {
+    const Primitive &prim = prims[order[i]];
+    LPoint3f prim_min, prim_max;
+    get_bounds(prim, spheres, prim_min, prim_max);
+    const LPoint3f &c = centroids[order[i]];
+    for (int k = 0; k < 3; ++k) {
+      min_point[k] = min(min_point[k], prim_min[k]);
+      max_point[k] = max(max_point[k], prim_max[k]);
+      min_centroid[k] = min(min_centroid[k], c[k]);
+      max_centroid[k] = max(max_centroid[k], c[k]);
+    }
+    mask |= prim._mask;
+  }
+
+  int node_index = (int)nodes.size();
+  nodes.push_back(BVHNode());
+  for (int k = 0; k < 3; ++k) {
+    nodes[node_index]._min[k] = min_point[k];
+    nodes[node_index]._max[k] = max_point[k];
+  }
+  nodes[node_index]._mask = mask;
+
+  if (end - begin <= max_prims_per_leaf) {
+    int count = end - begin;
+    if (spheres) {
+      SpherePacket packet;
+      memset(&packet, 0, sizeof(packet));
+      for (int i = 0; i < max_prims_per_leaf; ++i) {
+        packet._node[i] = -1;
+      }
+      for (int i = 0; i < count; ++i) {
+        const Primitive &prim = prims[order[begin + i]];
+        for (int k = 0; k < 3; ++k) {
+          packet._center[k][i] = prim._v[0][k];
+        }
+        packet._radius_sq[i] = prim._v[1][0] * prim._v[1][0];
+        packet._mask[i] = prim._mask;
+        packet._node[i] = prim._node;
+      }
+      nodes[node_index]._index = (int)_sphere_packets.size();
+      _sphere_packets.push_back(packet);
+
+    } else {
+      TrianglePacket packet;
+      memset(&packet, 0, sizeof(packet));
+      for (int i = 0; i < max_prims_per_leaf; ++i) {
+        packet._node[i] = -1;
+      }
+      for (int i = 0; i < count; ++i) {
+        const Primitive &prim = prims[order[begin + i]];
+        LVector3f e1 = prim._v[1] - prim._v[0];
+        LVector3f e2 = prim._v[2] - prim._v[0];
+        LVector3f normal = e1.cross(e2);
+        normal.normalize();
+        for (int k = 0; k < 3; ++k) {
+          packet._v0[k][i] = prim._v[0][k];
+          packet._e1[k][i] = e1[k];
+          packet._e2[k][i] = e2[k];
+          packet._normal[k][i] = normal[k];
+        }
+        packet._mask[i] = prim._mask;
+        packet._node[i] = prim._node;
+      }
+      nodes[node_index]._index = (int)_tri_packets.size();
+      _tri_packets.push_back(packet);
+    }
+    nodes[node_index]._axis = -1;
+    return node_index;
+  }
+
+  LVector3f size = max_centroid - min_centroid;
+  int axis = 0;
+  if (size[1] > size[axis]) {
+    axis = 1;
+  }
+  if (size[2] > size[axis]) {
+    axis = 2;
+  }
+
+  int mid = (begin + end) / 2;
+  std::nth_element(order.begin() + begin, order.begin() + mid,
+                   order.begin() + end,
+                   CollisionRayBatchCentroidCompare(centroids, axis));
+
+  // The left child immediately follows this node.
+  r_build(nodes, order, begin, mid, prims, centroids, spheres);
+  int right = r_build(nodes, order, mid, end, prims, centroids, spheres);
+
+  nodes[node_index]._index = right;
+  nodes[node_index]._axis = axis;
+  return node_index;
+}
+
+/**
+ * Computes the axis-aligned bounding box of the indicated primitive.
+ */
+void CollisionRayBatch::
+get_bounds(const Primitive &prim, bool sphere,
+           LPoint3f &min_point, LPoint3f &max_point) {
+  if (sphere) {
+    float radius = prim._v[1][0];
+    LVector3f extent(radius, radius, radius);
+    min_point = prim._v[0] - extent;
+    max_point = prim._v[0] + extent;
+  } else {
+    for (int k = 0; k < 3; ++k) {
+      min_point[k] = min(min(prim._v[0][k], prim._v[1][k]), prim._v[2][k]);
+      max_point[k] = max(max(prim._v[0][k], prim._v[1][k]), prim._v[2][k]);
+    }
+  }
+}
+
+/**
+ * Finds the nearest primitive of the indicated hierarchy that is hit by the
+ * ray with a parameter less than best_t.  If there is one, updates best_t,
+ * best_packet and best_lane.  Children are visited front to back, so that
+ * best_t shrinks as quickly as possible.
+ */
+void CollisionRayBatch::
+trace_bvh(const BVHNodes &bvh, bool spheres, const Ray &ray,
+          float &best_t, int &best_packet, int &best_lane) const {
+  int stack[64];
+  int stack_size = 0;
+  stack[stack_size++] = 0;
+
+  while (stack_size > 0) {
+    int node_index = stack[--stack_size];
+    const BVHNode &node = bvh[node_index];
+    if ((node._mask & ray._mask) == 0 || !test_box(node, ray, best_t)) {
+      continue;
+    }
+
+    if (node._axis < 0) {
+      int lane;
+      if (spheres) {
+        lane = intersect_spheres(_sphere_packets[node._index], ray, best_t);
+      } else {
+        lane = intersect_triangles(_tri_packets[node._index], ray, best_t);
+      }
+      if (lane >= 0) {
+        best_packet = node._index;
+        best_lane = lane;
+      }
+
+    } else {
+      nassertv(stack_size + 2 <= 64);
+      // Push the far child first, so that the near child is visited first.
+      if (ray._direction[node._axis] >= 0.0f) {
+        stack[stack_size++] = node._index;
+        stack[stack_size++] = node_index + 1;
+      } else {
+        stack[stack_size++] = node_index + 1;
+        stack[stack_size++] = node._index;
+      }
+    }
+  }
+}
+
+/**
+ * Returns true if the ray passes through the box of the indicated node with
+ * a parameter between 0 and max_t.
+ */
+bool CollisionRayBatch::
+test_box(const BVHNode &node, const Ray &ray, float max_t) {
+  float t0 = 0.0f;
+  float t1 = max_t;
+  for (int k = 0; k < 3; ++k) {
+    float near_t = (node._min[k] - ray._origin[k]) * ray._inv_direction[k];
+    float far_t = (node._max[k] - ray._origin[k]) * ray._inv_direction[k];
+    if (near_t > far_t) {
+      std::swap(near_t, far_t);
+    }
+    t0 = max(t0, near_t);
+    t1 = min(t1, far_t);
+  }
+  return t0 <= t1;
+}
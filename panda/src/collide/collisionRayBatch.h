@@ -0,0 +1,185 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file collisionRayBatch.h
+ * @author agent
+ * @date 2026-10-18
+ */
+
+#ifndef COLLISIONRAYBATCH_H
+#define COLLISIONRAYBATCH_H
+
+#include "pandabase.h"
+
+#include "referenceCount.h"
+#include "nodePath.h"
+#include "collideMask.h"
+#include "pta_LVecBase3.h"
+#include "pta_stdfloat.h"
+#include "pta_int.h"
+#include "pvector.h"
+#include "pStatCollector.h"
+
+class Geom;
+class CollisionSolid;
+
+/**
+ * Casts large numbers of rays against a snapshot of a scene graph at once,
+ * without going through the CollisionTraverser.  This is intended for things
+ * like line-of-sight checks, sensors and audio occlusion, which need only the
+ * nearest hit of each ray, and for which creating a CollisionNode and a
+ * CollisionEntry per ray would be far too expensive.
+ *
+ * First call set_scene() to record the geometry below some node.  The
+ * CollisionSpheres, CollisionPolygons, CollisionBoxes, CollisionFloorMeshes
+ * and CollisionMeshes of every CollisionNode are recorded, as are the
+ * triangles of every GeomNode, each along with the into collide mask of its
+ * node.  Other solids are ignored.  The snapshot is not updated when the
+ * scene graph changes; call set_scene() again for that.
+ *
+ * Then call cast() with arrays of ray origins and directions, expressed in
+ * the coordinate space of the root node.  The results are written into flat
+ * arrays, with one element per ray, which are reused from one call to the
+ * next; no memory is allocated per ray or per hit.
+ */
+class EXPCL_PANDA_COLLIDE CollisionRayBatch : public ReferenceCount {
+PUBLISHED:
+  CollisionRayBatch();
+
+  void set_scene(const NodePath &root);
+  void clear_scene();
+
+  INLINE int get_num_nodes() const;
+  INLINE NodePath get_node(int n) const;
+  MAKE_SEQ(get_nodes, get_num_nodes, get_node);
+  INLINE int get_num_triangles() const;
+  INLINE int get_num_spheres() const;
+
+  int cast(CPTA_LVecBase3 origins, CPTA_LVecBase3 directions,
+           CollideMask mask = CollideMask::all_on());
+
+  INLINE int get_num_rays() const;
+  INLINE CPTA_stdfloat get_distances() const;
+  INLINE CPTA_LVecBase3 get_normals() const;
+  INLINE CPTA_int get_node_ids() const;
+
+  INLINE PN_stdfloat get_distance(int n) const;
+  INLINE LVector3 get_normal(int n) const;
+  INLINE int get_node_id(int n) const;
+
+PUBLISHED:
+  MAKE_SEQ_PROPERTY(nodes, get_num_nodes, get_node);
+  MAKE_PROPERTY(distances, get_distances);
+  MAKE_PROPERTY(normals, get_normals);
+  MAKE_PROPERTY(node_ids, get_node_ids);
+
+public:
+  // A ray prepared for traversal.  The reciprocal of the direction is used
+  // for the box tests.
+  class Ray {
+  public:
+    float _origin[3];
+    float _direction[3];
+    float _inv_direction[3];
+    uint32_t _mask;
+  };
+
+  // Four triangles, stored as a structure of arrays, so that they can be
+  // tested against a ray at once.  Unused lanes have a mask of 0.
+  class TrianglePacket {
+  public:
+    float _v0[3][4];
+    float _e1[3][4];
+    float _e2[3][4];
+    float _normal[3][4];
+    uint32_t _mask[4];
+    int _node[4];
+  };
+
+  // Likewise, four spheres.
+  class SpherePacket {
+  public:
+    float _center[3][4];
+    float _radius_sq[4];
+    uint32_t _mask[4];
+    int _node[4];
+  };
+
+  static int intersect_triangles(const TrianglePacket &packet, const Ray &ray,
+                                 float &best_t);
+  static int intersect_spheres(const SpherePacket &packet, const Ray &ray,
+                               float &best_t);
+
+private:
+  // A primitive of the snapshot, before it is sorted into the hierarchy.
+  class Primitive {
+  public:
+    LPoint3f _v[3];
+    uint32_t _mask;
+    int _node;
+  };
+  typedef pvector<Primitive> Primitives;
+
+  // A node of a bounding volume hierarchy.  An interior node has the index
+  // of the axis along which it was split in _axis, its left child
+  // immediately follows it, and _index is the index of its right child.  A
+  // leaf node has an _axis of -1, and _index is the index of its packet.
+  class BVHNode {
+  public:
+    float _min[3];
+    float _max[3];
+    uint32_t _mask;
+    int _index;
+    int _axis;
+  };
+  typedef pvector<BVHNode> BVHNodes;
+
+  void r_collect(const NodePath &node_path, const TransformState *net_transform,
+                 CollideMask include_mask);
+  void add_solid(const CollisionSolid *solid, const LMatrix4 &mat,
+                 uint32_t mask, int node);
+  void add_geom(const Geom *geom, const LMatrix4 &mat, uint32_t mask, int node);
+  void add_triangle(const LPoint3 &a, const LPoint3 &b, const LPoint3 &c,
+                    uint32_t mask, int node);
+
+  void build();
+  int r_build(BVHNodes &nodes, pvector<int> &order, int begin, int end,
+              const Primitives &prims, const pvector<LPoint3f> &centroids,
+              bool spheres);
+  static void get_bounds(const Primitive &prim, bool sphere,
+                         LPoint3f &min_point, LPoint3f &max_point);
+
+  void trace_bvh(const BVHNodes &bvh, bool spheres, const Ray &ray,
+                 float &best_t, int &best_packet, int &best_lane) const;
+  static bool test_box(const BVHNode &node, const Ray &ray, float max_t);
+
+private:
+  typedef pvector<NodePath> Nodes;
+  Nodes _nodes;
+
+  // The spheres are stored with the center in _v[0] and the radius in the
+  // first component of _v[1].
+  Primitives _triangles;
+  Primitives _spheres;
+
+  BVHNodes _tri_bvh;
+  BVHNodes _sphere_bvh;
+  pvector<TrianglePacket> _tri_packets;
+  pvector<SpherePacket> _sphere_packets;
+
+  int _num_rays;
+  PTA_stdfloat _distances;
+  PTA_LVecBase3 _normals;
+  PTA_int _node_ids;
+
+  static PStatCollector _cast_pcollector;
+};
+
+#include "collisionRayBatch.I"
+
+#endif
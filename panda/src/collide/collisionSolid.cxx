@@ -20,6 +20,7 @@
 #include "collisionTube.h"
 #include "collisionParabola.h"
 #include "collisionBox.h"
+#include "collisionConvex.h"
 #include "collisionEntry.h"
 #include "boundingSphere.h"
 #include "datagram.h"
@@ -271,6 +272,17 @@ test_intersection_from_box(const CollisionEntry &) const {
   return nullptr;
 }
 
+/**
+ * This is part of the double-dispatch implementation of test_intersection().
+ * It is called when the "from" object is a convex hull.
+ */
+PT(CollisionEntry) CollisionSolid::
+test_intersection_from_convex(const CollisionEntry &) const {
+  report_undefined_intersection_test(CollisionConvex::get_class_type(),
+                                     get_type());
+  return nullptr;
+}
+
 
 #ifndef NDEBUG
 class CollisionSolidUndefinedPair {
@@ -113,6 +113,8 @@ protected:
   test_intersection_from_parabola(const CollisionEntry &entry) const;
   virtual PT(CollisionEntry)
   test_intersection_from_box(const CollisionEntry &entry) const;
+  virtual PT(CollisionEntry)
+  test_intersection_from_convex(const CollisionEntry &entry) const;
 
   static void report_undefined_intersection_test(TypeHandle from_type,
                                                  TypeHandle into_type);
@@ -181,6 +183,7 @@ private:
   friend class CollisionParabola;
   friend class CollisionHandlerFluidPusher;
   friend class CollisionBox;
+  friend class CollisionConvex;
 };
 
 INLINE std::ostream &operator << (std::ostream &out, const CollisionSolid &cs) {
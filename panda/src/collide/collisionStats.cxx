@@ -0,0 +1,318 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file collisionStats.cxx
+ * @author agent
+ * @date 2026-10-18
+ */
+
+#include "collisionStats.h"
+#include "collisionEntry.h"
+#include "collisionSolid.h"
+#include "indent.h"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+/**
+ * Orders the rows of one of the tables by decreasing time spent, and then by
+ * decreasing number of tests, for writing.
+ */
+template<class Row>
+class CollisionStatsRowCompare {
+public:
+  CollisionStatsRowCompare(const pvector<Row> &rows) : _rows(rows) {}
+
+  bool operator () (int a, int b) const {
+    const CollisionStats::Counts &ca = _rows[a]._counts;
+    const CollisionStats::Counts &cb = _rows[b]._counts;
+    if (ca._time != cb._time) {
+      return ca._time > cb._time;
+    }
+    if (ca._num_tests != cb._num_tests) {
+      return ca._num_tests > cb._num_tests;
+    }
+    return a < b;
+  }
+
+private:
+  const pvector<Row> &_rows;
+};
+
+/**
+ * Returns the indices of the indicated rows, sorted by decreasing cost.
+ */
+template<class Row>
+static pvector<int>
+sort_rows(const pvector<Row> &rows) {
+  pvector<int> order(rows.size());
+  for (size_t i = 0; i < rows.size(); ++i) {
+    order[i] = (int)i;
+  }
+  std::sort(order.begin(), order.end(), CollisionStatsRowCompare<Row>(rows));
+  return order;
+}
+
+/**
+ * Writes the counts as the columns of one row of a table.
+ */
+static void
+write_counts_columns(std::ostream &out, const CollisionStats::Counts &counts) {
+  out << std::setw(10) << counts._num_volume_tests
+      << std::setw(10) << counts._num_tests
+      << std::setw(8) << counts._num_hits
+      << std::setw(12) << std::fixed << std::setprecision(3)
+      << counts._time * 1000.0;
+  out.unsetf(std::ios::floatfield);
+}
+
+/**
+ * Returns the indicated NodePath formatted as a string.
+ */
+static std::string
+format_node_path(const NodePath &node_path) {
+  std::ostringstream strm;
+  strm << node_path;
+  return strm.str();
+}
+
+/**
+ * Writes the indicated string as a field of a CSV file.
+ */
+static void
+write_csv_field(std::ostream &out, const std::string &str) {
+  out << '"';
+  for (size_t i = 0; i < str.size(); ++i) {
+    if (str[i] == '"') {
+      out << '"';
+    }
+    out << str[i];
+  }
+  out << '"';
+}
+
+/**
+ *
+ */
+void CollisionStats::Counts::
+output(std::ostream &out) const {
+  out << _num_volume_tests << " volume tests, " << _num_tests << " tests, "
+      << _num_hits << " hits, " << _time * 1000.0 << " ms";
+}
+
+/**
+ *
+ */
+CollisionStats::
+CollisionStats() : _num_traversals(0) {
+}
+
+/**
+ * Resets all of the counts to zero, and forgets all of the pairs, nodes and
+ * colliders that have been recorded.
+ */
+void CollisionStats::
+clear() {
+  _num_traversals = 0;
+  _total = Counts();
+  _pairs.clear();
+  _pair_index.clear();
+  _nodes.clear();
+  _node_index.clear();
+  _colliders.clear();
+  _collider_index.clear();
+}
+
+/**
+ *
+ */
+void CollisionStats::
+output(std::ostream &out) const {
+  out << "CollisionStats, " << _num_traversals << " traversals, " << _total;
+}
+
+/**
+ * Writes the recorded statistics as a set of tables, each sorted with the
+ * most expensive rows first.  Times are given in milliseconds.
+ */
+void CollisionStats::
+write(std::ostream &out, int indent_level) const {
+  indent(out, indent_level) << *this << "\n";
+  write_pair_table(out, indent_level + 2);
+  write_node_table(out, indent_level + 2, "into node", _nodes);
+  write_node_table(out, indent_level + 2, "collider", _colliders);
+}
+
+/**
+ * Writes the recorded statistics in CSV format, one row per pair, node and
+ * collider, for analysis in other tools.  The first column indicates the kind
+ * of row.  Times are given in milliseconds.
+ */
+void CollisionStats::
+write_csv(std::ostream &out) const {
+  out << "kind,from,into,volume_tests,tests,hits,time_ms\n";
+
+  pvector<PairRow>::const_iterator pi;
+  for (pi = _pairs.begin(); pi != _pairs.end(); ++pi) {
+    const Counts &counts = (*pi)._counts;
+    out << "pair,";
+    write_csv_field(out, (*pi)._from_type.get_name());
+    out << ",";
+    write_csv_field(out, (*pi)._into_type.get_name());
+    out << "," << counts._num_volume_tests << "," << counts._num_tests
+        << "," << counts._num_hits << "," << counts._time * 1000.0 << "\n";
+  }
+
+  pvector<NodeRow>::const_iterator ni;
+  for (ni = _nodes.begin(); ni != _nodes.end(); ++ni) {
+    const Counts &counts = (*ni)._counts;
+    out << "node,,";
+    write_csv_field(out, format_node_path((*ni)._node_path));
+    out << "," << counts._num_volume_tests << "," << counts._num_tests
+        << "," << counts._num_hits << "," << counts._time * 1000.0 << "\n";
+  }
+
+  for (ni = _colliders.begin(); ni != _colliders.end(); ++ni) {
+    const Counts &counts = (*ni)._counts;
+    out << "collider,";
+    write_csv_field(out, format_node_path((*ni)._node_path));
+    out << ",," << counts._num_volume_tests << "," << counts._num_tests
+        << "," << counts._num_hits << "," << counts._time * 1000.0 << "\n";
+  }
+}
+
+/**
+ * Called by the CollisionTraverser each time the bounding volume of a
+ * collider is tested against the bounding volume of an "into" node, solid or
+ * Geom.  into_type is the type of the "into" solid, or TypeHandle::none() if
+ * the test was against a node or a Geom as a whole.
+ */
+void CollisionStats::
+record_volume_test(const CollisionEntry &entry, TypeHandle into_type) {
+  ++_total._num_volume_tests;
+  if (into_type != TypeHandle::none()) {
+    ++get_pair_row(entry.get_from()->get_type(), into_type)._num_volume_tests;
+  }
+  ++get_node_row(entry.get_into_node_path())._num_volume_tests;
+  ++get_collider_row(entry.get_from_node_path())._num_volume_tests;
+}
+
+/**
+ * Called by the CollisionTraverser after each intersection test, with
+ * whether it detected a collision and how long it took, in seconds.
+ */
+void CollisionStats::
+record_test(const CollisionEntry &entry, bool hit, double time) {
+  int num_hits = hit ? 1 : 0;
+
+  Counts *rows[4] = {
+    &_total,
+    &get_pair_row(entry.get_from()->get_type(), entry.get_into()->get_type()),
+    &get_node_row(entry.get_into_node_path()),
+    &get_collider_row(entry.get_from_node_path()),
+  };
+  for (int i = 0; i < 4; ++i) {
+    ++rows[i]->_num_tests;
+    rows[i]->_num_hits += num_hits;
+    rows[i]->_time += time;
+  }
+}
+
+/**
+ * Returns the counts for the indicated pair of solid types, adding a new row
+ * if necessary.
+ */
+CollisionStats::Counts &CollisionStats::
+get_pair_row(TypeHandle from_type, TypeHandle into_type) {
+  std::pair<PairIndex::iterator, bool> result =
+    _pair_index.insert(PairIndex::value_type(PairKey(from_type, into_type),
+                                             (int)_pairs.size()));
+  if (result.second) {
+    PairRow row;
+    row._from_type = from_type;
+    row._into_type = into_type;
+    _pairs.push_back(row);
+  }
+  return _pairs[(*result.first).second]._counts;
+}
+
+/**
+ * Returns the counts for the indicated "into" node, adding a new row if
+ * necessary.
+ */
+CollisionStats::Counts &CollisionStats::
+get_node_row(const NodePath &node_path) {
+  std::pair<NodeIndex::iterator, bool> result =
+    _node_index.insert(NodeIndex::value_type(node_path, (int)_nodes.size()));
+  if (result.second) {
+    NodeRow row;
+    row._node_path = node_path;
+    _nodes.push_back(row);
+  }
+  return _nodes[(*result.first).second]._counts;
+}
+
+/**
+ * Returns the counts for the indicated collider, adding a new row if
+ * necessary.
+ */
+CollisionStats::Counts &CollisionStats::
+get_collider_row(const NodePath &node_path) {
+  std::pair<NodeIndex::iterator, bool> result =
+    _collider_index.insert(NodeIndex::value_type(node_path, (int)_colliders.size()));
+  if (result.second) {
+    NodeRow row;
+    row._node_path = node_path;
+    _colliders.push_back(row);
+  }
+  return _colliders[(*result.first).second]._counts;
+}
+
+/**
+ * Writes the table of solid type pairs.
+ */
+void CollisionStats::
+write_pair_table(std::ostream &out, int indent_level) const {
+  indent(out, indent_level)
+    << std::left << std::setw(44) << "from / into"
+    << std::right << std::setw(10) << "volume" << std::setw(10) << "tests"
+    << std::setw(8) << "hits" << std::setw(12) << "ms" << "\n";
+
+  pvector<int> order = sort_rows(_pairs);
+  pvector<int>::const_iterator oi;
+  for (oi = order.begin(); oi != order.end(); ++oi) {
+    const PairRow &row = _pairs[*oi];
+    std::string name = row._from_type.get_name() + " / " + row._into_type.get_name();
+    indent(out, indent_level) << std::left << std::setw(44) << name << std::right;
+    write_counts_columns(out, row._counts);
+    out << "\n";
+  }
+}
+
+/**
+ * Writes the table of nodes or of colliders.
+ */
+void CollisionStats::
+write_node_table(std::ostream &out, int indent_level, const char *heading,
+                 const pvector<NodeRow> &rows) const {
+  indent(out, indent_level)
+    << std::left << std::setw(44) << heading
+    << std::right << std::setw(10) << "volume" << std::setw(10) << "tests"
+    << std::setw(8) << "hits" << std::setw(12) << "ms" << "\n";
+
+  pvector<int> order = sort_rows(rows);
+  pvector<int>::const_iterator oi;
+  for (oi = order.begin(); oi != order.end(); ++oi) {
+    const NodeRow &row = rows[*oi];
+    indent(out, indent_level)
+      << std::left << std::setw(44) << format_node_path(row._node_path)
+      << std::right;
+    write_counts_columns(out, row._counts);
+    out << "\n";
+  }
+}
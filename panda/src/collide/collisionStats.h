@@ -0,0 +1,152 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file collisionStats.h
+ * @author agent
+ * @date 2026-10-18
+ */
+
+#ifndef COLLISIONSTATS_H
+#define COLLISIONSTATS_H
+
+#include "pandabase.h"
+
+#include "referenceCount.h"
+#include "nodePath.h"
+#include "typeHandle.h"
+#include "pmap.h"
+#include "pvector.h"
+
+class CollisionEntry;
+
+/**
+ * Accumulates statistics about the work done by a CollisionTraverser, for
+ * finding out which colliders and which parts of a scene are expensive to
+ * test.  Assign one to a traverser with CollisionTraverser::set_stats().
+ *
+ * The number of bounding volume tests, intersection tests and detected
+ * collisions, and the time spent in the intersection tests, are counted
+ * separately for each combination of "from" and "into" solid type, for each
+ * "into" node (a CollisionNode or a GeomNode), and for each collider.  The
+ * counts keep accumulating over any number of traversals, until clear() is
+ * called.
+ *
+ * While statistics are being gathered, the traversal always runs on a single
+ * thread.
+ */
+class EXPCL_PANDA_COLLIDE CollisionStats : public ReferenceCount {
+PUBLISHED:
+  class EXPCL_PANDA_COLLIDE Counts {
+  PUBLISHED:
+    INLINE Counts();
+
+    INLINE int get_num_volume_tests() const;
+    INLINE int get_num_tests() const;
+    INLINE int get_num_hits() const;
+    INLINE double get_time() const;
+
+    MAKE_PROPERTY(num_volume_tests, get_num_volume_tests);
+    MAKE_PROPERTY(num_tests, get_num_tests);
+    MAKE_PROPERTY(num_hits, get_num_hits);
+    MAKE_PROPERTY(time, get_time);
+
+    void output(std::ostream &out) const;
+
+  public:
+    int _num_volume_tests;
+    int _num_tests;
+    int _num_hits;
+    double _time;
+  };
+
+  CollisionStats();
+  void clear();
+
+  INLINE int get_num_traversals() const;
+  INLINE const Counts &get_total() const;
+
+  INLINE int get_num_pairs() const;
+  INLINE TypeHandle get_pair_from_type(int n) const;
+  INLINE TypeHandle get_pair_into_type(int n) const;
+  INLINE const Counts &get_pair_counts(int n) const;
+
+  INLINE int get_num_nodes() const;
+  INLINE NodePath get_node(int n) const;
+  MAKE_SEQ(get_nodes, get_num_nodes, get_node);
+  INLINE const Counts &get_node_counts(int n) const;
+
+  INLINE int get_num_colliders() const;
+  INLINE NodePath get_collider(int n) const;
+  MAKE_SEQ(get_colliders, get_num_colliders, get_collider);
+  INLINE const Counts &get_collider_counts(int n) const;
+
+  MAKE_PROPERTY(num_traversals, get_num_traversals);
+  MAKE_PROPERTY(total, get_total);
+  MAKE_SEQ_PROPERTY(nodes, get_num_nodes, get_node);
+  MAKE_SEQ_PROPERTY(colliders, get_num_colliders, get_collider);
+
+  void output(std::ostream &out) const;
+  void write(std::ostream &out, int indent_level = 0) const;
+  void write_csv(std::ostream &out) const;
+
+public:
+  INLINE void record_traversal();
+  void record_volume_test(const CollisionEntry &entry, TypeHandle into_type);
+  void record_test(const CollisionEntry &entry, bool hit, double time);
+
+private:
+  class PairRow {
+  public:
+    TypeHandle _from_type;
+    TypeHandle _into_type;
+    Counts _counts;
+  };
+  class NodeRow {
+  public:
+    NodePath _node_path;
+    Counts _counts;
+  };
+
+  Counts &get_pair_row(TypeHandle from_type, TypeHandle into_type);
+  Counts &get_node_row(const NodePath &node_path);
+  Counts &get_collider_row(const NodePath &node_path);
+
+  void write_pair_table(std::ostream &out, int indent_level) const;
+  void write_node_table(std::ostream &out, int indent_level,
+                        const char *heading,
+                        const pvector<NodeRow> &rows) const;
+
+private:
+  int _num_traversals;
+  Counts _total;
+
+  typedef std::pair<TypeHandle, TypeHandle> PairKey;
+  typedef pmap<PairKey, int> PairIndex;
+  typedef pmap<NodePath, int> NodeIndex;
+
+  pvector<PairRow> _pairs;
+  PairIndex _pair_index;
+  pvector<NodeRow> _nodes;
+  NodeIndex _node_index;
+  pvector<NodeRow> _colliders;
+  NodeIndex _collider_index;
+};
+
+INLINE std::ostream &operator << (std::ostream &out, const CollisionStats::Counts &counts) {
+  counts.output(out);
+  return out;
+}
+
+INLINE std::ostream &operator << (std::ostream &out, const CollisionStats &stats) {
+  stats.output(out);
+  return out;
+}
+
+#include "collisionStats.I"
+
+#endif
@@ -23,6 +23,8 @@
 #include "collisionTube.h"
 #include "collisionPolygon.h"
 #include "collisionPlane.h"
+#include "collisionMesh.h"
+#include "collisionConvex.h"
 #include "config_collide.h"
 #include "boundingSphere.h"
 #include "transformState.h"
@@ -34,10 +36,13 @@
 #include "lodNode.h"
 #include "nodePath.h"
 #include "pStatTimer.h"
+#include "trueClock.h"
+#include "genericThread.h"
 #include "indent.h"
 
 #include <algorithm>
 
+using std::max;
 using std::min;
 
 PStatCollector CollisionTraverser::_collisions_pcollector("App:Collisions");
@@ -74,6 +79,9 @@ CollisionTraverser(const std::string &name) :
   _this_pcollector(_collisions_pcollector, name)
 {
   _respect_prev_transform = respect_prev_transform;
+  _continuous = collision_continuous;
+  _use_broadphase = collision_broadphase;
+  _num_threads = collision_num_threads;
   #ifdef DO_COLLISION_RECORDING
   _recorder = nullptr;
   #endif
@@ -245,6 +253,7 @@ clear_colliders() {
   _colliders.clear();
   _ordered_colliders.clear();
   _handlers.clear();
+  _broadphase.clear();
 }
 
 /**
@@ -260,6 +269,10 @@ traverse(const NodePath &root) {
   }
   #endif  // DO_COLLISION_RECORDING
 
+  if (_stats != nullptr) {
+    _stats->record_traversal();
+  }
+
   Handlers::iterator hi;
   for (hi = _handlers.begin(); hi != _handlers.end(); ++hi) {
     if ((*hi).first->wants_all_potential_collidees()) {
@@ -268,9 +281,21 @@ traverse(const NodePath &root) {
     (*hi).first->begin_group();
   }
 
+  if (_num_threads > 1) {
+    // Bring the bounding volumes of the scene graph up to date now, so that
+    // the threads below will only need to read them.
+    root.node()->get_bounds();
+  }
+
   bool traversal_done = false;
-  if ((int)_colliders.size() <= CollisionLevelStateSingle::get_max_colliders() ||
-      !allow_collider_multiple) {
+  if (_use_broadphase) {
+    traverse_broadphase(root);
+    traversal_done = true;
+  }
+
+  if (!traversal_done &&
+      ((int)_colliders.size() <= CollisionLevelStateSingle::get_max_colliders() ||
+       !allow_collider_multiple)) {
     // Use the single-word-at-a-time traverser, which might need to make lots
     // of passes.
     LevelStatesSingle level_states;
@@ -281,12 +306,7 @@ traverse(const NodePath &root) {
 
       // Make a number of passes, one for each group of 32 Colliders (or
       // whatever number of bits we have available in CurrentMask).
-      for (size_t pass = 0; pass < level_states.size(); ++pass) {
-#ifdef DO_PSTATS
-        PStatTimer pass_timer(get_pass_collector(pass));
-#endif
-        r_traverse_single(level_states[pass], pass);
-      }
+      traverse_passes(PK_single, &level_states, level_states.size());
     }
   }
 
@@ -299,12 +319,7 @@ traverse(const NodePath &root) {
     if (level_states.size() == 1) {
       traversal_done = true;
 
-      for (size_t pass = 0; pass < level_states.size(); ++pass) {
-#ifdef DO_PSTATS
-        PStatTimer pass_timer(get_pass_collector(pass));
-#endif
-        r_traverse_double(level_states[pass], pass);
-      }
+      traverse_passes(PK_double, &level_states, level_states.size());
     }
   }
 
@@ -315,12 +330,7 @@ traverse(const NodePath &root) {
 
     traversal_done = true;
 
-    for (size_t pass = 0; pass < level_states.size(); ++pass) {
-#ifdef DO_PSTATS
-      PStatTimer pass_timer(get_pass_collector(pass));
-#endif
-      r_traverse_quad(level_states[pass], pass);
-    }
+    traverse_passes(PK_quad, &level_states, level_states.size());
   }
 
   hi = _handlers.begin();
@@ -349,6 +359,8 @@ traverse(const NodePath &root) {
   CollisionPolygon::flush_level();
   CollisionPlane::flush_level();
   CollisionBox::flush_level();
+  CollisionMesh::flush_level();
+  CollisionConvex::flush_level();
 }
 
 #ifdef DO_COLLISION_RECORDING
@@ -470,6 +482,127 @@ write(std::ostream &out, int indent_level) const {
   }
 }
 
+/**
+ * Performs the indicated number of traversal passes.  The passes are
+ * distributed among several threads if set_num_threads() allows it, in which
+ * case the detected collisions are collected per pass, and then passed on to
+ * the handlers in the same order in which a serial traversal would have
+ * reported them.
+ */
+void CollisionTraverser::
+traverse_passes(PassKind kind, void *passes, size_t num_passes) {
+  size_t num_threads = min((size_t)max(_num_threads, 1), num_passes);
+  if (!Thread::is_true_threads()) {
+    num_threads = 1;
+  }
+#ifdef DO_COLLISION_RECORDING
+  if (has_recorder()) {
+    // The recorder is not prepared to be called from multiple threads.
+    num_threads = 1;
+  }
+#endif  // DO_COLLISION_RECORDING
+  if (_stats != nullptr) {
+    // Nor are the statistics.
+    num_threads = 1;
+  }
+
+  if (num_threads <= 1) {
+    for (size_t pass = 0; pass < num_passes; ++pass) {
+#ifdef DO_PSTATS
+      PStatTimer pass_timer(get_pass_collector(pass));
+#endif
+      traverse_pass(kind, passes, pass, num_passes);
+    }
+    return;
+  }
+
+  // Make sure all of the collectors exist before the threads look them up.
+  get_pass_collector((int)num_passes - 1);
+  nassertv(_pass_entries.empty());
+  _pass_entries.resize(num_passes);
+
+  // The passes are dealt out to the threads in turn; this thread takes the
+  // first share.
+  pvector<PassThreadData> data(num_threads);
+  pvector<PT(GenericThread)> threads;
+  for (size_t t = 0; t < num_threads; ++t) {
+    data[t]._trav = this;
+    data[t]._kind = kind;
+    data[t]._passes = passes;
+    data[t]._num_passes = num_passes;
+    data[t]._first = t;
+    data[t]._stride = num_threads;
+    if (t != 0) {
+      PT(GenericThread) thread =
+        new GenericThread("collide", "", &st_traverse_passes, &data[t]);
+      if (thread->start(TP_normal, true)) {
+        threads.push_back(thread);
+      } else {
+        // Couldn't start a thread; do its share here instead.
+        st_traverse_passes(&data[t]);
+      }
+    }
+  }
+  st_traverse_passes(&data[0]);
+
+  for (size_t t = 0; t < threads.size(); ++t) {
+    threads[t]->join();
+  }
+
+  // Now deliver the results in pass order.
+  for (size_t pass = 0; pass < num_passes; ++pass) {
+    DeferredEntries &entries = _pass_entries[pass];
+    DeferredEntries::const_iterator ei;
+    for (ei = entries.begin(); ei != entries.end(); ++ei) {
+      (*ei)._handler->add_entry((*ei)._entry);
+    }
+  }
+  _pass_entries.clear();
+}
+
+/**
+ * Performs the nth of the indicated number of traversal passes.
+ */
+void CollisionTraverser::
+traverse_pass(PassKind kind, void *passes, size_t pass, size_t num_passes) {
+  switch (kind) {
+  case PK_single:
+    r_traverse_single((*(LevelStatesSingle *)passes)[pass], pass);
+    break;
+
+  case PK_double:
+    r_traverse_double((*(LevelStatesDouble *)passes)[pass], pass);
+    break;
+
+  case PK_quad:
+    r_traverse_quad((*(LevelStatesQuad *)passes)[pass], pass);
+    break;
+
+  case PK_broadphase:
+    {
+      const CollisionBroadphase::Pairs &pairs = *(const CollisionBroadphase::Pairs *)passes;
+      size_t num_pairs = pairs.size();
+      compare_broadphase_pairs(pairs, num_pairs * pass / num_passes,
+                               num_pairs * (pass + 1) / num_passes, pass);
+    }
+    break;
+  }
+}
+
+/**
+ * The entry point for each thread started by traverse_passes().
+ */
+void CollisionTraverser::
+st_traverse_passes(void *data) {
+  PassThreadData *td = (PassThreadData *)data;
+  for (size_t pass = td->_first; pass < td->_num_passes; pass += td->_stride) {
+#ifdef DO_PSTATS
+    PStatTimer pass_timer(td->_trav->_pass_collectors[pass]);
+#endif
+    td->_trav->traverse_pass(td->_kind, td->_passes, pass, td->_num_passes);
+  }
+}
+
 /**
  * Fills up the set of LevelStates corresponding to the active colliders in
  * use.
@@ -592,7 +725,7 @@ r_traverse_single(CollisionLevelStateSingle &level_state, size_t pass) {
               entry,
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
-              node_gbv);
+              node_gbv, pass);
         }
       }
     }
@@ -637,7 +770,7 @@ r_traverse_single(CollisionLevelStateSingle &level_state, size_t pass) {
               entry,
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
-              node_gbv);
+              node_gbv, pass);
         }
       }
     }
@@ -803,7 +936,7 @@ r_traverse_double(CollisionLevelStateDouble &level_state, size_t pass) {
               entry,
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
-              node_gbv);
+              node_gbv, pass);
         }
       }
     }
@@ -848,7 +981,7 @@ r_traverse_double(CollisionLevelStateDouble &level_state, size_t pass) {
               entry,
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
-              node_gbv);
+              node_gbv, pass);
         }
       }
     }
@@ -1014,7 +1147,7 @@ r_traverse_quad(CollisionLevelStateQuad &level_state, size_t pass) {
               entry,
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
-              node_gbv);
+              node_gbv, pass);
         }
       }
     }
@@ -1059,7 +1192,7 @@ r_traverse_quad(CollisionLevelStateQuad &level_state, size_t pass) {
               entry,
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
-              node_gbv);
+              node_gbv, pass);
         }
       }
     }
@@ -1103,6 +1236,187 @@ r_traverse_quad(CollisionLevelStateQuad &level_state, size_t pass) {
   }
 }
 
+/**
+ * Performs the traversal using the sweep-and-prune broadphase, instead of the
+ * multiple-pass scene graph traversal.  See set_use_broadphase().
+ */
+void CollisionTraverser::
+traverse_broadphase(const NodePath &root) {
+  _broadphase.begin_update();
+
+  // All of the boxes are computed in the space of the root's parent, as
+  // prepare_collider() does for the ordinary traversal.
+  NodePath space = root.get_parent();
+
+  int num_colliders = _colliders.size();
+  int *indirect = (int *)alloca(sizeof(int) * num_colliders);
+  int i;
+  for (i = 0; i < num_colliders; ++i) {
+    indirect[i] = i;
+  }
+  std::sort(indirect, indirect + num_colliders, SortByColliderSort(*this));
+
+  CollideMask from_mask;
+  int sort = 0;
+  for (i = 0; i < num_colliders; ++i) {
+    OrderedColliderDef &ocd = _ordered_colliders[indirect[i]];
+    NodePath cnode_path = ocd._node_path;
+
+    if (!cnode_path.is_same_graph(root)) {
+      if (ocd._in_graph) {
+        // Only report this warning once.
+        collide_cat.info()
+          << "Collider " << cnode_path
+          << " is not in scene graph.  Ignoring.\n";
+        ocd._in_graph = false;
+      }
+
+    } else {
+      ocd._in_graph = true;
+      CollisionNode *cnode = DCAST(CollisionNode, cnode_path.node());
+      from_mask |= cnode->get_from_collide_mask();
+
+      CPT(TransformState) transform = cnode_path.get_transform(space);
+      LVector3 pos_delta = cnode_path.get_pos_delta(root);
+
+      int num_solids = cnode->get_num_solids();
+      for (int s = 0; s < num_solids; ++s) {
+        CPT(CollisionSolid) collider = cnode->get_solid(s);
+        _broadphase.add_collider(cnode_path, s, collider, transform,
+                                 pos_delta, sort++);
+      }
+    }
+  }
+
+  if (!from_mask.is_zero()) {
+    sort = 0;
+    r_collect_broadphase(root, root.get_transform(space), CollideMask::all_on(),
+                         from_mask, sort);
+  }
+
+  _broadphase.end_update();
+
+  CollisionBroadphase::Pairs pairs;
+  _broadphase.find_pairs(pairs);
+
+  // Each thread gets a contiguous range of the pairs.
+  size_t num_chunks = 1;
+  if (_num_threads > 1) {
+    num_chunks = min(pairs.size() / 64 + 1, (size_t)_num_threads);
+  }
+  traverse_passes(PK_broadphase, &pairs, num_chunks);
+}
+
+/**
+ * Performs the narrowphase tests for the indicated range of the pairs found
+ * by the broadphase.
+ */
+void CollisionTraverser::
+compare_broadphase_pairs(const CollisionBroadphase::Pairs &pairs,
+                         size_t begin, size_t end, size_t pass) {
+  for (size_t i = begin; i < end; ++i) {
+    const CollisionBroadphase::Proxy &from = _broadphase.get_proxy(pairs[i]._from);
+    const CollisionBroadphase::Proxy &into = _broadphase.get_proxy(pairs[i]._into);
+
+    CollisionEntry entry;
+    entry._from_node = DCAST(CollisionNode, from._node_path.node());
+    entry._from_node_path = from._node_path;
+    entry._from = from._solid;
+    entry._into_node = into._node_path.node();
+    entry._into_node_path = into._node_path;
+    if (_respect_prev_transform) {
+      entry._flags |= CollisionEntry::F_respect_prev_transform;
+    }
+
+    // The boxes have already been found to overlap, so we skip the node
+    // bounds test.  We still want the collider's bounds in the space of the
+    // into node, to test against the individual solids or Geoms.  As in
+    // prepare_collider(), a bounding sphere must also include the collider's
+    // position in the previous frame, or a fast-moving collider would miss
+    // the solids it passed through.
+    PT(GeometricBoundingVolume) from_gbv;
+    CPT(BoundingVolume) from_bv = from._bounds;
+    if (from_bv->is_of_type(GeometricBoundingVolume::get_class_type())) {
+      from_gbv = DCAST(GeometricBoundingVolume, from_bv->make_copy());
+      if (from_bv->as_bounding_sphere() && from._pos_delta != LVector3::zero()) {
+        PT(GeometricBoundingVolume) gbv_prev;
+        gbv_prev = DCAST(GeometricBoundingVolume, from_bv->make_copy());
+        gbv_prev->xform(LMatrix4::translate_mat(-from._pos_delta));
+        from_gbv->extend_by(gbv_prev);
+      }
+      from_gbv->xform(entry.get_wrt_mat());
+    }
+
+    if (entry._into_node->is_collision_node()) {
+      compare_collider_to_node(entry, nullptr, from_gbv, nullptr, pass);
+    } else {
+      compare_collider_to_geom_node(entry, nullptr, from_gbv, nullptr, pass);
+    }
+  }
+}
+
+/**
+ * Walks the scene graph below the indicated node, adding each CollisionNode
+ * and GeomNode that any of the colliders might collide with to the
+ * broadphase.  This visits the same nodes that r_traverse_single() would,
+ * including the special handling of switch nodes and LODNodes.
+ */
+void CollisionTraverser::
+r_collect_broadphase(const NodePath &node_path,
+                     const TransformState *net_transform,
+                     CollideMask include_mask, CollideMask from_mask,
+                     int &sort) {
+  PandaNode *node = node_path.node();
+  if ((node->get_net_collide_mask() & include_mask & from_mask).is_zero()) {
+    // Nothing at this node or below can be collided with.
+    return;
+  }
+
+  if (node->is_collision_node() || node->is_geom_node()) {
+    CollideMask into_mask = node->get_into_collide_mask() & include_mask;
+    if (!(into_mask & from_mask).is_zero()) {
+      _broadphase.add_into_node(node_path, net_transform, into_mask, sort++);
+    }
+  }
+
+  if (node->has_single_child_visibility()) {
+    int index = node->get_visible_child();
+    if (index >= 0 && index < node->get_num_children()) {
+      PandaNode *child = node->get_child(index);
+      r_collect_broadphase(NodePath(node_path, child),
+                           net_transform->compose(child->get_transform()),
+                           include_mask, from_mask, sort);
+    }
+
+  } else if (node->is_lod_node()) {
+    // As in r_traverse_single(), only the lowest level of detail may be
+    // collided with as visible geometry.
+    int index = DCAST(LODNode, node)->get_lowest_switch();
+    PandaNode::Children children = node->get_children();
+    int num_children = children.get_num_children();
+    for (int i = 0; i < num_children; ++i) {
+      PandaNode *child = children.get_child(i);
+      CollideMask child_mask = include_mask;
+      if (i != index) {
+        child_mask &= ~GeomNode::get_default_collide_mask();
+      }
+      r_collect_broadphase(NodePath(node_path, child),
+                           net_transform->compose(child->get_transform()),
+                           child_mask, from_mask, sort);
+    }
+
+  } else {
+    PandaNode::Children children = node->get_children();
+    int num_children = children.get_num_children();
+    for (int i = 0; i < num_children; ++i) {
+      PandaNode *child = children.get_child(i);
+      r_collect_broadphase(NodePath(node_path, child),
+                           net_transform->compose(child->get_transform()),
+                           include_mask, from_mask, sort);
+    }
+  }
+}
+
 /**
  *
  */
@@ -1110,12 +1424,16 @@ void CollisionTraverser::
 compare_collider_to_node(CollisionEntry &entry,
                          const GeometricBoundingVolume *from_parent_gbv,
                          const GeometricBoundingVolume *from_node_gbv,
-                         const GeometricBoundingVolume *into_node_gbv) {
+                         const GeometricBoundingVolume *into_node_gbv,
+                         size_t pass) {
   bool within_node_bounds = true;
   if (from_parent_gbv != nullptr &&
       into_node_gbv != nullptr) {
     within_node_bounds = (into_node_gbv->contains(from_parent_gbv) != 0);
     _cnode_volume_pcollector.add_level(1);
+    if (_stats != nullptr) {
+      _stats->record_volume_test(entry, TypeHandle::none());
+    }
   }
 
   if (within_node_bounds) {
@@ -1140,7 +1458,7 @@ compare_collider_to_node(CollisionEntry &entry,
       Colliders::const_iterator ci;
       ci = _colliders.find(entry.get_from_node_path());
       nassertv(ci != _colliders.end());
-      entry.test_intersection((*ci).second, this);
+      do_test_intersection(entry, (*ci).second, pass);
     } else {
       CollisionNode::Solids::const_iterator si;
       for (si = cnode->_solids.begin(); si != cnode->_solids.end(); ++si) {
@@ -1156,7 +1474,7 @@ compare_collider_to_node(CollisionEntry &entry,
           solid_gbv = (const GeometricBoundingVolume *)solid_bv.p();
         }
 
-        compare_collider_to_solid(entry, from_node_gbv, solid_gbv);
+        compare_collider_to_solid(entry, from_node_gbv, solid_gbv, pass);
       }
     }
   }
@@ -1169,12 +1487,16 @@ void CollisionTraverser::
 compare_collider_to_geom_node(CollisionEntry &entry,
                               const GeometricBoundingVolume *from_parent_gbv,
                               const GeometricBoundingVolume *from_node_gbv,
-                              const GeometricBoundingVolume *into_node_gbv) {
+                              const GeometricBoundingVolume *into_node_gbv,
+                              size_t pass) {
   bool within_node_bounds = true;
   if (from_parent_gbv != nullptr &&
       into_node_gbv != nullptr) {
     within_node_bounds = (into_node_gbv->contains(from_parent_gbv) != 0);
     _gnode_volume_pcollector.add_level(1);
+    if (_stats != nullptr) {
+      _stats->record_volume_test(entry, TypeHandle::none());
+    }
   }
 
   if (within_node_bounds) {
@@ -1197,7 +1519,7 @@ compare_collider_to_geom_node(CollisionEntry &entry,
           DCAST_INTO_V(geom_gbv, geom_bv);
         }
 
-        compare_collider_to_geom(entry, geom, from_node_gbv, geom_gbv);
+        compare_collider_to_geom(entry, geom, from_node_gbv, geom_gbv, pass);
       }
     }
   }
@@ -1209,7 +1531,8 @@ compare_collider_to_geom_node(CollisionEntry &entry,
 void CollisionTraverser::
 compare_collider_to_solid(CollisionEntry &entry,
                           const GeometricBoundingVolume *from_node_gbv,
-                          const GeometricBoundingVolume *solid_gbv) {
+                          const GeometricBoundingVolume *solid_gbv,
+                          size_t pass) {
   bool within_solid_bounds = true;
   if (from_node_gbv != nullptr &&
       solid_gbv != nullptr) {
@@ -1217,6 +1540,9 @@ compare_collider_to_solid(CollisionEntry &entry,
     #ifdef DO_PSTATS
     ((CollisionSolid *)entry.get_into())->get_volume_pcollector().add_level(1);
     #endif  // DO_PSTATS
+    if (_stats != nullptr) {
+      _stats->record_volume_test(entry, entry.get_into()->get_type());
+    }
 #ifndef NDEBUG
     if (collide_cat.is_spam()) {
       collide_cat.spam(false)
@@ -1230,7 +1556,7 @@ compare_collider_to_solid(CollisionEntry &entry,
     Colliders::const_iterator ci;
     ci = _colliders.find(entry.get_from_node_path());
     nassertv(ci != _colliders.end());
-    entry.test_intersection((*ci).second, this);
+    do_test_intersection(entry, (*ci).second, pass);
   }
 }
 
@@ -1240,12 +1566,16 @@ compare_collider_to_solid(CollisionEntry &entry,
 void CollisionTraverser::
 compare_collider_to_geom(CollisionEntry &entry, const Geom *geom,
                          const GeometricBoundingVolume *from_node_gbv,
-                         const GeometricBoundingVolume *geom_gbv) {
+                         const GeometricBoundingVolume *geom_gbv,
+                         size_t pass) {
   bool within_geom_bounds = true;
   if (from_node_gbv != nullptr &&
       geom_gbv != nullptr) {
     within_geom_bounds = (geom_gbv->contains(from_node_gbv) != 0);
     _geom_volume_pcollector.add_level(1);
+    if (_stats != nullptr) {
+      _stats->record_volume_test(entry, TypeHandle::none());
+    }
   }
   if (within_geom_bounds) {
     Colliders::const_iterator ci;
@@ -1287,11 +1617,14 @@ compare_collider_to_geom(CollisionEntry &entry, const Geom *geom,
 #ifdef DO_PSTATS
                 CollisionGeom::_volume_pcollector.add_level(1);
 #endif  // DO_PSTATS
+                if (_stats != nullptr) {
+                  _stats->record_volume_test(entry, CollisionGeom::get_class_type());
+                }
               }
               if (within_solid_bounds) {
                 PT(CollisionGeom) cgeom = new CollisionGeom(LVecBase3(v[0]), LVecBase3(v[1]), LVecBase3(v[2]));
                 entry._into = cgeom;
-                entry.test_intersection((*ci).second, this);
+                do_test_intersection(entry, (*ci).second, pass);
               }
             }
           }
@@ -1317,11 +1650,14 @@ compare_collider_to_geom(CollisionEntry &entry, const Geom *geom,
 #ifdef DO_PSTATS
                 CollisionGeom::_volume_pcollector.add_level(1);
 #endif  // DO_PSTATS
+                if (_stats != nullptr) {
+                  _stats->record_volume_test(entry, CollisionGeom::get_class_type());
+                }
               }
               if (within_solid_bounds) {
                 PT(CollisionGeom) cgeom = new CollisionGeom(LVecBase3(v[0]), LVecBase3(v[1]), LVecBase3(v[2]));
                 entry._into = cgeom;
-                entry.test_intersection((*ci).second, this);
+                do_test_intersection(entry, (*ci).second, pass);
               }
             }
           }
@@ -1384,6 +1720,48 @@ remove_handler(CollisionTraverser::Handlers::iterator hi) {
   return hi;
 }
 
+/**
+ * Performs the intersection test described by the indicated entry, and
+ * passes the result to the handler; or, if the passes are being performed by
+ * multiple threads, saves it to be passed to the handler later.
+ */
+void CollisionTraverser::
+do_test_intersection(const CollisionEntry &entry, CollisionHandler *handler,
+                     size_t pass) {
+  if (_stats != nullptr) {
+    // Time the test, and pass the result on ourselves, so that it can be
+    // recorded.  We are running on a single thread in this case.
+    TrueClock *clock = TrueClock::get_global_ptr();
+    double start = clock->get_short_time();
+    PT(CollisionEntry) result = entry.compute_intersection(handler, this);
+    double time = clock->get_short_time() - start;
+
+    // A handler that wants all potential collisions also receives entries
+    // for the tests that failed, which are marked as not having collided.
+    bool hit = (result != nullptr);
+    if (hit && handler->wants_all_potential_collidees()) {
+      hit = result->collided();
+    }
+    _stats->record_test(entry, hit, time);
+    if (result != nullptr) {
+      handler->add_entry(result);
+    }
+    return;
+  }
+
+  if (_pass_entries.empty()) {
+    entry.test_intersection(handler, this);
+  } else {
+    PT(CollisionEntry) result = entry.compute_intersection(handler, this);
+    if (result != nullptr) {
+      DeferredEntry def;
+      def._handler = handler;
+      def._entry = std::move(result);
+      _pass_entries[pass].push_back(std::move(def));
+    }
+  }
+}
+
 /**
  * Returns the PStatCollector suitable for timing the nth pass.
  */
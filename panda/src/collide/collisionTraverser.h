@@ -18,6 +18,8 @@
 
 #include "collisionHandler.h"
 #include "collisionLevelState.h"
+#include "collisionBroadphase.h"
+#include "collisionStats.h"
 
 #include "pointerTo.h"
 #include "pStatCollector.h"
@@ -52,6 +54,18 @@ PUBLISHED:
   MAKE_PROPERTY(respect_preV_transform, get_respect_prev_transform,
                                         set_respect_prev_transform);
 
+  INLINE void set_continuous(bool flag);
+  INLINE bool get_continuous() const;
+  MAKE_PROPERTY(continuous, get_continuous, set_continuous);
+
+  INLINE void set_use_broadphase(bool flag);
+  INLINE bool get_use_broadphase() const;
+  MAKE_PROPERTY(use_broadphase, get_use_broadphase, set_use_broadphase);
+
+  INLINE void set_num_threads(int num_threads);
+  INLINE int get_num_threads() const;
+  MAKE_PROPERTY(num_threads, get_num_threads, set_num_threads);
+
   void add_collider(const NodePath &collider, CollisionHandler *handler);
   bool remove_collider(const NodePath &collider);
   bool has_collider(const NodePath &collider) const;
@@ -64,6 +78,12 @@ PUBLISHED:
 
   void traverse(const NodePath &root);
 
+  INLINE void set_stats(CollisionStats *stats);
+  INLINE bool has_stats() const;
+  INLINE CollisionStats *get_stats() const;
+  INLINE void clear_stats();
+  MAKE_PROPERTY2(stats, has_stats, get_stats, set_stats, clear_stats);
+
 #ifdef DO_COLLISION_RECORDING
   void set_recorder(CollisionRecorder *recorder);
   INLINE bool has_recorder() const;
@@ -80,6 +100,16 @@ PUBLISHED:
   void write(std::ostream &out, int indent_level) const;
 
 private:
+  enum PassKind {
+    PK_single,
+    PK_double,
+    PK_quad,
+    PK_broadphase,
+  };
+  void traverse_passes(PassKind kind, void *passes, size_t num_passes);
+  void traverse_pass(PassKind kind, void *passes, size_t pass, size_t num_passes);
+  static void st_traverse_passes(void *data);
+
   typedef pvector<CollisionLevelStateSingle> LevelStatesSingle;
   void prepare_colliders_single(LevelStatesSingle &level_states, const NodePath &root);
   void r_traverse_single(CollisionLevelStateSingle &level_state, size_t pass);
@@ -92,20 +122,35 @@ private:
   void prepare_colliders_quad(LevelStatesQuad &level_states, const NodePath &root);
   void r_traverse_quad(CollisionLevelStateQuad &level_state, size_t pass);
 
+  void traverse_broadphase(const NodePath &root);
+  void r_collect_broadphase(const NodePath &node_path,
+                            const TransformState *net_transform,
+                            CollideMask include_mask, CollideMask from_mask,
+                            int &sort);
+  void compare_broadphase_pairs(const CollisionBroadphase::Pairs &pairs,
+                                size_t begin, size_t end, size_t pass);
+
+  void do_test_intersection(const CollisionEntry &entry,
+                            CollisionHandler *handler, size_t pass);
+
   void compare_collider_to_node(CollisionEntry &entry,
                                 const GeometricBoundingVolume *from_parent_gbv,
                                 const GeometricBoundingVolume *from_node_gbv,
-                                const GeometricBoundingVolume *into_node_gbv);
+                                const GeometricBoundingVolume *into_node_gbv,
+                                size_t pass);
   void compare_collider_to_geom_node(CollisionEntry &entry,
                                      const GeometricBoundingVolume *from_parent_gbv,
                                      const GeometricBoundingVolume *from_node_gbv,
-                                     const GeometricBoundingVolume *into_node_gbv);
+                                     const GeometricBoundingVolume *into_node_gbv,
+                                     size_t pass);
   void compare_collider_to_solid(CollisionEntry &entry,
                                  const GeometricBoundingVolume *from_node_gbv,
-                                 const GeometricBoundingVolume *solid_gbv);
+                                 const GeometricBoundingVolume *solid_gbv,
+                                 size_t pass);
   void compare_collider_to_geom(CollisionEntry &entry, const Geom *geom,
                                 const GeometricBoundingVolume *from_node_gbv,
-                                const GeometricBoundingVolume *solid_gbv);
+                                const GeometricBoundingVolume *solid_gbv,
+                                size_t pass);
 
   PStatCollector &get_pass_collector(int pass);
 
@@ -129,6 +174,34 @@ private:
   Handlers::iterator remove_handler(Handlers::iterator hi);
 
   bool _respect_prev_transform;
+  bool _continuous;
+  bool _use_broadphase;
+  CollisionBroadphase _broadphase;
+
+  // While the passes are being performed by multiple threads, the detected
+  // collisions are stored here, one list per pass, to be delivered to the
+  // handlers afterwards.
+  class DeferredEntry {
+  public:
+    CollisionHandler *_handler;
+    PT(CollisionEntry) _entry;
+  };
+  typedef pvector<DeferredEntry> DeferredEntries;
+  typedef pvector<DeferredEntries> PassEntries;
+  PassEntries _pass_entries;
+  int _num_threads;
+
+  class PassThreadData {
+  public:
+    CollisionTraverser *_trav;
+    PassKind _kind;
+    void *_passes;
+    size_t _num_passes;
+    size_t _first;
+    size_t _stride;
+  };
+  PT(CollisionStats) _stats;
+
 #ifdef DO_COLLISION_RECORDING
   CollisionRecorder *_recorder;
   NodePath _collision_visualizer_np;
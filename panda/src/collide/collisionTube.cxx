@@ -19,6 +19,7 @@
 #include "collisionHandler.h"
 #include "collisionEntry.h"
 #include "collisionParabola.h"
+#include "collisionConvex.h"
 #include "config_collide.h"
 #include "look_at.h"
 #include "geom.h"
@@ -506,6 +507,51 @@ test_intersection_from_parabola(const CollisionEntry &entry) const {
   return new_entry;
 }
 
+/**
+ *
+ */
+PT(CollisionEntry) CollisionTube::
+test_intersection_from_convex(const CollisionEntry &entry) const {
+  const CollisionConvex *convex;
+  DCAST_INTO_R(convex, entry.get_from(), nullptr);
+
+  CollisionConvex::SupportShape from_shape;
+  convex->get_support_shape(from_shape, entry.get_wrt_mat());
+  if (from_shape._points.empty()) {
+    return nullptr;
+  }
+
+  CollisionConvex::SupportShape into_shape;
+  into_shape._points.push_back(get_point_a());
+  into_shape._points.push_back(get_point_b());
+  into_shape._radius = get_radius();
+
+  LVector3 normal;
+  PN_stdfloat depth;
+  LPoint3 interior_point;
+  if (!CollisionConvex::compute_penetration(from_shape, into_shape, normal,
+                                            depth, interior_point)) {
+    return nullptr;
+  }
+
+  if (collide_cat.is_debug()) {
+    collide_cat.debug()
+      << "intersection detected from " << entry.get_from_node_path()
+      << " into " << entry.get_into_node_path() << "\n";
+  }
+  PT(CollisionEntry) new_entry = new CollisionEntry(entry);
+
+  if (has_effective_normal() && convex->get_respect_effective_normal()) {
+    new_entry->set_surface_normal(get_effective_normal());
+  } else {
+    new_entry->set_surface_normal(normal);
+  }
+  new_entry->set_surface_point(interior_point + normal * depth);
+  new_entry->set_interior_point(interior_point);
+
+  return new_entry;
+}
+
 /**
  * Fills the _viz_geom GeomNode up with Geoms suitable for rendering this
  * solid.
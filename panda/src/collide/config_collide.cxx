@@ -13,6 +13,7 @@
 
 #include "config_collide.h"
 #include "collisionBox.h"
+#include "collisionConvex.h"
 #include "collisionEntry.h"
 #include "collisionHandler.h"
 #include "collisionHandlerEvent.h"
@@ -32,6 +33,8 @@
 #include "collisionPlane.h"
 #include "collisionPolygon.h"
 #include "collisionFloorMesh.h"
+#include "collisionHeightfield.h"
+#include "collisionMesh.h"
 #include "collisionRay.h"
 #include "collisionRecorder.h"
 #include "collisionSegment.h"
@@ -77,6 +80,41 @@ ConfigVariableBool allow_collider_multiple
           "false, a one-word BitMask is always used instead, which is faster "
           "per pass, but may require more passes."));
 
+ConfigVariableBool collision_broadphase
+("collision-broadphase", false,
+ PRC_DESC("Set this true to make CollisionTraversers use a sweep-and-prune "
+          "broadphase by default, which walks the scene graph once per "
+          "traversal instead of once per group of colliders.  This is "
+          "usually faster with hundreds of moving colliders.  See "
+          "CollisionTraverser::set_use_broadphase()."));
+
+ConfigVariableInt collision_num_threads
+("collision-num-threads", 1,
+ PRC_DESC("The default maximum number of threads a CollisionTraverser may "
+          "use to perform its passes in parallel.  The collisions are "
+          "reported to the handlers in the same order regardless of this "
+          "setting.  See CollisionTraverser::set_num_threads()."));
+
+ConfigVariableBool collision_continuous
+("collision-continuous", false,
+ PRC_DESC("Set this true to make CollisionTraversers perform continuous "
+          "collision detection by default for fast-moving spheres and boxes.  "
+          "This has no effect unless respect-prev-transform is also enabled.  "
+          "See CollisionTraverser::set_continuous()."));
+
+ConfigVariableInt collision_ccd_max_steps
+("collision-ccd-max-steps", 32,
+ PRC_DESC("The maximum number of positions along its path at which a "
+          "fast-moving collider is tested for continuous collision detection.  "
+          "A collider that moves farther than this many times its own radius "
+          "in one frame may still pass through thin objects."));
+
+ConfigVariableInt collision_ccd_refine_steps
+("collision-ccd-refine-steps", 8,
+ PRC_DESC("The number of bisection steps used to refine the time of impact "
+          "found by continuous collision detection.  Each step halves the "
+          "uncertainty."));
+
 ConfigVariableBool flatten_collision_nodes
 ("flatten-collision-nodes", false,
  PRC_DESC("Set this true to allow NodePath::flatten_medium() and "
@@ -126,6 +164,7 @@ init_libcollide() {
   initialized = true;
 
   CollisionBox::init_type();
+  CollisionConvex::init_type();
   CollisionEntry::init_type();
   CollisionHandler::init_type();
   CollisionHandlerEvent::init_type();
@@ -145,6 +184,8 @@ init_libcollide() {
   CollisionPlane::init_type();
   CollisionPolygon::init_type();
   CollisionFloorMesh::init_type();
+  CollisionHeightfield::init_type();
+  CollisionMesh::init_type();
   CollisionRay::init_type();
   CollisionSegment::init_type();
   CollisionSolid::init_type();
@@ -158,6 +199,7 @@ init_libcollide() {
 #endif
 
   CollisionBox::register_with_read_factory();
+  CollisionConvex::register_with_read_factory();
   CollisionInvSphere::register_with_read_factory();
   CollisionLine::register_with_read_factory();
   CollisionNode::register_with_read_factory();
@@ -165,6 +207,8 @@ init_libcollide() {
   CollisionPlane::register_with_read_factory();
   CollisionPolygon::register_with_read_factory();
   CollisionFloorMesh::register_with_read_factory();
+  CollisionHeightfield::register_with_read_factory();
+  CollisionMesh::register_with_read_factory();
   CollisionRay::register_with_read_factory();
   CollisionSegment::register_with_read_factory();
   CollisionSphere::register_with_read_factory();
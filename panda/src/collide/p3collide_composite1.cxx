@@ -1,5 +1,7 @@
 #include "config_collide.cxx"
 #include "collisionBox.cxx"
+#include "collisionBroadphase.cxx"
+#include "collisionConvex.cxx"
 #include "collisionEntry.cxx"
 #include "collisionGeom.cxx"
 #include "collisionHandler.cxx"
@@ -11,6 +13,7 @@
 #include "collisionHandlerPusher.cxx"
 #include "collisionHandlerFluidPusher.cxx"
 #include "collisionHandlerQueue.cxx"
+#include "collisionHeightfield.cxx"
 #include "collisionInvSphere.cxx"
 #include "collisionLevelStateBase.cxx"
 #include "collisionLevelState.cxx"
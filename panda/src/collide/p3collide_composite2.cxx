@@ -1,14 +1,17 @@
 #include "collisionLine.cxx"
+#include "collisionMesh.cxx"
 #include "collisionNode.cxx"
 #include "collisionParabola.cxx"
 #include "collisionPlane.cxx"
 #include "collisionPolygon.cxx"
 #include "collisionFloorMesh.cxx"
 #include "collisionRay.cxx"
+#include "collisionRayBatch.cxx"
 #include "collisionRecorder.cxx"
 #include "collisionSegment.cxx"
 #include "collisionSolid.cxx"
 #include "collisionSphere.cxx"
+#include "collisionStats.cxx"
 #include "collisionTraverser.cxx"
 #include "collisionTube.cxx"
 #include "collisionVisualizer.cxx"
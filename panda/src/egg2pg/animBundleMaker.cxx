@@ -24,6 +24,7 @@
 #include "animBundleNode.h"
 #include "animChannelMatrixXfmTable.h"
 #include "animChannelScalarTable.h"
+#include "config_chan.h"
 
 using std::min;
 
@@ -84,6 +85,10 @@ make_bundle() {
 
   bundle->sort_descendants();
 
+  if (compress_anim_channels) {
+    bundle->compress_channels();
+  }
+
   return bundle;
 }
 
@@ -52,6 +52,7 @@
 #include "modelNode.h"
 #include "animBundleNode.h"
 #include "animChannelMatrixXfmTable.h"
+#include "animChannelMatrixCompressed.h"
 #include "characterJointEffect.h"
 #include "characterJoint.h"
 #include "character.h"
@@ -318,6 +319,28 @@ EggGroupNode * EggSaver::convert_animGroup_node(AnimGroup *animGroup, double fps
       }
     }
     eggNode->add_child(egg_anim);
+
+  } else if (animGroup->is_of_type(AnimChannelMatrixCompressed::get_class_type())) {
+    // A compressed channel is written out with one row for each frame.
+    AnimChannelMatrixCompressed *channel = DCAST(AnimChannelMatrixCompressed, animGroup);
+    EggXfmSAnim *egg_anim = new EggXfmSAnim("xform");
+    egg_anim->set_fps(fps);
+    int num_frames = channel->get_num_frames();
+    for (int f = 0; f < num_frames; f++) {
+      LVecBase3 scale, shear, hpr, pos;
+      channel->get_scale(f, scale);
+      channel->get_shear(f, shear);
+      channel->get_hpr(f, hpr);
+      channel->get_pos(f, pos);
+      for (int i = 0; i < 3; i++) {
+        egg_anim->add_component_data(string(1, matrix_component_letters[i]), scale[i]);
+        egg_anim->add_component_data(string(1, matrix_component_letters[i + 3]), shear[i]);
+        egg_anim->add_component_data(string(1, matrix_component_letters[i + 6]), hpr[i]);
+        egg_anim->add_component_data(string(1, matrix_component_letters[i + 9]), pos[i]);
+      }
+    }
+    egg_anim->optimize();
+    eggNode->add_child(egg_anim);
   }
   for (int i = 0; i < num_children; i++) {
     AnimGroup *animChild = animGroup->get_child(i);
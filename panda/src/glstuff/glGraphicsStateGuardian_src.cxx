@@ -6459,10 +6459,17 @@ prepare_shader_buffer(ShaderBuffer *data) {
     // Some drivers require the buffer to be padded to 16 byte boundary.
     uint64_t num_bytes = (data->get_data_size_bytes() + 15u) & ~15u;
     if (_supports_buffer_storage) {
-      _glBufferStorage(GL_SHADER_STORAGE_BUFFER, num_bytes, data->get_initial_data(), 0);
+      // Buffers that aren't static may have their contents replaced later.
+      GLbitfield flags = 0;
+      if (data->get_usage_hint() != GeomEnums::UH_static) {
+        flags |= GL_DYNAMIC_STORAGE_BIT;
+      }
+      _glBufferStorage(GL_SHADER_STORAGE_BUFFER, num_bytes, data->get_initial_data(), flags);
     } else {
       _glBufferData(GL_SHADER_STORAGE_BUFFER, num_bytes, data->get_initial_data(), get_usage(data->get_usage_hint()));
     }
+    gbc->update_data_size_bytes(num_bytes);
+    gbc->update_modified(data->get_modified());
 
     gbc->enqueue_lru(&_prepared_objects->_graphics_memory_lru);
 
@@ -6481,6 +6488,43 @@ apply_shader_buffer(GLuint base, ShaderBuffer *buffer) {
   GLuint index = 0;
   if (buffer != nullptr) {
     BufferContext *bc = buffer->prepare_now(get_prepared_objects(), this);
+    if (bc != nullptr && bc->get_modified() != buffer->get_modified()) {
+      // The contents were replaced since we last uploaded them.
+      PStatGPUTimer timer(this, _load_shader_buffer_pcollector);
+      CLP(BufferContext) *gbc = DCAST(CLP(BufferContext), bc);
+      uint64_t num_bytes = (buffer->get_data_size_bytes() + 15u) & ~15u;
+      GLbitfield flags = 0;
+      if (buffer->get_usage_hint() != GeomEnums::UH_static) {
+        flags |= GL_DYNAMIC_STORAGE_BIT;
+      }
+
+      if (num_bytes == gbc->get_data_size_bytes() &&
+          (!_supports_buffer_storage || flags != 0)) {
+        _glBindBuffer(GL_SHADER_STORAGE_BUFFER, gbc->_index);
+        _glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, num_bytes, buffer->get_initial_data());
+
+      } else if (_supports_buffer_storage) {
+        // Immutable storage cannot be respecified, so we have to replace the
+        // buffer object.
+        for (size_t i = 0; i < _current_sbuffer_base.size(); ++i) {
+          if (_current_sbuffer_base[i] == gbc->_index) {
+            _current_sbuffer_base[i] = 0;
+          }
+        }
+        _glDeleteBuffers(1, &gbc->_index);
+        _glGenBuffers(1, &gbc->_index);
+        _glBindBuffer(GL_SHADER_STORAGE_BUFFER, gbc->_index);
+        _glBufferStorage(GL_SHADER_STORAGE_BUFFER, num_bytes, buffer->get_initial_data(), flags);
+
+      } else {
+        _glBindBuffer(GL_SHADER_STORAGE_BUFFER, gbc->_index);
+        _glBufferData(GL_SHADER_STORAGE_BUFFER, num_bytes, buffer->get_initial_data(), get_usage(buffer->get_usage_hint()));
+      }
+      _current_sbuffer_index = gbc->_index;
+      gbc->update_data_size_bytes(num_bytes);
+      gbc->update_modified(buffer->get_modified());
+      report_my_gl_errors();
+    }
     if (bc != nullptr) {
       CLP(BufferContext) *gbc = DCAST(CLP(BufferContext), bc);
       index = gbc->_index;
@@ -266,6 +266,7 @@ CLP(ShaderContext)(CLP(GraphicsStateGuardian) *glgsg, Shader *s) : ShaderContext
   _enabled_attribs.clear();
   _color_attrib_index = -1;
   _transform_table_index = -1;
+  _transform_table_binding = -1;
   _slider_table_index = -1;
   _frame_number_loc = -1;
   _frame_number = -1;
@@ -349,6 +350,13 @@ CLP(ShaderContext)(CLP(GraphicsStateGuardian) *glgsg, Shader *s) : ShaderContext
       GLint values[2];
       _glgsg->_glGetProgramResourceiv(_glsl_program, GL_SHADER_STORAGE_BLOCK, i, 2, props, 2, nullptr, values);
 
+      if (strcmp(block_name_cstr, "p3d_TransformTable") == 0) {
+        // This receives the joint palette of the vertex data's transform
+        // table, rather than a shader input.
+        _transform_table_binding = values[0];
+        continue;
+      }
+
       StorageBlock block;
       block._name = InternalName::make(block_name_cstr);
       block._binding_index = values[0];
@@ -2230,20 +2238,39 @@ issue_parameters(int altered) {
  */
 void CLP(ShaderContext)::
 update_transform_table(const TransformTable *table) {
+  // If the table takes its palette from another table that holds the same
+  // matrices, we track that table instead, so that all of the tables sharing
+  // its palette share a single upload as well.
+  CPT(TransformTable) source;
+  if (table != nullptr) {
+    source = table->get_palette_source();
+    if (source != nullptr) {
+      table = source;
+    }
+  }
+
+  // The uniform values are retained by the program, so if it still holds the
+  // matrices of this table, there is nothing to upload.
+  UpdateSeq modified;
+  if (table != nullptr) {
+    modified = table->get_modified(_glgsg->_data_reader->get_current_thread());
+  }
+  if (table == _transform_table && modified == _transform_table_modified &&
+      !modified.is_initial()) {
+    return;
+  }
+  _transform_table = table;
+  _transform_table_modified = modified;
+
   LMatrix4f *matrices = (LMatrix4f *)alloca(_transform_table_size * 64);
 
   size_t i = 0;
   if (table != nullptr) {
-    size_t num_transforms = min((size_t)_transform_table_size, table->get_num_transforms());
-    for (; i < num_transforms; ++i) {
-#ifdef STDFLOAT_DOUBLE
-      LMatrix4 matrix;
-      table->get_transform(i)->get_matrix(matrix);
-      matrices[i] = LCAST(float, matrix);
-#else
-      table->get_transform(i)->get_matrix(matrices[i]);
-#endif
-    }
+    // The matrices are packed only once per modification of the table, no
+    // matter how many Geoms use it.
+    CPT(ShaderBuffer) palette = table->get_palette_buffer(_glgsg->_data_reader->get_current_thread());
+    i = min((size_t)_transform_table_size, table->get_num_transforms());
+    memcpy(matrices, palette->get_initial_data(), i * 64);
   }
   for (; i < (size_t)_transform_table_size; ++i) {
     matrices[i] = LMatrix4f::ident_mat();
@@ -2460,6 +2487,19 @@ update_shader_vertex_arrays(ShaderContext *prev, bool force) {
     update_transform_table(table);
   }
 
+#ifndef OPENGLES
+  if (_transform_table_binding >= 0) {
+    // The palette buffer is shared by all Geoms using the same table, and is
+    // only uploaded again when one of the transforms has changed.
+    const TransformTable *table = _glgsg->_data_reader->get_transform_table();
+    CPT(ShaderBuffer) buffer;
+    if (table != nullptr) {
+      buffer = table->get_palette_buffer(_glgsg->_data_reader->get_current_thread());
+    }
+    _glgsg->apply_shader_buffer(_transform_table_binding, (ShaderBuffer *)buffer.p());
+  }
+#endif
+
   if (_slider_table_index >= 0) {
     const SliderTable *table = _glgsg->_data_reader->get_slider_table();
     update_slider_table(table);
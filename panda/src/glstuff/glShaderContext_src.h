@@ -86,11 +86,17 @@ private:
   BitMask32 _enabled_attribs;
   GLint _color_attrib_index;
   GLint _transform_table_index;
+  GLint _transform_table_binding;
   GLint _slider_table_index;
   GLsizei _transform_table_size;
   GLsizei _slider_table_size;
   GLint _frame_number_loc;
   GLint _frame_number;
+
+  // The transform table whose matrices were last loaded into the
+  // p3d_TransformTable uniform of this program.
+  CPT(TransformTable) _transform_table;
+  UpdateSeq _transform_table_modified;
 #ifndef OPENGLES
   pmap<GLint, GLuint64> _glsl_uniform_handles;
 #endif
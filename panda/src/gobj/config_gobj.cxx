@@ -332,6 +332,16 @@ ConfigVariableBool textures_header_only
           "number of channels and so forth.  The texture images themselves "
           "will be generated in a default blue color."));
 
+ConfigVariableBool textures_direct_decode
+("textures-direct-decode", true,
+ PRC_DESC("If this is true, image files that are loaded as textures without "
+          "any rescaling or other modification will be decoded directly "
+          "into the texture's RAM image, when the file type supports it "
+          "(currently JPEG and PNG files with 8 bits per channel).  This "
+          "avoids the need for an intermediate PNMImage, which saves both "
+          "time and memory.  Set this false to always go through a "
+          "PNMImage."));
+
 ConfigVariableInt simple_image_size
 ("simple-image-size", "16 16",
  PRC_DESC("This is an x y pair that specifies the maximum size of an "
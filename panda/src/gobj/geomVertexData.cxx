@@ -1482,85 +1482,22 @@ update_animated_vertices(GeomVertexData::CData *cdata, Thread *current_thread) {
   // (and isn't obviously faster than just copying the whole thing).
   new_data->copy_from(this, true);
 
-  // First, apply all of the morphs.
+  // First, apply all of the morphs.  We work from a sparse copy of the morph
+  // deltas, so that we only visit the rows that each active slider moves.
   CPT(SliderTable) slider_table = cdata->_slider_table;
   if (slider_table != nullptr) {
     PStatTimer timer2(_morphs_pcollector);
-    int num_morphs = orig_format->get_num_morphs();
-    for (int mi = 0; mi < num_morphs; mi++) {
-      CPT(InternalName) slider_name = orig_format->get_morph_slider(mi);
-
-      const SparseArray &sliders = slider_table->find_sliders(slider_name);
-      if (!sliders.is_zero()) {
-        nassertv(!sliders.is_inverse());
-        int num_slider_subranges = sliders.get_num_subranges();
-        for (int sni = 0; sni < num_slider_subranges; ++sni) {
-          int slider_begin = sliders.get_subrange_begin(sni);
-          int slider_end = sliders.get_subrange_end(sni);
-          for (int sn = slider_begin; sn < slider_end; ++sn) {
-            const VertexSlider *slider = slider_table->get_slider(sn);
-            const SparseArray &rows = slider_table->get_slider_rows(sn);
-            nassertv(!rows.is_inverse());
-
-            PN_stdfloat slider_value = slider->get_slider();
-            if (slider_value != 0.0f) {
-              CPT(InternalName) base_name = orig_format->get_morph_base(mi);
-              CPT(InternalName) delta_name = orig_format->get_morph_delta(mi);
-
-              GeomVertexRewriter data(new_data, base_name);
-              GeomVertexReader delta(this, delta_name);
-              int num_subranges = rows.get_num_subranges();
-
-              if (data.get_column()->get_num_values() == 4) {
-                if (data.get_column()->has_homogeneous_coord()) {
-                  // Scale the delta by the homogeneous coordinate.
-                  for (int i = 0; i < num_subranges; ++i) {
-                    int begin = rows.get_subrange_begin(i);
-                    int end = rows.get_subrange_end(i);
-                    data.set_row_unsafe(begin);
-                    delta.set_row_unsafe(begin);
-                    for (int j = begin; j < end; ++j) {
-                      LPoint4 vertex = data.get_data4();
-                      LPoint3 d = delta.get_data3();
-                      d *= slider_value * vertex[3];
-                      data.set_data4(vertex[0] + d[0],
-                                      vertex[1] + d[1],
-                                      vertex[2] + d[2],
-                                      vertex[3]);
-                    }
-                  }
-                } else {
-                  // Just apply the four-component delta.
-                  for (int i = 0; i < num_subranges; ++i) {
-                    int begin = rows.get_subrange_begin(i);
-                    int end = rows.get_subrange_end(i);
-                    data.set_row_unsafe(begin);
-                    delta.set_row_unsafe(begin);
-                    for (int j = begin; j < end; ++j) {
-                      const LPoint4 &vertex = data.get_data4();
-                      LPoint4 d = delta.get_data4();
-                      data.set_data4(vertex + d * slider_value);
-                    }
-                  }
-                }
-              } else {
-                // 3-component or smaller values; don't worry about a
-                // homogeneous coordinate.
-                for (int i = 0; i < num_subranges; ++i) {
-                  int begin = rows.get_subrange_begin(i);
-                  int end = rows.get_subrange_end(i);
-                  data.set_row_unsafe(begin);
-                  delta.set_row_unsafe(begin);
-                  for (int j = begin; j < end; ++j) {
-                    const LPoint3 &vertex = data.get_data3();
-                    LPoint3 d = delta.get_data3();
-                    data.set_data3(vertex + d * slider_value);
-                  }
-                }
-              }
-            }
-          }
-        }
+    if (cdata->_sparse_morphs == nullptr ||
+        cdata->_sparse_morphs->_slider_table != slider_table ||
+        cdata->_sparse_morphs->_modified != cdata->_modified) {
+      cdata->_sparse_morphs = make_sparse_morphs(cdata, current_thread);
+    }
+
+    const pvector<SparseMorph> &morphs = cdata->_sparse_morphs->_morphs;
+    for (const SparseMorph &morph : morphs) {
+      PN_stdfloat slider_value = slider_table->get_slider(morph._slider)->get_slider();
+      if (slider_value != 0.0f) {
+        apply_sparse_morph(new_data, morph, slider_value, current_thread);
       }
     }
   }
@@ -1774,6 +1711,214 @@ update_animated_vertices(GeomVertexData::CData *cdata, Thread *current_thread) {
   }
 }
 
+/**
+ * Builds a sparse copy of the morph deltas of this vertex data: for each
+ * slider affecting each morph, the rows that it moves (omitting those whose
+ * delta is zero) and the deltas for those rows, packed together.
+ */
+CPT(GeomVertexData::SparseMorphs) GeomVertexData::
+make_sparse_morphs(const GeomVertexData::CData *cdata,
+                   Thread *current_thread) const {
+  PT(SparseMorphs) morphs = new SparseMorphs;
+  morphs->_slider_table = cdata->_slider_table;
+  morphs->_modified = cdata->_modified;
+
+  const SliderTable *slider_table = cdata->_slider_table;
+  const GeomVertexFormat *format = cdata->_format;
+  int num_morphs = format->get_num_morphs();
+  for (int mi = 0; mi < num_morphs; mi++) {
+    const SparseArray &sliders = slider_table->find_sliders(format->get_morph_slider(mi));
+    if (sliders.is_zero()) {
+      continue;
+    }
+    nassertd(!sliders.is_inverse()) continue;
+
+    GeomVertexReader delta(this, format->get_morph_delta(mi), current_thread);
+    const GeomVertexColumn *base_column = format->get_column(format->get_morph_base(mi));
+    if (!delta.has_column() || base_column == nullptr) {
+      continue;
+    }
+
+    // This must match the way the deltas are applied in apply_sparse_morph().
+    SparseMorphMode mode = SMM_vector;
+    int num_components = 3;
+    if (base_column->get_num_values() == 4) {
+      if (base_column->has_homogeneous_coord()) {
+        mode = SMM_homogeneous;
+      } else {
+        mode = SMM_vector4;
+        num_components = 4;
+      }
+    }
+
+    int num_slider_subranges = sliders.get_num_subranges();
+    for (int sni = 0; sni < num_slider_subranges; ++sni) {
+      int slider_begin = sliders.get_subrange_begin(sni);
+      int slider_end = sliders.get_subrange_end(sni);
+      for (int sn = slider_begin; sn < slider_end; ++sn) {
+        const SparseArray &rows = slider_table->get_slider_rows(sn);
+        nassertd(!rows.is_inverse()) continue;
+
+        SparseMorph morph;
+        morph._base_name = format->get_morph_base(mi);
+        morph._slider = sn;
+        morph._mode = mode;
+
+        int num_subranges = rows.get_num_subranges();
+        for (int i = 0; i < num_subranges; ++i) {
+          int begin = rows.get_subrange_begin(i);
+          int end = rows.get_subrange_end(i);
+          delta.set_row_unsafe(begin);
+          for (int j = begin; j < end; ++j) {
+            LVecBase4 d;
+            if (num_components == 4) {
+              d = delta.get_data4();
+            } else {
+              const LVecBase3 &d3 = delta.get_data3();
+              d.set(d3[0], d3[1], d3[2], 0);
+            }
+            if (d != LVecBase4::zero()) {
+              if (!morph._run_ends.empty() && morph._run_ends.back() == j) {
+                // Extend the current run.
+                ++morph._run_ends.back();
+              } else {
+                morph._run_begins.push_back(j);
+                morph._run_ends.push_back(j + 1);
+              }
+              for (int c = 0; c < num_components; ++c) {
+                morph._deltas.push_back((float)d[c]);
+              }
+            }
+          }
+        }
+
+        if (!morph._run_begins.empty()) {
+          morphs->_morphs.push_back(std::move(morph));
+        }
+      }
+    }
+  }
+
+  return morphs;
+}
+
+/**
+ * Adds the deltas of the indicated sparse morph, scaled by the given weight,
+ * to the corresponding column of the destination vertex data.
+ */
+void GeomVertexData::
+apply_sparse_morph(GeomVertexData *dest, const SparseMorph &morph,
+                   PN_stdfloat weight, Thread *current_thread) {
+  GeomVertexRewriter data(dest, morph._base_name, current_thread);
+  if (!data.has_column()) {
+    return;
+  }
+
+  const GeomVertexColumn *data_column = data.get_column();
+  int num_values = std::min(data_column->get_num_values(), 4);
+  size_t num_runs = morph._run_begins.size();
+  const int *run_begins = &morph._run_begins[0];
+  const int *run_ends = &morph._run_ends[0];
+  const float *d = &morph._deltas[0];
+
+  if (data_column->get_numeric_type() == NT_float32) {
+    // The common case: the column is a table of floats, which we can
+    // accumulate the packed deltas into directly.
+    GeomVertexArrayDataHandle *data_handle = data.get_array_handle();
+    size_t stride = data.get_stride();
+    unsigned char *start = data_handle->get_write_pointer() + data_column->get_start();
+    float w = (float)weight;
+
+    int num_components = (morph._mode == SMM_vector4) ? 4 : 3;
+    if (morph._mode != SMM_homogeneous && num_values == num_components &&
+        stride == num_components * sizeof(float)) {
+      // The column is tightly packed in its own array, so that each run of
+      // rows is one contiguous range of floats, lined up with its deltas.
+      for (size_t r = 0; r < num_runs; ++r) {
+        float *v = (float *)(start + run_begins[r] * stride);
+        size_t num_floats = (size_t)(run_ends[r] - run_begins[r]) * num_components;
+        for (size_t i = 0; i < num_floats; ++i) {
+          v[i] += d[i] * w;
+        }
+        d += num_floats;
+      }
+      return;
+    }
+
+    for (size_t r = 0; r < num_runs; ++r) {
+      unsigned char *p = start + run_begins[r] * stride;
+      unsigned char *end = start + run_ends[r] * stride;
+
+      switch (morph._mode) {
+      case SMM_homogeneous:
+        for (; p < end; p += stride, d += 3) {
+          float *v = (float *)p;
+          float s = w * v[3];
+          v[0] += d[0] * s;
+          v[1] += d[1] * s;
+          v[2] += d[2] * s;
+        }
+        break;
+
+      case SMM_vector4:
+        for (; p < end; p += stride, d += 4) {
+          float *v = (float *)p;
+          v[0] += d[0] * w;
+          v[1] += d[1] * w;
+          v[2] += d[2] * w;
+          v[3] += d[3] * w;
+        }
+        break;
+
+      case SMM_vector:
+        for (; p < end; p += stride, d += 3) {
+          float *v = (float *)p;
+          for (int c = 0; c < num_values && c < 3; ++c) {
+            v[c] += d[c] * w;
+          }
+        }
+        break;
+      }
+    }
+    return;
+  }
+
+  // Some other numeric type; go through the rewriter.
+  for (size_t r = 0; r < num_runs; ++r) {
+    data.set_row_unsafe(run_begins[r]);
+    for (int j = run_begins[r]; j < run_ends[r]; ++j) {
+      switch (morph._mode) {
+      case SMM_homogeneous:
+        {
+          LPoint4 vertex = data.get_data4();
+          PN_stdfloat s = weight * vertex[3];
+          data.set_data4(vertex[0] + d[0] * s,
+                         vertex[1] + d[1] * s,
+                         vertex[2] + d[2] * s,
+                         vertex[3]);
+          d += 3;
+        }
+        break;
+
+      case SMM_vector4:
+        {
+          LPoint4 vertex = data.get_data4();
+          data.set_data4(vertex + LVecBase4(d[0], d[1], d[2], d[3]) * weight);
+          d += 4;
+        }
+        break;
+
+      case SMM_vector:
+        {
+          LPoint3 vertex = data.get_data3();
+          data.set_data3(vertex + LVecBase3(d[0], d[1], d[2]) * weight);
+          d += 3;
+        }
+        break;
+      }
+    }
+  }
+}
 
 /**
  * Transforms a range of vertices for one particular column, as a point.
@@ -38,6 +38,8 @@
 #include "pmap.h"
 #include "pvector.h"
 #include "deletedChain.h"
+#include "vector_int.h"
+#include "vector_float.h"
 
 class FactoryParams;
 class GeomVertexColumn;
@@ -286,6 +288,31 @@ public:
   typedef pmap<const CacheKey *, PT(CacheEntry), IndirectLess<CacheKey> > Cache;
 
 private:
+  // The deltas of one morph slider, stored only for the rows that it
+  // actually moves, so that they can be applied without scanning the full
+  // delta column.  The rows are stored as runs of consecutive rows, and the
+  // deltas for all of the runs are packed together in order.
+  enum SparseMorphMode {
+    SMM_vector,       // up to 3 components
+    SMM_vector4,      // 4 components
+    SMM_homogeneous,  // 3 components, scaled by the w of the base
+  };
+  class SparseMorph {
+  public:
+    CPT(InternalName) _base_name;
+    size_t _slider;
+    SparseMorphMode _mode;
+    vector_int _run_begins;
+    vector_int _run_ends;
+    vector_float _deltas;
+  };
+  class SparseMorphs : public ReferenceCount {
+  public:
+    CPT(SliderTable) _slider_table;
+    UpdateSeq _modified;
+    pvector<SparseMorph> _morphs;
+  };
+
   // This is the data that must be cycled between pipeline stages.
   class EXPCL_PANDA_GOBJ CData : public CycleData {
   public:
@@ -310,6 +337,7 @@ private:
     PT(GeomVertexData) _animated_vertices;
     UpdateSeq _animated_vertices_modified;
     UpdateSeq _modified;
+    CPT(SparseMorphs) _sparse_morphs;
 
   public:
     static TypeHandle get_class_type() {
@@ -335,6 +363,10 @@ private:
 
 private:
   void update_animated_vertices(CData *cdata, Thread *current_thread);
+  CPT(SparseMorphs) make_sparse_morphs(const CData *cdata,
+                                       Thread *current_thread) const;
+  static void apply_sparse_morph(GeomVertexData *dest, const SparseMorph &morph,
+                                 PN_stdfloat weight, Thread *current_thread);
   void do_transform_point_column(const GeomVertexFormat *format, GeomVertexRewriter &data,
                                  const LMatrix4 &mat, int begin_row, int end_row);
   void do_transform_vector_column(const GeomVertexFormat *format, GeomVertexRewriter &data,
@@ -32,6 +32,25 @@ output(std::ostream &out) const {
   out << "buffer " << get_name() << ", " << _data_size_bytes << "B, " << _usage_hint;
 }
 
+/**
+ * Replaces the contents of the buffer.  The new data will be uploaded to the
+ * graphics memory the next time the buffer is bound; if the size changed,
+ * the buffer is recreated.  This is intended for buffers that are updated at
+ * most once per frame, such as a joint palette; the usage hint should
+ * reflect this.
+ */
+void ShaderBuffer::
+set_data(vector_uchar data) {
+  _initial_data = std::move(data);
+
+  // Make sure it is padded to 16 bytes, as in the constructor.
+  if ((_initial_data.size() & 15u) != 0) {
+    _initial_data.resize((_initial_data.size() + 15u) & ~15u, 0);
+  }
+  _data_size_bytes = _initial_data.size();
+  ++_modified;
+}
+
 /**
  * Indicates that the data should be enqueued to be prepared in the indicated
  * prepared_objects at the beginning of the next frame.  This will ensure the
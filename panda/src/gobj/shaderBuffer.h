@@ -21,6 +21,7 @@
 #include "graphicsStateGuardianBase.h"
 #include "factoryParams.h"
 #include "vector_uchar.h"
+#include "updateSeq.h"
 
 class BufferContext;
 class PreparedGraphicsObjects;
@@ -42,12 +43,18 @@ public:
   INLINE uint64_t get_data_size_bytes() const;
   INLINE UsageHint get_usage_hint() const;
   INLINE const unsigned char *get_initial_data() const;
+  INLINE UpdateSeq get_modified() const;
+  INLINE unsigned char *modify_data();
 
   virtual void output(std::ostream &out) const;
 
 PUBLISHED:
   MAKE_PROPERTY(data_size_bytes, get_data_size_bytes);
   MAKE_PROPERTY(usage_hint, get_usage_hint);
+  MAKE_PROPERTY(modified, get_modified);
+
+  void set_data(vector_uchar data);
+  INLINE const vector_uchar &get_data() const;
 
   void prepare(PreparedGraphicsObjects *prepared_objects);
   bool is_prepared(PreparedGraphicsObjects *prepared_objects) const;
@@ -61,6 +68,7 @@ private:
   uint64_t _data_size_bytes;
   UsageHint _usage_hint;
   vector_uchar _initial_data;
+  UpdateSeq _modified;
 
   typedef pmap<PreparedGraphicsObjects *, BufferContext *> Contexts;
   Contexts *_contexts = nullptr;
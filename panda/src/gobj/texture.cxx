@@ -3036,6 +3036,7 @@ do_read_one(CData *cdata, const Filename &fullpath, const Filename &alpha_fullpa
   image.copy_header_from(*image_reader);
 
   AutoTextureScale auto_texture_scale = do_get_auto_texture_scale(cdata);
+  bool read_direct = false;
 
   // If it's a floating-point image file, read it by default into a floating-
   // point texture.
@@ -3115,9 +3116,26 @@ do_read_one(CData *cdata, const Filename &fullpath, const Filename &alpha_fullpa
         << "\n";
     }
 
+    // If the image will be loaded into the texture exactly as it appears in
+    // the file, we may be able to skip the PNMImage altogether, and decode it
+    // straight into the RAM image.
+    read_direct =
+      textures_direct_decode && !read_floating_point &&
+      alpha_fullpath.empty() && z == 0 && n == 0 &&
+      cdata->_ram_images.size() <= 1 &&
+      auto_texture_scale != ATS_pad &&
+      (primary_file_num_channels == 0 ||
+       primary_file_num_channels >= image.get_num_channels()) &&
+      image.get_x_size() == image.get_read_x_size() &&
+      image.get_y_size() == image.get_read_y_size() &&
+      image_reader->supports_read_ram_image();
+
     bool success;
     if (read_floating_point) {
       success = pfm.read(image_reader);
+    } else if (read_direct) {
+      success = do_load_one_direct(cdata, image_reader, fullpath.get_basename(),
+                                   z, n, options);
     } else {
       success = image.read(image_reader);
     }
@@ -3267,6 +3285,9 @@ do_read_one(CData *cdata, const Filename &fullpath, const Filename &alpha_fullpa
     if (!do_load_one(cdata, pfm, fullpath.get_basename(), z, n, options)) {
       return false;
     }
+  } else if (read_direct) {
+    // The image has already been loaded by do_load_one_direct().
+    do_set_pad_size(cdata, 0, 0, 0);
   } else {
     // Now see if we want to pad the image within a larger power-of-2 image.
     int pad_x_size = 0;
@@ -3368,6 +3389,71 @@ do_load_one(CData *cdata, const PNMImage &pnmimage, const string &name, int z, i
   return true;
 }
 
+/**
+ * Internal method to load mipmap level 0 of the first page directly from the
+ * indicated PNMReader, which must return true for supports_read_ram_image(),
+ * and which has been determined to produce an image that needs no further
+ * modification.  The reader is deleted when this method returns.
+ *
+ * This decodes the file straight into the RAM image, without the intermediate
+ * PNMImage that do_load_one() requires.
+ */
+bool Texture::
+do_load_one_direct(CData *cdata, PNMReader *reader, const string &name,
+                   int z, int n, const LoaderOptions &options) {
+  nassertd(z == 0 && n == 0 && cdata->_ram_images.size() <= 1) {
+    delete reader;
+    return false;
+  }
+
+  if (!reader->is_valid()) {
+    delete reader;
+    return false;
+  }
+  reader->prepare_read();
+
+  int x_size = reader->get_x_size();
+  int y_size = reader->get_y_size();
+  int num_channels = reader->get_num_channels();
+  nassertd(reader->get_maxval() == 255) {
+    delete reader;
+    return false;
+  }
+
+  if (!do_reconsider_z_size(cdata, z, options) ||
+      !do_reconsider_image_properties(cdata, x_size, y_size, num_channels,
+                                      T_unsigned_byte, z, options)) {
+    delete reader;
+    return false;
+  }
+
+  do_modify_ram_image(cdata);
+  cdata->_loaded_from_image = true;
+  do_modify_ram_mipmap_image(cdata, n);
+
+  size_t page_size = do_get_expected_ram_mipmap_page_size(cdata, n);
+  nassertd(page_size == (size_t)x_size * (size_t)y_size * num_channels &&
+           page_size * (z + 1) <= cdata->_ram_images[n]._image.size()) {
+    delete reader;
+    return false;
+  }
+
+  unsigned char *data = &cdata->_ram_images[n]._image[page_size * z];
+  int rows_read = reader->read_ram_image(data);
+  delete reader;
+
+  if (rows_read == 0) {
+    return false;
+  }
+  if (rows_read < y_size) {
+    gobj_cat.warning()
+      << "Only " << rows_read << " of " << y_size << " rows could be read from "
+      << name << "\n";
+  }
+
+  return true;
+}
+
 /**
  * Internal method to load a single page or mipmap level.
  */
@@ -53,6 +53,7 @@ class PreparedGraphicsObjects;
 class CullTraverser;
 class CullTraverserData;
 class TexturePeeker;
+class PNMReader;
 struct DDSHeader;
 
 /**
@@ -666,6 +667,9 @@ protected:
   virtual bool do_load_one(CData *cdata,
                            const PfmFile &pfm, const std::string &name,
                            int z, int n, const LoaderOptions &options);
+  bool do_load_one_direct(CData *cdata, PNMReader *reader,
+                          const std::string &name, int z, int n,
+                          const LoaderOptions &options);
   virtual bool do_load_sub_image(CData *cdata, const PNMImage &image,
                                  int x, int y, int z, int n);
   bool do_read_txo_file(CData *cdata, const Filename &fullpath);
@@ -14,6 +14,7 @@
 #include "transformTable.h"
 #include "bamReader.h"
 #include "bamWriter.h"
+#include "lightMutexHolder.h"
 
 TypeHandle TransformTable::_type_handle;
 
@@ -107,6 +108,106 @@ add_transform(const VertexTransform *transform) {
   return new_index;
 }
 
+/**
+ * Returns a buffer containing the matrices of all of the transforms in the
+ * table, in order, as an array of single-precision 4x4 matrices suitable for
+ * binding to a shader as the joint palette for hardware skinning.
+ *
+ * The same buffer object is returned each time, and its contents are
+ * recomputed only when get_modified() reports that a transform has changed,
+ * so that all of the Geoms sharing this table (for instance, all the Geoms of
+ * an animated Character) share a single upload per frame.  This is only
+ * reliable for a registered table.
+ *
+ * If a palette source has been set with set_palette_source(), this returns
+ * the palette buffer of that table instead.
+ */
+CPT(ShaderBuffer) TransformTable::
+get_palette_buffer(Thread *current_thread) const {
+  CPT(TransformTable) source = get_palette_source();
+  if (source != nullptr) {
+    // We don't follow the source's own source, if any, so that tables that
+    // are momentarily each other's source don't recurse forever.
+    return source->do_get_palette_buffer(current_thread);
+  }
+  return do_get_palette_buffer(current_thread);
+}
+
+/**
+ * The implementation of get_palette_buffer(), which packs the palette of
+ * this table, disregarding any palette source.
+ */
+CPT(ShaderBuffer) TransformTable::
+do_get_palette_buffer(Thread *current_thread) const {
+  UpdateSeq modified = get_modified(current_thread);
+
+  LightMutexHolder holder(_palette_lock);
+  if (_palette_buffer != nullptr && _palette_modified == modified) {
+    return _palette_buffer;
+  }
+
+  // We always store at least one matrix, since some drivers don't care for
+  // empty buffers.
+  size_t num_transforms = _transforms.size();
+  size_t num_matrices = std::max(num_transforms, (size_t)1);
+  if (_palette_buffer == nullptr) {
+    _palette_buffer = new ShaderBuffer("palette", num_matrices * sizeof(LMatrix4f),
+                                       GeomEnums::UH_dynamic);
+  }
+
+  unsigned char *data = _palette_buffer->modify_data();
+  for (size_t i = 0; i < num_matrices; ++i) {
+    LMatrix4f matrix;
+    if (i < num_transforms) {
+#ifdef STDFLOAT_DOUBLE
+      LMatrix4 matrix_d;
+      _transforms[i]->get_matrix(matrix_d);
+      matrix = LCAST(float, matrix_d);
+#else
+      _transforms[i]->get_matrix(matrix);
+#endif
+    } else {
+      matrix = LMatrix4f::ident_mat();
+    }
+    memcpy(data + i * sizeof(LMatrix4f), matrix.get_data(), sizeof(LMatrix4f));
+  }
+
+  _palette_modified = modified;
+  return _palette_buffer;
+}
+
+/**
+ * Indicates that the indicated table currently holds the same matrices as
+ * this one, in the same order, so that get_palette_buffer() may return the
+ * palette of that table instead of packing and uploading another copy.  This
+ * is used by Characters that share their joint transforms with an identical
+ * Character; see PartBundle::set_anim_instancing().
+ *
+ * It is the caller's responsibility to clear this again, by passing NULL, as
+ * soon as the two tables might differ.  Like the palette buffer itself, this
+ * is not part of the contents of the table, so it may be changed on a
+ * registered table.
+ */
+void TransformTable::
+set_palette_source(const TransformTable *source) const {
+  nassertv(source != this);
+  nassertv(source == nullptr ||
+           source->get_num_transforms() == get_num_transforms());
+
+  LightMutexHolder holder(_palette_lock);
+  _palette_source = source;
+}
+
+/**
+ * Returns the table set by set_palette_source(), or NULL if this table
+ * provides its own palette.
+ */
+CPT(TransformTable) TransformTable::
+get_palette_source() const {
+  LightMutexHolder holder(_palette_lock);
+  return _palette_source;
+}
+
 /**
  *
  */
@@ -24,6 +24,8 @@
 #include "cycleDataReader.h"
 #include "cycleDataWriter.h"
 #include "pipelineCycler.h"
+#include "shaderBuffer.h"
+#include "lightMutex.h"
 
 class FactoryParams;
 
@@ -55,6 +57,10 @@ PUBLISHED:
   void remove_transform(size_t n);
   size_t add_transform(const VertexTransform *transform);
 
+  CPT(ShaderBuffer) get_palette_buffer(Thread *current_thread = Thread::get_current_thread()) const;
+  void set_palette_source(const TransformTable *source) const;
+  CPT(TransformTable) get_palette_source() const;
+
   void write(std::ostream &out) const;
 
   MAKE_PROPERTY(registered, is_registered);
@@ -63,6 +69,7 @@ PUBLISHED:
                                 remove_transform, insert_transform);
 
 private:
+  CPT(ShaderBuffer) do_get_palette_buffer(Thread *current_thread) const;
   void do_register();
   void do_unregister();
   INLINE void update_modified(UpdateSeq modified, Thread *current_thread);
@@ -73,6 +80,17 @@ private:
   typedef pvector< CPT(VertexTransform) > Transforms;
   Transforms _transforms;
 
+  // The matrices of the transforms, packed for upload to the graphics card.
+  // This is shared by all of the Geoms that use this table, and is repacked
+  // only when the table reports a modification.
+  mutable LightMutex _palette_lock;
+  mutable PT(ShaderBuffer) _palette_buffer;
+  mutable UpdateSeq _palette_modified;
+
+  // If this is set, get_palette_buffer() returns the palette of this other
+  // table instead, which is known to hold the same matrices.
+  mutable CPT(TransformTable) _palette_source;
+
   // This is the data that must be cycled between pipeline stages.
   class EXPCL_PANDA_GOBJ CData : public CycleData {
   public:
@@ -7,4 +7,5 @@
 #include "fisheyeMaker.cxx"
 #include "frameRateMeter.cxx"
 #include "sceneGraphAnalyzerMeter.cxx"
+#include "textureAtlas.cxx"
 
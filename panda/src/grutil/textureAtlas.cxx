@@ -0,0 +1,408 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file textureAtlas.cxx
+ * @author agent
+ * @date 2026-10-18
+ */
+
+#include "textureAtlas.h"
+#include "config_grutil.h"
+#include "indent.h"
+
+/**
+ * Creates a new, empty atlas of the indicated size.  The margin is the number
+ * of pixels reserved on each side of every image.
+ */
+TextureAtlas::
+TextureAtlas(const std::string &name, int x_size, int y_size, int margin) :
+  Namable(name),
+  _x_size(x_size),
+  _y_size(y_size),
+  _margin(std::max(margin, 0)),
+  _next_id(0)
+{
+  _texture = new Texture(name);
+  _texture->setup_2d_texture(_x_size, _y_size, Texture::T_unsigned_byte,
+                             Texture::F_rgba);
+  _texture->set_minfilter(SamplerState::FT_linear);
+  _texture->set_magfilter(SamplerState::FT_linear);
+  _texture->set_wrap_u(SamplerState::WM_clamp);
+  _texture->set_wrap_v(SamplerState::WM_clamp);
+
+  // We need to keep the RAM image around, since we will be writing new
+  // images into it piecemeal.
+  _texture->set_keep_ram_image(true);
+  clear();
+}
+
+/**
+ *
+ */
+TextureAtlas::
+~TextureAtlas() {
+}
+
+/**
+ * Copies the indicated image into a free region of the atlas, and returns
+ * the id by which it may subsequently be referenced.  Returns -1 if there is
+ * not enough room left in the atlas.
+ */
+int TextureAtlas::
+add_image(const PNMImage &image) {
+  nassertr(image.is_valid(), -1);
+
+  int x_size = image.get_x_size() + _margin * 2;
+  int y_size = image.get_y_size() + _margin * 2;
+
+  int x, y;
+  if (!find_free_rect(x, y, x_size, y_size)) {
+    grutil_cat.info()
+      << "No room in " << *this << " for " << image.get_x_size() << " by "
+      << image.get_y_size() << " image.\n";
+    return -1;
+  }
+
+  int id = _next_id++;
+  Entry &entry = _entries[id];
+  entry._x = x;
+  entry._y = y;
+  entry._x_size = x_size;
+  entry._y_size = y_size;
+
+  store_image(x, y, image);
+  return id;
+}
+
+/**
+ * Copies the image of the indicated texture into a free region of the atlas.
+ * The texture must have a RAM image, or be able to reload one.  Returns the
+ * id of the new image, or -1 on failure.
+ */
+int TextureAtlas::
+add_texture(Texture *tex) {
+  nassertr(tex != nullptr, -1);
+
+  PNMImage image;
+  if (!tex->store(image)) {
+    grutil_cat.error()
+      << "Could not get image of " << tex->get_name() << " for " << *this
+      << "\n";
+    return -1;
+  }
+  return add_image(image);
+}
+
+/**
+ * Replaces the contents of a previously-added image with a new image of the
+ * same size.  Only the affected region of the atlas's RAM image is modified.
+ * Returns true on success, or false if the id is invalid or the size does
+ * not match.
+ */
+bool TextureAtlas::
+update_image(int id, const PNMImage &image) {
+  Entries::const_iterator ei = _entries.find(id);
+  if (ei == _entries.end()) {
+    return false;
+  }
+
+  const Entry &entry = (*ei).second;
+  if (image.get_x_size() + _margin * 2 != entry._x_size ||
+      image.get_y_size() + _margin * 2 != entry._y_size) {
+    grutil_cat.error()
+      << "Cannot replace image " << id << " in " << *this
+      << " with an image of a different size.\n";
+    return false;
+  }
+
+  store_image(entry._x, entry._y, image);
+  return true;
+}
+
+/**
+ * Removes the indicated image from the atlas, making its space available for
+ * future images.  Returns true if the image was removed, or false if there
+ * was no such image.
+ */
+bool TextureAtlas::
+remove_image(int id) {
+  Entries::iterator ei = _entries.find(id);
+  if (ei == _entries.end()) {
+    return false;
+  }
+
+  Entry entry = (*ei).second;
+  _entries.erase(ei);
+
+  // Clear the region, so that stale pixels don't show up if the texture is
+  // viewed as a whole.
+  PNMImage blank(entry._x_size, entry._y_size, 4, 255);
+  _texture->load_sub_image(blank, entry._x, entry._y);
+
+  release_rect(entry._x, entry._y, entry._x_size, entry._y_size);
+  return true;
+}
+
+/**
+ * Removes all images from the atlas.  Previously-returned ids are no longer
+ * valid, though they will not be reused.
+ */
+void TextureAtlas::
+clear() {
+  _entries.clear();
+  _free_rects.clear();
+  _free_rects.push_back(LVecBase4i(0, 0, _x_size, _y_size));
+
+  _texture->set_clear_color(LColor(0, 0, 0, 0));
+  _texture->make_ram_image();
+}
+
+/**
+ * Returns the fraction of the atlas area, in the range 0 .. 1, that is
+ * currently occupied by images (including their margins).
+ */
+double TextureAtlas::
+get_used_fraction() const {
+  double used = 0.0;
+  Entries::const_iterator ei;
+  for (ei = _entries.begin(); ei != _entries.end(); ++ei) {
+    used += (double)(*ei).second._x_size * (double)(*ei).second._y_size;
+  }
+  return used / ((double)_x_size * (double)_y_size);
+}
+
+/**
+ * Returns the region of the atlas texture occupied by the indicated image, as
+ * x, y, x_size, y_size in pixels, where y is measured from the top of the
+ * texture, as in a PNMImage.  The margin is not included.
+ */
+LVecBase4i TextureAtlas::
+get_image_region(int id) const {
+  Entries::const_iterator ei = _entries.find(id);
+  nassertr(ei != _entries.end(), LVecBase4i::zero());
+
+  const Entry &entry = (*ei).second;
+  return LVecBase4i(entry._x + _margin, entry._y + _margin,
+                    entry._x_size - _margin * 2, entry._y_size - _margin * 2);
+}
+
+/**
+ * Returns the texture coordinates occupied by the indicated image, as (u0,
+ * v0, u1, v1), where (u0, v0) is the lower-left corner and (u1, v1) the
+ * upper-right corner of the image.
+ */
+LVecBase4 TextureAtlas::
+get_uv_rect(int id) const {
+  LVecBase4i region = get_image_region(id);
+  PN_stdfloat u0 = (PN_stdfloat)region[0] / (PN_stdfloat)_x_size;
+  PN_stdfloat u1 = (PN_stdfloat)(region[0] + region[2]) / (PN_stdfloat)_x_size;
+  PN_stdfloat v0 = 1.0f - (PN_stdfloat)(region[1] + region[3]) / (PN_stdfloat)_y_size;
+  PN_stdfloat v1 = 1.0f - (PN_stdfloat)region[1] / (PN_stdfloat)_y_size;
+  return LVecBase4(u0, v0, u1, v1);
+}
+
+/**
+ * Converts a texture coordinate in the range 0 .. 1 on the original image to
+ * the corresponding texture coordinate on the atlas texture.
+ */
+LTexCoord TextureAtlas::
+remap_uv(int id, const LTexCoord &uv) const {
+  LVecBase4 rect = get_uv_rect(id);
+  return LTexCoord(rect[0] + uv[0] * (rect[2] - rect[0]),
+                   rect[1] + uv[1] * (rect[3] - rect[1]));
+}
+
+/**
+ * Returns a TransformState that, when applied with NodePath::set_tex_transform()
+ * to geometry whose texture coordinates span the range 0 .. 1 on the original
+ * image, maps those coordinates onto the image's region of the atlas.
+ */
+CPT(TransformState) TextureAtlas::
+get_tex_transform(int id) const {
+  LVecBase4 rect = get_uv_rect(id);
+  return TransformState::make_pos_rotate_scale2d
+    (LVecBase2(rect[0], rect[1]), 0.0f,
+     LVecBase2(rect[2] - rect[0], rect[3] - rect[1]));
+}
+
+/**
+ *
+ */
+void TextureAtlas::
+output(std::ostream &out) const {
+  out << "TextureAtlas " << get_name() << ", " << _x_size << " by "
+      << _y_size << ", " << _entries.size() << " images";
+}
+
+/**
+ *
+ */
+void TextureAtlas::
+write(std::ostream &out, int indent_level) const {
+  indent(out, indent_level)
+    << *this << ", " << (int)(get_used_fraction() * 100.0 + 0.5)
+    << "% used\n";
+
+  Entries::const_iterator ei;
+  for (ei = _entries.begin(); ei != _entries.end(); ++ei) {
+    const Entry &entry = (*ei).second;
+    indent(out, indent_level + 2)
+      << (*ei).first << ": " << entry._x_size - _margin * 2 << " by "
+      << entry._y_size - _margin * 2 << " at " << entry._x + _margin << ", "
+      << entry._y + _margin << "\n";
+  }
+}
+
+/**
+ * Searches for a free rectangle that can hold a block of the indicated size.
+ * If one is found, allocates the block from its upper-left corner, splits the
+ * remaining space into new free rectangles, and returns true.
+ */
+bool TextureAtlas::
+find_free_rect(int &x, int &y, int x_size, int y_size) {
+  // Choose the rectangle whose shorter leftover side is the smallest; this
+  // tends to leave the remaining space in large, usable pieces.
+  int best = -1;
+  int best_short_side = 0;
+  int best_long_side = 0;
+  for (size_t i = 0; i < _free_rects.size(); ++i) {
+    const LVecBase4i &rect = _free_rects[i];
+    if (rect[2] < x_size || rect[3] < y_size) {
+      continue;
+    }
+    int leftover_x = rect[2] - x_size;
+    int leftover_y = rect[3] - y_size;
+    int short_side = std::min(leftover_x, leftover_y);
+    int long_side = std::max(leftover_x, leftover_y);
+    if (best < 0 || short_side < best_short_side ||
+        (short_side == best_short_side && long_side < best_long_side)) {
+      best = (int)i;
+      best_short_side = short_side;
+      best_long_side = long_side;
+    }
+  }
+
+  if (best < 0) {
+    return false;
+  }
+
+  LVecBase4i rect = _free_rects[best];
+  _free_rects.erase(_free_rects.begin() + best);
+
+  x = rect[0];
+  y = rect[1];
+
+  // Split the leftover space with a single cut along the shorter leftover
+  // axis, so that the larger of the two pieces is as large as possible.
+  int leftover_x = rect[2] - x_size;
+  int leftover_y = rect[3] - y_size;
+  LVecBase4i right, below;
+  if (leftover_x < leftover_y) {
+    right.set(rect[0] + x_size, rect[1], leftover_x, y_size);
+    below.set(rect[0], rect[1] + y_size, rect[2], leftover_y);
+  } else {
+    right.set(rect[0] + x_size, rect[1], leftover_x, rect[3]);
+    below.set(rect[0], rect[1] + y_size, x_size, leftover_y);
+  }
+  if (right[2] > 0 && right[3] > 0) {
+    _free_rects.push_back(right);
+  }
+  if (below[2] > 0 && below[3] > 0) {
+    _free_rects.push_back(below);
+  }
+  return true;
+}
+
+/**
+ * Returns the indicated block to the pool of free space.
+ */
+void TextureAtlas::
+release_rect(int x, int y, int x_size, int y_size) {
+  _free_rects.push_back(LVecBase4i(x, y, x_size, y_size));
+  merge_free_rects();
+}
+
+/**
+ * Combines pairs of free rectangles that share an entire edge, repeatedly,
+ * until no more can be combined.  This allows the space freed by removed
+ * images to be reused for larger images.
+ */
+void TextureAtlas::
+merge_free_rects() {
+  bool any_merged = true;
+  while (any_merged) {
+    any_merged = false;
+    for (size_t i = 0; i < _free_rects.size() && !any_merged; ++i) {
+      for (size_t j = i + 1; j < _free_rects.size() && !any_merged; ++j) {
+        LVecBase4i &a = _free_rects[i];
+        const LVecBase4i &b = _free_rects[j];
+
+        if (a[1] == b[1] && a[3] == b[3]) {
+          // Same rows; are they adjacent horizontally?
+          if (a[0] + a[2] == b[0]) {
+            a[2] += b[2];
+            any_merged = true;
+          } else if (b[0] + b[2] == a[0]) {
+            a[0] = b[0];
+            a[2] += b[2];
+            any_merged = true;
+          }
+        } else if (a[0] == b[0] && a[2] == b[2]) {
+          // Same columns; are they adjacent vertically?
+          if (a[1] + a[3] == b[1]) {
+            a[3] += b[3];
+            any_merged = true;
+          } else if (b[1] + b[3] == a[1]) {
+            a[1] = b[1];
+            a[3] += b[3];
+            any_merged = true;
+          }
+        }
+
+        if (any_merged) {
+          _free_rects.erase(_free_rects.begin() + j);
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Writes the indicated image into the atlas texture at the indicated block,
+ * surrounded by the margin, which is filled by extending the edge pixels of
+ * the image outward.
+ */
+void TextureAtlas::
+store_image(int x, int y, const PNMImage &image) {
+  int x_size = image.get_x_size();
+  int y_size = image.get_y_size();
+
+  PNMImage block(x_size + _margin * 2, y_size + _margin * 2, 4, 255,
+                 nullptr, image.get_color_space());
+  for (int yi = 0; yi < block.get_y_size(); ++yi) {
+    int sy = std::max(std::min(yi - _margin, y_size - 1), 0);
+    for (int xi = 0; xi < block.get_x_size(); ++xi) {
+      int sx = std::max(std::min(xi - _margin, x_size - 1), 0);
+
+      LColorf color;
+      if (image.is_grayscale()) {
+        float gray = image.get_gray(sx, sy);
+        color.set(gray, gray, gray, 1.0f);
+      } else {
+        LRGBColorf rgb = image.get_xel(sx, sy);
+        color.set(rgb[0], rgb[1], rgb[2], 1.0f);
+      }
+      if (image.has_alpha()) {
+        color[3] = image.get_alpha(sx, sy);
+      }
+      block.set_xel_a(xi, yi, color);
+    }
+  }
+
+  _texture->load_sub_image(block, x, y);
+}
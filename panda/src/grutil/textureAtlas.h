@@ -0,0 +1,109 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file textureAtlas.h
+ * @author agent
+ * @date 2026-10-18
+ */
+
+#ifndef TEXTUREATLAS_H
+#define TEXTUREATLAS_H
+
+#include "pandabase.h"
+#include "referenceCount.h"
+#include "namable.h"
+#include "texture.h"
+#include "transformState.h"
+#include "pnmImage.h"
+#include "pmap.h"
+#include "pvector.h"
+#include "luse.h"
+
+/**
+ * Packs many small images into a single large Texture at runtime, so that
+ * geometry using any of them may be rendered with the same texture, and
+ * therefore batched together.  This is intended for user interface elements,
+ * decals and the like, which are frequently added and removed; for an
+ * offline solution, see egg-palettize.
+ *
+ * Each image that is added is given an integer id, which may later be used to
+ * remove or replace it, and to retrieve the texture coordinates at which it
+ * was placed.  The free space of the texture is tracked as a set of
+ * rectangles, which are split as images are added (guillotine packing) and
+ * merged back together as images are removed.
+ *
+ * Each image is surrounded by a margin of pixels copied from its edges, to
+ * prevent neighboring images from bleeding into it when it is filtered.
+ */
+class EXPCL_PANDA_GRUTIL TextureAtlas : public ReferenceCount, public Namable {
+PUBLISHED:
+  explicit TextureAtlas(const std::string &name, int x_size, int y_size,
+                        int margin = 1);
+  ~TextureAtlas();
+
+  INLINE Texture *get_texture() const;
+  INLINE int get_x_size() const;
+  INLINE int get_y_size() const;
+  INLINE int get_margin() const;
+  MAKE_PROPERTY(texture, get_texture);
+  MAKE_PROPERTY(margin, get_margin);
+
+  int add_image(const PNMImage &image);
+  int add_texture(Texture *tex);
+  bool update_image(int id, const PNMImage &image);
+  bool remove_image(int id);
+  void clear();
+
+  INLINE bool has_image(int id) const;
+  INLINE int get_num_images() const;
+  double get_used_fraction() const;
+
+  LVecBase4i get_image_region(int id) const;
+  LVecBase4 get_uv_rect(int id) const;
+  LTexCoord remap_uv(int id, const LTexCoord &uv) const;
+  CPT(TransformState) get_tex_transform(int id) const;
+
+  void output(std::ostream &out) const;
+  void write(std::ostream &out, int indent_level = 0) const;
+
+private:
+  bool find_free_rect(int &x, int &y, int x_size, int y_size);
+  void release_rect(int x, int y, int x_size, int y_size);
+  void merge_free_rects();
+  void store_image(int x, int y, const PNMImage &image);
+
+private:
+  PT(Texture) _texture;
+  int _x_size;
+  int _y_size;
+  int _margin;
+
+  // An image's block includes the margin around it.
+  class Entry {
+  public:
+    int _x, _y;
+    int _x_size, _y_size;
+  };
+  typedef pmap<int, Entry> Entries;
+  Entries _entries;
+  int _next_id;
+
+  // Each free rectangle is stored as x, y, x_size, y_size, in pixels from the
+  // upper-left corner of the texture.
+  typedef pvector<LVecBase4i> FreeRects;
+  FreeRects _free_rects;
+};
+
+INLINE std::ostream &operator << (std::ostream &out, const TextureAtlas &atlas) {
+  atlas.output(out);
+  return out;
+}
+
+#include "textureAtlas.I"
+
+#endif
@@ -62,6 +62,27 @@ ConfigVariableDouble pfm_resize_radius
           "always call box_filter() or gaussian_filter() explicitly with "
           "a specific radius."));
 
+ConfigVariableInt pfm_max_resident_tiles
+("pfm-max-resident-tiles", 16,
+ PRC_DESC("Specify the default number of tiles that a PfmTiledFile will keep "
+          "in memory at once to serve random-access lookups.  This bounds "
+          "the memory used for each open file."));
+
+ConfigVariableInt pfm_num_threads
+("pfm-num-threads", 4,
+ PRC_DESC("The number of threads that PfmFile will use to process large "
+          "operations such as xform(), forward_distort(), reverse_distort() "
+          "and calc_tight_bounds().  The rows of the image are divided "
+          "evenly among the threads.  Set this to 1 to perform all "
+          "operations in the calling thread."));
+
+ConfigVariableInt pfm_min_points_per_thread
+("pfm-min-points-per-thread", 65536,
+ PRC_DESC("The minimum number of points that each of the threads described "
+          "by pfm-num-threads must have to process.  Smaller operations use "
+          "fewer threads, or are performed entirely in the calling thread, "
+          "since the cost of starting a thread would outweigh the benefit."));
+
 /**
  * Initializes the library.  This must be called at least once before any of
  * the functions or classes in this library can be used.  Normally it will be
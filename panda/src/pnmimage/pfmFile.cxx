@@ -23,6 +23,7 @@
 #include "pnmWriter.h"
 #include "string_utils.h"
 #include "look_at.h"
+#include "genericThread.h"
 
 using std::istream;
 using std::max;
@@ -1216,11 +1217,23 @@ void PfmFile::
 xform(const LMatrix4f &transform) {
   nassertv(is_valid());
 
+  XformData data;
+  data._file = this;
+  data._transform = &transform;
+  run_parallel(_y_size, _x_size, &st_xform_rows, &data);
+}
+
+/**
+ * The implementation of xform(), applied to the rows in the range [y_begin,
+ * y_end) only.
+ */
+void PfmFile::
+do_xform(const LMatrix4f &transform, int y_begin, int y_end) {
   int num_channels = get_num_channels();
   switch (num_channels) {
   case 1:
     {
-      for (int yi = 0; yi < _y_size; ++yi) {
+      for (int yi = y_begin; yi < y_end; ++yi) {
         for (int xi = 0; xi < _x_size; ++xi) {
           if (!has_point(xi, yi)) {
             continue;
@@ -1235,7 +1248,7 @@ xform(const LMatrix4f &transform) {
 
   case 2:
     {
-      for (int yi = 0; yi < _y_size; ++yi) {
+      for (int yi = y_begin; yi < y_end; ++yi) {
         for (int xi = 0; xi < _x_size; ++xi) {
           if (!has_point(xi, yi)) {
             continue;
@@ -1250,7 +1263,7 @@ xform(const LMatrix4f &transform) {
 
   case 3:
     {
-      for (int yi = 0; yi < _y_size; ++yi) {
+      for (int yi = y_begin; yi < y_end; ++yi) {
         for (int xi = 0; xi < _x_size; ++xi) {
           if (!has_point(xi, yi)) {
             continue;
@@ -1264,7 +1277,7 @@ xform(const LMatrix4f &transform) {
 
   case 4:
     {
-      for (int yi = 0; yi < _y_size; ++yi) {
+      for (int yi = y_begin; yi < y_end; ++yi) {
         for (int xi = 0; xi < _x_size; ++xi) {
           if (!has_point(xi, yi)) {
             continue;
@@ -1278,6 +1291,15 @@ xform(const LMatrix4f &transform) {
   }
 }
 
+/**
+ * The thread function for xform().
+ */
+void PfmFile::
+st_xform_rows(void *data, int y_begin, int y_end) {
+  XformData *xd = (XformData *)data;
+  xd->_file->do_xform(*xd->_transform, y_begin, y_end);
+}
+
 /**
  * Applies the distortion indicated in the supplied dist map to the current
  * map.  The dist map is understood to be a mapping of points in the range
@@ -1329,19 +1351,21 @@ forward_distort(const PfmFile &dist, PN_float32 scale_factor) {
     result.fill(_no_data_value);
   }
 
-  for (int yi = 0; yi < working_y_size; ++yi) {
-    for (int xi = 0; xi < working_x_size; ++xi) {
-      if (!dist_p->has_point(xi, yi)) {
-        continue;
-      }
-      LPoint2f uv = dist_p->get_point2(xi, yi);
-      LPoint3f p;
-      if (!source_p->calc_bilinear_point(p, uv[0], 1.0 - uv[1])) {
-        continue;
-      }
-      nassertv(!p.is_nan());
-      result.set_point(xi, working_y_size - 1 - yi, p);
-    }
+  // Each range of rows gets its own copy of the data, so that a failure in
+  // any of them can be reported back here.
+  int num_ranges = get_num_row_ranges(working_y_size, working_x_size);
+  pvector<DistortData> ranges(num_ranges);
+  for (DistortData &range : ranges) {
+    range._result = &result;
+    range._source = source_p;
+    range._dist = dist_p;
+    range._failed = false;
+  }
+  run_parallel(working_y_size, working_x_size, &st_forward_distort_rows, &ranges[0], sizeof(DistortData));
+
+  // If any of the ranges failed, leave this file unchanged.
+  for (const DistortData &range : ranges) {
+    nassertv(!range._failed);
   }
 
   // Resize to the target size for completion.
@@ -1402,7 +1426,76 @@ reverse_distort(const PfmFile &dist, PN_float32 scale_factor) {
     result.fill(_no_data_value);
   }
 
-  for (int yi = 0; yi < working_y_size; ++yi) {
+  // Each range of rows gets its own copy of the data, so that a failure in
+  // any of them can be reported back here.
+  int num_ranges = get_num_row_ranges(working_y_size, working_x_size);
+  pvector<DistortData> ranges(num_ranges);
+  for (DistortData &range : ranges) {
+    range._result = &result;
+    range._source = source_p;
+    range._dist = dist_p;
+    range._failed = false;
+  }
+  run_parallel(working_y_size, working_x_size, &st_reverse_distort_rows, &ranges[0], sizeof(DistortData));
+
+  // If any of the ranges failed, leave this file unchanged.
+  for (const DistortData &range : ranges) {
+    nassertv(!range._failed);
+  }
+
+  // Resize to the target size for completion.
+  result.resize(_x_size, _y_size);
+
+  nassertv(result._table.size() == _table.size());
+  _table.swap(result._table);
+}
+
+/**
+ * The thread function for forward_distort().  Computes the rows in the range
+ * [y_begin, y_end) of the dist map.
+ */
+void PfmFile::
+st_forward_distort_rows(void *data, int y_begin, int y_end) {
+  DistortData *dd = (DistortData *)data;
+  PfmFile &result = *dd->_result;
+  const PfmFile *source_p = dd->_source;
+  const PfmFile *dist_p = dd->_dist;
+
+  int working_x_size = result.get_x_size();
+  int working_y_size = result.get_y_size();
+  for (int yi = y_begin; yi < y_end; ++yi) {
+    for (int xi = 0; xi < working_x_size; ++xi) {
+      if (!dist_p->has_point(xi, yi)) {
+        continue;
+      }
+      LPoint2f uv = dist_p->get_point2(xi, yi);
+      LPoint3f p;
+      if (!source_p->calc_bilinear_point(p, uv[0], 1.0 - uv[1])) {
+        continue;
+      }
+      if (p.is_nan()) {
+        // We can't assert here, since that would only stop this thread.
+        dd->_failed = true;
+        return;
+      }
+      result.set_point(xi, working_y_size - 1 - yi, p);
+    }
+  }
+}
+
+/**
+ * The thread function for reverse_distort().  Computes the rows in the range
+ * [y_begin, y_end) of the result.
+ */
+void PfmFile::
+st_reverse_distort_rows(void *data, int y_begin, int y_end) {
+  DistortData *dd = (DistortData *)data;
+  PfmFile &result = *dd->_result;
+  const PfmFile *source_p = dd->_source;
+  const PfmFile *dist_p = dd->_dist;
+
+  int working_x_size = result.get_x_size();
+  for (int yi = y_begin; yi < y_end; ++yi) {
     for (int xi = 0; xi < working_x_size; ++xi) {
       if (!source_p->has_point(xi, yi)) {
         continue;
@@ -1415,12 +1508,6 @@ reverse_distort(const PfmFile &dist, PN_float32 scale_factor) {
       result.set_point(xi, yi, LPoint3f(p[0], 1.0 - p[1], p[2]));
     }
   }
-
-  // Resize to the target size for completion.
-  result.resize(_x_size, _y_size);
-
-  nassertv(result._table.size() == _table.size());
-  _table.swap(result._table);
 }
 
 /**
@@ -1594,6 +1681,136 @@ clear_to_texcoords(int x_size, int y_size) {
   }
 }
 
+/**
+ * Replaces this PfmFile with a new 1-component PfmFile of the same size as
+ * the mask image, in which each point contains the exact Euclidean distance,
+ * in pixels, from the center of that pixel to the boundary of the mask.  The
+ * distance is positive for pixels inside the mask (those whose gray value is
+ * >= threshold) and negative for pixels outside of it; the boundary is
+ * considered to lie halfway between adjacent inside and outside pixels.
+ *
+ * This runs in time linear to the number of pixels, regardless of the
+ * distances involved.  If the mask contains only inside or only outside
+ * pixels, the distances are effectively infinite, and are filled in with a
+ * very large value of the appropriate sign.
+ */
+void PfmFile::
+fill_signed_distance(const PNMImage &mask, float threshold) {
+  int x_size = mask.get_x_size();
+  int y_size = mask.get_y_size();
+  clear(x_size, y_size, 1);
+
+  size_t size = (size_t)x_size * (size_t)y_size;
+  if (size == 0) {
+    return;
+  }
+
+  // The "inside" table measures the distance of each pixel to the nearest
+  // inside pixel, and the "outside" table to the nearest outside pixel.
+  static const PN_float32 far_away = 1.0e20f;
+  vector_float inside(size);
+  vector_float outside(size);
+
+  xelval threshold_val = mask.to_val(threshold);
+  size_t i = 0;
+  for (int yi = 0; yi < y_size; ++yi) {
+    for (int xi = 0; xi < x_size; ++xi) {
+      if (mask.get_gray_val(xi, yi) >= threshold_val) {
+        inside[i] = 0.0f;
+        outside[i] = far_away;
+      } else {
+        inside[i] = far_away;
+        outside[i] = 0.0f;
+      }
+      ++i;
+    }
+  }
+
+  calc_squared_distance(&inside[0], x_size, y_size);
+  calc_squared_distance(&outside[0], x_size, y_size);
+
+  for (i = 0; i < size; ++i) {
+    if (inside[i] == 0.0f) {
+      _table[i] = csqrt(outside[i]) - 0.5f;
+    } else {
+      _table[i] = 0.5f - csqrt(inside[i]);
+    }
+  }
+}
+
+/**
+ * Computes the squared Euclidean distance transform of the indicated grid of
+ * x_size * y_size values in-place.  On input, each value should be 0 for a
+ * feature pixel and a very large value (not infinity) for all other pixels;
+ * on output, each value contains the squared distance to the nearest feature
+ * pixel.
+ *
+ * This is the separable algorithm of Felzenszwalb and Huttenlocher, which
+ * runs in linear time by computing the lower envelope of parabolas, first
+ * along each column, then along each row.
+ */
+void PfmFile::
+calc_squared_distance(PN_float32 *grid, int x_size, int y_size) {
+  int max_size = max(x_size, y_size);
+  if (max_size <= 0) {
+    return;
+  }
+
+  pvector<double> f(max_size);
+  pvector<int> v(max_size);
+  pvector<double> z(max_size + 1);
+
+  for (int xi = 0; xi < x_size; ++xi) {
+    calc_squared_distance_1d(grid + xi, y_size, x_size, &f[0], &v[0], &z[0]);
+  }
+  for (int yi = 0; yi < y_size; ++yi) {
+    calc_squared_distance_1d(grid + (size_t)yi * x_size, x_size, 1, &f[0], &v[0], &z[0]);
+  }
+}
+
+/**
+ * Computes the one-dimensional squared distance transform of count values,
+ * stride values apart, in-place.  The remaining parameters point to scratch
+ * buffers of at least count (or, for z, count + 1) elements.
+ */
+void PfmFile::
+calc_squared_distance_1d(PN_float32 *data, int count, int stride,
+                         double *f, int *v, double *z) {
+  for (int q = 0; q < count; ++q) {
+    f[q] = data[q * stride];
+  }
+
+  // Compute the lower envelope of the parabolas rooted at each sample.
+  int k = 0;
+  v[0] = 0;
+  z[0] = -DBL_MAX;
+  z[1] = DBL_MAX;
+  for (int q = 1; q < count; ++q) {
+    int p = v[k];
+    double s = ((f[q] + (double)q * q) - (f[p] + (double)p * p)) / (2.0 * (q - p));
+    while (s <= z[k]) {
+      // The new parabola hides the previous one entirely.
+      --k;
+      p = v[k];
+      s = ((f[q] + (double)q * q) - (f[p] + (double)p * p)) / (2.0 * (q - p));
+    }
+    ++k;
+    v[k] = q;
+    z[k] = s;
+    z[k + 1] = DBL_MAX;
+  }
+
+  // Now fill in the values from the envelope.
+  k = 0;
+  for (int q = 0; q < count; ++q) {
+    while (z[k + 1] < q) {
+      ++k;
+    }
+    double d = (double)(q - v[k]);
+    data[q * stride] = (PN_float32)(d * d + f[v[k]]);
+  }
+}
+
 /**
  * Applies delta * t to the point values within radius (xr, yr) distance of
  * (xc, yc).  The t value is scaled from 1.0 at the center to 0.0 at radius
@@ -1641,18 +1858,61 @@ calc_tight_bounds(LPoint3f &min_point, LPoint3f &max_point) const {
   min_point.set(0.0f, 0.0f, 0.0f);
   max_point.set(0.0f, 0.0f, 0.0f);
 
+  // Each range of rows computes its own bounds, which are then combined.
+  // Since we are only computing a minimum and maximum, the result does not
+  // depend on how the rows were divided up.
+  int num_ranges = get_num_row_ranges(_y_size, _x_size);
+  pvector<BoundsData> ranges(num_ranges);
+  for (BoundsData &range : ranges) {
+    range._file = this;
+    range._found_any = false;
+  }
+  run_parallel(_y_size, _x_size, &st_calc_tight_bounds_rows, &ranges[0], sizeof(BoundsData));
+
   bool found_any = false;
-  for (int yi = 0; yi < _y_size; ++yi) {
-    for (int xi = 0; xi < _x_size; ++xi) {
-      if (!has_point(xi, yi)) {
+  for (const BoundsData &range : ranges) {
+    if (!range._found_any) {
+      continue;
+    }
+    if (!found_any) {
+      min_point = range._min_point;
+      max_point = range._max_point;
+      found_any = true;
+    } else {
+      min_point.set(min(min_point[0], range._min_point[0]),
+                    min(min_point[1], range._min_point[1]),
+                    min(min_point[2], range._min_point[2]));
+      max_point.set(max(max_point[0], range._max_point[0]),
+                    max(max_point[1], range._max_point[1]),
+                    max(max_point[2], range._max_point[2]));
+    }
+  }
+
+  return found_any;
+}
+
+/**
+ * The thread function for calc_tight_bounds().  Computes the bounds of the
+ * rows in the range [y_begin, y_end).
+ */
+void PfmFile::
+st_calc_tight_bounds_rows(void *data, int y_begin, int y_end) {
+  BoundsData *bd = (BoundsData *)data;
+  const PfmFile *file = bd->_file;
+  LPoint3f &min_point = bd->_min_point;
+  LPoint3f &max_point = bd->_max_point;
+
+  for (int yi = y_begin; yi < y_end; ++yi) {
+    for (int xi = 0; xi < file->_x_size; ++xi) {
+      if (!file->has_point(xi, yi)) {
         continue;
       }
 
-      const LPoint3f &point = get_point(xi, yi);
-      if (!found_any) {
+      const LPoint3f &point = file->get_point(xi, yi);
+      if (!bd->_found_any) {
         min_point = point;
         max_point = point;
-        found_any = true;
+        bd->_found_any = true;
       } else {
         min_point.set(min(min_point[0], point[0]),
                       min(min_point[1], point[1]),
@@ -1663,8 +1923,6 @@ calc_tight_bounds(LPoint3f &min_point, LPoint3f &max_point) const {
       }
     }
   }
-
-  return found_any;
 }
 
 /**
@@ -2710,6 +2968,85 @@ fill_mini_grid(MiniGridCell *mini_grid, int x_size, int y_size,
   }
 }
 
+/**
+ * Returns the number of ranges into which run_parallel() will divide the
+ * indicated number of rows.  This is 1 if the job is too small to be worth
+ * dividing, or if true threads are not available.
+ */
+int PfmFile::
+get_num_row_ranges(int num_rows, int row_size) {
+  int num_threads = pfm_num_threads;
+  if (num_threads <= 1 || !Thread::is_true_threads()) {
+    return 1;
+  }
+
+  // Below this many points per thread, the overhead of starting the threads
+  // outweighs any benefit of running them.
+  int64_t min_points_per_thread = max((int)pfm_min_points_per_thread, 1);
+  int64_t num_points = (int64_t)num_rows * (int64_t)row_size;
+  num_threads = (int)min((int64_t)num_threads, num_points / min_points_per_thread);
+  num_threads = min(num_threads, num_rows);
+  return max(num_threads, 1);
+}
+
+/**
+ * Divides the rows [0, num_rows) into get_num_row_ranges() contiguous ranges
+ * and calls func on each of them, each in its own thread.  The calling thread
+ * processes the last range itself, and this function returns when all ranges
+ * have been processed.
+ *
+ * The function must not modify any data outside the range of rows it has been
+ * given.  If data_stride is nonzero, data is understood to point to an array
+ * of get_num_row_ranges() elements of that size, and each range receives its
+ * own element; otherwise, all ranges receive the same data pointer.
+ */
+void PfmFile::
+run_parallel(int num_rows, int row_size, RowFunc *func, void *data,
+             size_t data_stride) {
+  int num_ranges = get_num_row_ranges(num_rows, row_size);
+  if (num_ranges <= 1) {
+    (*func)(data, 0, num_rows);
+    return;
+  }
+
+  pvector<RowRange> ranges(num_ranges);
+  for (int i = 0; i < num_ranges; ++i) {
+    RowRange &range = ranges[i];
+    range._func = func;
+    range._data = (char *)data + data_stride * i;
+    range._y_begin = (int)(((int64_t)num_rows * i) / num_ranges);
+    range._y_end = (int)(((int64_t)num_rows * (i + 1)) / num_ranges);
+  }
+
+  pvector<PT(GenericThread)> threads;
+  threads.reserve(num_ranges - 1);
+  for (int i = 0; i < num_ranges - 1; ++i) {
+    PT(GenericThread) thread =
+      new GenericThread("pfm", "pfm", &st_run_row_range, &ranges[i]);
+    if (!thread->start(TP_normal, true)) {
+      // Couldn't start the thread; do the work here instead.
+      st_run_row_range(&ranges[i]);
+    } else {
+      threads.push_back(thread);
+    }
+  }
+
+  st_run_row_range(&ranges[num_ranges - 1]);
+
+  for (GenericThread *thread : threads) {
+    thread->join();
+  }
+}
+
+/**
+ * The thread function for run_parallel().
+ */
+void PfmFile::
+st_run_row_range(void *data) {
+  RowRange *range = (RowRange *)data;
+  (*range->_func)(range->_data, range->_y_begin, range->_y_end);
+}
+
 /**
  * The implementation of has_point() for files without a no_data_value.
  */
@@ -130,6 +130,7 @@ PUBLISHED:
   BLOCKING void copy_channel_masked(int to_channel, const PfmFile &other, int from_channel);
   BLOCKING void apply_crop(int x_begin, int x_end, int y_begin, int y_end);
   BLOCKING void clear_to_texcoords(int x_size, int y_size);
+  BLOCKING void fill_signed_distance(const PNMImage &mask, float threshold);
 
   BLOCKING int pull_spot(const LPoint4f &delta, float xc, float yc,
                          float xr, float yr, float exponent);
@@ -180,7 +181,52 @@ public:
   INLINE const vector_float &get_table() const;
   INLINE void swap_table(vector_float &table);
 
+  static void calc_squared_distance(PN_float32 *grid, int x_size, int y_size);
+
 private:
+  void do_xform(const LMatrix4f &transform, int y_begin, int y_end);
+
+  typedef void RowFunc(void *data, int y_begin, int y_end);
+  static int get_num_row_ranges(int num_rows, int row_size);
+  static void run_parallel(int num_rows, int row_size, RowFunc *func,
+                           void *data, size_t data_stride = 0);
+  static void st_run_row_range(void *data);
+  static void st_xform_rows(void *data, int y_begin, int y_end);
+  static void st_forward_distort_rows(void *data, int y_begin, int y_end);
+  static void st_reverse_distort_rows(void *data, int y_begin, int y_end);
+  static void st_calc_tight_bounds_rows(void *data, int y_begin, int y_end);
+
+  class RowRange {
+  public:
+    RowFunc *_func;
+    void *_data;
+    int _y_begin, _y_end;
+  };
+
+  class XformData {
+  public:
+    PfmFile *_file;
+    const LMatrix4f *_transform;
+  };
+
+  class DistortData {
+  public:
+    PfmFile *_result;
+    const PfmFile *_source;
+    const PfmFile *_dist;
+    bool _failed;
+  };
+
+  class BoundsData {
+  public:
+    const PfmFile *_file;
+    bool _found_any;
+    LPoint3f _min_point, _max_point;
+  };
+
+  static void calc_squared_distance_1d(PN_float32 *data, int count, int stride,
+                                       double *f, int *v, double *z);
+
   INLINE void setup_sub_image(const PfmFile &copy, int &xto, int &yto,
                               int &xfrom, int &yfrom, int &x_size, int &y_size,
                               int &xmin, int &ymin, int &xmax, int &ymax);
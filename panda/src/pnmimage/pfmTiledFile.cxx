@@ -0,0 +1,983 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file pfmTiledFile.cxx
+ * @author agent
+ * @date 2026-10-18
+ */
+
+#include "pfmTiledFile.h"
+#include "config_pnmimage.h"
+#include "virtualFileSystem.h"
+#include "numeric_types.h"
+#include "reversedNumericData.h"
+#include "cmath.h"
+
+using std::max;
+using std::min;
+using std::streamoff;
+
+/**
+ *
+ */
+PfmTiledFile::
+PfmTiledFile() :
+  _in(nullptr),
+  _writing(false),
+  _tiled_format(false),
+  _endian_reversed(false),
+  _data_offset(0),
+  _scale(1.0f),
+  _tile_x_size(0),
+  _tile_y_size(0),
+  _num_x_tiles(0),
+  _num_y_tiles(0),
+  _no_data_nan_channels(0),
+  _has_no_data_value(false),
+  _no_data_value(LPoint4f::zero()),
+  _max_resident_tiles(pfm_max_resident_tiles),
+  _use_counter(0)
+{
+  _x_size = 0;
+  _y_size = 0;
+  _num_channels = 0;
+}
+
+/**
+ *
+ */
+PfmTiledFile::
+~PfmTiledFile() {
+  close();
+}
+
+/**
+ * Opens the indicated pfm file for reading.  Only the header is read at this
+ * time; the point data is read on demand.  The file may be either a standard
+ * pfm file or the tiled variant; in the latter case, the tile size stored in
+ * the file is used, and the tile size parameters are ignored.  Returns true
+ * on success, false on failure.
+ *
+ * The file must not be compressed, since it must be possible to seek within
+ * it.
+ */
+bool PfmTiledFile::
+open_read(const Filename &fullpath, int tile_x_size, int tile_y_size) {
+  close();
+
+  VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
+  _filename = Filename::binary_filename(fullpath);
+  PT(VirtualFile) file = vfs->get_file(_filename);
+  if (file == nullptr) {
+    pnmimage_cat.error()
+      << "Could not find " << fullpath << "\n";
+    return false;
+  }
+
+  _in = file->open_read_file(false);
+  if (_in == nullptr) {
+    pnmimage_cat.error()
+      << "Unable to open " << fullpath << "\n";
+    return false;
+  }
+
+  std::string magic_number(2, '\0');
+  _in->read(&magic_number[0], 2);
+  if (magic_number == "pf") {
+    magic_number.resize(4);
+    _in->read(&magic_number[2], 2);
+  }
+
+  if (magic_number == "PF") {
+    _num_channels = 3;
+  } else if (magic_number == "Pf") {
+    _num_channels = 1;
+  } else if (magic_number == "pf2c") {
+    _num_channels = 2;
+  } else if (magic_number == "pf4c") {
+    _num_channels = 4;
+  } else if (magic_number == "pftl") {
+    _tiled_format = true;
+    (*_in) >> _num_channels;
+  }
+
+  if (_tiled_format) {
+    (*_in) >> _x_size >> _y_size >> tile_x_size >> tile_y_size >> _scale;
+  } else {
+    (*_in) >> _x_size >> _y_size >> _scale;
+  }
+
+  if (_num_channels < 1 || _num_channels > 4 || !(*_in) ||
+      _x_size < 0 || _y_size < 0 || tile_x_size <= 0 || tile_y_size <= 0) {
+    pnmimage_cat.error()
+      << fullpath << " is not a valid PFM file.\n";
+    close();
+    return false;
+  }
+
+  // Skip the last newline/whitespace character before the raw data begins.
+  _in->get();
+  _data_offset = _in->tellg();
+  if (_data_offset < 0) {
+    pnmimage_cat.error()
+      << "Cannot seek within " << fullpath << "\n";
+    close();
+    return false;
+  }
+
+  bool little_endian = false;
+  if (_scale < 0) {
+    _scale = -_scale;
+    little_endian = true;
+  }
+  if (pfm_force_littleendian) {
+    little_endian = true;
+  }
+  if (pfm_reverse_dimensions && !_tiled_format) {
+    std::swap(_x_size, _y_size);
+  }
+#ifdef WORDS_BIGENDIAN
+  _endian_reversed = little_endian;
+#else
+  _endian_reversed = !little_endian;
+#endif
+
+  setup_tiles(tile_x_size, tile_y_size);
+
+  if (pnmimage_cat.is_debug()) {
+    pnmimage_cat.debug()
+      << "Opened " << *this << "\n";
+  }
+  return true;
+}
+
+/**
+ * Creates the indicated pfm file for writing, with the given size and number
+ * of channels.  The point data is then written one tile at a time with
+ * write_tile(), in any order.
+ *
+ * If tiled_format is true, the file is written in the tiled variant of the
+ * pfm format; otherwise, a standard pfm file is written, which may be read by
+ * any pfm reader, but is less efficient to access one tile at a time.
+ */
+bool PfmTiledFile::
+open_write(const Filename &fullpath, int x_size, int y_size, int num_channels,
+           int tile_x_size, int tile_y_size, bool tiled_format) {
+  close();
+  nassertr(x_size >= 0 && y_size >= 0, false);
+  nassertr(num_channels > 0 && num_channels <= 4, false);
+  nassertr(tile_x_size > 0 && tile_y_size > 0, false);
+
+  _filename = Filename::binary_filename(fullpath);
+  if (!_filename.open_write(_out)) {
+    pnmimage_cat.error()
+      << "Unable to open " << _filename << "\n";
+    return false;
+  }
+
+  _writing = true;
+  _tiled_format = tiled_format;
+  _endian_reversed = false;
+  _x_size = x_size;
+  _y_size = y_size;
+  _num_channels = num_channels;
+  _scale = 1.0f;
+
+  if (tiled_format) {
+    _out << "pftl\n" << num_channels << " " << x_size << " " << y_size << "\n"
+         << tile_x_size << " " << tile_y_size << "\n";
+  } else {
+    switch (num_channels) {
+    case 1:
+      _out << "Pf\n";
+      break;
+    case 2:
+      _out << "pf2c\n";
+      break;
+    case 3:
+      _out << "PF\n";
+      break;
+    case 4:
+      _out << "pf4c\n";
+      break;
+    }
+    _out << x_size << " " << y_size << "\n";
+  }
+
+#ifdef WORDS_BIGENDIAN
+  _out << "1\n";
+#else
+  // Little-endian computers must write a negative scale to indicate the
+  // little-endian nature of the output.
+  _out << "-1\n";
+#endif
+
+  _data_offset = _out.tellp();
+  setup_tiles(tile_x_size, tile_y_size);
+
+  if (pnmimage_cat.is_debug()) {
+    pnmimage_cat.debug()
+      << "Writing " << *this << "\n";
+  }
+  return !_out.fail();
+}
+
+/**
+ * Closes the file, and releases all of the tiles held in memory.  If the file
+ * was opened for writing, any tiles that were never written are left filled
+ * with zeroes.
+ */
+void PfmTiledFile::
+close() {
+  if (_in != nullptr) {
+    VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
+    vfs->close_read_file(_in);
+    _in = nullptr;
+  }
+
+  if (_writing) {
+    // Make sure the file is as long as it should be, even if the last tile
+    // was never written.
+    streamoff end;
+    if (_tiled_format) {
+      end = get_tile_offset(0, _num_y_tiles);
+    } else {
+      end = get_point_offset(0, _y_size);
+    }
+    _out.seekp(0, std::ios::end);
+    if (_out.tellp() < end) {
+      _out.seekp(end - 1);
+      _out.put('\0');
+    }
+    _out.close();
+    _writing = false;
+  }
+
+  _cache.clear();
+  _tiled_format = false;
+  _x_size = 0;
+  _y_size = 0;
+  _num_channels = 0;
+  _num_x_tiles = 0;
+  _num_y_tiles = 0;
+}
+
+/**
+ * Sets the no_data_nan flag on every tile read from the file.  When
+ * num_channels is nonzero, then a NaN value in any of the first num_channels
+ * channels indicates no data for that point.
+ */
+void PfmTiledFile::
+set_no_data_nan(int num_channels) {
+  _no_data_nan_channels = max(num_channels, 0);
+  _has_no_data_value = false;
+  _cache.clear();
+}
+
+/**
+ * Sets the special value that means "no data" when it appears in the pfm
+ * file.  This is applied to every tile read from the file.
+ */
+void PfmTiledFile::
+set_no_data_value(const LPoint4f &no_data_value) {
+  _no_data_nan_channels = 0;
+  _has_no_data_value = true;
+  _no_data_value = no_data_value;
+  _cache.clear();
+}
+
+/**
+ * Fills the indicated PfmFile with the contents of the indicated tile of the
+ * file, which must have been opened for reading.  Returns true on success,
+ * false on failure.
+ */
+bool PfmTiledFile::
+read_tile(PfmFile &tile, int tx, int ty) {
+  nassertr(is_valid() && !_writing, false);
+  nassertr(tx >= 0 && tx < _num_x_tiles && ty >= 0 && ty < _num_y_tiles, false);
+
+  // If we happen to have the tile already, we don't need to go to disk.
+  for (const CachedTile &cached : _cache) {
+    if (cached._tx == tx && cached._ty == ty) {
+      tile = cached._tile;
+      return true;
+    }
+  }
+  return do_read_tile(tile, tx, ty);
+}
+
+/**
+ * Writes the indicated PfmFile into the indicated tile of the file, which
+ * must have been opened for writing.  The PfmFile must have the same number
+ * of channels as the file, and must be exactly the size of the tile, as
+ * returned by get_tile_width() and get_tile_height().  Returns true on
+ * success, false on failure.
+ */
+bool PfmTiledFile::
+write_tile(const PfmFile &tile, int tx, int ty) {
+  nassertr(is_valid() && _writing, false);
+  nassertr(tx >= 0 && tx < _num_x_tiles && ty >= 0 && ty < _num_y_tiles, false);
+  nassertr(tile.get_num_channels() == _num_channels, false);
+
+  int width = get_tile_width(tx);
+  int height = get_tile_height(ty);
+  nassertr(tile.get_x_size() == width && tile.get_y_size() == height, false);
+
+  const vector_float &table = tile.get_table();
+  size_t row_size = (size_t)width * _num_channels;
+
+  if (_tiled_format) {
+    _out.seekp(get_tile_offset(tx, ty));
+    if (width == _tile_x_size) {
+      _out.write((const char *)&table[0], sizeof(PN_float32) * row_size * height);
+    } else {
+      // The tile is short; we pad each row out to the full tile size.
+      vector_float padding((size_t)(_tile_x_size - width) * _num_channels, 0.0f);
+      for (int yi = 0; yi < height; ++yi) {
+        _out.write((const char *)&table[yi * row_size], sizeof(PN_float32) * row_size);
+        _out.write((const char *)&padding[0], sizeof(PN_float32) * padding.size());
+      }
+    }
+
+  } else {
+    int x_begin = tx * _tile_x_size;
+    int y_begin = ty * _tile_y_size;
+    for (int yi = 0; yi < height; ++yi) {
+      _out.seekp(get_point_offset(x_begin, y_begin + yi));
+      _out.write((const char *)&table[yi * row_size], sizeof(PN_float32) * row_size);
+    }
+  }
+
+  if (_out.fail()) {
+    pnmimage_cat.error()
+      << "Error writing to " << _filename << "\n";
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Fills the indicated PfmFile with an arbitrary rectangular region of the
+ * file, which must have been opened for reading.  The region may span any
+ * number of tiles, but must lie entirely within the file.  Returns true on
+ * success, false on failure.
+ */
+bool PfmTiledFile::
+read_region(PfmFile &region, int x_begin, int y_begin, int x_size, int y_size) {
+  nassertr(is_valid() && !_writing, false);
+  nassertr(x_begin >= 0 && y_begin >= 0 && x_size >= 0 && y_size >= 0 &&
+           x_begin + x_size <= _x_size && y_begin + y_size <= _y_size, false);
+
+  if (!_tiled_format) {
+    // The rows are stored contiguously, so we can read them directly.
+    prepare_region(region, x_size, y_size);
+    return read_rows(region, x_begin, y_begin);
+  }
+
+  // Otherwise, we assemble the region from the tiles that overlap it.
+  prepare_region(region, x_size, y_size);
+  if (x_size == 0 || y_size == 0) {
+    return true;
+  }
+
+  int tx_begin = x_begin / _tile_x_size;
+  int tx_end = (x_begin + x_size - 1) / _tile_x_size + 1;
+  int ty_begin = y_begin / _tile_y_size;
+  int ty_end = (y_begin + y_size - 1) / _tile_y_size + 1;
+
+  for (int ty = ty_begin; ty < ty_end; ++ty) {
+    for (int tx = tx_begin; tx < tx_end; ++tx) {
+      const PfmFile *tile = get_cached_tile(tx, ty);
+      if (tile == nullptr) {
+        return false;
+      }
+      int xto = tx * _tile_x_size - x_begin;
+      int yto = ty * _tile_y_size - y_begin;
+      region.copy_sub_image(*tile, xto, yto);
+    }
+  }
+  return true;
+}
+
+/**
+ * Computes the weighted average of the four nearest points to the floating-
+ * point index (x, y), in the range 0..1, as in PfmFile::calc_bilinear_point().
+ * Only the tiles containing those points are read from disk, and they are
+ * retained for future calls, up to the limit specified by
+ * set_max_resident_tiles().
+ */
+bool PfmTiledFile::
+calc_bilinear_point(LPoint3f &result, PN_float32 x, PN_float32 y) {
+  LPoint4f result4;
+  bool any = calc_bilinear_point4(result4, x, y);
+  result = result4.get_xyz();
+  return any;
+}
+
+/**
+ * Computes the weighted average of the four nearest points to the floating-
+ * point index (x, y), in the range 0..1, as in calc_bilinear_point(), but
+ * returns all four channels.
+ */
+bool PfmTiledFile::
+calc_bilinear_point4(LPoint4f &result, PN_float32 x, PN_float32 y) {
+  result = LPoint4f::zero();
+
+  x = (x * _x_size - 0.5);
+  y = (y * _y_size - 0.5);
+
+  int min_x = int(floor(x));
+  int min_y = int(floor(y));
+
+  PN_float32 frac_x = x - min_x;
+  PN_float32 frac_y = y - min_y;
+
+  LPoint4f p00, p01, p10, p11;
+  PN_float32 w00 = 0.0, w01 = 0.0, w10 = 0.0, w11 = 0.0;
+
+  if (get_cached_point(p00, min_x, min_y)) {
+    w00 = (1.0 - frac_y) * (1.0 - frac_x);
+  }
+  if (get_cached_point(p10, min_x + 1, min_y)) {
+    w10 = (1.0 - frac_y) * frac_x;
+  }
+  if (get_cached_point(p01, min_x, min_y + 1)) {
+    w01 = frac_y * (1.0 - frac_x);
+  }
+  if (get_cached_point(p11, min_x + 1, min_y + 1)) {
+    w11 = frac_y * frac_x;
+  }
+
+  PN_float32 net_w = w00 + w01 + w10 + w11;
+  if (net_w == 0.0) {
+    return false;
+  }
+
+  result = (p00 * w00 + p01 * w01 + p10 * w10 + p11 * w11) / net_w;
+  return true;
+}
+
+/**
+ * Calculates the minimum and maximum x, y, and z depth component values over
+ * the whole file, reading it one tile at a time.  Returns true if successful,
+ * false if the file contains no points.
+ */
+bool PfmTiledFile::
+calc_min_max(LVecBase3f &min_points, LVecBase3f &max_points) {
+  nassertr(is_valid() && !_writing, false);
+
+  bool any_points = false;
+  min_points = LVecBase3f::zero();
+  max_points = LVecBase3f::zero();
+
+  PfmFile tile;
+  for (int ty = 0; ty < _num_y_tiles; ++ty) {
+    for (int tx = 0; tx < _num_x_tiles; ++tx) {
+      if (!read_tile(tile, tx, ty)) {
+        return false;
+      }
+      LVecBase3f tile_min, tile_max;
+      if (!tile.calc_min_max(tile_min, tile_max)) {
+        continue;
+      }
+      if (!any_points) {
+        min_points = tile_min;
+        max_points = tile_max;
+        any_points = true;
+      } else {
+        min_points = min_points.fmin(tile_min);
+        max_points = max_points.fmax(tile_max);
+      }
+    }
+  }
+
+  return any_points;
+}
+
+/**
+ * Resamples the contents of this file into the indicated destination file,
+ * which must have been opened for writing with the same number of channels,
+ * and the desired new size.  This is the streaming equivalent of
+ * PfmFile::resize(); when the file is being reduced in size, each point is a
+ * box-filtered average of the points it covers, and otherwise it is
+ * bilinearly interpolated.
+ */
+bool PfmTiledFile::
+resize(PfmTiledFile &dest) {
+  if (!check_dest(dest, false)) {
+    return false;
+  }
+
+  PN_float32 x_scale = (PN_float32)_x_size / (PN_float32)max(dest._x_size, 1);
+  PN_float32 y_scale = (PN_float32)_y_size / (PN_float32)max(dest._y_size, 1);
+  bool downsample = (x_scale >= 1.0f && y_scale >= 1.0f);
+
+  PfmFile tile, source;
+  for (int ty = 0; ty < dest._num_y_tiles; ++ty) {
+    for (int tx = 0; tx < dest._num_x_tiles; ++tx) {
+      int width = dest.get_tile_width(tx);
+      int height = dest.get_tile_height(ty);
+      int x_begin = tx * dest._tile_x_size;
+      int y_begin = ty * dest._tile_y_size;
+      dest.prepare_region(tile, width, height);
+
+      if (downsample) {
+        // Read the part of the source that this tile covers.
+        int sx_begin = (int)floor(x_begin * x_scale);
+        int sy_begin = (int)floor(y_begin * y_scale);
+        int sx_end = min((int)cceil((x_begin + width) * x_scale), _x_size);
+        int sy_end = min((int)cceil((y_begin + height) * y_scale), _y_size);
+        if (!read_region(source, sx_begin, sy_begin,
+                         sx_end - sx_begin, sy_end - sy_begin)) {
+          return false;
+        }
+
+        for (int yi = 0; yi < height; ++yi) {
+          PN_float32 y0 = (y_begin + yi) * y_scale - sy_begin;
+          PN_float32 y1 = y0 + y_scale;
+          for (int xi = 0; xi < width; ++xi) {
+            PN_float32 x0 = (x_begin + xi) * x_scale - sx_begin;
+            PN_float32 x1 = x0 + x_scale;
+
+            LPoint4f net(LPoint4f::zero());
+            PN_float32 net_w = 0.0f;
+            int syi_end = min((int)cceil(y1), source.get_y_size());
+            int sxi_end = min((int)cceil(x1), source.get_x_size());
+            for (int syi = (int)y0; syi < syi_end; ++syi) {
+              PN_float32 wy = min(y1, (PN_float32)(syi + 1)) - max(y0, (PN_float32)syi);
+              for (int sxi = (int)x0; sxi < sxi_end; ++sxi) {
+                if (!source.has_point(sxi, syi)) {
+                  continue;
+                }
+                PN_float32 w = wy * (min(x1, (PN_float32)(sxi + 1)) - max(x0, (PN_float32)sxi));
+                for (int c = 0; c < _num_channels; ++c) {
+                  net[c] += source.get_channel(sxi, syi, c) * w;
+                }
+                net_w += w;
+              }
+            }
+
+            if (net_w > 0.0f) {
+              for (int c = 0; c < _num_channels; ++c) {
+                tile.set_channel(xi, yi, c, net[c] / net_w);
+              }
+            }
+          }
+        }
+
+      } else {
+        // Upsampling; interpolate from the surrounding points.
+        for (int yi = 0; yi < height; ++yi) {
+          PN_float32 v = (y_begin + yi + 0.5f) / dest._y_size;
+          for (int xi = 0; xi < width; ++xi) {
+            PN_float32 u = (x_begin + xi + 0.5f) / dest._x_size;
+            LPoint4f p;
+            if (calc_bilinear_point4(p, u, v)) {
+              for (int c = 0; c < _num_channels; ++c) {
+                tile.set_channel(xi, yi, c, p[c]);
+              }
+            }
+          }
+        }
+      }
+
+      if (!dest.write_tile(tile, tx, ty)) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+/**
+ * Applies the indicated transform matrix to all points, writing the results
+ * to the indicated destination file, which must have been opened for writing
+ * with the same size and number of channels as this file.  This is the
+ * streaming equivalent of PfmFile::xform().
+ */
+bool PfmTiledFile::
+xform(PfmTiledFile &dest, const LMatrix4f &transform) {
+  if (!check_dest(dest, true)) {
+    return false;
+  }
+
+  PfmFile tile;
+  for (int ty = 0; ty < dest._num_y_tiles; ++ty) {
+    for (int tx = 0; tx < dest._num_x_tiles; ++tx) {
+      int width = dest.get_tile_width(tx);
+      int height = dest.get_tile_height(ty);
+      if (!read_region(tile, tx * dest._tile_x_size, ty * dest._tile_y_size,
+                       width, height)) {
+        return false;
+      }
+      tile.xform(transform);
+      if (!dest.write_tile(tile, tx, ty)) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+/**
+ * Applies the distortion indicated in the supplied dist map to the points of
+ * this file, writing the result to the indicated destination file, which
+ * must have been opened for writing with the same size and number of
+ * channels as this file.  This is the streaming equivalent of
+ * PfmFile::forward_distort(), with a scale_factor of 1:
+ *
+ * dest(u, v) = this(dist(u, v))
+ *
+ * The points of this file are read at random, according to the dist map, so
+ * it is best if neighboring points of the dist map refer to nearby points in
+ * this file.
+ */
+bool PfmTiledFile::
+forward_distort(PfmTiledFile &dest, PfmTiledFile &dist) {
+  if (!check_dest(dest, true)) {
+    return false;
+  }
+  nassertr(dist.is_valid() && !dist._writing && dist._num_channels >= 2, false);
+
+  bool same_size = (dist._x_size == _x_size && dist._y_size == _y_size);
+
+  PfmFile tile, dist_region;
+  for (int ty = 0; ty < dest._num_y_tiles; ++ty) {
+    for (int tx = 0; tx < dest._num_x_tiles; ++tx) {
+      int width = dest.get_tile_width(tx);
+      int height = dest.get_tile_height(ty);
+      int x_begin = tx * dest._tile_x_size;
+      int y_begin = ty * dest._tile_y_size;
+      dest.prepare_region(tile, width, height);
+
+      // By convention, the y axis is inverted in the distortion map.
+      if (same_size &&
+          !dist.read_region(dist_region, x_begin, _y_size - y_begin - height,
+                            width, height)) {
+        return false;
+      }
+
+      for (int yi = 0; yi < height; ++yi) {
+        for (int xi = 0; xi < width; ++xi) {
+          LPoint3f uv;
+          if (same_size) {
+            int dyi = height - 1 - yi;
+            if (!dist_region.has_point(xi, dyi)) {
+              continue;
+            }
+            uv.set(dist_region.get_channel(xi, dyi, 0),
+                   dist_region.get_channel(xi, dyi, 1), 0.0f);
+
+          } else if (!dist.calc_bilinear_point(uv, (x_begin + xi + 0.5f) / _x_size,
+                                               1.0f - (y_begin + yi + 0.5f) / _y_size)) {
+            continue;
+          }
+
+          LPoint4f p;
+          if (!calc_bilinear_point4(p, uv[0], 1.0 - uv[1])) {
+            continue;
+          }
+          for (int c = 0; c < _num_channels; ++c) {
+            tile.set_channel(xi, yi, c, p[c]);
+          }
+        }
+      }
+
+      if (!dest.write_tile(tile, tx, ty)) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+/**
+ * Applies the distortion indicated in the supplied dist map to the points of
+ * this file, writing the result to the indicated destination file, which
+ * must have been opened for writing with the same size and number of
+ * channels as this file.  This is the streaming equivalent of
+ * PfmFile::reverse_distort(), with a scale_factor of 1:
+ *
+ * dest(u, v) = dist(this(u, v))
+ *
+ * The points of the dist map are read at random, so it is best if the dist
+ * map is small, or if neighboring points of this file refer to nearby points
+ * in the dist map.
+ */
+bool PfmTiledFile::
+reverse_distort(PfmTiledFile &dest, PfmTiledFile &dist) {
+  if (!check_dest(dest, true)) {
+    return false;
+  }
+  nassertr(_num_channels >= 2, false);
+  nassertr(dist.is_valid() && !dist._writing, false);
+
+  PfmFile source, tile;
+  for (int ty = 0; ty < dest._num_y_tiles; ++ty) {
+    for (int tx = 0; tx < dest._num_x_tiles; ++tx) {
+      int width = dest.get_tile_width(tx);
+      int height = dest.get_tile_height(ty);
+      if (!read_region(source, tx * dest._tile_x_size, ty * dest._tile_y_size,
+                       width, height)) {
+        return false;
+      }
+      dest.prepare_region(tile, width, height);
+
+      for (int yi = 0; yi < height; ++yi) {
+        for (int xi = 0; xi < width; ++xi) {
+          if (!source.has_point(xi, yi)) {
+            continue;
+          }
+          LPoint4f p;
+          if (!dist.calc_bilinear_point4(p, source.get_channel(xi, yi, 0),
+                                         1.0 - source.get_channel(xi, yi, 1))) {
+            continue;
+          }
+          p[1] = 1.0 - p[1];
+          for (int c = 0; c < _num_channels; ++c) {
+            tile.set_channel(xi, yi, c, p[c]);
+          }
+        }
+      }
+
+      if (!dest.write_tile(tile, tx, ty)) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+/**
+ *
+ */
+void PfmTiledFile::
+output(std::ostream &out) const {
+  out << "PfmTiledFile " << _filename << ", " << _x_size << " by " << _y_size
+      << " by " << _num_channels << " in ";
+  if (_tiled_format) {
+    out << "stored ";
+  }
+  out << _tile_x_size << " by " << _tile_y_size << " tiles";
+}
+
+/**
+ * Computes the number of tiles from the file size and the indicated tile
+ * size.
+ */
+void PfmTiledFile::
+setup_tiles(int tile_x_size, int tile_y_size) {
+  _tile_x_size = tile_x_size;
+  _tile_y_size = tile_y_size;
+  _num_x_tiles = (_x_size + _tile_x_size - 1) / _tile_x_size;
+  _num_y_tiles = (_y_size + _tile_y_size - 1) / _tile_y_size;
+  _cache.clear();
+}
+
+/**
+ * Resets the indicated PfmFile to the indicated size, with the same number of
+ * channels and "no data" value as this file, and fills it with the "no data"
+ * value, if any.
+ */
+void PfmTiledFile::
+prepare_region(PfmFile &region, int x_size, int y_size) const {
+  region.clear(x_size, y_size, _num_channels);
+  region.set_scale(_scale);
+  if (_no_data_nan_channels != 0) {
+    region.set_no_data_nan(_no_data_nan_channels);
+    region.fill_no_data_value();
+  } else if (_has_no_data_value) {
+    region.set_no_data_value(_no_data_value);
+    region.fill_no_data_value();
+  }
+}
+
+/**
+ * Reads the indicated tile from disk, bypassing the cache.
+ */
+bool PfmTiledFile::
+do_read_tile(PfmFile &tile, int tx, int ty) {
+  int width = get_tile_width(tx);
+  int height = get_tile_height(ty);
+  if (!_tiled_format) {
+    prepare_region(tile, width, height);
+    return read_rows(tile, tx * _tile_x_size, ty * _tile_y_size);
+  }
+
+  prepare_region(tile, width, height);
+  size_t row_size = (size_t)width * _num_channels;
+  vector_float table;
+  tile.swap_table(table);
+
+  _in->clear();
+  _in->seekg(get_tile_offset(tx, ty));
+  if (width == _tile_x_size) {
+    _in->read((char *)&table[0], sizeof(PN_float32) * row_size * height);
+  } else {
+    // The tile is short; skip the padding at the end of each row.
+    streamoff padding = (streamoff)(_tile_x_size - width) * _num_channels * sizeof(PN_float32);
+    for (int yi = 0; yi < height && !_in->fail(); ++yi) {
+      _in->read((char *)&table[yi * row_size], sizeof(PN_float32) * row_size);
+      _in->seekg(padding, std::ios::cur);
+    }
+  }
+
+  bool success = !_in->fail();
+  if (success && _endian_reversed) {
+    reverse_endian(&table[0], row_size * height);
+  }
+  tile.swap_table(table);
+
+  if (!success) {
+    pnmimage_cat.error()
+      << "Error reading tile " << tx << ", " << ty << " from " << _filename << "\n";
+  }
+  return success;
+}
+
+/**
+ * Reads the rows of the indicated region directly from a standard pfm file,
+ * into the PfmFile, which has already been sized appropriately.
+ */
+bool PfmTiledFile::
+read_rows(PfmFile &region, int x_begin, int y_begin) {
+  nassertr(!_tiled_format, false);
+
+  int width = region.get_x_size();
+  int height = region.get_y_size();
+  size_t row_size = (size_t)width * _num_channels;
+  if (row_size == 0) {
+    return true;
+  }
+
+  vector_float table;
+  region.swap_table(table);
+
+  _in->clear();
+  for (int yi = 0; yi < height && !_in->fail(); ++yi) {
+    _in->seekg(get_point_offset(x_begin, y_begin + yi));
+    _in->read((char *)&table[yi * row_size], sizeof(PN_float32) * row_size);
+  }
+
+  bool success = !_in->fail();
+  if (success && _endian_reversed) {
+    reverse_endian(&table[0], row_size * height);
+  }
+  region.swap_table(table);
+
+  if (!success) {
+    pnmimage_cat.error()
+      << "Error reading " << _filename << "\n";
+  }
+  return success;
+}
+
+/**
+ * Returns the indicated tile from the cache, reading it from disk (and
+ * evicting the least-recently-used tile) if necessary.  Returns NULL on
+ * failure.  The pointer remains valid only until the next call.
+ */
+const PfmFile *PfmTiledFile::
+get_cached_tile(int tx, int ty) {
+  ++_use_counter;
+
+  Cache::iterator ci;
+  Cache::iterator oldest = _cache.end();
+  for (ci = _cache.begin(); ci != _cache.end(); ++ci) {
+    if ((*ci)._tx == tx && (*ci)._ty == ty) {
+      (*ci)._last_used = _use_counter;
+      return &(*ci)._tile;
+    }
+    if (oldest == _cache.end() || (*ci)._last_used < (*oldest)._last_used) {
+      oldest = ci;
+    }
+  }
+
+  if ((int)_cache.size() < _max_resident_tiles) {
+    _cache.push_back(CachedTile());
+    oldest = _cache.end() - 1;
+  }
+
+  CachedTile &cached = (*oldest);
+  cached._tx = tx;
+  cached._ty = ty;
+  cached._last_used = _use_counter;
+  if (!do_read_tile(cached._tile, tx, ty)) {
+    _cache.erase(oldest);
+    return nullptr;
+  }
+  return &cached._tile;
+}
+
+/**
+ * Fetches the indicated point through the tile cache.  Returns true if the
+ * point is within the file and has data, false otherwise.
+ */
+bool PfmTiledFile::
+get_cached_point(LPoint4f &result, int x, int y) {
+  result = LPoint4f::zero();
+  if (x < 0 || x >= _x_size || y < 0 || y >= _y_size) {
+    return false;
+  }
+
+  int tx = x / _tile_x_size;
+  int ty = y / _tile_y_size;
+  const PfmFile *tile = get_cached_tile(tx, ty);
+  if (tile == nullptr) {
+    return false;
+  }
+
+  x -= tx * _tile_x_size;
+  y -= ty * _tile_y_size;
+  if (!tile->has_point(x, y)) {
+    return false;
+  }
+  for (int c = 0; c < _num_channels; ++c) {
+    result[c] = tile->get_channel(x, y, c);
+  }
+  return true;
+}
+
+/**
+ * Verifies that this file has been opened for reading, and the indicated file
+ * has been opened for writing with a compatible format.  Returns true if all
+ * is well, false (with an error message) otherwise.
+ */
+bool PfmTiledFile::
+check_dest(const PfmTiledFile &dest, bool same_size) const {
+  nassertr(is_valid() && !_writing, false);
+  nassertr(&dest != this, false);
+
+  if (!dest.is_valid() || !dest._writing) {
+    pnmimage_cat.error()
+      << "Destination file has not been opened for writing.\n";
+    return false;
+  }
+  if (dest._num_channels != _num_channels ||
+      (same_size && (dest._x_size != _x_size || dest._y_size != _y_size))) {
+    pnmimage_cat.error()
+      << dest << " does not match " << *this << "\n";
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Reverses the byte order of the indicated floats in-place.
+ */
+void PfmTiledFile::
+reverse_endian(PN_float32 *data, size_t count) const {
+  for (size_t i = 0; i < count; ++i) {
+    ReversedNumericData nd(&data[i], sizeof(PN_float32));
+    nd.store_value(&data[i], sizeof(PN_float32));
+  }
+}
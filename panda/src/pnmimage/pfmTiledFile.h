@@ -0,0 +1,148 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file pfmTiledFile.h
+ * @author agent
+ * @date 2026-10-18
+ */
+
+#ifndef PFMTILEDFILE_H
+#define PFMTILEDFILE_H
+
+#include "pandabase.h"
+#include "pnmImageHeader.h"
+#include "pfmFile.h"
+#include "filename.h"
+#include "pandaFileStream.h"
+#include "luse.h"
+
+/**
+ * Provides access to a pfm file on disk that may be much too large to hold in
+ * memory all at once.  The file is divided into rectangular tiles, which are
+ * read (or written) individually, and only a bounded number of tiles are ever
+ * held in memory at a time.
+ *
+ * This can read any standard pfm file, in which case the tiles are simply
+ * rectangular regions of the rows on disk, or a special tiled variant of the
+ * pfm format, in which each tile is stored contiguously, which makes reading
+ * a tile much cheaper.  The tiled variant may also be read in its entirety
+ * with PfmFile::read().
+ *
+ * A number of the PfmFile operations are provided here in a streaming form,
+ * which read the source file one tile at a time and write the results to
+ * another PfmTiledFile that has been opened for writing.  The tiles are
+ * processed one at a time, since they share the file stream and the cache of
+ * resident tiles; only xform() divides the rows of each tile among threads,
+ * as PfmFile::xform() does.
+ *
+ * This class is not inherently thread-safe; use it from a single thread or
+ * protect access using a mutex.
+ */
+class EXPCL_PANDA_PNMIMAGE PfmTiledFile : public PNMImageHeader {
+PUBLISHED:
+  PfmTiledFile();
+  ~PfmTiledFile();
+
+  BLOCKING bool open_read(const Filename &fullpath,
+                          int tile_x_size = 256, int tile_y_size = 256);
+  BLOCKING bool open_write(const Filename &fullpath, int x_size, int y_size,
+                           int num_channels, int tile_x_size = 256,
+                           int tile_y_size = 256, bool tiled_format = true);
+  BLOCKING void close();
+
+  INLINE bool is_valid() const;
+  INLINE bool is_writing() const;
+  INLINE bool is_tiled_format() const;
+  INLINE PN_float32 get_scale() const;
+  MAKE_PROPERTY(valid, is_valid);
+  MAKE_PROPERTY(scale, get_scale);
+
+  INLINE int get_tile_x_size() const;
+  INLINE int get_tile_y_size() const;
+  INLINE int get_num_x_tiles() const;
+  INLINE int get_num_y_tiles() const;
+  INLINE int get_tile_width(int tx) const;
+  INLINE int get_tile_height(int ty) const;
+
+  INLINE void set_max_resident_tiles(int max_resident_tiles);
+  INLINE int get_max_resident_tiles() const;
+  MAKE_PROPERTY(max_resident_tiles, get_max_resident_tiles, set_max_resident_tiles);
+
+  void set_no_data_nan(int num_channels);
+  void set_no_data_value(const LPoint4f &no_data_value);
+  INLINE void clear_no_data_value();
+  INLINE bool has_no_data_value() const;
+
+  BLOCKING bool read_tile(PfmFile &tile, int tx, int ty);
+  BLOCKING bool write_tile(const PfmFile &tile, int tx, int ty);
+  BLOCKING bool read_region(PfmFile &region, int x_begin, int y_begin,
+                            int x_size, int y_size);
+
+  BLOCKING bool calc_bilinear_point(LPoint3f &result, PN_float32 x, PN_float32 y);
+  BLOCKING bool calc_bilinear_point4(LPoint4f &result, PN_float32 x, PN_float32 y);
+  BLOCKING bool calc_min_max(LVecBase3f &min_points, LVecBase3f &max_points);
+
+  BLOCKING bool resize(PfmTiledFile &dest);
+  BLOCKING bool xform(PfmTiledFile &dest, const LMatrix4f &transform);
+  BLOCKING bool forward_distort(PfmTiledFile &dest, PfmTiledFile &dist);
+  BLOCKING bool reverse_distort(PfmTiledFile &dest, PfmTiledFile &dist);
+
+  void output(std::ostream &out) const;
+
+private:
+  void setup_tiles(int tile_x_size, int tile_y_size);
+  void prepare_region(PfmFile &region, int x_size, int y_size) const;
+  bool do_read_tile(PfmFile &tile, int tx, int ty);
+  bool read_rows(PfmFile &region, int x_begin, int y_begin);
+  const PfmFile *get_cached_tile(int tx, int ty);
+  bool get_cached_point(LPoint4f &result, int x, int y);
+  bool check_dest(const PfmTiledFile &dest, bool same_size) const;
+
+  INLINE std::streamoff get_tile_offset(int tx, int ty) const;
+  INLINE std::streamoff get_point_offset(int x, int y) const;
+  void reverse_endian(PN_float32 *data, size_t count) const;
+
+private:
+  Filename _filename;
+  std::istream *_in;
+  pofstream _out;
+  bool _writing;
+  bool _tiled_format;
+  bool _endian_reversed;
+  std::streamoff _data_offset;
+  PN_float32 _scale;
+
+  int _tile_x_size;
+  int _tile_y_size;
+  int _num_x_tiles;
+  int _num_y_tiles;
+
+  int _no_data_nan_channels;
+  bool _has_no_data_value;
+  LPoint4f _no_data_value;
+
+  class CachedTile {
+  public:
+    int _tx, _ty;
+    unsigned int _last_used;
+    PfmFile _tile;
+  };
+  typedef pvector<CachedTile> Cache;
+  Cache _cache;
+  int _max_resident_tiles;
+  unsigned int _use_counter;
+};
+
+INLINE std::ostream &operator << (std::ostream &out, const PfmTiledFile &file) {
+  file.output(out);
+  return out;
+}
+
+#include "pfmTiledFile.I"
+
+#endif
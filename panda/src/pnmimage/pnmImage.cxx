@@ -1583,8 +1583,8 @@ threshold(const PNMImage &select_image, int channel, float threshold,
  * Replaces this image with a grayscale image whose gray channel represents
  * the linear Manhattan distance from the nearest dark pixel in the given mask
  * image, up to the specified radius value (which also becomes the new
- * maxval).  radius may range from 0 to maxmaxval; smaller values will compute
- * faster.  A dark pixel is defined as one whose pixel value is < threshold.
+ * maxval).  radius may range from 0 to maxmaxval.  A dark pixel is defined
+ * as one whose pixel value is < threshold.
  *
  * If shrink_from_border is true, then the mask image is considered to be
  * surrounded by a border of dark pixels; otherwise, the border isn't
@@ -1607,23 +1607,26 @@ fill_distance_inside(const PNMImage &mask, float threshold, int radius, bool shr
   for (int yi = 0; yi < mask.get_y_size(); ++yi) {
     for (int xi = 0; xi < mask.get_x_size(); ++xi) {
       if (mask.get_gray_val(xi, yi) < threshold_val) {
-        dist.do_fill_distance(xi, yi, 0);
+        dist.set_gray_val(xi, yi, 0);
       }
     }
   }
 
-  if (shrink_from_border) {
+  if (shrink_from_border && radius > 0) {
     // Also measure from the image border.
-    for (int yi = 0; yi < mask.get_y_size(); ++yi) {
-      dist.do_fill_distance(0, yi, 1);
-      dist.do_fill_distance(mask.get_x_size() - 1, yi, 1);
+    int x_last = mask.get_x_size() - 1;
+    int y_last = mask.get_y_size() - 1;
+    for (int yi = 0; yi <= y_last; ++yi) {
+      dist.set_gray_val(0, yi, std::min(dist.get_gray_val(0, yi), (xelval)1));
+      dist.set_gray_val(x_last, yi, std::min(dist.get_gray_val(x_last, yi), (xelval)1));
     }
-    for (int xi = 0; xi < mask.get_x_size(); ++xi) {
-      dist.do_fill_distance(xi, 0, 1);
-      dist.do_fill_distance(xi, mask.get_y_size() - 1, 1);
+    for (int xi = 0; xi <= x_last; ++xi) {
+      dist.set_gray_val(xi, 0, std::min(dist.get_gray_val(xi, 0), (xelval)1));
+      dist.set_gray_val(xi, y_last, std::min(dist.get_gray_val(xi, y_last), (xelval)1));
     }
   }
 
+  dist.do_fill_distance();
   take_from(dist);
 }
 
@@ -1631,8 +1634,8 @@ fill_distance_inside(const PNMImage &mask, float threshold, int radius, bool shr
  * Replaces this image with a grayscale image whose gray channel represents
  * the linear Manhattan distance from the nearest white pixel in the given
  * mask image, up to the specified radius value (which also becomes the new
- * maxval).  radius may range from 0 to maxmaxval; smaller values will compute
- * faster.  A white pixel is defined as one whose pixel value is >= threshold.
+ * maxval).  radius may range from 0 to maxmaxval.  A white pixel is defined
+ * as one whose pixel value is >= threshold.
  *
  * This can be used, in conjunction with threshold, to grow a mask image
  * outwards by a certain number of pixels.
@@ -1651,14 +1654,51 @@ fill_distance_outside(const PNMImage &mask, float threshold, int radius) {
   for (int yi = 0; yi < mask.get_y_size(); ++yi) {
     for (int xi = 0; xi < mask.get_x_size(); ++xi) {
       if (mask.get_gray_val(xi, yi) >= threshold_val) {
-        dist.do_fill_distance(xi, yi, 0);
+        dist.set_gray_val(xi, yi, 0);
       }
     }
   }
 
+  dist.do_fill_distance();
   take_from(dist);
 }
 
+/**
+ * Replaces this image with a grayscale image representing the signed
+ * Euclidean distance field of the given mask image, as is commonly used for
+ * rendering scalable text and decals.  A value of 0.5 lies on the boundary of
+ * the mask; pixels inside the mask (those whose value is >= threshold) are
+ * brighter, and pixels outside it are darker, reaching 1.0 and 0.0,
+ * respectively, at radius pixels away from the boundary.  The maxval of this
+ * image is preserved.
+ *
+ * Unlike fill_distance_inside() and fill_distance_outside(), the distance is
+ * exact, and the computation time does not depend on the radius.  See also
+ * PfmFile::fill_signed_distance(), which stores the unscaled distances.
+ *
+ * The mask image may be the same image as this one, in which case it is
+ * destructively modified by this process.
+ */
+void PNMImage::
+fill_signed_distance(const PNMImage &mask, float threshold, float radius) {
+  nassertv(radius > 0.0f);
+  PfmFile pfm;
+  pfm.fill_signed_distance(mask, threshold);
+
+  xelval maxval = get_maxval();
+  if (maxval == 0) {
+    maxval = 255;
+  }
+  clear(pfm.get_x_size(), pfm.get_y_size(), 1, maxval, nullptr, CS_linear);
+
+  float scale = 0.5f / radius;
+  for (int yi = 0; yi < _y_size; ++yi) {
+    for (int xi = 0; xi < _x_size; ++xi) {
+      set_gray(xi, yi, std::max(0.0f, std::min(1.0f, pfm.get_point1(xi, yi) * scale + 0.5f)));
+    }
+  }
+}
+
 /**
  * index_image is a WxH grayscale image, while pixel_values is an Nx1 color
  * (or grayscale) image.  Typically pixel_values will be a 256x1 image.
@@ -2160,24 +2200,45 @@ setup_encoding() {
 }
 
 /**
- * Recursively fills in the minimum distance measured from a certain set of
- * points into the gray channel.
+ * Given a grayscale image whose gray channel has been initialized with a
+ * starting distance at each pixel (0 for a seed pixel, maxval elsewhere),
+ * fills in the minimum Manhattan distance measured from those starting
+ * values.  This is done in two sweeps over the image, the first propagating
+ * the distances downwards and the second upwards.
  */
 void PNMImage::
-do_fill_distance(int xi, int yi, int d) {
-  if (xi < 0 || xi >= get_x_size() ||
-      yi < 0 || yi >= get_y_size()) {
-    return;
-  }
-  if (get_gray_val(xi, yi) <= d) {
-    return;
-  }
-  set_gray_val(xi, yi, d);
+do_fill_distance() {
+  for (int pass = 0; pass < 2; ++pass) {
+    int y_begin = (pass == 0) ? 0 : _y_size - 1;
+    int y_end = (pass == 0) ? _y_size : -1;
+    int y_step = (pass == 0) ? 1 : -1;
+
+    for (int yi = y_begin; yi != y_end; yi += y_step) {
+      int prev_y = yi - y_step;
+      if (prev_y >= 0 && prev_y < _y_size) {
+        for (int xi = 0; xi < _x_size; ++xi) {
+          int d = get_gray_val(xi, prev_y) + 1;
+          if (d < get_gray_val(xi, yi)) {
+            set_gray_val(xi, yi, d);
+          }
+        }
+      }
 
-  do_fill_distance(xi + 1, yi, d + 1);
-  do_fill_distance(xi - 1, yi, d + 1);
-  do_fill_distance(xi, yi + 1, d + 1);
-  do_fill_distance(xi, yi - 1, d + 1);
+      // Now spread the distances along the row, in both directions.
+      for (int xi = 1; xi < _x_size; ++xi) {
+        int d = get_gray_val(xi - 1, yi) + 1;
+        if (d < get_gray_val(xi, yi)) {
+          set_gray_val(xi, yi, d);
+        }
+      }
+      for (int xi = _x_size - 2; xi >= 0; --xi) {
+        int d = get_gray_val(xi + 1, yi) + 1;
+        if (d < get_gray_val(xi, yi)) {
+          set_gray_val(xi, yi, d);
+        }
+      }
+    }
+  }
 }
 
 /**
@@ -225,6 +225,7 @@ PUBLISHED:
                  const PNMImage &lt, const PNMImage &ge);
   BLOCKING void fill_distance_inside(const PNMImage &mask, float threshold, int radius, bool shrink_from_border);
   BLOCKING void fill_distance_outside(const PNMImage &mask, float threshold, int radius);
+  BLOCKING void fill_signed_distance(const PNMImage &mask, float threshold, float radius);
 
   void indirect_1d_lookup(const PNMImage &index_image, int channel,
                           const PNMImage &pixel_values);
@@ -270,7 +271,7 @@ PUBLISHED:
   LColorf get_average_xel_a() const;
   float get_average_gray() const;
 
-  void do_fill_distance(int xi, int yi, int d);
+  void do_fill_distance();
 
 PUBLISHED:
   // Provides an accessor for reading or writing the contents of one row of
@@ -236,6 +236,37 @@ supports_stream_read() const {
   return false;
 }
 
+/**
+ * Returns true if this particular PNMReader is capable of decoding the image
+ * directly into a buffer in the layout of a Texture's RAM image, via
+ * read_ram_image().  This should only return true if the file has 8 bits per
+ * channel, in which case no scaling of the component values is necessary.
+ *
+ * This may be called before prepare_read().
+ */
+bool PNMReader::
+supports_read_ram_image() const {
+  return false;
+}
+
+/**
+ * If supports_read_ram_image(), above, returns true, this function may be
+ * called instead of read_data() to decode the entire image directly into the
+ * indicated buffer, which must have room for _x_size * _y_size *
+ * _num_channels bytes.  The image is stored with one byte per component, in
+ * the order blue, green, red, alpha (or gray, alpha for a grayscale image),
+ * with the bottom row first; this is the layout used by Texture.  This avoids
+ * the need for an intermediate PNMImage.
+ *
+ * As with read_data(), prepare_read() must have been called first, and the
+ * return value is the number of rows correctly read.  If the file is
+ * truncated, the rows that were read are stored at the top of the image.
+ */
+int PNMReader::
+read_ram_image(unsigned char *) {
+  return 0;
+}
+
 /**
  * Determines the reduction factor between the original size and the requested
  * size, returned as an exponent of power of 2 (that is, a bit shift).
@@ -43,6 +43,9 @@ public:
 
   virtual bool supports_stream_read() const;
 
+  virtual bool supports_read_ram_image() const;
+  virtual int read_ram_image(unsigned char *data);
+
   INLINE bool is_valid() const;
 
 private:
@@ -419,4 +419,55 @@ read_data(xel *array, xelval *) {
   return _y_size;
 }
 
+/**
+ * Returns true if this particular PNMReader is capable of decoding the image
+ * directly into a buffer in the layout of a Texture's RAM image, via
+ * read_ram_image().
+ */
+bool PNMFileTypeJPG::Reader::
+supports_read_ram_image() const {
+  return _is_valid && (_num_channels == 1 || _num_channels == 3);
+}
+
+/**
+ * Decodes the entire image directly into the indicated buffer, in the layout
+ * of a Texture's RAM image.  See PNMReader::read_ram_image().
+ */
+int PNMFileTypeJPG::Reader::
+read_ram_image(unsigned char *data) {
+  if (!_is_valid) {
+    return 0;
+  }
+  nassertr(_cinfo.output_components == 1 || _cinfo.output_components == 3, 0);
+  nassertr(_cinfo.output_components == _num_channels, 0);
+
+  size_t row_stride = (size_t)_cinfo.output_width * _cinfo.output_components;
+
+  // Decode each scanline straight into its final place in the buffer, which
+  // stores the bottom row first.
+  while (_cinfo.output_scanline < _cinfo.output_height) {
+    JSAMPROW row = data + (_cinfo.output_height - 1 - _cinfo.output_scanline) * row_stride;
+    jpeg_read_scanlines(&_cinfo, &row, 1);
+
+    if (_cinfo.output_components == 3) {
+      // Swap the red and blue components in-place.
+      for (size_t i = 0; i < row_stride; i += 3) {
+        JSAMPLE red = row[i];
+        row[i] = row[i + 2];
+        row[i + 2] = red;
+      }
+    }
+    Thread::consider_yield();
+  }
+
+  jpeg_finish_decompress(&_cinfo);
+
+  if (_jerr.pub.num_warnings) {
+    pnmimage_jpg_cat.warning()
+      << "Jpeg data may be corrupt" << std::endl;
+  }
+
+  return _y_size;
+}
+
 #endif  // HAVE_JPEG
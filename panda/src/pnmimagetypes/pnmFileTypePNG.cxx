@@ -412,6 +412,61 @@ read_data(xel *array, xelval *alpha_data) {
   return _y_size;
 }
 
+/**
+ * Returns true if this particular PNMReader is capable of decoding the image
+ * directly into a buffer in the layout of a Texture's RAM image, via
+ * read_ram_image().
+ */
+bool PNMFileTypePNG::Reader::
+supports_read_ram_image() const {
+  // We can only do this for 8-bit images; 16-bit images, and grayscale
+  // images with fewer than 8 bits, need their values scaled.
+  return _is_valid && _maxval == 255;
+}
+
+/**
+ * Decodes the entire image directly into the indicated buffer, in the layout
+ * of a Texture's RAM image.  See PNMReader::read_ram_image().
+ */
+int PNMFileTypePNG::Reader::
+read_ram_image(unsigned char *data) {
+  if (!is_valid()) {
+    return 0;
+  }
+  nassertr(_maxval == 255, 0);
+
+  if (setjmp(_jmpbuf)) {
+    // This is the ANSI C way to handle exceptions.  If setjmp(), above,
+    // returns true, it means that libpng detected an exception while
+    // executing the code that reads the image, below.
+    free_png();
+    return 0;
+  }
+
+  if (!is_grayscale()) {
+    // Texture stores its color components in BGR order.
+    png_set_bgr(_png);
+  }
+
+  // libpng can decode straight into our buffer, if we give it the row
+  // pointers in reverse order, since Texture stores the bottom row first.
+  size_t row_byte_length = (size_t)_x_size * _num_channels;
+  nassertr(png_get_rowbytes(_png, _info) == row_byte_length, 0);
+
+  int num_rows = _y_size;
+  png_bytep *rows = (png_bytep *)PANDA_MALLOC_ARRAY(num_rows * sizeof(png_bytep));
+  for (int yi = 0; yi < num_rows; yi++) {
+    rows[yi] = data + (num_rows - 1 - yi) * row_byte_length;
+  }
+
+  png_read_image(_png, rows);
+  PANDA_FREE_ARRAY(rows);
+
+  png_read_end(_png, nullptr);
+
+  return _y_size;
+}
+
 /**
  * Releases the internal PNG structures and marks the reader invalid.
  */
@@ -53,6 +53,9 @@ public:
 
     virtual int read_data(xel *array, xelval *alpha_data);
 
+    virtual bool supports_read_ram_image() const;
+    virtual int read_ram_image(unsigned char *data);
+
   private:
     void free_png();
     static void png_read_data(png_structp png_ptr, png_bytep data,
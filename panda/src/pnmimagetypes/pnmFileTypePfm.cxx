@@ -114,7 +114,9 @@ make_writer(ostream *file, bool owns_file) {
  */
 PNMFileTypePfm::Reader::
 Reader(PNMFileType *type, istream *file, bool owns_file, string magic_number) :
-  PNMReader(type, file, owns_file)
+  PNMReader(type, file, owns_file),
+  _tile_x_size(0),
+  _tile_y_size(0)
 {
   read_magic_number(_file, magic_number, 2);
 
@@ -139,6 +141,17 @@ Reader(PNMFileType *type, istream *file, bool owns_file, string magic_number) :
     // Special DRZ extension.
     _num_channels = 4;
 
+  } else if (magic_number == "pftl") {
+    // The tiled variant written by PfmTiledFile.  The number of channels and
+    // the tile size are given in the header.
+    (*_file) >> _num_channels;
+    if (!(*_file) || _num_channels < 1 || _num_channels > 4) {
+      pnmimage_cat.debug()
+        << "Error parsing PFM header\n";
+      _is_valid = false;
+      return;
+    }
+
   } else {
     pnmimage_cat.debug()
       << "Not a PFM file\n";
@@ -148,8 +161,12 @@ Reader(PNMFileType *type, istream *file, bool owns_file, string magic_number) :
 
   _maxval = PGM_MAXMAXVAL;
 
-  (*_file) >> _x_size >> _y_size >> _scale;
-  if (!(*_file)) {
+  (*_file) >> _x_size >> _y_size;
+  if (magic_number == "pftl") {
+    (*_file) >> _tile_x_size >> _tile_y_size;
+  }
+  (*_file) >> _scale;
+  if (!(*_file) || (magic_number == "pftl" && (_tile_x_size <= 0 || _tile_y_size <= 0))) {
     pnmimage_cat.debug()
       << "Error parsing PFM header\n";
     _is_valid = false;
@@ -188,7 +205,7 @@ read_pfm(PfmFile &pfm) {
   if (pfm_force_littleendian) {
     little_endian = true;
   }
-  if (pfm_reverse_dimensions) {
+  if (pfm_reverse_dimensions && _tile_x_size == 0) {
     int t = _x_size;
     _x_size = _y_size;
     _y_size = t;
@@ -203,7 +220,32 @@ read_pfm(PfmFile &pfm) {
   pvector<PN_float32> table;
   pfm.swap_table(table);
 
-  (*_file).read((char *)&table[0], sizeof(PN_float32) * size);
+  if (_tile_x_size == 0) {
+    (*_file).read((char *)&table[0], sizeof(PN_float32) * size);
+
+  } else {
+    // The data is stored one tile at a time, each padded to the full tile
+    // size; we have to reassemble the rows.
+    int num_x_tiles = (_x_size + _tile_x_size - 1) / _tile_x_size;
+    int num_y_tiles = (_y_size + _tile_y_size - 1) / _tile_y_size;
+    int tile_row_size = _tile_x_size * _num_channels;
+    pvector<PN_float32> tile_row(tile_row_size);
+
+    for (int ty = 0; ty < num_y_tiles && !(*_file).fail(); ++ty) {
+      for (int tx = 0; tx < num_x_tiles && !(*_file).fail(); ++tx) {
+        int x_begin = tx * _tile_x_size;
+        int width = std::min(_tile_x_size, _x_size - x_begin);
+        for (int yi = 0; yi < _tile_y_size && !(*_file).fail(); ++yi) {
+          (*_file).read((char *)&tile_row[0], sizeof(PN_float32) * tile_row_size);
+          int y = ty * _tile_y_size + yi;
+          if (y < _y_size) {
+            memcpy(&table[(y * _x_size + x_begin) * _num_channels], &tile_row[0],
+                   sizeof(PN_float32) * width * _num_channels);
+          }
+        }
+      }
+    }
+  }
   if ((*_file).fail() && !(*_file).eof()) {
     pfm.clear();
     return false;
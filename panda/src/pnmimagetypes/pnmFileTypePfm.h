@@ -52,6 +52,8 @@ public:
 
   private:
     PN_float32 _scale;
+    int _tile_x_size;
+    int _tile_y_size;
   };
 
   class Writer : public PNMWriter {
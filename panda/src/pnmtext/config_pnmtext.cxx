@@ -35,6 +35,17 @@ ConfigVariableDouble text_scale_factor
 ("text-scale-factor", 2.0);
 ConfigVariableBool text_native_antialias
 ("text-native-antialias", true);
+ConfigVariableInt text_distance_field_supersample
+("text-distance-field-supersample", 4,
+ PRC_DESC("When generating signed distance field glyphs, the glyph outline is "
+          "rasterized at this many times the texture resolution in each "
+          "direction, and the distance field is computed from the "
+          "rasterized image with a linear-time Euclidean distance "
+          "transform.  The result approximates the distance to the outline; "
+          "higher values give a closer approximation at the cost of memory "
+          "and time.  Set this to 0 to compute the distance to the analytic "
+          "glyph contours for every pixel instead, which is the most "
+          "accurate but much slower for large glyphs."));
 
 /**
  * Initializes the library.  This must be called at least once before any of
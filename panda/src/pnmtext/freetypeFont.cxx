@@ -21,6 +21,7 @@
 #include "virtualFileSystem.h"
 #include "nurbsCurveEvaluator.h"
 #include "nurbsCurveResult.h"
+#include "pfmFile.h"
 
 #undef interface  // I don't know where this symbol is defined, but it interferes with FreeType.
 #include FT_OUTLINE_H
@@ -390,6 +391,94 @@ reset_scale() {
   return true;
 }
 
+/**
+ * Renders a signed distance field to the PNMImage based on the indicated
+ * glyph outline.  The outline is rasterized at a higher resolution, and the
+ * distance field is derived from that with a linear-time distance transform.
+ * If text-distance-field-supersample is 0, this instead decomposes the outline
+ * and measures the distance to the contours directly.
+ */
+void FreetypeFont::
+render_distance_field(PNMImage &image, FT_Outline &outline,
+                      int radius, int min_x, int min_y) {
+  int supersample = text_distance_field_supersample;
+  if (supersample <= 0) {
+    decompose_outline(outline);
+    render_distance_field(image, radius, min_x, min_y);
+    return;
+  }
+
+  int x_size = image.get_x_size();
+  int y_size = image.get_y_size();
+  int ss_x_size = x_size * supersample;
+  int ss_y_size = y_size * supersample;
+
+  FT_Outline ss_outline;
+  int error = FT_Outline_New(_face->_ft_library, outline.n_points,
+                             outline.n_contours, &ss_outline);
+  if (error) {
+    pnmtext_cat.error()
+      << "Unable to allocate outline for distance field.\n";
+    return;
+  }
+  FT_Outline_Copy(&outline, &ss_outline);
+
+  // Transform the outline from font pixels into the supersampled raster, such
+  // that the average of each supersample block is centered on the point at
+  // which the corresponding pixel would have been sampled.
+  PN_stdfloat pixel_scale = _tex_pixels_per_unit / (64.0f * _font_pixels_per_unit);
+  PN_stdfloat offset_x = radius - min_x * pixel_scale;
+  PN_stdfloat offset_y = (y_size - 1 - radius) + min_y * pixel_scale;
+
+  FT_Matrix matrix;
+  matrix.xx = (FT_Fixed)(supersample * pixel_scale * 64.0f * 65536.0f);
+  matrix.xy = 0;
+  matrix.yx = 0;
+  matrix.yy = matrix.xx;
+  FT_Outline_Transform(&ss_outline, &matrix);
+  FT_Outline_Translate(&ss_outline,
+    (FT_Pos)floor(64.0f * supersample * (offset_x + 0.5f) + 0.5f),
+    (FT_Pos)floor(64.0f * (ss_y_size - supersample * (offset_y + 0.5f)) + 0.5f));
+
+  pvector<unsigned char> buffer((size_t)ss_x_size * (size_t)ss_y_size, 0);
+  FT_Bitmap bitmap;
+  memset(&bitmap, 0, sizeof(bitmap));
+  bitmap.rows = ss_y_size;
+  bitmap.width = ss_x_size;
+  bitmap.pitch = ss_x_size;
+  bitmap.buffer = buffer.data();
+  bitmap.num_grays = 256;
+  bitmap.pixel_mode = ft_pixel_mode_grays;
+
+  error = FT_Outline_Get_Bitmap(_face->_ft_library, &ss_outline, &bitmap);
+  FT_Outline_Done(_face->_ft_library, &ss_outline);
+  if (error) {
+    pnmtext_cat.error()
+      << "Unable to rasterize outline for distance field.\n";
+    return;
+  }
+
+  PNMImage mask(ss_x_size, ss_y_size, 1);
+  copy_bitmap_to_pnmimage(bitmap, mask);
+
+  PfmFile dist;
+  dist.fill_signed_distance(mask, 0.5f);
+
+  // Now average each block of supersamples down to a single pixel.
+  PN_stdfloat scale = 1.0f / (supersample * supersample * supersample * radius * 2);
+  for (int y = 0; y < y_size; ++y) {
+    for (int x = 0; x < x_size; ++x) {
+      PN_stdfloat total = 0.0f;
+      for (int sy = y * supersample; sy < (y + 1) * supersample; ++sy) {
+        for (int sx = x * supersample; sx < (x + 1) * supersample; ++sx) {
+          total += dist.get_point1(sx, sy);
+        }
+      }
+      image.set_gray(x, y, total * scale + (PN_stdfloat)0.5);
+    }
+  }
+}
+
 /**
  * Renders a signed distance field to the PNMImage based on the contours.
  */
@@ -93,6 +93,8 @@ protected:
 
   bool load_glyph(FT_Face face, int glyph_index, bool prerender = true);
   void copy_bitmap_to_pnmimage(const FT_Bitmap &bitmap, PNMImage &image);
+  void render_distance_field(PNMImage &image, FT_Outline &outline,
+                             int radius, int min_x, int min_y);
   void render_distance_field(PNMImage &image, int radius, int min_x, int min_y);
 
   void decompose_outline(FT_Outline &outline);
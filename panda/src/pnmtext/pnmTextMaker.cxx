@@ -192,9 +192,6 @@ make_glyph(int glyph_index) {
     PNMImage &glyph_image = glyph->_image;
 
     if (_distance_field_radius != 0) {
-      // Ask FreeType to extract the contours out of the outline description.
-      decompose_outline(slot->outline);
-
       PN_stdfloat tex_x_size, tex_y_size, tex_x_orig, tex_y_orig;
       FT_BBox bounds;
 
@@ -226,7 +223,8 @@ make_glyph(int glyph_index) {
         int_y_size += outline * 2;
 
         glyph_image.clear(int_x_size, int_y_size, 1);
-        render_distance_field(glyph_image, outline, bounds.xMin, bounds.yMin);
+        render_distance_field(glyph_image, slot->outline, outline,
+                              bounds.xMin, bounds.yMin);
 
         glyph->_top = tex_y_orig + outline * _scale_factor;
         glyph->_left = tex_x_orig + outline * _scale_factor;
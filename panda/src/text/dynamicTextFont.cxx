@@ -618,7 +618,8 @@ make_glyph(int character, FT_Face face, int glyph_index) {
       tex_y_size += outline * 2;
 
       PNMImage image(int_x_size, int_y_size, PNMImage::CT_grayscale);
-      render_distance_field(image, outline, bounds.xMin, bounds.yMin);
+      render_distance_field(image, slot->outline, outline,
+                            bounds.xMin, bounds.yMin);
 
       glyph = slot_glyph(character, int_x_size, int_y_size, advance);
       if (!_needs_image_processing) {
@@ -0,0 +1,146 @@
+from panda3d.core import Character, CharacterJoint, PartGroup, PartSubset
+from panda3d.core import AnimBundle, AnimGroup, AnimChannelMatrixXfmTable
+from panda3d.core import AnimBlendTree, PTA_stdfloat, Mat4, ClockObject
+
+
+def make_character():
+    char = Character("char")
+    bundle = char.get_bundle(0)
+    skeleton = PartGroup(bundle, "<skeleton>")
+    root = CharacterJoint(char, bundle, skeleton, "root", Mat4.ident_mat())
+    spine = CharacterJoint(char, bundle, root, "spine", Mat4.ident_mat())
+    return char, bundle, [root, spine]
+
+
+def make_anim(root_x, spine_x):
+    # Each joint is simply moved along the x axis, so that blends between
+    # the animations are easy to predict.
+    anim = AnimBundle("char", 24, 2)
+    skeleton = AnimGroup(anim, "<skeleton>")
+    root = AnimChannelMatrixXfmTable(skeleton, "root")
+    root.set_table(b'x', PTA_stdfloat([root_x]))
+    spine = AnimChannelMatrixXfmTable(root, "spine")
+    spine.set_table(b'x', PTA_stdfloat([spine_x]))
+    return anim
+
+
+def get_x(joint):
+    return joint.get_transform().get_row3(3)[0]
+
+
+def update(bundle):
+    ClockObject.get_global_clock().tick()
+    bundle.update()
+
+
+def test_blend_tree_1d():
+    char, bundle, joints = make_character()
+    walk = bundle.bind_anim(make_anim(1.0, 1.0))
+    run = bundle.bind_anim(make_anim(3.0, 5.0))
+
+    tree = AnimBlendTree()
+    walk_clip = tree.add_clip(walk)
+    run_clip = tree.add_clip(run)
+    blend = tree.add_blend_1d("speed")
+    tree.add_blend_child(blend, run_clip, 1.0)
+    tree.add_blend_child(blend, walk_clip, 0.0)
+    tree.root = blend
+    assert tree.get_num_controls() == 2
+    bundle.blend_tree = tree
+
+    for speed, root_x, spine_x in ((0.0, 1.0, 1.0), (0.25, 1.5, 2.0),
+                                   (1.0, 3.0, 5.0), (2.0, 3.0, 5.0)):
+        tree.set_parameter("speed", speed)
+        update(bundle)
+        assert abs(get_x(joints[0]) - root_x) < 0.001
+        assert abs(get_x(joints[1]) - spine_x) < 0.001
+
+    tree.set_parameter("speed", 0.75)
+    assert abs(tree.get_node_child_weight(blend, 0) - 0.25) < 0.001
+    assert abs(tree.get_node_child_weight(blend, 1) - 0.75) < 0.001
+
+    # Going back to the control effects.
+    bundle.clear_blend_tree()
+    assert bundle.get_control_effect(walk) == 0.0
+    bundle.set_control_effect(walk, 1.0)
+    update(bundle)
+    assert abs(get_x(joints[0]) - 1.0) < 0.001
+
+
+def test_blend_tree_2d():
+    char, bundle, joints = make_character()
+    tree = AnimBlendTree()
+    points = ((0, 0), (1, 0), (0, 1), (1, 1))
+    clips = []
+    for i in range(len(points)):
+        control = bundle.bind_anim(make_anim(i, i))
+        clips.append(tree.add_clip(control))
+
+    # The blend node must come after its children.
+    blend = tree.add_blend_2d("x", "y")
+    for clip, (x, y) in zip(clips, points):
+        tree.add_blend_child(blend, clip, x, y)
+    tree.root = blend
+    bundle.blend_tree = tree
+
+    tree.set_parameter("x", 1.0)
+    tree.set_parameter("y", 0.0)
+    update(bundle)
+    assert abs(get_x(joints[0]) - 1.0) < 0.001
+
+    # In the middle, all four count equally.
+    tree.set_parameter("x", 0.5)
+    tree.set_parameter("y", 0.5)
+    update(bundle)
+    assert abs(get_x(joints[0]) - 1.5) < 0.001
+
+
+def test_blend_tree_layer():
+    char, bundle, joints = make_character()
+    walk = bundle.bind_anim(make_anim(1.0, 1.0))
+    wave = bundle.bind_anim(make_anim(7.0, 9.0))
+
+    mask = PartSubset()
+    mask.add_include_joint("spine")
+
+    tree = AnimBlendTree()
+    layer = tree.add_layer(tree.add_clip(walk), tree.add_clip(wave), mask,
+                           "wave")
+    tree.root = layer
+    bundle.blend_tree = tree
+
+    tree.set_parameter("wave", 1.0)
+    update(bundle)
+    assert abs(get_x(joints[0]) - 1.0) < 0.001
+    assert abs(get_x(joints[1]) - 9.0) < 0.001
+
+    tree.set_parameter("wave", 0.5)
+    update(bundle)
+    assert abs(get_x(joints[0]) - 1.0) < 0.001
+    assert abs(get_x(joints[1]) - 5.0) < 0.001
+
+
+def test_blend_tree_additive():
+    char, bundle, joints = make_character()
+    walk = bundle.bind_anim(make_anim(1.0, 1.0))
+    lean = bundle.bind_anim(make_anim(2.0, 0.0))
+
+    tree = AnimBlendTree()
+    additive = tree.add_additive(tree.add_clip(walk), tree.add_clip(lean),
+                                 "lean")
+    tree.root = additive
+    bundle.blend_tree = tree
+
+    # The difference from the default pose is added on top.
+    tree.set_parameter("lean", 1.0)
+    update(bundle)
+    assert abs(get_x(joints[0]) - 3.0) < 0.001
+    assert abs(get_x(joints[1]) - 1.0) < 0.001
+
+    tree.set_parameter("lean", 0.5)
+    update(bundle)
+    assert abs(get_x(joints[0]) - 2.0) < 0.001
+
+    tree.set_parameter("lean", 0.0)
+    update(bundle)
+    assert abs(get_x(joints[0]) - 1.0) < 0.001
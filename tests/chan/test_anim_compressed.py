@@ -0,0 +1,168 @@
+from panda3d.core import Character, CharacterJoint, PartGroup
+from panda3d.core import AnimBundle, AnimGroup, AnimChannelMatrixXfmTable
+from panda3d.core import AnimChannelMatrixCompressed
+from panda3d.core import PTA_stdfloat, Mat4, ClockObject
+import math
+
+
+NUM_FRAMES = 120
+
+
+def make_anim(names):
+    # A smooth animation, of the kind that is typically exported from a
+    # modeling package: every component is written out on every frame.
+    anim = AnimBundle("char", 30, NUM_FRAMES)
+    skeleton = AnimGroup(anim, "<skeleton>")
+    parent = skeleton
+    for i, name in enumerate(names):
+        table = AnimChannelMatrixXfmTable(parent, name)
+        frames = range(NUM_FRAMES)
+        table.set_table(b'h', PTA_stdfloat([
+            math.sin(f * 0.02 + i) * 60 for f in frames]))
+        table.set_table(b'p', PTA_stdfloat([
+            math.cos(f * 0.01 + i) * 30 for f in frames]))
+        table.set_table(b'r', PTA_stdfloat([0.0] * NUM_FRAMES))
+        table.set_table(b'x', PTA_stdfloat([1.0 + f * 0.01 for f in frames]))
+        table.set_table(b'y', PTA_stdfloat([0.0] * NUM_FRAMES))
+        table.set_table(b'z', PTA_stdfloat([
+            math.sin(f * 0.02) * 0.5 for f in frames]))
+        table.set_table(b'i', PTA_stdfloat([1.0] * NUM_FRAMES))
+        table.set_table(b'j', PTA_stdfloat([1.0] * NUM_FRAMES))
+        table.set_table(b'k', PTA_stdfloat([1.0] * NUM_FRAMES))
+        parent = table
+    return anim
+
+
+def make_character(names):
+    char = Character("char")
+    bundle = char.get_bundle(0)
+    skeleton = PartGroup(bundle, "<skeleton>")
+    parent = skeleton
+    joints = []
+    for name in names:
+        joint = CharacterJoint(char, bundle, parent, name, Mat4.ident_mat())
+        joints.append(joint)
+        parent = joint
+    return char, bundle, joints
+
+
+def get_channels(group, channels=None):
+    if channels is None:
+        channels = []
+    for child in group.children:
+        if isinstance(child, (AnimChannelMatrixXfmTable,
+                              AnimChannelMatrixCompressed)):
+            channels.append(child)
+        get_channels(child, channels)
+    return channels
+
+
+def sample(bundle, joints, control, frame):
+    control.pose(frame)
+    ClockObject.get_global_clock().tick()
+    bundle.update()
+    result = []
+    for joint in joints:
+        mat = Mat4()
+        joint.get_net_transform(mat)
+        result.append(mat)
+    return result
+
+
+def compare(anim1, anim2, names, threshold):
+    char1, bundle1, joints1 = make_character(names)
+    char2, bundle2, joints2 = make_character(names)
+    control1 = bundle1.bind_anim(anim1)
+    control2 = bundle2.bind_anim(anim2)
+    assert control1 is not None and control2 is not None
+
+    for frame in range(NUM_FRAMES):
+        for mat1, mat2 in zip(sample(bundle1, joints1, control1, frame),
+                              sample(bundle2, joints2, control2, frame)):
+            assert mat1.almost_equal(mat2, threshold)
+
+
+def test_anim_compressed_channels():
+    names = ["a", "b", "c"]
+    anim = make_anim(names)
+    compressed = make_anim(names)
+    assert compressed.compress_channels(0.05, 0.0005, 0.0005) == len(names)
+
+    # The hierarchy is unchanged, but every channel has been replaced.
+    channels = get_channels(compressed)
+    assert [chan.name for chan in channels] == names
+    for chan in channels:
+        assert isinstance(chan, AnimChannelMatrixCompressed)
+        assert chan.get_num_frames() == NUM_FRAMES
+        assert 0 < chan.get_num_keys() < NUM_FRAMES // 2
+
+    # Nothing is left to compress the second time around.
+    assert compressed.compress_channels() == 0
+
+    compare(anim, compressed, names, 0.01)
+
+
+def test_anim_compressed_tolerance():
+    names = ["a"]
+    anim = make_anim(names)
+    source = get_channels(anim)[0]
+
+    parent = AnimBundle("parent", 30, NUM_FRAMES)
+    coarse = AnimChannelMatrixCompressed(parent, "coarse")
+    coarse.compress(source, 1.0, 0.01, 0.01)
+    fine = AnimChannelMatrixCompressed(parent, "fine")
+    fine.compress(source, 0.01, 0.0001, 0.0001)
+    assert coarse.get_num_keys() < fine.get_num_keys()
+
+    # A constant channel needs only a single key.
+    const = AnimChannelMatrixXfmTable(parent, "const")
+    const.set_table(b'x', PTA_stdfloat([2.0]))
+    const.set_table(b'h', PTA_stdfloat([45.0]))
+    chan = AnimChannelMatrixCompressed(parent, "chan")
+    chan.compress(const, 0.05, 0.0005, 0.0005)
+    assert chan.get_num_keys() <= 2
+
+
+def test_anim_compressed_bam():
+    names = ["a", "b", "c", "d"]
+    anim = make_anim(names)
+    compressed = make_anim(names)
+    compressed.compress_channels()
+
+    data = anim.encode_to_bam_stream()
+    compressed_data = compressed.encode_to_bam_stream()
+    assert len(compressed_data) * 5 < len(data)
+
+    decoded = AnimBundle.decode_from_bam_stream(compressed_data)
+    channels = get_channels(decoded)
+    assert len(channels) == len(names)
+    for chan1, chan2 in zip(get_channels(compressed), channels):
+        assert chan1.get_num_keys() == chan2.get_num_keys()
+
+    compare(anim, decoded, names, 0.01)
+
+
+def test_anim_compressed_large_range():
+    # Root motion that covers a long distance, too far to be quantized to
+    # 16 bits within the tolerance.
+    parent = AnimBundle("parent", 30, NUM_FRAMES)
+    table = AnimChannelMatrixXfmTable(parent, "root")
+    xs = [f * 50.0 + math.sin(f) * 0.3 for f in range(NUM_FRAMES)]
+    table.set_table(b'x', PTA_stdfloat(xs))
+    table.set_table(b'y', PTA_stdfloat([math.cos(f) * 0.1 for f in range(NUM_FRAMES)]))
+
+    tolerance = 0.01
+    chan = AnimChannelMatrixCompressed(parent, "chan")
+    chan.compress(table, 0.05, tolerance, 0.0005)
+
+    decoded = AnimBundle.decode_from_bam_stream(parent.encode_to_bam_stream())
+    for compressed in (chan, decoded.find_child("chan")):
+        for frame in range(NUM_FRAMES):
+            mat1 = Mat4()
+            mat2 = Mat4()
+            table.get_value(frame, mat1)
+            compressed.get_value(frame, mat2)
+            pos1 = mat1.get_row3(3)
+            pos2 = mat2.get_row3(3)
+            assert abs(pos1[0] - pos2[0]) <= tolerance
+            assert abs(pos1[1] - pos2[1]) <= tolerance
@@ -0,0 +1,197 @@
+from panda3d.core import Character, CharacterJoint, PartGroup
+from panda3d.core import AnimBundle, AnimGroup, AnimChannelMatrixXfmTable
+from panda3d.core import JointPaletteCache, TransformState
+from panda3d.core import PTA_stdfloat, Mat4, ClockObject, NodePath
+from panda3d.core import JointVertexTransform, TransformTable, Geom, GeomNode
+from panda3d.core import GeomVertexFormat, GeomVertexData
+from panda3d.core import GeomVertexAnimationSpec, LMatrix4f
+import math
+import struct
+
+
+NUM_FRAMES = 10
+NAMES = ["a", "b", "c"]
+
+
+def make_anim():
+    anim = AnimBundle("char", 24, NUM_FRAMES)
+    parent = AnimGroup(anim, "<skeleton>")
+    for i, name in enumerate(NAMES):
+        table = AnimChannelMatrixXfmTable(parent, name)
+        table.set_table(b'x', PTA_stdfloat([1.0]))
+        table.set_table(b'h', PTA_stdfloat([
+            math.sin(f + i) * 45 for f in range(NUM_FRAMES)]))
+        parent = table
+    return anim
+
+
+def make_character(anim, instancing=True):
+    char = Character("char")
+    bundle = char.get_bundle(0)
+    bundle.anim_instancing = instancing
+    parent = PartGroup(bundle, "<skeleton>")
+    joints = []
+    for name in NAMES:
+        joint = CharacterJoint(char, bundle, parent, name, Mat4.ident_mat())
+        joints.append(joint)
+        parent = joint
+    control = bundle.bind_anim(anim)
+    assert control is not None
+    return bundle, control, joints
+
+
+def get_net_transforms(joints):
+    result = []
+    for joint in joints:
+        mat = Mat4()
+        joint.get_net_transform(mat)
+        result.append(mat)
+    return result
+
+
+def update_all(chars):
+    ClockObject.get_global_clock().tick()
+    for bundle, control, joints in chars:
+        bundle.update()
+
+
+def test_anim_instancing_shared():
+    cache = JointPaletteCache.get_global_ptr()
+    anim = make_anim()
+    chars = [make_character(anim) for i in range(5)]
+    ref = make_character(anim, False)
+
+    for frame in (2, 6):
+        for bundle, control, joints in chars + [ref]:
+            control.pose(frame)
+        cache.clear()
+        update_all(chars + [ref])
+
+        # Only the first bundle had to sample the channels.
+        assert cache.num_misses == 1
+        assert cache.num_hits == len(chars) - 1
+        assert cache.num_palettes == 1
+
+        expected = get_net_transforms(ref[2])
+        for bundle, control, joints in chars:
+            for mat, ref_mat in zip(get_net_transforms(joints), expected):
+                assert mat.almost_equal(ref_mat)
+
+
+def test_anim_instancing_different_frames():
+    cache = JointPaletteCache.get_global_ptr()
+    anim = make_anim()
+    chars = [make_character(anim) for i in range(4)]
+    ref = make_character(anim, False)
+
+    for i, (bundle, control, joints) in enumerate(chars):
+        control.pose(i % 2)
+    cache.clear()
+    update_all(chars)
+    assert cache.num_misses == 2
+    assert cache.num_hits == 2
+    assert cache.num_palettes == 2
+
+    for i, (bundle, control, joints) in enumerate(chars):
+        ref[1].pose(i % 2)
+        update_all([ref])
+        for mat, ref_mat in zip(get_net_transforms(joints),
+                                get_net_transforms(ref[2])):
+            assert mat.almost_equal(ref_mat)
+
+
+def test_anim_instancing_frozen():
+    cache = JointPaletteCache.get_global_ptr()
+    anim = make_anim()
+    chars = [make_character(anim) for i in range(3)]
+    assert chars[0][0].freeze_joint("b", TransformState.make_pos((0, 5, 0)))
+
+    for bundle, control, joints in chars:
+        control.pose(3)
+    cache.clear()
+    update_all(chars)
+
+    # The bundle with the frozen joint neither uses nor offers a palette.
+    assert cache.num_misses + cache.num_hits == 2
+    assert cache.num_hits == 1
+    assert not get_net_transforms(chars[0][2])[1].almost_equal(
+        get_net_transforms(chars[1][2])[1])
+
+
+def make_skinned_model():
+    # A Character whose vertices are animated on the graphics card, with a
+    # TransformTable holding a transform for each joint.
+    char = Character("char")
+    bundle = char.get_bundle(0)
+    parent = PartGroup(bundle, "<skeleton>")
+    table = TransformTable()
+    for name in NAMES:
+        joint = CharacterJoint(char, bundle, parent, name, Mat4.ident_mat())
+        table.add_transform(JointVertexTransform(joint))
+        parent = joint
+
+    aspec = GeomVertexAnimationSpec()
+    aspec.set_hardware(4, True)
+    format = GeomVertexFormat(GeomVertexFormat.get_v3())
+    format.set_animation(aspec)
+    vdata = GeomVertexData("char", GeomVertexFormat.register_format(format),
+                           Geom.UH_static)
+    vdata.set_transform_table(TransformTable.register_table(table))
+    gnode = GeomNode("geom")
+    gnode.add_geom(Geom(vdata))
+    char.add_child(gnode)
+    return NodePath(char)
+
+
+def get_table(model):
+    gnode = model.find("**/+GeomNode").node()
+    return gnode.get_geom(0).get_vertex_data().get_transform_table()
+
+
+def test_anim_instancing_shared_palette_buffer():
+    anim = make_anim()
+    model = make_skinned_model()
+    copies = [model.copy_to(NodePath()) for i in range(3)]
+    controls = []
+    for copy in copies:
+        bundle = copy.node().get_bundle(0)
+        bundle.anim_instancing = True
+        control = bundle.bind_anim(anim)
+        assert control is not None
+        controls.append(control)
+
+    for frame in (2, 6):
+        for control in controls:
+            control.pose(frame)
+        ClockObject.get_global_clock().tick()
+        for copy in copies:
+            copy.node().force_update()
+
+        # The copies use the palette of the first one.
+        tables = [get_table(copy) for copy in copies]
+        assert tables[0].get_palette_source() is None
+        assert tables[1].get_palette_source() == tables[0]
+        assert tables[2].get_palette_source() == tables[0]
+        buffer = tables[0].get_palette_buffer()
+        assert tables[1].get_palette_buffer() == buffer
+        assert tables[2].get_palette_buffer() == buffer
+
+        # It holds the matrices of their own transforms.
+        data = bytes(buffer.get_data())
+        for table in tables:
+            for i in range(len(NAMES)):
+                mat = Mat4()
+                table.get_transform(i).get_matrix(mat)
+                packed = LMatrix4f(*struct.unpack_from("16f", data, i * 64))
+                assert packed.almost_equal(LMatrix4f(mat))
+
+    # A copy that is posed differently goes back to its own palette.
+    controls[1].pose(3)
+    ClockObject.get_global_clock().tick()
+    for copy in copies:
+        copy.node().force_update()
+
+    tables = [get_table(copy) for copy in copies]
+    assert tables[1].get_palette_source() is None
+    assert tables[2].get_palette_source() == tables[0]
+    assert tables[1].get_palette_buffer() != tables[0].get_palette_buffer()
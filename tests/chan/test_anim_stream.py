@@ -0,0 +1,168 @@
+from panda3d.core import Character, CharacterJoint, PartGroup, PartSubset
+from panda3d.core import AnimBundle, AnimGroup, AnimChannelMatrixXfmTable
+from panda3d.core import AnimStream, AnimPreloadTable
+from panda3d.core import Loader, Filename, PTA_stdfloat, Mat4, ClockObject
+import math
+
+
+NUM_FRAMES = 10
+NAMES = ["a", "b", "c"]
+
+
+def make_anim():
+    anim = AnimBundle("char", 24, NUM_FRAMES)
+    parent = AnimGroup(anim, "<skeleton>")
+    for i, name in enumerate(NAMES):
+        table = AnimChannelMatrixXfmTable(parent, name)
+        table.set_table(b'x', PTA_stdfloat([f * 0.5 + i for f in range(NUM_FRAMES)]))
+        table.set_table(b'h', PTA_stdfloat([
+            math.sin(f + i) * 45 for f in range(NUM_FRAMES)]))
+        table.set_table(b'i', PTA_stdfloat([2.0]))
+        parent = table
+    return anim
+
+
+def make_character():
+    char = Character("char")
+    bundle = char.get_bundle(0)
+    parent = PartGroup(bundle, "<skeleton>")
+    joints = []
+    for name in NAMES:
+        joint = CharacterJoint(char, bundle, parent, name, Mat4.ident_mat())
+        joints.append(joint)
+        parent = joint
+    return bundle, joints
+
+
+def get_net_transforms(joints):
+    result = []
+    for joint in joints:
+        mat = Mat4()
+        joint.get_net_transform(mat)
+        result.append(mat)
+    return result
+
+
+def write_stream(tmp_path, chunk_frames=4):
+    filename = Filename.from_os_specific(str(tmp_path / "walk.pas"))
+    assert AnimStream.write_bundle(filename, make_anim(), chunk_frames)
+    return filename
+
+
+def test_anim_stream_playback(tmp_path):
+    filename = write_stream(tmp_path)
+
+    stream = AnimStream()
+    assert stream.open(filename)
+    assert stream.name == "char"
+    assert stream.num_frames == NUM_FRAMES
+    assert stream.base_frame_rate == 24
+    assert stream.num_chunks == 3
+
+    # Nothing is read until a frame is needed.
+    assert stream.num_resident_chunks == 0
+    stream.max_resident_chunks = 2
+
+    # Every chunk is read as it is needed; see test_anim_stream_prefetch.
+    stream.prefetch = False
+
+    bundle, joints = make_character()
+    control = bundle.bind_anim(stream.make_bundle())
+    assert control is not None
+    ref_bundle, ref_joints = make_character()
+    ref_control = ref_bundle.bind_anim(make_anim())
+
+    for frame in range(NUM_FRAMES):
+        control.pose(frame)
+        ref_control.pose(frame)
+        ClockObject.get_global_clock().tick()
+        bundle.update()
+        ref_bundle.update()
+
+        for mat, ref_mat in zip(get_net_transforms(joints),
+                                get_net_transforms(ref_joints)):
+            assert mat.almost_equal(ref_mat)
+
+        # Only the chunks around the playhead stay in memory.
+        assert stream.num_resident_chunks <= 2
+
+    assert stream.num_chunk_reads == 3
+
+    # Going back to the start means reading the first chunk again.
+    control.pose(0)
+    ClockObject.get_global_clock().tick()
+    bundle.update()
+    assert stream.num_chunk_reads == 4
+
+    stream.release_chunks()
+    assert stream.num_resident_chunks == 0
+
+
+def test_anim_stream_prefetch(tmp_path):
+    filename = write_stream(tmp_path, 2)
+
+    stream = AnimStream()
+    assert stream.open(filename)
+    assert stream.num_chunks == 5
+    stream.max_resident_chunks = 2
+    stream.prefetch = True
+
+    bundle, joints = make_character()
+    control = bundle.bind_anim(stream.make_bundle())
+    ref_bundle, ref_joints = make_character()
+    ref_control = ref_bundle.bind_anim(make_anim())
+
+    for frame in range(NUM_FRAMES):
+        control.pose(frame)
+        ref_control.pose(frame)
+        ClockObject.get_global_clock().tick()
+        bundle.update()
+        ref_bundle.update()
+
+        for mat, ref_mat in zip(get_net_transforms(joints),
+                                get_net_transforms(ref_joints)):
+            assert mat.almost_equal(ref_mat)
+
+    # Only the first chunk had to be read while the animation waited for it;
+    # each of the others was read in the background while the one before it
+    # was playing.
+    assert stream.num_sync_chunk_reads == 1
+    assert stream.num_chunk_reads >= stream.num_chunks
+    stream.close()
+
+
+def test_anim_stream_load_bind(tmp_path):
+    filename = write_stream(tmp_path)
+
+    # The preload table allows binding without opening the file.
+    bundle, joints = make_character()
+    table = AnimPreloadTable()
+    table.add_anim("walk", 24, NUM_FRAMES)
+    bundle.set_anim_preload(table)
+
+    loader = Loader.get_global_ptr()
+    control = bundle.load_bind_anim(loader, filename, 0, PartSubset(), True)
+    assert control is not None
+    assert control.get_num_frames() == NUM_FRAMES
+    control.wait_pending()
+    assert control.has_anim()
+
+    ref_bundle, ref_joints = make_character()
+    ref_control = ref_bundle.bind_anim(make_anim())
+    control.pose(7)
+    ref_control.pose(7)
+    ClockObject.get_global_clock().tick()
+    bundle.update()
+    ref_bundle.update()
+    for mat, ref_mat in zip(get_net_transforms(joints),
+                            get_net_transforms(ref_joints)):
+        assert mat.almost_equal(ref_mat)
+
+
+def test_anim_stream_invalid(tmp_path):
+    path = tmp_path / "bad.pas"
+    path.write_bytes(b"not an animation")
+
+    stream = AnimStream()
+    assert not stream.open(Filename.from_os_specific(str(path)))
+    assert not stream.is_open()
@@ -0,0 +1,141 @@
+from panda3d.core import Character, CharacterJoint, PartGroup
+from panda3d.core import AnimBundle, AnimGroup, AnimChannelMatrixXfmTable
+from panda3d.core import PandaNode, ClockObject, PTA_stdfloat, Mat4
+from panda3d.core import TransformState
+import math
+
+
+NUM_FRAMES = 10
+
+
+def make_skeleton(char, bundle, parent, anim_parent, prefix, depth, fanout):
+    # Builds a tree of joints, each offset from its parent, with a channel
+    # that swings it back and forth over the course of the animation.
+    for i in range(fanout):
+        name = "%s%d" % (prefix, i)
+        CharacterJoint(char, bundle, parent, name, Mat4.translate_mat(1, 0, 0))
+        table = AnimChannelMatrixXfmTable(anim_parent, name)
+        table.set_table(b'x', PTA_stdfloat([1.0]))
+        table.set_table(b'h', PTA_stdfloat([
+            math.sin(f + depth + i) * 30 for f in range(NUM_FRAMES)]))
+        table.set_table(b'p', PTA_stdfloat([
+            math.cos(f * 2 + i) * 20 for f in range(NUM_FRAMES)]))
+
+        if depth > 1:
+            joint = parent.find_child(name)
+            make_skeleton(char, bundle, joint, table, name + "_",
+                          depth - 1, fanout)
+
+
+def make_character(compiled):
+    char = Character("char")
+    bundle = char.get_bundle(0)
+    bundle.compiled_update = compiled
+
+    anim = AnimBundle("char", 24, NUM_FRAMES)
+    skeleton = PartGroup(bundle, "<skeleton>")
+    anim_skeleton = AnimGroup(anim, "<skeleton>")
+    make_skeleton(char, bundle, skeleton, anim_skeleton, "j", 3, 3)
+
+    bundle.sort_descendants()
+    anim.sort_descendants()
+    control = bundle.bind_anim(anim)
+    assert control is not None
+    return char, bundle, control
+
+
+def get_joints(group, joints=None):
+    if joints is None:
+        joints = []
+    for child in group.children:
+        if isinstance(child, CharacterJoint):
+            joints.append(child)
+        get_joints(child, joints)
+    return joints
+
+
+def get_net_transforms(bundle):
+    result = []
+    for joint in get_joints(bundle):
+        mat = Mat4()
+        joint.get_net_transform(mat)
+        result.append(mat)
+    return result
+
+
+def update(bundle):
+    ClockObject.get_global_clock().tick()
+    return bundle.update()
+
+
+def test_compiled_update_matches():
+    char1, bundle1, control1 = make_character(False)
+    char2, bundle2, control2 = make_character(True)
+    assert bundle2.compiled_update
+
+    for frame in (0, 3, 3, 7, 2):
+        control1.pose(frame)
+        control2.pose(frame)
+        assert update(bundle1) == update(bundle2)
+        for mat1, mat2 in zip(get_net_transforms(bundle1),
+                              get_net_transforms(bundle2)):
+            assert mat1.almost_equal(mat2)
+
+    # Moving the root of the bundle moves all of the joints.
+    bundle1.root_xform = Mat4.scale_mat(2)
+    bundle2.root_xform = Mat4.scale_mat(2)
+    update(bundle1)
+    update(bundle2)
+    for mat1, mat2 in zip(get_net_transforms(bundle1),
+                          get_net_transforms(bundle2)):
+        assert mat1.almost_equal(mat2)
+
+    # A frozen joint holds its transform while the rest keep animating.
+    joint1 = get_joints(bundle1)[0]
+    joint2 = get_joints(bundle2)[0]
+    bundle1.freeze_joint(joint1.name, TransformState.make_pos((0, 0, 5)))
+    bundle2.freeze_joint(joint2.name, TransformState.make_pos((0, 0, 5)))
+    control1.pose(5)
+    control2.pose(5)
+    update(bundle1)
+    update(bundle2)
+    for mat1, mat2 in zip(get_net_transforms(bundle1),
+                          get_net_transforms(bundle2)):
+        assert mat1.almost_equal(mat2)
+
+
+def test_compiled_update_exposed_joint():
+    char, bundle, control = make_character(True)
+    joint = get_joints(bundle)[4]
+    node = PandaNode("exposed")
+    joint.add_net_transform(node)
+
+    for frame in (1, 6):
+        control.pose(frame)
+        update(bundle)
+        mat = Mat4()
+        joint.get_net_transform(mat)
+        assert node.get_transform().get_mat().almost_equal(mat)
+
+    # Nothing changes if the frame doesn't.
+    assert not update(bundle)
+
+
+def test_compiled_update_new_joint():
+    char, bundle, control = make_character(True)
+    control.pose(2)
+    update(bundle)
+
+    # A joint added after the table was compiled is still animated along with
+    # its parent.
+    parent = get_joints(bundle)[0]
+    joint = CharacterJoint(char, bundle, parent, "new",
+                           Mat4.translate_mat(0, 1, 0))
+    control.pose(4)
+    update(bundle)
+
+    parent_mat = Mat4()
+    parent.get_net_transform(parent_mat)
+    mat = Mat4()
+    joint.get_net_transform(mat)
+    assert mat.almost_equal(Mat4.translate_mat(0, 1, 0) * parent_mat)
@@ -0,0 +1,198 @@
+from panda3d.core import Character, CharacterJoint, PartGroup
+from panda3d.core import AnimBundle, AnimGroup, AnimChannelMatrixXfmTable
+from panda3d.core import PTA_stdfloat, Mat4, ClockObject
+
+
+NUM_FRAMES = 10
+
+
+def make_character(num_joints=3):
+    # A chain of joints, each turning a bit further on every frame.
+    char = Character("char")
+    bundle = char.get_bundle(0)
+    anim = AnimBundle("char", 24, NUM_FRAMES)
+
+    parent = PartGroup(bundle, "<skeleton>")
+    anim_parent = AnimGroup(anim, "<skeleton>")
+    joints = []
+    for i in range(num_joints):
+        joint_name = "j%d" % i
+        joint = CharacterJoint(char, bundle, parent, joint_name,
+                               Mat4.ident_mat())
+        table = AnimChannelMatrixXfmTable(anim_parent, joint_name)
+        table.set_table(b'h', PTA_stdfloat([
+            f * 10.0 for f in range(NUM_FRAMES)]))
+        joints.append(joint)
+        parent = joint
+        anim_parent = table
+
+    control = bundle.bind_anim(anim)
+    assert control is not None
+    return char, bundle, control, joints
+
+
+def get_transform(joint):
+    return Mat4(joint.get_transform())
+
+
+def expected(frame):
+    return Mat4.rotate_mat(frame * 10.0, (0, 0, 1))
+
+
+class SlaveClock(object):
+    # Lets the test decide what time it is.
+    def __enter__(self):
+        self.clock = ClockObject.get_global_clock()
+        self.mode = self.clock.mode
+        self.clock.mode = ClockObject.M_slave
+        return self
+
+    def __exit__(self, *args):
+        self.clock.mode = self.mode
+
+    def set_time(self, time):
+        self.clock.frame_time = time
+
+
+def update(bundle):
+    ClockObject.get_global_clock().tick()
+    bundle.update()
+
+
+def test_anim_lod_max_joint_depth():
+    char, bundle, control, joints = make_character()
+    bundle.max_joint_depth = 1
+
+    # The first update always brings everything up to date.
+    control.pose(1)
+    update(bundle)
+    for joint in joints:
+        assert get_transform(joint).almost_equal(expected(1))
+
+    # After that, only the first two levels of the hierarchy keep moving.
+    control.pose(4)
+    update(bundle)
+    assert get_transform(joints[0]).almost_equal(expected(4))
+    assert get_transform(joints[1]).almost_equal(expected(4))
+    assert get_transform(joints[2]).almost_equal(expected(1))
+
+    # A forced update still brings everything up to date.
+    control.pose(5)
+    bundle.force_update()
+    for joint in joints:
+        assert get_transform(joint).almost_equal(expected(5))
+
+    bundle.max_joint_depth = -1
+    control.pose(6)
+    update(bundle)
+    for joint in joints:
+        assert get_transform(joint).almost_equal(expected(6))
+
+
+def test_anim_lod_frame_blend():
+    char, bundle, control, joints = make_character(1)
+    bundle.frame_blend_flag = True
+    assert bundle.allow_frame_blend
+
+    control.set_play_rate(0.5)
+    control.pose(2)
+    with SlaveClock() as clock:
+        clock.set_time(0.0)
+        control.play()
+        clock.set_time(1.5 / 24)
+        bundle.update()
+        # Frame 0.75, blended between frames 0 and 1.
+        assert get_transform(joints[0]).almost_equal(
+            Mat4.rotate_mat(7.5, (0, 0, 1)), 0.001)
+
+        bundle.allow_frame_blend = False
+        assert bundle.frame_blend_flag
+        clock.set_time(2.5 / 24)
+        bundle.update()
+        # Frame 1.25, without blending.
+        assert get_transform(joints[0]).almost_equal(expected(1))
+
+
+def test_anim_lod_interpolate_updates():
+    char, bundle, control, joints = make_character(2)
+    bundle.update_delay = 1.0
+    bundle.interpolate_updates = True
+
+    with SlaveClock() as clock:
+        clock.set_time(10.0)
+        control.pose(0)
+        bundle.update()
+
+        # Nothing happens until the delay has elapsed.
+        control.pose(4)
+        clock.set_time(10.5)
+        bundle.update()
+        for joint in joints:
+            assert get_transform(joint).almost_equal(expected(0))
+
+        # The update samples the new pose, but doesn't show it right away...
+        clock.set_time(11.1)
+        bundle.update()
+        for joint in joints:
+            assert get_transform(joint).almost_equal(expected(0))
+
+        # ...the joints move towards it until the next update instead.
+        clock.set_time(11.6)
+        bundle.update()
+        halfway = Mat4(expected(0))
+        halfway *= 0.5
+        halfway += expected(4) * 0.5
+        for joint in joints:
+            assert get_transform(joint).almost_equal(halfway)
+
+        # With nothing new to show, the next update just settles there.
+        clock.set_time(12.2)
+        bundle.update()
+        for joint in joints:
+            assert get_transform(joint).almost_equal(expected(4))
+
+
+def test_anim_lod_interpolate_other_character():
+    char, bundle, control, joints = make_character(2)
+    bundle.update_delay = 1.0
+    bundle.interpolate_updates = True
+
+    with SlaveClock() as clock:
+        clock.set_time(10.0)
+        control.pose(0)
+        bundle.update()
+
+        control.pose(4)
+        clock.set_time(11.1)
+        bundle.update()
+
+        # Building another character doesn't disturb this one on its way
+        # towards the new pose.
+        other = make_character(2)
+        clock.set_time(11.6)
+        bundle.update()
+        halfway = Mat4(expected(0))
+        halfway *= 0.5
+        halfway += expected(4) * 0.5
+        for joint in joints:
+            assert get_transform(joint).almost_equal(halfway)
+
+
+def test_anim_lod_levels():
+    char, bundle, control, joints = make_character()
+    assert char.get_num_lod_animation_levels() == 0
+    assert char.get_lod_animation_level() == 0
+
+    char.add_lod_animation_level(0.1, 0.5)
+    char.add_lod_animation_level(0.3, 0.1, 2, True, False)
+    assert char.get_num_lod_animation_levels() == 2
+    assert char.get_lod_animation_level() == 0
+    assert bundle.max_joint_depth == -1
+    assert bundle.allow_frame_blend
+    assert not bundle.interpolate_updates
+    assert bundle.update_delay == 0.0
+
+    char.clear_lod_animation_levels()
+    assert char.get_num_lod_animation_levels() == 0
+    assert char.get_lod_animation_level() == 0
+    assert char.get_lod_animation_size() == 1.0
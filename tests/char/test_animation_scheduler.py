@@ -0,0 +1,129 @@
+from panda3d.core import Character, CharacterJoint, PartGroup
+from panda3d.core import AnimBundle, AnimGroup, AnimChannelMatrixXfmTable
+from panda3d.core import AnimationScheduler, AsyncTaskManager
+from panda3d.core import PandaNode, ClockObject, PTA_stdfloat, Mat4
+import math
+
+
+NUM_FRAMES = 10
+
+
+def make_character(name, num_joints=4):
+    # A chain of joints, each swinging back and forth.
+    char = Character(name)
+    bundle = char.get_bundle(0)
+    anim = AnimBundle(name, 24, NUM_FRAMES)
+
+    parent = PartGroup(bundle, "<skeleton>")
+    anim_parent = AnimGroup(anim, "<skeleton>")
+    joints = []
+    for i in range(num_joints):
+        joint_name = "j%d" % i
+        joint = CharacterJoint(char, bundle, parent, joint_name,
+                               Mat4.translate_mat(1, 0, 0))
+        table = AnimChannelMatrixXfmTable(anim_parent, joint_name)
+        table.set_table(b'x', PTA_stdfloat([1.0]))
+        table.set_table(b'h', PTA_stdfloat([
+            math.sin(f + i) * 30 for f in range(NUM_FRAMES)]))
+        joints.append(joint)
+        parent = joint
+        anim_parent = table
+
+    control = bundle.bind_anim(anim)
+    assert control is not None
+    return char, control, joints
+
+
+def get_net_transform(joint):
+    mat = Mat4()
+    joint.get_net_transform(mat)
+    return mat
+
+
+def scheduler_update(scheduler):
+    ClockObject.get_global_clock().tick()
+    scheduler.update()
+
+
+def test_animation_scheduler_update():
+    scheduler = AnimationScheduler.get_global_ptr()
+    scheduler.num_threads = 2
+
+    characters = [make_character("char%d" % i) for i in range(6)]
+    reference, ref_control, ref_joints = make_character("ref")
+    for char, control, joints in characters:
+        scheduler.add_character(char)
+    assert scheduler.get_num_characters() == len(characters)
+    assert scheduler.has_character(characters[0][0])
+
+    try:
+        for frame in (0, 3, 7):
+            for char, control, joints in characters:
+                control.pose(frame)
+            ref_control.pose(frame)
+            ClockObject.get_global_clock().tick()
+            scheduler.update()
+            reference.update()
+
+            assert scheduler.num_updated == len(characters)
+            assert scheduler.num_levels == 1
+            for char, control, joints in characters:
+                for joint, ref_joint in zip(joints, ref_joints):
+                    assert get_net_transform(joint).almost_equal(
+                        get_net_transform(ref_joint))
+
+        assert scheduler.remove_character(characters[0][0])
+        assert not scheduler.remove_character(characters[0][0])
+        scheduler_update(scheduler)
+        assert scheduler.num_updated == len(characters) - 1
+    finally:
+        scheduler.clear_characters()
+
+    scheduler_update(scheduler)
+    assert scheduler.num_updated == 0
+
+
+def test_animation_scheduler_dependency():
+    scheduler = AnimationScheduler.get_global_ptr()
+    scheduler.num_threads = 2
+
+    # The last joint of the leader is exposed to a node, which in turn
+    # controls the first joint of the follower.
+    leader, leader_control, leader_joints = make_character("leader")
+    follower, follower_control, follower_joints = make_character("follower")
+    node = PandaNode("hand")
+    leader_joints[-1].add_net_transform(node)
+    assert follower.get_bundle(0).control_joint("j0", node)
+
+    others = [make_character("other%d" % i) for i in range(3)]
+
+    scheduler.add_character(follower)
+    scheduler.add_character(leader)
+    for char, control, joints in others:
+        scheduler.add_character(char)
+
+    try:
+        for frame in (2, 5, 8):
+            leader_control.pose(frame)
+            follower_control.pose(frame)
+            scheduler_update(scheduler)
+
+            assert scheduler.num_updated == 5
+            assert scheduler.num_levels == 2
+            assert get_net_transform(follower_joints[0]).almost_equal(
+                get_net_transform(leader_joints[-1]))
+    finally:
+        scheduler.clear_characters()
+
+
+def test_animation_scheduler_active():
+    scheduler = AnimationScheduler.get_global_ptr()
+    manager = AsyncTaskManager.get_global_ptr()
+    assert not scheduler.active
+
+    scheduler.active = True
+    try:
+        assert manager.find_task("animationScheduler") is not None
+    finally:
+        scheduler.active = False
+    assert manager.find_task("animationScheduler") is None
@@ -0,0 +1,141 @@
+from panda3d.core import CollisionTraverser, CollisionHandlerQueue, CollisionNode
+from panda3d.core import CollisionSphere, CollisionBox, CollisionPolygon
+from panda3d.core import CollideMask, NodePath, LODNode, Point3, CardMaker
+import pytest
+import random
+
+
+def make_scene(num_colliders, num_obstacles):
+    random.seed(42)
+    root = NodePath("root")
+    colliders = []
+    for i in range(num_colliders):
+        np = root.attach_new_node(CollisionNode("from%d" % i))
+        np.node().add_solid(CollisionSphere(0, 0, 0, 1))
+        np.set_pos(random.uniform(-20, 20), random.uniform(-20, 20), 0)
+        colliders.append(np)
+
+    group = root.attach_new_node("group")
+    group.set_pos(5, 0, 0)
+    for i in range(num_obstacles):
+        np = group.attach_new_node(CollisionNode("into%d" % i))
+        np.node().add_solid(CollisionBox(Point3(0, 0, 0), 1, 1, 1))
+        np.node().set_from_collide_mask(CollideMask.all_off())
+        np.set_pos(random.uniform(-20, 20), random.uniform(-20, 20), 0)
+
+    # Only the lowest level of an LOD may be collided with as visible
+    # geometry; all levels may be collided with as CollisionNodes.
+    lod = root.attach_new_node(LODNode("lod"))
+    for i in range(2):
+        np = lod.attach_new_node(CollisionNode("lod%d" % i))
+        np.node().add_solid(CollisionSphere(0, 0, 0, 30))
+        np.node().set_from_collide_mask(CollideMask.all_off())
+    lod.node().add_switch(10, 0)
+    lod.node().add_switch(100, 10)
+
+    return root, colliders
+
+
+def collect(root, colliders, use_broadphase):
+    trav = CollisionTraverser()
+    trav.use_broadphase = use_broadphase
+    queue = CollisionHandlerQueue()
+    for np in colliders:
+        trav.add_collider(np, queue)
+
+    results = []
+    for frame in range(3):
+        trav.traverse(root)
+        # The ordinary traversal makes one pass per group of colliders, so
+        # the entries may be reported in a different order.
+        entries = [(e.get_from_node_path().get_name(),
+                    e.get_into_node_path().get_name(),
+                    e.get_surface_point(root))
+                   for e in queue.entries]
+        entries.sort(key=lambda e: e[:2])
+        results.append(entries)
+
+        # Move some of the colliders between traversals.
+        for np in colliders[::3]:
+            np.set_x(np.get_x() + 1.5)
+    return results
+
+
+def test_collision_broadphase_matches_traversal():
+    root, colliders = make_scene(100, 60)
+    start = [np.get_pos() for np in colliders]
+    expected = collect(root, colliders, False)
+
+    for np, pos in zip(colliders, start):
+        np.set_pos(pos)
+    result = collect(root, colliders, True)
+
+    assert len(result) == len(expected)
+    for frame, frame_expected in zip(result, expected):
+        assert len(frame) > 0
+        assert len(frame) == len(frame_expected)
+        for (f1, i1, p1), (f2, i2, p2) in zip(frame, frame_expected):
+            assert (f1, i1) == (f2, i2)
+            assert p1.almost_equal(p2)
+
+
+def test_collision_broadphase_removed_node():
+    root, colliders = make_scene(10, 0)
+    trav = CollisionTraverser()
+    trav.use_broadphase = True
+    queue = CollisionHandlerQueue()
+    trav.add_collider(colliders[0], queue)
+
+    target = root.attach_new_node(CollisionNode("target"))
+    target.node().add_solid(CollisionSphere(0, 0, 0, 1))
+    target.set_pos(colliders[0].get_pos())
+
+    trav.traverse(root)
+    assert "target" in [e.get_into_node_path().get_name() for e in queue.entries]
+
+    target.remove_node()
+    trav.traverse(root)
+    assert "target" not in [e.get_into_node_path().get_name() for e in queue.entries]
+
+
+def make_wall(into_type):
+    root = NodePath("root")
+    if into_type == "solid":
+        # The distant sphere makes the node's bounds much bigger than the
+        # wall's, so that the wall's own bounds must be tested as well.
+        wall = root.attach_new_node(CollisionNode("wall"))
+        wall.node().add_solid(CollisionPolygon(
+            Point3(-2, 0, -2), Point3(2, 0, -2),
+            Point3(2, 0, 2), Point3(-2, 0, 2)))
+        wall.node().add_solid(CollisionSphere(50, 0, 0, 1))
+    else:
+        cm = CardMaker("wall")
+        cm.set_frame(-2, 2, -2, 2)
+        wall = root.attach_new_node(cm.generate())
+        wall.set_collide_mask(CollideMask.all_on())
+    return root
+
+
+@pytest.mark.parametrize("into_type", ["solid", "geom"])
+@pytest.mark.parametrize("use_broadphase,continuous",
+                         [(False, False), (True, False), (True, True)])
+def test_collision_broadphase_fluid_motion(into_type, use_broadphase, continuous):
+    # A small sphere passes right through a wall in a single frame.  This
+    # should be detected when respect_prev_transform is enabled.
+    root = make_wall(into_type)
+    ball = root.attach_new_node(CollisionNode("ball"))
+    ball.node().add_solid(CollisionSphere(0, 0, 0, 0.5))
+    ball.node().set_into_collide_mask(CollideMask.all_off())
+    ball.set_pos(1, -10, -1)
+    ball.set_fluid_pos(1, 10, -1)
+
+    trav = CollisionTraverser()
+    trav.set_respect_prev_transform(True)
+    trav.use_broadphase = use_broadphase
+    trav.continuous = continuous
+    queue = CollisionHandlerQueue()
+    trav.add_collider(ball, queue)
+    trav.traverse(root)
+
+    assert queue.get_num_entries() == 1
+    assert queue.get_entry(0).get_into_node_path().get_name() == "wall"
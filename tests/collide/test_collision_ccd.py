@@ -0,0 +1,93 @@
+from panda3d.core import CollisionTraverser, CollisionHandlerQueue, CollisionNode
+from panda3d.core import CollisionSphere, CollisionBox, CollisionMesh, CollideMask
+from panda3d.core import NodePath, Point3, Vec3
+import pytest
+
+
+def make_wall(root):
+    # A thin slab across the X axis, 0.2 units thick.
+    wall = root.attach_new_node(CollisionNode("wall"))
+    wall.node().add_solid(CollisionBox(Point3(0, 0, 0), 0.1, 5, 5))
+    wall.node().set_from_collide_mask(CollideMask.all_off())
+    return wall
+
+
+def make_sheet(root):
+    # A single quad in the X = 0 plane, facing -X.
+    mesh = CollisionMesh()
+    mesh.add_vertex(Point3(0, -5, -5))
+    mesh.add_vertex(Point3(0, -5, 5))
+    mesh.add_vertex(Point3(0, 5, 5))
+    mesh.add_vertex(Point3(0, 5, -5))
+    mesh.add_triangle(0, 1, 2)
+    mesh.add_triangle(0, 2, 3)
+    sheet = root.attach_new_node(CollisionNode("sheet"))
+    sheet.node().add_solid(mesh)
+    sheet.node().set_from_collide_mask(CollideMask.all_off())
+    return sheet
+
+
+def sweep(root, solid, continuous):
+    mover = root.attach_new_node(CollisionNode("mover"))
+    mover.node().add_solid(solid)
+    mover.set_pos(-10, 0, 0)
+    mover.set_fluid_pos(10, 0, 0)
+
+    trav = CollisionTraverser()
+    trav.set_respect_prev_transform(True)
+    trav.continuous = continuous
+    queue = CollisionHandlerQueue()
+    trav.add_collider(mover, queue)
+    trav.traverse(root)
+    mover.remove_node()
+    return list(queue.entries)
+
+
+@pytest.mark.parametrize("make_into", [make_wall, make_sheet])
+@pytest.mark.parametrize("solid", [CollisionSphere(0, 0, 0, 0.5),
+                                   CollisionBox(Point3(0, 0, 0), 0.5, 0.5, 0.5)])
+def test_collision_ccd_tunneling(make_into, solid):
+    root = NodePath("root")
+    into = make_into(root)
+    thickness = 0.1 if make_into is make_wall else 0.0
+
+    # Without continuous collision detection, the fast collider passes
+    # straight through.
+    if not (make_into is make_wall and isinstance(solid, CollisionSphere)):
+        assert not sweep(root, solid, False)
+
+    entries = sweep(root, solid, True)
+    assert len(entries) == 1
+    entry = entries[0]
+    assert entry.get_into_node_path() == into
+
+    # The time of impact is when the leading face of the collider reaches the
+    # near face of the slab.
+    toi = (10 - 0.5 - thickness) / 20.0
+    assert abs(entry.get_t() - toi) < 0.005
+    assert entry.has_contact_pos()
+    assert abs(entry.get_contact_pos(root).x - (-10 + 20 * toi)) < 0.1
+    assert entry.get_contact_pos(root).x < -0.5 - thickness + 0.001
+
+    # The interior point is reported relative to the collider's current
+    # position, on the far side of the slab.
+    assert entry.get_interior_point(root).x > 5
+
+
+def test_collision_ccd_slow_motion():
+    # A collider that moves less than its own radius is tested as usual.
+    root = NodePath("root")
+    make_wall(root)
+    mover = root.attach_new_node(CollisionNode("mover"))
+    mover.node().add_solid(CollisionBox(Point3(0, 0, 0), 0.5, 0.5, 0.5))
+    mover.set_pos(-0.8, 0, 0)
+    mover.set_fluid_pos(-0.5, 0, 0)
+
+    trav = CollisionTraverser()
+    trav.set_respect_prev_transform(True)
+    trav.continuous = True
+    queue = CollisionHandlerQueue()
+    trav.add_collider(mover, queue)
+    trav.traverse(root)
+    assert queue.get_num_entries() == 1
+    assert not queue.get_entry(0).has_contact_pos()
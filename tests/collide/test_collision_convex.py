@@ -0,0 +1,172 @@
+from panda3d.core import CollisionConvex, CollisionNode, CollisionTraverser
+from panda3d.core import CollisionHandlerQueue, CollisionHandlerPusher
+from panda3d.core import CollisionSphere, CollisionBox, CollisionPolygon
+from panda3d.core import CollisionRay, CollisionSegment, CollisionPlane
+from panda3d.core import NodePath, Point3, Vec3, Plane, CollideMask
+import random
+
+
+def make_cube(size=1.0):
+    # The corners of a cube, plus some points inside it.
+    convex = CollisionConvex()
+    for x in (-size, size):
+        for y in (-size, size):
+            for z in (-size, size):
+                convex.add_point(Point3(x, y, z))
+    convex.add_point(Point3(0, 0, 0))
+    convex.add_point(Point3(0.5 * size, -0.2 * size, 0.1 * size))
+    return convex
+
+
+def make_ball(radius=1.0, count=200):
+    random.seed(3)
+    convex = CollisionConvex()
+    for i in range(count):
+        v = Vec3(random.gauss(0, 1), random.gauss(0, 1), random.gauss(0, 1))
+        v.normalize()
+        convex.add_point(Point3(v * radius))
+    return convex
+
+
+def collide(into_solid, from_solid, pos=(0, 0, 0)):
+    root = NodePath("root")
+    into = root.attach_new_node(CollisionNode("into"))
+    into.node().add_solid(into_solid)
+
+    mover = root.attach_new_node(CollisionNode("from"))
+    mover.node().add_solid(from_solid)
+    mover.node().set_into_collide_mask(CollideMask.all_off())
+    mover.set_pos(pos)
+
+    trav = CollisionTraverser()
+    queue = CollisionHandlerQueue()
+    trav.add_collider(mover, queue)
+    trav.traverse(root)
+    if queue.get_num_entries() == 0:
+        return None
+    return queue.get_entry(0)
+
+
+def push_vector(entry):
+    into = entry.get_into_node_path()
+    return entry.get_surface_point(into) - entry.get_interior_point(into)
+
+
+def test_collision_convex_hull():
+    convex = make_cube()
+    assert convex.get_num_points() == 10
+    assert convex.get_num_hull_vertices() == 8
+    assert convex.get_num_hull_faces() == 12
+
+    # Points inside the hull don't change it.
+    convex.add_point(Point3(0.2, 0.3, -0.4))
+    assert convex.get_num_hull_vertices() == 8
+
+    convex.add_point(Point3(0, 0, 3))
+    assert convex.get_num_hull_vertices() == 9
+
+
+def test_collision_convex_sphere():
+    cube = make_cube()
+
+    assert collide(cube, CollisionSphere(0, 0, 0, 0.5), (1.6, 0, 0)) is None
+
+    entry = collide(cube, CollisionSphere(0, 0, 0, 0.5), (1.3, 0.2, 0.1))
+    assert entry is not None
+    push = push_vector(entry)
+    assert abs(push.x - 0.2) < 1e-3
+    assert abs(push.y) < 1e-3 and abs(push.z) < 1e-3
+    normal = entry.get_surface_normal(entry.get_into_node_path())
+    assert normal.almost_equal(Vec3(1, 0, 0), 1e-3)
+
+    # Off a corner, the push is diagonal.
+    entry = collide(cube, CollisionSphere(0, 0, 0, 0.5), (1.2, 1.2, 0))
+    assert entry is not None
+    normal = entry.get_surface_normal(entry.get_into_node_path())
+    assert abs(normal.x - normal.y) < 1e-3
+    assert abs(normal.length() - 1) < 1e-3
+
+    # The center of the sphere is deep inside the cube.
+    entry = collide(cube, CollisionSphere(0, 0, 0, 0.25), (0.6, 0, 0))
+    assert entry is not None
+    assert abs(push_vector(entry).x - 0.65) < 1e-3
+
+
+def test_collision_convex_convex():
+    cube = make_cube()
+
+    assert collide(cube, make_cube(0.5), (1.6, 0, 0)) is None
+
+    entry = collide(cube, make_cube(0.5), (1.3, 0.1, 0))
+    assert entry is not None
+    push = push_vector(entry)
+    assert abs(push.x - 0.2) < 1e-3
+    assert abs(push.y) < 1e-3 and abs(push.z) < 1e-3
+
+    # A rounded hull against a box.
+    box = CollisionBox(Point3(0, 0, 0), 1, 1, 1)
+    entry = collide(box, make_ball(), (0, 0, 1.8))
+    assert entry is not None
+    push = push_vector(entry)
+    assert push.z > 0.1 and push.z < 0.3
+    assert abs(push.x) < 0.05 and abs(push.y) < 0.05
+
+    # And the other way around.
+    entry = collide(make_ball(), box, (0, 0, 1.8))
+    assert entry is not None
+    assert push_vector(entry).z > 0.1
+
+
+def test_collision_convex_polygon():
+    floor = CollisionPolygon(Point3(-5, -5, 0), Point3(5, -5, 0),
+                             Point3(5, 5, 0), Point3(-5, 5, 0))
+
+    assert collide(floor, make_cube(), (0, 0, 1.5)) is None
+    assert collide(floor, make_cube(), (7, 0, 0.5)) is None
+
+    entry = collide(floor, make_cube(), (1, 2, 0.75))
+    assert entry is not None
+    assert abs(push_vector(entry).z - 0.25) < 1e-3
+    normal = entry.get_surface_normal(entry.get_into_node_path())
+    assert normal.almost_equal(Vec3(0, 0, 1), 1e-3)
+
+    plane = CollisionPlane(Plane(Vec3(0, 0, 1), Point3(0, 0, 0)))
+    entry = collide(plane, make_cube(), (1, 2, 0.75))
+    assert entry is not None
+    assert abs(push_vector(entry).z - 0.25) < 1e-3
+
+
+def test_collision_convex_ray():
+    cube = make_cube()
+
+    entry = collide(cube, CollisionRay(-5, 0.3, 0.2, 1, 0, 0))
+    assert entry is not None
+    into = entry.get_into_node_path()
+    assert entry.get_surface_point(into).almost_equal(Point3(-1, 0.3, 0.2), 1e-3)
+    assert entry.get_surface_normal(into).almost_equal(Vec3(-1, 0, 0), 1e-3)
+
+    assert collide(cube, CollisionRay(-5, 3, 0, 1, 0, 0)) is None
+    assert collide(cube, CollisionSegment(-5, 0, 0, -2, 0, 0)) is None
+    assert collide(cube, CollisionSegment(-5, 0, 0, 0, 0, 0)) is not None
+
+
+def test_collision_convex_pusher():
+    root = NodePath("root")
+    wall = root.attach_new_node(CollisionNode("wall"))
+    wall.node().add_solid(make_cube())
+
+    mover = root.attach_new_node("mover")
+    cnode = mover.attach_new_node(CollisionNode("mover"))
+    cnode.node().add_solid(make_ball(0.5))
+    cnode.node().set_into_collide_mask(CollideMask.all_off())
+    mover.set_pos(1.3, 0, 0)
+
+    trav = CollisionTraverser()
+    pusher = CollisionHandlerPusher()
+    pusher.add_collider(cnode, mover)
+    trav.add_collider(cnode, pusher)
+    trav.traverse(root)
+
+    # The ball is pushed out until it just touches the wall.
+    assert mover.get_x() > 1.45
+    assert abs(mover.get_y()) < 0.05 and abs(mover.get_z()) < 0.05
@@ -0,0 +1,103 @@
+from panda3d.core import CollisionTraverser, CollisionHandlerPusher
+from panda3d.core import CollisionNode, CollisionSphere, CollisionPlane
+from panda3d.core import NodePath, Point3, Vec3, Plane, CollideMask
+import random
+
+
+def make_crowd(root, count, crowd, seed=1):
+    random.seed(seed)
+    trav = CollisionTraverser()
+    pusher = CollisionHandlerPusher()
+
+    agents = []
+    for i in range(count):
+        agent = root.attach_new_node("agent%d" % i)
+        agent.set_pos(random.uniform(0, 12), random.uniform(0, 12), 0)
+        radius = random.uniform(0.4, 0.6)
+        cnode = agent.attach_new_node(CollisionNode("agent%d" % i))
+        cnode.node().add_solid(CollisionSphere(0, 0, 0, radius))
+        cnode.node().set_from_collide_mask(CollideMask.bit(1))
+        if crowd:
+            # The traverser no longer tests the agents against each other.
+            cnode.node().set_into_collide_mask(CollideMask.all_off())
+        else:
+            cnode.node().set_into_collide_mask(CollideMask.bit(1))
+
+        pusher.add_collider(cnode, agent)
+        trav.add_collider(cnode, pusher)
+        if crowd:
+            pusher.add_crowd_collider(cnode)
+        agents.append(agent)
+
+    return trav, pusher, agents
+
+
+def test_collision_crowd_matches_traverser():
+    root1 = NodePath("root")
+    trav1, pusher1, agents1 = make_crowd(root1, 60, False)
+
+    root2 = NodePath("root")
+    trav2, pusher2, agents2 = make_crowd(root2, 60, True)
+    assert pusher2.has_crowd_collider(agents2[0].get_child(0))
+    start = [agent.get_pos() for agent in agents1]
+
+    for i in range(3):
+        trav1.traverse(root1)
+        trav2.traverse(root2)
+
+    moved = 0
+    for a1, a2, pos in zip(agents1, agents2, start):
+        assert (a1.get_pos() - a2.get_pos()).length() < 1e-4
+        if a1.get_pos() != pos:
+            moved += 1
+    assert moved > 10
+
+
+def test_collision_crowd_separates():
+    root = NodePath("root")
+    trav, pusher, agents = make_crowd(root, 3, True)
+    agents[0].set_pos(0, 0, 0)
+    agents[1].set_pos(0.5, 0, 0)
+    agents[2].set_pos(20, 0, 0)
+    start = agents[2].get_pos()
+
+    trav.traverse(root)
+    assert agents[0].get_x() < 0
+    assert agents[1].get_x() > 0.5
+    assert agents[2].get_pos() == start
+
+    # Removed from the crowd, the agents no longer push each other.
+    agents[0].set_pos(0, 0, 0)
+    agents[1].set_pos(0.5, 0, 0)
+    pusher.clear_crowd_colliders()
+    trav.traverse(root)
+    assert agents[0].get_pos() == Point3(0, 0, 0)
+
+
+def test_collision_crowd_with_walls():
+    root = NodePath("root")
+    trav, pusher, agents = make_crowd(root, 2, True)
+    pusher.horizontal = False
+
+    floor = root.attach_new_node(CollisionNode("floor"))
+    floor.node().add_solid(CollisionPlane(Plane(Vec3(0, 0, 1), Point3(0, 0, 0))))
+    floor.node().set_into_collide_mask(CollideMask.bit(1))
+
+    # The two agents overlap each other, and are half-buried in the floor.
+    agents[0].set_pos(0, 0, 0.2)
+    agents[1].set_pos(0.5, 0, 0.2)
+    trav.traverse(root)
+
+    for agent in agents:
+        radius = agent.get_child(0).node().get_solid(0).get_radius()
+        assert abs(agent.get_z() - radius) < 1e-4
+    assert agents[0].get_x() < 0
+    assert agents[1].get_x() > 0.5
+
+    # A small cell size still finds all of the pairs.
+    pusher.crowd_cell_size = 0.3
+    agents[0].set_pos(0, 0, 1)
+    agents[1].set_pos(0.5, 0, 1)
+    trav.traverse(root)
+    assert agents[0].get_x() < 0
+    assert agents[1].get_x() > 0.5
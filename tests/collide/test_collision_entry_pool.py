@@ -0,0 +1,60 @@
+from panda3d.core import CollisionTraverser, CollisionHandlerQueue, CollisionNode
+from panda3d.core import CollisionHandlerPusher, CollisionSphere, NodePath
+import random
+
+
+def make_scene():
+    random.seed(5)
+    root = NodePath("root")
+    colliders = []
+    for i in range(60):
+        np = root.attach_new_node(CollisionNode("s%d" % i))
+        np.node().add_solid(CollisionSphere(0, 0, 0, 2))
+        np.set_pos(random.uniform(-10, 10), random.uniform(-10, 10), 0)
+        colliders.append(np)
+    return root, colliders
+
+
+def test_collision_entry_reuse():
+    # Entries freed by one pass are recycled by the next one; the results
+    # must not be affected.
+    root, colliders = make_scene()
+    trav = CollisionTraverser()
+    queue = CollisionHandlerQueue()
+    for np in colliders:
+        trav.add_collider(np, queue)
+
+    results = []
+    for i in range(3):
+        trav.traverse(root)
+        results.append([(e.get_from_node_path(), e.get_into_node_path(),
+                         e.get_surface_point(root)) for e in queue.entries])
+    assert len(results[0]) > 0
+    assert results[0] == results[1] == results[2]
+
+
+def test_collision_pusher_reuse():
+    # The pusher keeps its per-collider lists between passes; a collider that
+    # is no longer touching anything must not be pushed by stale entries.
+    root = NodePath("root")
+    wall = root.attach_new_node(CollisionNode("wall"))
+    wall.node().add_solid(CollisionSphere(0, 0, 0, 1))
+
+    mover = root.attach_new_node(CollisionNode("mover"))
+    mover.node().add_solid(CollisionSphere(0, 0, 0, 1))
+
+    trav = CollisionTraverser()
+    pusher = CollisionHandlerPusher()
+    pusher.add_collider(mover, mover)
+    trav.add_collider(mover, pusher)
+
+    for i in range(3):
+        mover.set_pos(1.5, 0, 0)
+        trav.traverse(root)
+        assert abs(mover.get_x() - 2) < 0.001
+
+        mover.set_pos(5, 0, 0)
+        trav.traverse(root)
+        assert mover.get_x() == 5
+        trav.traverse(root)
+        assert mover.get_x() == 5
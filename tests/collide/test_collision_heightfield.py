@@ -0,0 +1,144 @@
+from panda3d.core import CollisionHeightfield, CollisionMesh, CollisionNode
+from panda3d.core import CollisionTraverser, CollisionHandlerQueue, CollisionRay
+from panda3d.core import CollisionSegment, CollisionSphere, CollisionBox
+from panda3d.core import PNMImage, NodePath, Point3, Vec3, CollideMask
+import random
+import math
+
+
+def make_image(size=17):
+    # Rolling hills, brighter towards the top of the image.
+    image = PNMImage(size, size, 1)
+    for row in range(size):
+        for x in range(size):
+            value = 0.5 + 0.25 * math.sin(x * 0.7) * math.cos(row * 0.4)
+            image.set_gray(x, row, value)
+    return image
+
+
+def make_mesh(hfield):
+    # The same surface as a plain triangle mesh, for reference.
+    mesh = CollisionMesh()
+    for y in range(hfield.y_size):
+        for x in range(hfield.x_size):
+            mesh.add_vertex(Point3(x, y, hfield.get_sample(x, y)))
+    for y in range(hfield.y_size - 1):
+        for x in range(hfield.x_size - 1):
+            v00 = y * hfield.x_size + x
+            v10 = v00 + 1
+            v01 = v00 + hfield.x_size
+            v11 = v01 + 1
+            mesh.add_triangle(v00, v10, v11)
+            mesh.add_triangle(v00, v11, v01)
+    return mesh
+
+
+def collide(into_solid, from_solid, pos=(0, 0, 0)):
+    root = NodePath("root")
+    into = root.attach_new_node(CollisionNode("into"))
+    into.node().add_solid(into_solid)
+
+    mover = root.attach_new_node(CollisionNode("from"))
+    mover.node().add_solid(from_solid)
+    mover.node().set_into_collide_mask(CollideMask.all_off())
+    mover.set_pos(pos)
+
+    trav = CollisionTraverser()
+    queue = CollisionHandlerQueue()
+    trav.add_collider(mover, queue)
+    trav.traverse(root)
+    if queue.get_num_entries() == 0:
+        return None
+    queue.sort_entries()
+    return queue.get_entry(0)
+
+
+def test_collision_heightfield_sampling():
+    image = PNMImage(3, 2, 1, 65535)
+    image.set_gray(0, 0, 1.0)
+    image.set_gray(2, 1, 0.5)
+    hfield = CollisionHeightfield(image, 10)
+    assert hfield.x_size == 3
+    assert hfield.y_size == 2
+
+    # The top row of the image is at the far end of the Y axis.
+    assert abs(hfield.get_sample(0, 1) - 10) < 1e-3
+    assert abs(hfield.get_sample(2, 0) - 5) < 1e-3
+    assert abs(hfield.get_height(0, 0.5) - 5) < 1e-3
+    assert abs(hfield.get_height(1.5, 0) - 2.5) < 1e-3
+
+    hfield.max_height = 20
+    assert abs(hfield.get_sample(0, 1) - 20) < 1e-4
+
+
+def test_collision_heightfield_ray():
+    hfield = CollisionHeightfield(make_image(), 4)
+
+    entry = collide(hfield, CollisionRay(3.3, 7.6, 10, 0, 0, -1))
+    assert entry is not None
+    point = entry.get_surface_point(entry.get_into_node_path())
+    assert abs(point.z - hfield.get_height(3.3, 7.6)) < 1e-3
+    assert entry.get_surface_normal(entry.get_into_node_path()).z > 0
+
+    # Beyond the edge of the heightfield.
+    assert collide(hfield, CollisionRay(-1, 5, 10, 0, 0, -1)) is None
+
+    # A segment that stops short of the surface.
+    assert collide(hfield, CollisionSegment(3, 3, 10, 3, 3, 5)) is None
+    assert collide(hfield, CollisionSegment(3, 3, 10, 3, 3, -5)) is not None
+
+
+def test_collision_heightfield_matches_mesh():
+    random.seed(11)
+    hfield = CollisionHeightfield(make_image(), 4)
+    mesh = make_mesh(hfield)
+
+    for i in range(200):
+        origin = Point3(random.uniform(-2, 18), random.uniform(-2, 18), random.uniform(0, 8))
+        direction = Vec3(random.uniform(-1, 1), random.uniform(-1, 1), random.uniform(-1, 0.2))
+        ray = CollisionRay(origin, direction)
+
+        expected = collide(mesh, ray)
+        result = collide(hfield, ray)
+        assert (result is None) == (expected is None)
+        if expected is not None:
+            p1 = result.get_surface_point(result.get_into_node_path())
+            p2 = expected.get_surface_point(expected.get_into_node_path())
+            assert (p1 - p2).length() < 1e-3
+
+
+def test_collision_heightfield_sphere():
+    hfield = CollisionHeightfield(make_image(), 4)
+    height = hfield.get_height(8, 8)
+
+    # Floating just above the surface.
+    assert collide(hfield, CollisionSphere(0, 0, 0, 0.5), (8, 8, height + 1)) is None
+
+    # Resting on the surface.
+    entry = collide(hfield, CollisionSphere(0, 0, 0, 0.5), (8, 8, height + 0.3))
+    assert entry is not None
+    assert entry.get_surface_normal(entry.get_into_node_path()).z > 0.5
+
+    # Buried deep underground: still pushed back up.
+    entry = collide(hfield, CollisionSphere(0, 0, 0, 0.5), (8, 8, height - 3))
+    assert entry is not None
+    into = entry.get_into_node_path()
+    push = entry.get_surface_point(into) - entry.get_interior_point(into)
+    assert push.z > 3
+
+
+def test_collision_heightfield_box():
+    hfield = CollisionHeightfield(make_image(), 4)
+    height = hfield.get_height(5, 5)
+
+    box = CollisionBox(Point3(0, 0, 0), 0.5, 0.5, 0.5)
+    assert collide(hfield, box, (5, 5, height + 2)) is None
+
+    entry = collide(hfield, box, (5, 5, height + 0.2))
+    assert entry is not None
+    into = entry.get_into_node_path()
+    push = entry.get_surface_point(into) - entry.get_interior_point(into)
+    assert push.z > 0
+
+    entry = collide(hfield, box, (5, 5, height - 3))
+    assert entry is not None
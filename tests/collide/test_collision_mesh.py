@@ -0,0 +1,123 @@
+from panda3d.core import CollisionMesh, CollisionNode, CollisionTraverser
+from panda3d.core import CollisionHandlerQueue, CollisionRay, CollisionSegment
+from panda3d.core import CollisionSphere, CollisionBox, CollisionTube
+from panda3d.core import NodePath, Point3, Vec3
+
+
+def make_grid(size):
+    # A flat, upward-facing grid of size x size quads in the z = 0 plane.
+    mesh = CollisionMesh()
+    for y in range(size + 1):
+        for x in range(size + 1):
+            mesh.add_vertex(Point3(x, y, 0))
+    for y in range(size):
+        for x in range(size):
+            a = y * (size + 1) + x
+            b = a + 1
+            c = a + size + 1
+            d = c + 1
+            mesh.add_triangle(a, b, d)
+            mesh.add_triangle(a, d, c)
+    return mesh
+
+
+def collide(into_solid, from_solid):
+    root = NodePath("root")
+    into_np = root.attach_new_node(CollisionNode("into"))
+    into_np.node().add_solid(into_solid)
+    from_np = root.attach_new_node(CollisionNode("from"))
+    from_np.node().add_solid(from_solid)
+
+    trav = CollisionTraverser()
+    queue = CollisionHandlerQueue()
+    trav.add_collider(from_np, queue)
+    trav.traverse(root)
+    return list(queue.entries)
+
+
+def test_collision_mesh_structure():
+    mesh = make_grid(4)
+    assert mesh.get_num_vertices() == 25
+    assert mesh.get_num_triangles() == 32
+    assert tuple(mesh.get_triangle(0)) == (0, 1, 6)
+
+    bounds = mesh.get_bounds()
+    assert bounds.get_min() == Point3(0, 0, 0)
+    assert bounds.get_max() == Point3(4, 4, 0)
+
+
+def test_collision_mesh_ray():
+    mesh = make_grid(16)
+
+    entries = collide(mesh, CollisionRay(Point3(3.25, 7.5, 10), Vec3(0, 0, -1)))
+    assert len(entries) == 1
+    entry = entries[0]
+    assert entry.get_surface_point(entry.get_into_node_path()).almost_equal(Point3(3.25, 7.5, 0))
+    assert entry.get_surface_normal(entry.get_into_node_path()).almost_equal(Vec3(0, 0, 1))
+
+    # Rays pointing away from the mesh, or passing beside it, miss it.
+    assert not collide(mesh, CollisionRay(Point3(3, 7, 10), Vec3(0, 0, 1)))
+    assert not collide(mesh, CollisionRay(Point3(20, 7, 10), Vec3(0, 0, -1)))
+
+    # A segment must reach the mesh.
+    assert not collide(mesh, CollisionSegment(Point3(1.5, 1.5, 10), Point3(1.5, 1.5, 1)))
+    assert collide(mesh, CollisionSegment(Point3(1.5, 1.5, 1), Point3(1.5, 1.5, -1)))
+
+
+def test_collision_mesh_sphere():
+    mesh = make_grid(16)
+
+    entries = collide(mesh, CollisionSphere(Point3(5.5, 5.5, 0.25), 1))
+    assert len(entries) == 1
+    entry = entries[0]
+    into = entry.get_into_node_path()
+    assert entry.get_surface_point(into).almost_equal(Point3(5.5, 5.5, 0))
+    assert entry.get_interior_point(into).almost_equal(Point3(5.5, 5.5, -0.75))
+    assert entry.get_surface_normal(into).almost_equal(Vec3(0, 0, 1))
+
+    assert not collide(mesh, CollisionSphere(Point3(5.5, 5.5, 1.5), 1))
+    assert not collide(mesh, CollisionSphere(Point3(-2, 5.5, 0), 1))
+
+    # The triangles are one-sided.
+    assert not collide(mesh, CollisionSphere(Point3(5.5, 5.5, -0.25), 1))
+
+
+def test_collision_mesh_box_tube():
+    mesh = make_grid(16)
+
+    entries = collide(mesh, CollisionBox(Point3(8, 8, 0.5), 1, 1, 1))
+    assert len(entries) == 1
+    into = entries[0].get_into_node_path()
+    assert abs(entries[0].get_interior_point(into).z + 0.5) < 0.001
+
+    assert not collide(mesh, CollisionBox(Point3(8, 8, 1.5), 1, 1, 1))
+
+    assert collide(mesh, CollisionTube(Point3(2, 2, 0.5), Point3(6, 2, 0.5), 1))
+    assert not collide(mesh, CollisionTube(Point3(2, 2, 1.5), Point3(6, 2, 1.5), 1))
+
+
+def test_collision_mesh_add_geom_bad_index():
+    from panda3d.core import Geom, GeomTriangles, GeomVertexData
+    from panda3d.core import GeomVertexFormat, GeomVertexWriter
+    import pytest
+
+    vdata = GeomVertexData("tris", GeomVertexFormat.get_v3(), Geom.UH_static)
+    writer = GeomVertexWriter(vdata, "vertex")
+    for x, y in ((0, 0), (1, 0), (1, 1), (0, 1)):
+        writer.add_data3(x, y, 0)
+    prim = GeomTriangles(Geom.UH_static)
+    prim.add_vertices(0, 1, 2)
+    prim.add_vertices(0, 2, 3)
+    geom = Geom(vdata)
+    geom.add_primitive(prim)
+
+    # Drop the last vertex, so that the second triangle is invalid.
+    geom.modify_vertex_data().set_num_rows(3)
+
+    mesh = CollisionMesh()
+    with pytest.raises(AssertionError):
+        mesh.add_geom(geom)
+
+    # Nothing was added.
+    assert mesh.get_num_vertices() == 0
+    assert mesh.get_num_triangles() == 0
@@ -0,0 +1,164 @@
+from panda3d.core import CollisionRayBatch, CollisionNode, CollisionSphere
+from panda3d.core import CollisionPolygon, CollisionBox, CollisionTraverser
+from panda3d.core import CollisionHandlerQueue, CollisionRay, CollideMask
+from panda3d.core import NodePath, Point3, Vec3, PTA_LVecBase3f
+import random
+
+
+def make_scene():
+    root = NodePath("root")
+
+    floor = root.attach_new_node(CollisionNode("floor"))
+    floor.node().add_solid(CollisionPolygon(Point3(-50, -50, 0), Point3(50, -50, 0),
+                                            Point3(50, 50, 0), Point3(-50, 50, 0)))
+    floor.node().set_into_collide_mask(CollideMask.bit(25))
+
+    ball = root.attach_new_node(CollisionNode("ball"))
+    ball.node().add_solid(CollisionSphere(0, 0, 0, 1))
+    ball.set_pos(5, 0, 3)
+
+    crate = root.attach_new_node(CollisionNode("crate"))
+    crate.node().add_solid(CollisionBox(Point3(0, 0, 0), 1, 1, 1))
+    crate.set_pos(-5, 0, 1)
+    crate.set_scale(2)
+    return root
+
+
+def test_collision_ray_batch_hits():
+    root = make_scene()
+    batch = CollisionRayBatch()
+    batch.set_scene(root)
+    assert batch.get_num_nodes() == 3
+    assert batch.get_num_spheres() == 1
+    assert batch.get_num_triangles() == 2 + 12
+
+    origins = PTA_LVecBase3f(((5, 0, 10), (-5, 0, 10), (20, 20, 10), (0, 0, -5), (5, 0, 3)))
+    directions = PTA_LVecBase3f(((0, 0, -1), (0, 0, -1), (0, 0, -1), (0, 0, -1), (1, 0, 0)))
+    assert batch.cast(origins, directions) == 4
+
+    names = [batch.nodes[i].name if i >= 0 else None for i in batch.node_ids]
+    assert names == ["ball", "crate", "floor", None, "ball"]
+
+    assert abs(batch.distances[0] - 6) < 1e-4
+    assert Vec3(batch.normals[0]).almost_equal(Vec3(0, 0, 1))
+    assert abs(batch.distances[1] - 7) < 1e-4
+    assert Vec3(batch.normals[1]).almost_equal(Vec3(0, 0, 1))
+    assert abs(batch.distances[2] - 10) < 1e-4
+    assert batch.distances[3] == -1
+
+    # The last ray starts inside the ball.
+    assert batch.distances[4] == 0
+    assert Vec3(batch.normals[4]).almost_equal(Vec3(-1, 0, 0))
+
+    # The floor can be excluded by its collide mask.
+    batch.cast(origins, directions, CollideMask.bit(25))
+    assert list(batch.node_ids) == [0, 0, 0, -1, -1]
+    batch.cast(origins, directions, ~CollideMask.bit(25))
+    assert batch.get_node_id(2) == -1
+
+
+def test_collision_ray_batch_matches_traverser():
+    random.seed(3)
+    root = NodePath("root")
+    for i in range(40):
+        np = root.attach_new_node(CollisionNode("sphere%d" % i))
+        np.node().add_solid(CollisionSphere(0, 0, 0, random.uniform(0.5, 2)))
+        np.set_pos(random.uniform(-20, 20), random.uniform(-20, 20), random.uniform(-20, 20))
+    for i in range(40):
+        np = root.attach_new_node(CollisionNode("box%d" % i))
+        np.node().add_solid(CollisionBox(Point3(0, 0, 0), 1, 2, 1))
+        np.set_pos(random.uniform(-20, 20), random.uniform(-20, 20), random.uniform(-20, 20))
+        np.set_hpr(random.uniform(0, 360), random.uniform(0, 360), 0)
+
+    batch = CollisionRayBatch()
+    batch.set_scene(root)
+
+    origins = PTA_LVecBase3f()
+    directions = PTA_LVecBase3f()
+    for i in range(200):
+        origins.push_back(Vec3(random.uniform(-25, 25), random.uniform(-25, 25), random.uniform(-25, 25)))
+        directions.push_back(Vec3(random.uniform(-1, 1), random.uniform(-1, 1), random.uniform(-1, 1)).normalized())
+    batch.cast(origins, directions)
+
+    trav = CollisionTraverser()
+    queue = CollisionHandlerQueue()
+    ray = CollisionRay()
+    ray_np = root.attach_new_node(CollisionNode("ray"))
+    ray_np.node().add_solid(ray)
+    ray_np.node().set_into_collide_mask(CollideMask.all_off())
+    trav.add_collider(ray_np, queue)
+
+    num_hits = 0
+    for i in range(len(origins)):
+        ray.set_origin(Point3(origins[i]))
+        ray.set_direction(Vec3(directions[i]))
+        trav.traverse(root)
+        queue.sort_entries()
+
+        if queue.get_num_entries() == 0:
+            assert batch.get_node_id(i) == -1
+            continue
+
+        num_hits += 1
+        entry = queue.get_entry(0)
+        assert batch.get_node(batch.get_node_id(i)) == entry.get_into_node_path()
+        point = entry.get_surface_point(root)
+        assert abs((point - Point3(origins[i])).length() - batch.get_distance(i)) < 1e-3
+    assert num_hits > 0
+
+
+def test_collision_ray_batch_morphed_geom():
+    from panda3d.core import Geom, GeomNode, GeomTriangles, GeomVertexData
+    from panda3d.core import GeomVertexFormat, GeomVertexArrayFormat
+    from panda3d.core import GeomVertexAnimationSpec, GeomVertexWriter
+    from panda3d.core import InternalName, SliderTable, UserVertexSlider
+    from panda3d.core import SparseArray
+
+    # A floor quad at z = 0 with a morph that raises it to z = 2.
+    vertex = InternalName.get_vertex()
+    morph = InternalName.get_morph(vertex, "raise")
+    array_format = GeomVertexArrayFormat()
+    array_format.add_column(vertex, 3, Geom.NT_float32, Geom.C_point)
+    array_format.add_column(morph, 3, Geom.NT_float32, Geom.C_morph_delta)
+    format = GeomVertexFormat()
+    format.add_array(array_format)
+    spec = GeomVertexAnimationSpec()
+    spec.set_panda()
+    format.set_animation(spec)
+    format = GeomVertexFormat.register_format(format)
+
+    vdata = GeomVertexData("floor", format, Geom.UH_static)
+    writer = GeomVertexWriter(vdata, vertex)
+    delta = GeomVertexWriter(vdata, morph)
+    for x, y in ((-5, -5), (5, -5), (5, 5), (-5, 5)):
+        writer.add_data3(x, y, 0)
+        delta.add_data3(0, 0, 2)
+
+    slider = UserVertexSlider(InternalName.make("raise"))
+    slider.set_slider(1)
+    rows = SparseArray()
+    rows.set_range(0, 4)
+    table = SliderTable()
+    table.add_slider(slider, rows)
+    vdata.set_slider_table(SliderTable.register_table(table))
+
+    prim = GeomTriangles(Geom.UH_static)
+    prim.add_vertices(0, 1, 2)
+    prim.add_vertices(0, 2, 3)
+    geom = Geom(vdata)
+    geom.add_primitive(prim)
+
+    root = NodePath("root")
+    gnode = GeomNode("floor")
+    gnode.add_geom(geom)
+    gnode.set_into_collide_mask(GeomNode.get_default_collide_mask())
+    root.attach_new_node(gnode)
+
+    batch = CollisionRayBatch()
+    batch.set_scene(root)
+    origins = PTA_LVecBase3f(((0, 0, 10),))
+    directions = PTA_LVecBase3f(((0, 0, -1),))
+    assert batch.cast(origins, directions) == 1
+
+    # The ray hits the floor where it is drawn, as with the traverser.
+    assert abs(batch.get_distance(0) - 8) < 1e-4
@@ -0,0 +1,85 @@
+from panda3d.core import CollisionTraverser, CollisionHandlerQueue, CollisionNode
+from panda3d.core import CollisionStats, CollisionSphere, CollisionBox
+from panda3d.core import CollisionPolygon, NodePath, Point3, StringStream
+
+
+def make_scene():
+    root = NodePath("root")
+
+    balls = root.attach_new_node(CollisionNode("balls"))
+    balls.node().add_solid(CollisionSphere(0, 0, 0, 1))
+    balls.node().add_solid(CollisionSphere(10, 0, 0, 1))
+
+    wall = root.attach_new_node(CollisionNode("wall"))
+    wall.node().add_solid(CollisionPolygon(Point3(0, 5, -5), Point3(0, 5, 5),
+                                           Point3(0, -5, 5), Point3(0, -5, -5)))
+
+    mover = root.attach_new_node(CollisionNode("mover"))
+    mover.node().add_solid(CollisionBox(Point3(0, 0, 0), 0.5, 0.5, 0.5))
+    mover.node().set_into_collide_mask(0)
+    mover.set_pos(0.5, 0, 0)
+    return root, balls, wall, mover
+
+
+def test_collision_stats_counts():
+    root, balls, wall, mover = make_scene()
+
+    trav = CollisionTraverser()
+    queue = CollisionHandlerQueue()
+    trav.add_collider(mover, queue)
+
+    stats = CollisionStats()
+    trav.stats = stats
+    assert trav.has_stats()
+
+    trav.traverse(root)
+    trav.traverse(root)
+    assert stats.num_traversals == 2
+    assert queue.get_num_entries() == 2
+
+    # The mover touches the first ball and the wall, but not the second ball,
+    # which is rejected by its bounding volume.
+    total = stats.total
+    assert total.num_tests == 4
+    assert total.num_hits == 4
+    assert total.num_volume_tests > 0
+    assert total.time >= 0
+
+    pairs = {}
+    for i in range(stats.get_num_pairs()):
+        key = (stats.get_pair_from_type(i).name, stats.get_pair_into_type(i).name)
+        pairs[key] = stats.get_pair_counts(i)
+    assert pairs[("CollisionBox", "CollisionSphere")].num_volume_tests == 4
+    assert pairs[("CollisionBox", "CollisionSphere")].num_tests == 2
+    assert pairs[("CollisionBox", "CollisionPolygon")].num_hits == 2
+
+    nodes = {}
+    for i in range(stats.get_num_nodes()):
+        nodes[stats.get_node(i)] = stats.get_node_counts(i)
+    assert nodes[balls].num_tests == 2
+    assert nodes[wall].num_tests == 2
+
+    assert list(stats.colliders) == [mover]
+    assert stats.get_collider_counts(0).num_tests == 4
+
+    # The results are written as a table and as CSV.
+    out = StringStream()
+    stats.write(out)
+    assert b"CollisionBox / CollisionSphere" in out.data
+
+    out = StringStream()
+    stats.write_csv(out)
+    lines = out.data.decode().splitlines()
+    assert lines[0] == "kind,from,into,volume_tests,tests,hits,time_ms"
+    assert len(lines) == 1 + 2 + 2 + 1
+
+    stats.clear()
+    assert stats.num_traversals == 0
+    assert stats.get_num_pairs() == 0
+    assert stats.total.num_tests == 0
+
+    # Statistics are no longer recorded once removed.
+    trav.clear_stats()
+    trav.traverse(root)
+    assert stats.num_traversals == 0
+    assert queue.get_num_entries() == 2
@@ -0,0 +1,47 @@
+from panda3d.core import CollisionTraverser, CollisionHandlerQueue, CollisionNode
+from panda3d.core import CollisionSphere, NodePath
+import random
+import pytest
+
+
+def make_scene():
+    random.seed(7)
+    root = NodePath("root")
+    colliders = []
+    for i in range(150):
+        np = root.attach_new_node(CollisionNode("from%d" % i))
+        np.node().add_solid(CollisionSphere(0, 0, 0, 1.5))
+        np.set_pos(random.uniform(-15, 15), random.uniform(-15, 15), 0)
+        colliders.append(np)
+    return root, colliders
+
+
+def collect(num_threads, use_broadphase):
+    root, colliders = make_scene()
+    trav = CollisionTraverser()
+    trav.num_threads = num_threads
+    trav.use_broadphase = use_broadphase
+    queue = CollisionHandlerQueue()
+    for np in colliders:
+        trav.add_collider(np, queue)
+
+    trav.traverse(root)
+    return [(e.get_from_node_path().get_name(),
+             e.get_into_node_path().get_name(),
+             e.get_surface_point(root))
+            for e in queue.entries]
+
+
+@pytest.mark.parametrize("use_broadphase", [False, True])
+def test_collision_threads_deterministic(use_broadphase):
+    expected = collect(1, use_broadphase)
+    assert len(expected) > 0
+
+    for num_threads in (2, 4):
+        result = collect(num_threads, use_broadphase)
+
+        # Not only the same entries, but in the same order.
+        assert len(result) == len(expected)
+        for (f1, i1, p1), (f2, i2, p2) in zip(result, expected):
+            assert (f1, i1) == (f2, i2)
+            assert p1 == p2
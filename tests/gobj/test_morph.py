@@ -0,0 +1,129 @@
+from panda3d import core
+
+
+NUM_ROWS = 8
+
+
+def make_morph_data(num_components=3, numeric_type=core.GeomEnums.NT_float32,
+                    separate_arrays=False):
+    vertex = core.InternalName.get_vertex()
+    morph = core.InternalName.get_morph(vertex, "smile")
+
+    format = core.GeomVertexFormat()
+    array_format = core.GeomVertexArrayFormat()
+    array_format.add_column(vertex, num_components, numeric_type, core.GeomEnums.C_point)
+    if separate_arrays:
+        # The vertex column is tightly packed in an array of its own.
+        format.add_array(array_format)
+        array_format = core.GeomVertexArrayFormat()
+    array_format.add_column(morph, 3, numeric_type, core.GeomEnums.C_morph_delta)
+    format.add_array(array_format)
+    spec = core.GeomVertexAnimationSpec()
+    spec.set_panda()
+    format.set_animation(spec)
+    format = core.GeomVertexFormat.register_format(format)
+
+    vdata = core.GeomVertexData("morph", format, core.GeomEnums.UH_dynamic)
+    vdata.set_num_rows(NUM_ROWS)
+    writer = core.GeomVertexWriter(vdata, vertex)
+    delta = core.GeomVertexWriter(vdata, morph)
+    for i in range(NUM_ROWS):
+        if num_components == 4:
+            writer.set_data4(i, 0, 0, 1)
+        else:
+            writer.set_data3(i, 0, 0)
+        # Only the odd rows are actually moved by the morph.
+        delta.set_data3(0, 0, 1 if i % 2 else 0)
+
+    slider = core.UserVertexSlider(core.InternalName.make("smile"))
+    rows = core.SparseArray()
+    rows.set_range(0, NUM_ROWS // 2)
+    table = core.SliderTable()
+    table.add_slider(slider, rows)
+    vdata.set_slider_table(core.SliderTable.register_table(table))
+    return vdata, slider
+
+
+def get_vertices(vdata):
+    reader = core.GeomVertexReader(vdata, core.InternalName.get_vertex())
+    result = []
+    while not reader.is_at_end():
+        result.append(tuple(reader.get_data3()))
+    return result
+
+
+def expected_vertices(weight):
+    return [(i, 0, weight if i % 2 and i < NUM_ROWS // 2 else 0)
+            for i in range(NUM_ROWS)]
+
+
+def test_morph_zero_weight():
+    vdata, slider = make_morph_data()
+    slider.set_slider(0)
+    animated = vdata.animate_vertices(True, core.Thread.get_current_thread())
+    assert get_vertices(animated) == expected_vertices(0)
+
+
+def test_morph_weight():
+    vdata, slider = make_morph_data()
+    slider.set_slider(0.5)
+    animated = vdata.animate_vertices(True, core.Thread.get_current_thread())
+    assert get_vertices(animated) == expected_vertices(0.5)
+
+    # Changing the weight reuses the same deltas.
+    slider.set_slider(2)
+    animated = vdata.animate_vertices(True, core.Thread.get_current_thread())
+    assert get_vertices(animated) == expected_vertices(2)
+
+
+def test_morph_modified_deltas():
+    vdata, slider = make_morph_data()
+    slider.set_slider(1)
+    animated = vdata.animate_vertices(True, core.Thread.get_current_thread())
+    assert get_vertices(animated) == expected_vertices(1)
+
+    # Changing the deltas is picked up on the next animation.
+    delta = core.GeomVertexWriter(vdata, core.InternalName.get_morph(core.InternalName.get_vertex(), "smile"))
+    delta.set_row(0)
+    delta.set_data3(0, 0, 3)
+    animated = vdata.animate_vertices(True, core.Thread.get_current_thread())
+    expected = expected_vertices(1)
+    expected[0] = (0, 0, 3)
+    assert get_vertices(animated) == expected
+
+
+def test_morph_homogeneous():
+    vdata, slider = make_morph_data(4)
+    slider.set_slider(0.5)
+    animated = vdata.animate_vertices(True, core.Thread.get_current_thread())
+    assert get_vertices(animated) == expected_vertices(0.5)
+
+
+def test_morph_non_float():
+    vdata, slider = make_morph_data(3, core.GeomEnums.NT_float64)
+    slider.set_slider(0.25)
+    animated = vdata.animate_vertices(True, core.Thread.get_current_thread())
+    assert get_vertices(animated) == expected_vertices(0.25)
+
+
+def test_morph_separate_array():
+    vdata, slider = make_morph_data(separate_arrays=True)
+    slider.set_slider(0.5)
+    animated = vdata.animate_vertices(True, core.Thread.get_current_thread())
+    assert get_vertices(animated) == expected_vertices(0.5)
+
+
+def test_morph_runs():
+    # Consecutive moved rows, with a gap in between.
+    for separate_arrays in (False, True):
+        vdata, slider = make_morph_data(separate_arrays=separate_arrays)
+        delta = core.GeomVertexWriter(vdata, core.InternalName.get_morph(core.InternalName.get_vertex(), "smile"))
+        for i, z in enumerate((1, 2, 0, 3)):
+            delta.set_data3(0, 0, z)
+        slider.set_slider(2)
+        animated = vdata.animate_vertices(True, core.Thread.get_current_thread())
+        expected = [(i, 0, 0) for i in range(NUM_ROWS)]
+        expected[0] = (0, 0, 2)
+        expected[1] = (1, 0, 4)
+        expected[3] = (3, 0, 6)
+        assert get_vertices(animated) == expected
@@ -1,6 +1,7 @@
 from panda3d.core import Texture, PNMImage, LColor
 from array import array
 import math
+import pytest
 
 
 def image_from_stored_pixel(component_type, format, data):
@@ -134,3 +135,66 @@ def test_texture_clear_half():
     assert col.y == -inf
     assert col.z == -inf
     assert math.isnan(col.w)
+
+
+def read_texture_from_image(tmpdir, img, extension, direct):
+    from panda3d.core import Filename, ConfigVariableBool
+
+    path = Filename.from_os_specific(str(tmpdir.join("image." + extension)))
+
+    # A small image would otherwise be written as a palette image, which is
+    # read back as a color image.
+    palette = ConfigVariableBool('png-palette')
+    palette.set_value(False)
+    try:
+        if not img.write(path):
+            pytest.skip("cannot write ." + extension + " files")
+    finally:
+        palette.clear_local_value()
+
+    var = ConfigVariableBool('textures-direct-decode')
+    var.set_value(direct)
+    try:
+        tex = Texture("")
+        assert tex.read(path)
+    finally:
+        var.clear_local_value()
+    return tex
+
+
+@pytest.mark.parametrize("num_channels", [1, 2, 3, 4])
+def test_texture_read_direct_png(tmpdir, num_channels):
+    img = PNMImage(8, 4, num_channels)
+    for y in range(4):
+        for x in range(8):
+            # Setting a color would turn a grayscale image into a color one.
+            if img.is_grayscale():
+                img.set_gray_val(x, y, x * 30)
+            else:
+                img.set_xel_val(x, y, x * 30, y * 60, x * y)
+            if img.has_alpha():
+                img.set_alpha_val(x, y, 255 - x)
+
+    direct = read_texture_from_image(tmpdir, img, "png", True)
+    indirect = read_texture_from_image(tmpdir, img, "png", False)
+
+    assert direct.get_num_components() == num_channels
+    assert direct.get_component_type() == Texture.T_unsigned_byte
+    assert bytes(direct.get_ram_image()) == bytes(indirect.get_ram_image())
+
+    if num_channels == 4:
+        # The bottom row comes first, in BGRA order.
+        assert tuple(bytes(direct.get_ram_image())[:8]) == (0, 180, 0, 255, 3, 180, 30, 254)
+
+
+def test_texture_read_direct_jpg(tmpdir):
+    img = PNMImage(16, 8, 3)
+    for y in range(8):
+        for x in range(16):
+            img.set_xel_val(x, y, x * 16, y * 32, 128)
+
+    direct = read_texture_from_image(tmpdir, img, "jpg", True)
+    indirect = read_texture_from_image(tmpdir, img, "jpg", False)
+
+    assert direct.get_num_components() == 3
+    assert bytes(direct.get_ram_image()) == bytes(indirect.get_ram_image())
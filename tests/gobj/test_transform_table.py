@@ -0,0 +1,65 @@
+from panda3d import core
+import struct
+
+
+def make_table(num_transforms):
+    transforms = [core.UserVertexTransform("t%d" % i) for i in range(num_transforms)]
+    table = core.TransformTable()
+    for transform in transforms:
+        table.add_transform(transform)
+    return core.TransformTable.register_table(table), transforms
+
+
+def unpack_palette(buffer):
+    data = bytes(buffer.get_data())
+    assert len(data) == buffer.data_size_bytes
+    matrices = []
+    for i in range(len(data) // 64):
+        matrices.append(core.LMatrix4f(*struct.unpack_from("16f", data, i * 64)))
+    return matrices
+
+
+def test_transform_table_palette_buffer():
+    table, transforms = make_table(3)
+
+    buffer = table.get_palette_buffer()
+    assert buffer.data_size_bytes == 3 * 64
+    assert buffer.usage_hint == core.GeomEnums.UH_dynamic
+
+    # Asking again without changing anything returns the same contents.
+    modified = buffer.modified
+    assert table.get_palette_buffer() == buffer
+    assert buffer.modified == modified
+
+    # The buffer holds the matrices of the transforms, in order.
+    assert unpack_palette(buffer) == [core.LMatrix4f.ident_mat()] * 3
+
+    # Changing a transform repacks the same buffer.
+    matrix = core.Mat4.translate_mat(1, 2, 3) * core.Mat4.scale_mat(2)
+    transforms[1].set_matrix(matrix)
+    assert table.get_palette_buffer() == buffer
+    assert buffer.modified != modified
+
+    palette = unpack_palette(buffer)
+    assert palette[0] == core.LMatrix4f.ident_mat()
+    assert palette[1].almost_equal(core.LMatrix4f(matrix))
+    assert palette[2] == core.LMatrix4f.ident_mat()
+
+
+def test_transform_table_palette_buffer_empty():
+    table, transforms = make_table(0)
+
+    # There is always room for at least one matrix.
+    buffer = table.get_palette_buffer()
+    assert buffer.data_size_bytes == 64
+    assert unpack_palette(buffer) == [core.LMatrix4f.ident_mat()]
+
+
+def test_shader_buffer_set_data():
+    buffer = core.ShaderBuffer("test", b"\x01\x02\x03", core.GeomEnums.UH_dynamic)
+    assert buffer.data_size_bytes == 16
+
+    modified = buffer.modified
+    buffer.set_data(b"\x00" * 20)
+    assert buffer.data_size_bytes == 32
+    assert buffer.modified != modified
@@ -0,0 +1,79 @@
+from panda3d.core import TextureAtlas, PNMImage, LTexCoord, LVecBase4i, LColor
+
+
+def make_image(x_size, y_size, color):
+    img = PNMImage(x_size, y_size, 4)
+    img.fill(*color[:3])
+    img.alpha_fill(color[3])
+    return img
+
+
+def test_texture_atlas_add_remove():
+    atlas = TextureAtlas("atlas", 64, 64, 1)
+    assert atlas.get_num_images() == 0
+
+    a = atlas.add_image(make_image(30, 30, (1, 0, 0, 1)))
+    b = atlas.add_image(make_image(30, 30, (0, 1, 0, 1)))
+    c = atlas.add_image(make_image(30, 30, (0, 0, 1, 1)))
+    d = atlas.add_image(make_image(30, 30, (1, 1, 1, 1)))
+    assert -1 not in (a, b, c, d)
+    assert atlas.get_num_images() == 4
+
+    # The atlas is now full.
+    assert atlas.add_image(make_image(30, 30, (0, 0, 0, 1))) == -1
+
+    # Regions may not overlap.
+    regions = [atlas.get_image_region(i) for i in (a, b, c, d)]
+    for i, r1 in enumerate(regions):
+        for r2 in regions[i + 1:]:
+            assert (r1[0] + r1[2] <= r2[0] or r2[0] + r2[2] <= r1[0] or
+                    r1[1] + r1[3] <= r2[1] or r2[1] + r2[3] <= r1[1])
+
+    # Removing all of the images frees up the whole texture again.
+    for i in (a, b, c, d):
+        assert atlas.remove_image(i)
+    assert not atlas.has_image(a)
+    assert not atlas.remove_image(a)
+    assert atlas.get_used_fraction() == 0
+
+    e = atlas.add_image(make_image(62, 62, (1, 1, 0, 1)))
+    assert e != -1
+    assert atlas.get_image_region(e) == LVecBase4i(1, 1, 62, 62)
+
+
+def fetch(atlas, x, y):
+    # Texture rows are stored bottom-up.
+    color = LColor()
+    atlas.get_texture().peek().fetch_pixel(color, x, atlas.get_y_size() - 1 - y)
+    return color
+
+
+def test_texture_atlas_contents():
+    atlas = TextureAtlas("atlas", 32, 32, 2)
+    red = atlas.add_image(make_image(4, 4, (1, 0, 0, 1)))
+    green = atlas.add_image(make_image(8, 2, (0, 1, 0, 0.5)))
+
+    for id, color in ((red, (1, 0, 0, 1)), (green, (0, 1, 0, 128 / 255.0))):
+        x, y, x_size, y_size = atlas.get_image_region(id)
+        assert fetch(atlas, x + x_size // 2, y + y_size // 2).almost_equal(color, 0.01)
+
+        # The margin repeats the edge pixels.
+        assert fetch(atlas, x - 2, y - 2).almost_equal(color, 0.01)
+        assert fetch(atlas, x + x_size + 1, y).almost_equal(color, 0.01)
+
+        u0, v0, u1, v1 = atlas.get_uv_rect(id)
+        assert u0 == x / 32.0 and u1 == (x + x_size) / 32.0
+        assert v0 == 1 - (y + y_size) / 32.0 and v1 == 1 - y / 32.0
+        uv = atlas.remap_uv(id, LTexCoord(0.5, 0.5))
+        assert uv.almost_equal(LTexCoord((u0 + u1) / 2, (v0 + v1) / 2))
+
+    # Replacing an image updates the texture in place.
+    assert atlas.update_image(red, make_image(4, 4, (0, 0, 1, 1)))
+    x, y, x_size, y_size = atlas.get_image_region(red)
+    assert fetch(atlas, x, y).almost_equal((0, 0, 1, 1), 0.01)
+
+    assert not atlas.update_image(red, make_image(5, 5, (0, 0, 1, 1)))
+
+    # Removing an image clears its region.
+    assert atlas.remove_image(red)
+    assert fetch(atlas, x, y) == (0, 0, 0, 0)
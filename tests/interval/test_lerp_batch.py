@@ -0,0 +1,105 @@
+from panda3d.core import NodePath, Point3, Vec3, Vec4, Quat
+from panda3d.core import TransparencyAttrib
+from panda3d.direct import CLerpBatch, CLerpInterval, CIntervalManager
+
+
+def test_lerp_batch_pos():
+    batch = CLerpBatch()
+    node = NodePath("node")
+    batch.add_pos_lerp(node, 2.0, Point3(0, 0, 0), Point3(4, 0, 0))
+    assert batch.num_lerps == 1
+
+    batch.step(10.0)
+    assert node.get_pos().almost_equal(Point3(0, 0, 0))
+
+    batch.step(11.0)
+    assert node.get_pos().almost_equal(Point3(2, 0, 0))
+    assert batch.num_lerps == 1
+
+    # It is removed once it reaches the end.
+    batch.step(12.5)
+    assert node.get_pos().almost_equal(Point3(4, 0, 0))
+    assert batch.num_lerps == 0
+
+
+def test_lerp_batch_blend():
+    batch = CLerpBatch()
+    node = NodePath("node")
+    batch.add_pos_lerp(node, 1.0, Point3(0, 0, 0), Point3(1, 0, 0),
+                       CLerpInterval.BT_ease_in_out)
+    batch.step(0.0)
+    batch.step(0.25)
+    assert abs(node.get_x() - 0.15625) < 0.0001
+
+
+def test_lerp_batch_same_node():
+    batch = CLerpBatch()
+    node = NodePath("node")
+    node.set_hpr(30, 0, 0)
+    batch.add_pos_lerp(node, 1.0, Point3(0, 0, 0), Point3(0, 2, 0))
+    batch.add_scale_lerp(node, 1.0, Vec3(1, 1, 1), Vec3(3, 3, 3))
+    batch.add_color_lerp(node, 1.0, Vec4(0, 0, 0, 1), Vec4(1, 1, 1, 1))
+    batch.add_color_scale_lerp(node, 1.0, Vec4(1, 1, 1, 1), Vec4(1, 1, 1, 0))
+
+    batch.step(0.0)
+    batch.step(0.5)
+    assert node.get_pos().almost_equal(Point3(0, 1, 0))
+    assert node.get_scale().almost_equal(Vec3(2, 2, 2))
+    assert node.get_hpr().almost_equal(Vec3(30, 0, 0))
+    assert node.get_color().almost_equal(Vec4(0.5, 0.5, 0.5, 1))
+    assert node.get_color_scale().almost_equal(Vec4(1, 1, 1, 0.5))
+
+
+def test_lerp_batch_keeps_other_properties():
+    batch = CLerpBatch()
+    node = NodePath("node")
+    quat = Quat()
+    quat.set_hpr((45, 10, 0))
+    node.set_quat(quat)
+    node.set_shear(0.5, 0, 0)
+    node.set_transparency(TransparencyAttrib.M_alpha)
+    node.set_color_scale(1, 1, 1, 0.25)
+    batch.add_pos_lerp(node, 1.0, Point3(0, 0, 0), Point3(2, 0, 0))
+    batch.add_color_lerp(node, 1.0, Vec4(0, 0, 0, 1), Vec4(1, 0, 0, 1))
+
+    batch.step(0.0)
+    batch.step(0.5)
+    assert node.get_pos().almost_equal(Point3(1, 0, 0))
+    assert node.get_transform().quat_given()
+    assert node.get_quat().almost_equal(quat)
+    assert node.get_shear().almost_equal(Vec3(0.5, 0, 0))
+    assert node.get_color().almost_equal(Vec4(0.5, 0, 0, 1))
+    assert node.get_color_scale().almost_equal(Vec4(1, 1, 1, 0.25))
+    assert node.get_transparency() == TransparencyAttrib.M_alpha
+
+
+def test_lerp_batch_stop():
+    batch = CLerpBatch()
+    node1 = NodePath("node1")
+    node2 = NodePath("node2")
+    batch.add_pos_lerp(node1, 1.0, Point3(0, 0, 0), Point3(1, 0, 0))
+    batch.add_scale_lerp(node1, 1.0, Vec3(1), Vec3(2))
+    batch.add_pos_lerp(node2, 1.0, Point3(0, 0, 0), Point3(1, 0, 0))
+
+    assert batch.stop_lerps(node1) == 2
+    assert batch.num_lerps == 1
+
+    batch.step(0.0)
+    batch.step(0.5)
+    assert node1.get_pos() == Point3(0, 0, 0)
+    assert node2.get_pos().almost_equal(Point3(0.5, 0, 0))
+
+    batch.clear()
+    assert batch.num_lerps == 0
+
+
+def test_interval_manager_lerp_batch():
+    mgr = CIntervalManager()
+    batch = mgr.get_lerp_batch()
+    node = NodePath("node")
+    batch.add_pos_lerp(node, 0.0, Point3(0, 0, 0), Point3(1, 2, 3))
+
+    # A lerp with no duration is applied by the next step, and then removed.
+    mgr.step()
+    assert node.get_pos().almost_equal(Point3(1, 2, 3))
+    assert batch.num_lerps == 0
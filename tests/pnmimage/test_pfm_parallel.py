@@ -0,0 +1,99 @@
+from panda3d.core import PfmFile, LPoint3f, LPoint4f, Mat4, ConfigVariableInt
+import pytest
+
+
+def make_grid(size=256):
+    pfm = PfmFile()
+    pfm.clear(size, size, 3)
+    for yi in range(size):
+        for xi in range(size):
+            pfm.set_point3(xi, yi, ((xi + 0.5) / size, (yi + 0.5) / size, (xi * yi) % 7))
+    return pfm
+
+
+def run_with_threads(num_threads, func):
+    var = ConfigVariableInt('pfm-num-threads')
+    var.set_value(num_threads)
+    # Make sure that the test images are large enough to be divided up.
+    min_points = ConfigVariableInt('pfm-min-points-per-thread')
+    min_points.set_value(1024)
+    try:
+        return func()
+    finally:
+        var.clear_local_value()
+        min_points.clear_local_value()
+
+
+def assert_same(a, b):
+    assert a.get_x_size() == b.get_x_size()
+    assert a.get_y_size() == b.get_y_size()
+    assert a.get_num_channels() == b.get_num_channels()
+    for yi in range(a.get_y_size()):
+        for xi in range(a.get_x_size()):
+            assert a.get_point4(xi, yi) == b.get_point4(xi, yi)
+
+
+def test_pfm_parallel_xform():
+    mat = Mat4.scale_mat(2, 3, 4) * Mat4.translate_mat(1, -1, 0.5)
+
+    def xform():
+        pfm = make_grid()
+        pfm.xform(mat)
+        return pfm
+
+    serial = run_with_threads(1, xform)
+    parallel = run_with_threads(4, xform)
+    assert_same(serial, parallel)
+    assert serial.get_point3(0, 0).almost_equal(mat.xform_point(LPoint3f(0.5 / 256, 0.5 / 256, 0)))
+
+
+def test_pfm_parallel_distort():
+    dist = make_grid()
+    dist.xform(Mat4.scale_mat(0.5, 0.5, 1))
+
+    def forward():
+        pfm = make_grid()
+        pfm.forward_distort(dist)
+        return pfm
+
+    def reverse():
+        pfm = make_grid()
+        pfm.reverse_distort(dist)
+        return pfm
+
+    assert_same(run_with_threads(1, forward), run_with_threads(4, forward))
+    assert_same(run_with_threads(1, reverse), run_with_threads(4, reverse))
+
+
+def test_pfm_parallel_distort_nan():
+    # A NaN found by any of the threads leaves the file unchanged.
+    dist = make_grid()
+    pfm = make_grid()
+    pfm.set_point3(10, 250, (float('nan'), 0, 0))
+    before = PfmFile(pfm)
+
+    def forward():
+        with pytest.raises(AssertionError):
+            pfm.forward_distort(dist)
+
+    run_with_threads(4, forward)
+    assert pfm.get_point3(0, 0) == before.get_point3(0, 0)
+    assert pfm.get_point3(100, 100) == before.get_point3(100, 100)
+
+
+def test_pfm_parallel_tight_bounds():
+    pfm = make_grid()
+    pfm.set_no_data_value(LPoint4f(0, 0, 0, 0))
+    pfm.set_point3(3, 200, (-5, 0.5, 9))
+
+    def bounds():
+        min_point = LPoint3f()
+        max_point = LPoint3f()
+        assert pfm.calc_tight_bounds(min_point, max_point)
+        return min_point, max_point
+
+    serial = run_with_threads(1, bounds)
+    parallel = run_with_threads(4, bounds)
+    assert serial == parallel
+    assert serial[0] == LPoint3f(-5, 0.5 / 256, 0)
+    assert serial[1] == LPoint3f((255.5) / 256, 255.5 / 256, 9)
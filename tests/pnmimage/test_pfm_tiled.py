@@ -0,0 +1,134 @@
+from panda3d.core import PfmFile, PfmTiledFile, Filename, LMatrix4f, LPoint3f
+from panda3d.core import LPoint4f
+
+
+def make_pfm(x_size, y_size):
+    pfm = PfmFile()
+    pfm.clear(x_size, y_size, 3)
+    for y in range(y_size):
+        for x in range(x_size):
+            pfm.set_point(x, y, (x, y, x * 0.5 + y))
+    return pfm
+
+
+def write_tiled(pfm, path, tiled_format):
+    tiled = PfmTiledFile()
+    assert tiled.open_write(path, pfm.get_x_size(), pfm.get_y_size(), 3,
+                            4, 3, tiled_format)
+    tile = PfmFile()
+    for ty in range(tiled.get_num_y_tiles()):
+        for tx in range(tiled.get_num_x_tiles()):
+            tile.clear(tiled.get_tile_width(tx), tiled.get_tile_height(ty), 3)
+            tile.copy_sub_image(pfm, 0, 0, tx * 4, ty * 3)
+            assert tiled.write_tile(tile, tx, ty)
+    tiled.close()
+
+
+def test_pfm_tiled_roundtrip(tmpdir):
+    pfm = make_pfm(10, 7)
+
+    for tiled_format in (False, True):
+        path = Filename.from_os_specific(str(tmpdir.join("test.pfm")))
+        write_tiled(pfm, path, tiled_format)
+
+        # The whole file can also be read in at once.
+        full = PfmFile()
+        assert full.read(path)
+        assert full.get_x_size() == 10 and full.get_y_size() == 7
+        assert full.get_point(9, 6) == pfm.get_point(9, 6)
+        assert full.get_point(3, 4) == pfm.get_point(3, 4)
+
+        tiled = PfmTiledFile()
+        assert tiled.open_read(path, 4, 3)
+        assert tiled.is_tiled_format() == tiled_format
+        assert tiled.get_num_x_tiles() == 3
+        assert tiled.get_num_y_tiles() == 3
+
+        region = PfmFile()
+        assert tiled.read_region(region, 2, 1, 7, 5)
+        for y in range(5):
+            for x in range(7):
+                assert region.get_point(x, y) == pfm.get_point(x + 2, y + 1)
+
+        p = LPoint3f()
+        assert tiled.calc_bilinear_point(p, 0.5, 0.5)
+        assert p.almost_equal(LPoint3f(4.5, 3, 5.25))
+        tiled.close()
+
+
+def test_pfm_tiled_streaming(tmpdir):
+    pfm = make_pfm(9, 5)
+    path = Filename.from_os_specific(str(tmpdir.join("source.pfm")))
+    assert pfm.write(path)
+
+    source = PfmTiledFile()
+    source.set_max_resident_tiles(1)
+    assert source.open_read(path, 4, 2)
+
+    min_p, max_p = LPoint3f(), LPoint3f()
+    assert source.calc_min_max(min_p, max_p)
+    assert min_p == LPoint3f(0, 0, 0)
+    assert max_p == LPoint3f(8, 4, 8)
+
+    mat = LMatrix4f.translate_mat(1, 2, 3)
+    dest_path = Filename.from_os_specific(str(tmpdir.join("dest.pfm")))
+    dest = PfmTiledFile()
+    assert dest.open_write(dest_path, 9, 5, 3, 3, 3)
+    assert source.xform(dest, mat)
+    dest.close()
+
+    expected = PfmFile(pfm)
+    expected.xform(mat)
+    result = PfmFile()
+    assert result.read(dest_path)
+    for y in range(5):
+        for x in range(9):
+            assert result.get_point(x, y) == expected.get_point(x, y)
+
+    # Reducing the width to a third averages each three adjacent points.
+    assert dest.open_write(dest_path, 3, 5, 3, 2, 2)
+    assert source.resize(dest)
+    dest.close()
+    assert result.read(dest_path)
+    assert result.get_x_size() == 3
+    assert result.get_point(0, 0).almost_equal(LPoint3f(1, 0, 0.5))
+
+
+def test_pfm_tiled_four_channels(tmpdir):
+    x_size, y_size = 6, 5
+    pfm = PfmFile()
+    pfm.clear(x_size, y_size, 4)
+    dist = PfmFile()
+    dist.clear(x_size, y_size, 2)
+    for y in range(y_size):
+        for x in range(x_size):
+            pfm.set_point4(x, y, (x, y, x * 0.5 + y, x + y * 10))
+            dist.set_point2(x, y, ((x + 0.5) / x_size, (y + 0.5) / y_size))
+    path = Filename.from_os_specific(str(tmpdir.join("source.pfm")))
+    assert pfm.write(path)
+    dist_path = Filename.from_os_specific(str(tmpdir.join("dist.pfm")))
+    assert dist.write(dist_path)
+
+    source = PfmTiledFile()
+    assert source.open_read(path, 4, 2)
+    assert source.get_num_channels() == 4
+    dist_file = PfmTiledFile()
+    assert dist_file.open_read(dist_path, 4, 2)
+
+    p = LPoint4f()
+    assert source.calc_bilinear_point4(p, 0.5, 0.5)
+    assert p.almost_equal(LPoint4f(2.5, 2, 3.25, 22.5))
+
+    # The fourth channel is carried through, just like the others.
+    dest_path = Filename.from_os_specific(str(tmpdir.join("dest.pfm")))
+    dest = PfmTiledFile()
+    assert dest.open_write(dest_path, x_size, y_size, 4, 4, 2)
+    assert source.forward_distort(dest, dist_file)
+    dest.close()
+
+    result = PfmFile()
+    assert result.read(dest_path)
+    assert result.get_num_channels() == 4
+    for y in range(y_size):
+        for x in range(x_size):
+            assert result.get_point4(x, y).almost_equal(pfm.get_point4(x, y), 0.001)
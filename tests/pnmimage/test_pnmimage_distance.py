@@ -0,0 +1,69 @@
+from panda3d.core import PNMImage, PfmFile
+
+
+def make_mask():
+    # A 4x3 white rectangle on a black 12x9 background.
+    mask = PNMImage(12, 9, 1)
+    mask.fill(0)
+    for y in range(3, 6):
+        for x in range(4, 8):
+            mask.set_gray(x, y, 1)
+    return mask
+
+
+def test_fill_distance_outside():
+    mask = make_mask()
+    dist = PNMImage()
+    dist.fill_distance_outside(mask, 0.5, 8)
+    assert dist.get_maxval() == 8
+
+    for y in range(mask.get_y_size()):
+        for x in range(mask.get_x_size()):
+            dx = max(4 - x, 0, x - 7)
+            dy = max(3 - y, 0, y - 5)
+            assert dist.get_gray_val(x, y) == min(dx + dy, 8)
+
+
+def test_fill_distance_inside():
+    mask = make_mask()
+    dist = PNMImage()
+    dist.fill_distance_inside(mask, 0.5, 4, True)
+
+    # Inside the rectangle, we measure to the nearest black pixel.
+    assert dist.get_gray_val(4, 3) == 1
+    assert dist.get_gray_val(5, 4) == 2
+    assert dist.get_gray_val(0, 0) == 0
+
+    # Everything is close to the image border when shrinking from it.
+    mask.fill(1)
+    dist.fill_distance_inside(mask, 0.5, 4, True)
+    assert dist.get_gray_val(0, 4) == 1
+    assert dist.get_gray_val(1, 4) == 2
+    assert dist.get_gray_val(6, 4) == 4
+
+
+def test_pfm_fill_signed_distance():
+    mask = make_mask()
+    pfm = PfmFile()
+    pfm.fill_signed_distance(mask, 0.5)
+    assert pfm.get_num_channels() == 1
+
+    # Pixels adjacent to the boundary are half a pixel away from it.
+    assert pfm.get_point1(4, 3) == 0.5
+    assert pfm.get_point1(3, 4) == -0.5
+    assert pfm.get_point1(5, 4) == 1.5
+
+    # The distance to the nearest inside pixel is Euclidean.
+    assert pfm.get_point1(0, 0) == -4.5
+    assert abs(pfm.get_point1(2, 1) - (0.5 - 8 ** 0.5)) < 1e-5
+
+
+def test_fill_signed_distance():
+    mask = make_mask()
+    sdf = PNMImage()
+    sdf.fill_signed_distance(mask, 0.5, 2.0)
+    assert sdf.get_num_channels() == 1
+
+    assert sdf.get_gray(0, 0) == 0
+    assert abs(sdf.get_gray(4, 3) - 0.625) < 0.01
+    assert abs(sdf.get_gray(3, 4) - 0.375) < 0.01